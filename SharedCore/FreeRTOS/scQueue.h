@@ -82,6 +82,11 @@ namespace SharedCore
 			/// </summary>
 			virtual uint32_t SpacesAvailable(void)  { return 0; }
 
+			/// <summary>
+			/// Return the number of items waiting in the queue.
+			/// </summary>
+			virtual uint32_t MessagesWaiting(void)  { return 0; }
+
 		};
 	}
 }	// namespace SharedCore::FreeRTOS
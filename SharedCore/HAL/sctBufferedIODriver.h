@@ -20,6 +20,9 @@
 #include <string.h>
 #include "scRingBuffer.h"
 #include "scErrorCodes.h"
+#include "scProfiler.h"
+#include "scTimeline.h"
+#include "scMetrics.h"
 
 #ifndef assert_param
 #define assert_param(X)	if ( !(X) ) { for(;;) ; }
@@ -62,8 +65,43 @@ namespace SharedCore
 			/// protection for the situations where it is required.</param>
 			void SetQueue( scRingBuffer* pQueueIn, scRingBuffer* pQueueOut );
 
+			/// <summary>
+			/// Copy a block of data into the transmit queue and signal the device to start
+			/// sending it.
+			/// </summary>
+			/// <param name="pBuffer">Pointer to the data to send.</param>
+			/// <param name="nLength">Number of bytes to send.</param>
 			uint32_t Send_n( const uint8_t* pBuffer, uint32_t nLength );
 
+			/// <summary>
+			/// Scatter-gather version of Send_n. All of the segments are copied into the
+			/// transmit queue, in order, while holding the queue lock once and the device
+			/// is signaled to start sending only after the last segment has been queued.
+			/// This allows a header, payload and trailer that live in different buffers to
+			/// go out as one unit without concatenating them first.
+			/// </summary>
+			/// <param name="pSpans">Array of segments to be sent.</param>
+			/// <param name="nCount">Number of segments in the array.</param>
+			uint32_t Send_v( const scIOSpan_t* pSpans, uint32_t nCount );
+
+			/// <summary>
+			/// Format text straight into the transmit queue and signal the device to start
+			/// sending it. Unlike Send_n this does not wait for room, text that does not
+			/// fit is truncated and the overflow is flagged.
+			/// </summary>
+			/// <param name="pFormat">The format string, see scFormat.</param>
+			/// <param name="ap">The arguments.</param>
+			uint32_t Send_f( const char* pFormat, va_list ap );
+
+			/// <summary>
+			/// Number of bytes that can be queued for sending without waiting for the
+			/// device. There is no limit when no transmit queue is assigned.
+			/// </summary>
+			uint32_t SendSpace(void) const
+			{
+				return ( _pQueueOut != NULL ) ? _pQueueOut->Available() : 0xFFFFFFFF;
+			}
+
 			uint32_t Recv_n( uint8_t* pBuffer, uint32_t nLength );
 
 			/// <summary>
@@ -139,43 +177,117 @@ namespace SharedCore
 			delete _pQueueOut;
 		}
 
+		/// <summary>
+		/// Copy a block of data into the transmit queue and signal the device to start
+		/// sending it.
+		/// </summary>
+		/// <param name="pBuffer">Pointer to the data to send.</param>
+		/// <param name="nLength">Number of bytes to send.</param>
 		template<class Base_T>
 		uint32_t sctBufferedIODriver<Base_T>::Send_n( const uint8_t* pBuffer, uint32_t nLength )
+		{
+			scIOSpan_t span;
+			span._pData = pBuffer;
+			span._nLength = nLength;
+			return Send_v( &span, 1 );
+		}
+
+		/// <summary>
+		/// Scatter-gather version of Send_n. All of the segments are copied into the
+		/// transmit queue, in order, while holding the queue lock once and the device
+		/// is signaled to start sending only after the last segment has been queued.
+		/// </summary>
+		/// <param name="pSpans">Array of segments to be sent.</param>
+		/// <param name="nCount">Number of segments in the array.</param>
+		template<class Base_T>
+		uint32_t sctBufferedIODriver<Base_T>::Send_v( const scIOSpan_t* pSpans, uint32_t nCount )
 		{
 			uint32_t overflow = 10000;
-			while( nLength > 0 && overflow > 0 && _pQueueOut != NULL )
+			uint32_t nSent = 0;
+			scPROFILE_SCOPE( scPROBE_SEND );
+
+			if ( _pQueueOut != NULL && pSpans != NULL )
 			{
 				_pQueueOut->Lock();
-				uint32_t nLimit = _pQueueOut->WriteStart();
-				if ( nLimit == 0 )
+				for( uint32_t i=0; i < nCount && overflow > 0; ++i )
 				{
-					// this will let the ISR trigger to clear data from the send buffer provided
-					// we are not getting called from an ISR. IF we are in an ISR this will not
-					// work and the program will get stuck here.
-					_pQueueOut->Unlock();
-					overflow--;
-					_pQueueOut->Lock();
-				}
-				else if ( nLimit >= nLength )
-				{
-					nLimit = _pQueueOut->WriteBlock( pBuffer, nLength );
-					nLength = 0;
-				}
-				else
-				{
-					nLimit = _pQueueOut->WriteBlock( pBuffer, nLimit );
-					nLength -= nLimit;
-					pBuffer += nLimit;
+					const uint8_t*	pBuffer = pSpans[i]._pData;
+					uint32_t		nLength = pSpans[i]._nLength;
+
+					while( nLength > 0 && overflow > 0 )
+					{
+						uint32_t nLimit = _pQueueOut->WriteStart();
+						if ( nLimit == 0 )
+						{
+							_pQueueOut->WriteEnd( 0 );
+							// The queue is full. Release the lock and get the device moving so the
+							// ISR can clear data from the send buffer provided we are not getting
+							// called from an ISR. If we are in an ISR this will not work and the
+							// program will get stuck here until the overflow count runs out.
+							_pQueueOut->Unlock();
+							scTIMELINE_INSTANT( "driver", "TriggerSend", _pQueueOut->InUse() );
+							TriggerSend();
+							overflow--;
+							_pQueueOut->Lock();
+						}
+						else if ( nLimit >= nLength )
+						{
+							nLimit = _pQueueOut->WriteBlock( pBuffer, nLength );
+							nSent += nLimit;
+							nLength = 0;
+						}
+						else
+						{
+							nLimit = _pQueueOut->WriteBlock( pBuffer, nLimit );
+							nSent += nLimit;
+							nLength -= nLimit;
+							pBuffer += nLimit;
+						}
+					}
 				}
 				_pQueueOut->Unlock();
+				scMETRIC_ADD( scMETRIC_DRIVER_TOTAL_BYTES_OUT, nSent );
 			}
 
 			if ( overflow == 0 )
 			{
 				Base_T::SetLastError( ERROR_SC_BUFFER_OVERFLOW );
 				_bOverflow = true;
+				scMETRIC_ADD( scMETRIC_DRIVER_TOTAL_OVERFLOWS, 1 );
+			}
+
+			scTIMELINE_INSTANT( "driver", "TriggerSend", ( _pQueueOut != NULL ) ? _pQueueOut->InUse() : 0 );
+			TriggerSend();
+			return Base_T::GetLastError();
+		}
+
+		/// <summary>
+		/// Format text straight into the transmit queue and signal the device to start
+		/// sending it. Unlike Send_n this does not wait for room, text that does not
+		/// fit is truncated and the overflow is flagged.
+		/// </summary>
+		/// <param name="pFormat">The format string, see scFormat.</param>
+		/// <param name="ap">The arguments.</param>
+		template<class Base_T>
+		uint32_t sctBufferedIODriver<Base_T>::Send_f( const char* pFormat, va_list ap )
+		{
+			if ( _pQueueOut != NULL && pFormat != NULL )
+			{
+				_pQueueOut->Lock();
+				uint32_t nFree = _pQueueOut->Available();
+				uint32_t nLength = _pQueueOut->WriteFormat( pFormat, ap );
+				_pQueueOut->Unlock();
+				scMETRIC_ADD( scMETRIC_DRIVER_TOTAL_BYTES_OUT, ( nLength > nFree ) ? nFree : nLength );
+
+				if ( nLength > nFree )
+				{
+					Base_T::SetLastError( ERROR_SC_BUFFER_OVERFLOW );
+					_bOverflow = true;
+					scMETRIC_ADD( scMETRIC_DRIVER_TOTAL_OVERFLOWS, 1 );
+				}
 			}
 
+			scTIMELINE_INSTANT( "driver", "TriggerSend", ( _pQueueOut != NULL ) ? _pQueueOut->InUse() : 0 );
 			TriggerSend();
 			return Base_T::GetLastError();
 		}
@@ -201,6 +313,7 @@ namespace SharedCore
 					_pQueueIn->ReadEnd( nFirstCopy );
 				}
 				_pQueueIn->Unlock();
+				scMETRIC_ADD( scMETRIC_DRIVER_TOTAL_BYTES_IN, nResult );
 			}
 			return nResult;
 		}
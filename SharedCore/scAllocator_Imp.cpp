@@ -28,6 +28,7 @@
 
 
 #include "scAllocator_Imp.h"
+#include "scAtomic.h"
 
 using SharedCore::scAllocator_Imp;
 
@@ -35,6 +36,9 @@ using SharedCore::scAllocator_Imp;
 /// Construct the implementation object.
 /// </summary>
 scAllocator_Imp::scAllocator_Imp()
+	: _nAllocations( 0 )
+	, _nReleases( 0 )
+	, _nBytes( 0 )
 {
 
 }
@@ -56,6 +60,8 @@ scAllocator_Imp::~scAllocator_Imp()
 /// switching of where memory will come from. Not used by default.</param>
 uint8_t* scAllocator_Imp::Allocate(uint32_t nSize, bool bIsStatic, size_t nType )
 {
+	SharedCore::scAtomicAdd( &_nAllocations, 1 );
+	SharedCore::scAtomicAdd( &_nBytes, nSize );
 	return new uint8_t[nSize];
 }
 
@@ -68,6 +74,23 @@ uint8_t* scAllocator_Imp::Allocate(uint32_t nSize, bool bIsStatic, size_t nType
 /// </param>
 void scAllocator_Imp::Destroy( void* pBuffer)
 {
+	if ( pBuffer != NULL )
+	{
+		SharedCore::scAtomicAdd( &_nReleases, 1 );
+	}
 	delete reinterpret_cast<uint8_t*>(pBuffer);
 }
 
+/// <summary>
+/// Obtain the usage counts of the allocator. The new operator does not return NULL
+/// so there are no failures.
+/// </summary>
+/// <param name="stats">Receives the counts.</param>
+bool scAllocator_Imp::Statistics( SharedCore::scAllocatorStats_t& stats ) const
+{
+	stats._nAllocations = SharedCore::scAtomicLoad( &_nAllocations );
+	stats._nReleases = SharedCore::scAtomicLoad( &_nReleases );
+	stats._nFailures = 0;
+	stats._nBytes = SharedCore::scAtomicLoad( &_nBytes );
+	return true;
+}
@@ -69,6 +69,20 @@ namespace SharedCore
 		/// <param name="pBuffer">pointer to the memory to be released. NULL is allowed.
 		/// </param>
 		virtual void Destroy( void* pBuffer);
+
+		/// <summary>
+		/// Obtain the usage counts of the allocator.
+		/// </summary>
+		/// <param name="stats">Receives the counts.</param>
+		virtual bool Statistics( scAllocatorStats_t& stats ) const;
+
+	private:
+		/// <summary>
+		/// The usage counts, updated with atomics.
+		/// </summary>
+		volatile uint32_t		_nAllocations;
+		volatile uint32_t		_nReleases;
+		volatile uint32_t		_nBytes;
 	};
 
 }
@@ -0,0 +1,200 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scAtomic.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCATOMIC_H__INCLUDED_)
+#define __SCATOMIC_H__INCLUDED_
+
+#include "scTypes.h"
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
+namespace SharedCore
+{
+	// Minimal set of atomic operations on 32 bit values used by the lock-free
+	// classes. GCC and clang use the __atomic builtins, these need LDREX/STREX so on
+	// a Cortex-M0 the compiler support library must provide them. Visual Studio uses
+	// the Interlocked intrinsics.
+
+	/// <summary>
+	/// Read a value shared between threads, later reads are not moved ahead of it.
+	/// </summary>
+	inline uint32_t scAtomicLoad( const volatile uint32_t* pValue )
+	{
+#if defined(_MSC_VER)
+		uint32_t nValue = *pValue;
+		_ReadWriteBarrier();
+		return nValue;
+#else
+		return __atomic_load_n( pValue, __ATOMIC_ACQUIRE );
+#endif
+	}
+
+	/// <summary>
+	/// Write a value shared between threads, earlier writes are visible before it.
+	/// </summary>
+	inline void scAtomicStore( volatile uint32_t* pValue, uint32_t nValue )
+	{
+#if defined(_MSC_VER)
+		_ReadWriteBarrier();
+		*pValue = nValue;
+#else
+		__atomic_store_n( pValue, nValue, __ATOMIC_RELEASE );
+#endif
+	}
+
+	/// <summary>
+	/// Replace the value with nDesired if it still holds nExpected.
+	/// </summary>
+	/// <returns>true if the value was replaced.</returns>
+	inline bool scAtomicCompareExchange( volatile uint32_t* pValue, uint32_t nExpected, uint32_t nDesired )
+	{
+#if defined(_MSC_VER)
+		return (uint32_t)_InterlockedCompareExchange( reinterpret_cast<volatile long*>(pValue), (long)nDesired, (long)nExpected ) == nExpected;
+#else
+		return __atomic_compare_exchange_n( pValue, &nExpected, nDesired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE );
+#endif
+	}
+
+	/// <summary>
+	/// Replace the value.
+	/// </summary>
+	/// <returns>The value replaced.</returns>
+	inline uint32_t scAtomicExchange( volatile uint32_t* pValue, uint32_t nValue )
+	{
+#if defined(_MSC_VER)
+		return (uint32_t)_InterlockedExchange( reinterpret_cast<volatile long*>(pValue), (long)nValue );
+#else
+		return __atomic_exchange_n( pValue, nValue, __ATOMIC_ACQ_REL );
+#endif
+	}
+
+	/// <summary>
+	/// Add to the value.
+	/// </summary>
+	/// <returns>The new value.</returns>
+	inline uint32_t scAtomicAdd( volatile uint32_t* pValue, uint32_t nAdd )
+	{
+#if defined(_MSC_VER)
+		return (uint32_t)_InterlockedExchangeAdd( reinterpret_cast<volatile long*>(pValue), (long)nAdd ) + nAdd;
+#else
+		return __atomic_add_fetch( pValue, nAdd, __ATOMIC_ACQ_REL );
+#endif
+	}
+
+	/// <summary>
+	/// Set bits in the value.
+	/// </summary>
+	inline void scAtomicOr( volatile uint32_t* pValue, uint32_t nBits )
+	{
+#if defined(_MSC_VER)
+		_InterlockedOr( reinterpret_cast<volatile long*>(pValue), (long)nBits );
+#else
+		__atomic_or_fetch( pValue, nBits, __ATOMIC_ACQ_REL );
+#endif
+	}
+
+	/// <summary>
+	/// Clear the bits of the value that are not in the mask.
+	/// </summary>
+	inline void scAtomicAnd( volatile uint32_t* pValue, uint32_t nMask )
+	{
+#if defined(_MSC_VER)
+		_InterlockedAnd( reinterpret_cast<volatile long*>(pValue), (long)nMask );
+#else
+		__atomic_and_fetch( pValue, nMask, __ATOMIC_ACQ_REL );
+#endif
+	}
+
+	/// <summary>
+	/// Full barrier, no read or write is moved across it in either direction. Needed
+	/// where a thread writes one value and then reads another that a second thread
+	/// writes, the other way round.
+	/// </summary>
+	inline void scAtomicFence( void )
+	{
+#if defined(_MSC_VER)
+		long nDummy = 0;
+		_InterlockedExchange( &nDummy, 1 );
+#else
+		__atomic_thread_fence( __ATOMIC_SEQ_CST );
+#endif
+	}
+
+	/// <summary>
+	/// Read a pointer shared between threads, what it points to is read after it.
+	/// </summary>
+	template< typename T >
+	inline T* scAtomicLoadPointer( T* const volatile* ppValue )
+	{
+#if defined(_MSC_VER)
+		T* pValue = *ppValue;
+		_ReadWriteBarrier();
+		return pValue;
+#else
+		return __atomic_load_n( ppValue, __ATOMIC_ACQUIRE );
+#endif
+	}
+
+	/// <summary>
+	/// Publish a pointer to other threads, what it points to is written before it.
+	/// </summary>
+	template< typename T >
+	inline void scAtomicStorePointer( T* volatile* ppValue, T* pValue )
+	{
+#if defined(_MSC_VER)
+		_ReadWriteBarrier();
+		*ppValue = pValue;
+#else
+		__atomic_store_n( ppValue, pValue, __ATOMIC_RELEASE );
+#endif
+	}
+
+	/// <summary>
+	/// Replace the pointer with pDesired if it still holds pExpected.
+	/// </summary>
+	/// <returns>true if the pointer was replaced.</returns>
+	template< typename T >
+	inline bool scAtomicCompareExchangePointer( T* volatile* ppValue, T* pExpected, T* pDesired )
+	{
+#if defined(_MSC_VER)
+		return _InterlockedCompareExchangePointer( reinterpret_cast<void* volatile*>(ppValue), pDesired, pExpected ) == pExpected;
+#else
+		return __atomic_compare_exchange_n( ppValue, &pExpected, pDesired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE );
+#endif
+	}
+}
+
+#endif // !defined(__SCATOMIC_H__INCLUDED_)
@@ -0,0 +1,464 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scConsole.cpp
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#include <string.h>
+#include <stdarg.h>
+#include "scConsole.h"
+#include "scIAllocator.h"
+#include "scIQueue.h"
+#include "scDeviceManager.h"
+#include "scFSM.h"
+#include "scDebugManager.h"
+#include "scFormat.h"
+#include "scMetrics.h"
+#include "scProfiler.h"
+
+using namespace SharedCore;
+
+/// <summary>
+/// Names of the setup states of a device.
+/// </summary>
+static const char* const g_SetupStates[] =
+{
+	"Uninitialized",
+	"Initialized",
+	"Configured",
+	"Unconfigured"
+};
+
+/// <summary>
+/// Constructor.
+/// </summary>
+/// <param name="pDriver">Driver the command lines are read from.</param>
+/// <param name="nLabel">Debug label the answers are traced on.</param>
+scConsole::scConsole( HAL::scBufferIODriver* pDriver, uint16_t nLabel )
+	: _pDriver( pDriver ), _nLabel( nLabel ), _nCommands( 0 ), _nLength( 0 ), _bOverflow( false )
+{
+	_sLine[0] = '\0';
+	AddCommand( "help", "list the commands", &scConsole::HelpCommand, NULL );
+	AddCommand( "labels", "list the debug labels, labels <label|group> on|off", &scConsole::LabelsCommand, NULL );
+#if SC_METRICS_ENABLED
+	AddCommand( "metrics", "dump the metrics, metrics reset", &scConsole::MetricsCommand, NULL );
+#endif
+#if SC_PROFILER_ENABLED
+	AddCommand( "profile", "dump the probes, profile reset", &scConsole::ProfileCommand, NULL );
+#endif
+}
+
+/// <summary>
+/// Destructor.
+/// </summary>
+scConsole::~scConsole()
+{
+}
+
+/// <summary>
+/// Add a command.
+/// </summary>
+/// <returns>false if the table is full or the command exists.</returns>
+bool scConsole::AddCommand( const char* pName, const char* pHelp, Handler_t pHandler, void* pContext )
+{
+	assert_param( pName != NULL && pHandler != NULL );
+
+	if ( _nCommands >= SC_CONSOLE_COMMANDS )
+	{
+		return false;
+	}
+	for( uint32_t i = 0; i < _nCommands; i++ )
+	{
+		if ( strcmp( _Commands[i]._pName, pName ) == 0 )
+		{
+			return false;
+		}
+	}
+	_Commands[_nCommands]._pName = pName;
+	_Commands[_nCommands]._pHelp = ( pHelp != NULL ) ? pHelp : "";
+	_Commands[_nCommands]._pHandler = pHandler;
+	_Commands[_nCommands]._pContext = pContext;
+	_nCommands++;
+	return true;
+}
+
+/// <summary>
+/// Add a command showing the statistics of an allocator.
+/// </summary>
+bool scConsole::AddAllocator( const char* pName, scIAllocator* pAllocator )
+{
+	return AddCommand( pName, "allocator statistics", &scConsole::AllocatorCommand, pAllocator );
+}
+
+/// <summary>
+/// Add a command showing the depth of a queue.
+/// </summary>
+bool scConsole::AddQueue( const char* pName, scIQueue* pQueue )
+{
+	return AddCommand( pName, "queue depth", &scConsole::QueueCommand, pQueue );
+}
+
+/// <summary>
+/// Add the devices command, showing the state of every device of the manager.
+/// </summary>
+bool scConsole::AddDevices( scDeviceManager* pManager )
+{
+	return AddCommand( "devices", "device states", &scConsole::DevicesCommand, pManager );
+}
+
+/// <summary>
+/// Add a command showing the current state of a state machine.
+/// </summary>
+bool scConsole::AddFSM( const char* pName, scFSM* pFsm )
+{
+	return AddCommand( pName, "state machine state", &scConsole::FSMCommand, pFsm );
+}
+
+/// <summary>
+/// Read what the driver received and run every complete line.
+/// </summary>
+/// <returns>Number of lines run.</returns>
+uint32_t scConsole::Poll( void )
+{
+	uint8_t		buffer[16];
+	uint32_t	nLines = 0;
+	uint32_t	nRead;
+
+	while( ( nRead = _pDriver->Recv_n( buffer, sizeof(buffer) ) ) > 0 )
+	{
+		for( uint32_t i = 0; i < nRead; i++ )
+		{
+			char c = (char)buffer[i];
+			if ( c == '\r' || c == '\n' )
+			{
+				if ( _bOverflow )
+				{
+					Print( "line longer than %u characters\n\r", (uint32_t)SC_CONSOLE_LINE );
+				}
+				else if ( _nLength > 0 )
+				{
+					_sLine[_nLength] = '\0';
+					Execute( _sLine );
+					nLines++;
+				}
+				_nLength = 0;
+				_bOverflow = false;
+			}
+			else if ( c == '\b' || c == 0x7F )
+			{
+				if ( _nLength > 0 )
+				{
+					_nLength--;
+				}
+			}
+			else if ( _nLength < SC_CONSOLE_LINE )
+			{
+				_sLine[_nLength++] = c;
+			}
+			else
+			{
+				_bOverflow = true;
+			}
+		}
+	}
+	return nLines;
+}
+
+/// <summary>
+/// Run one command line. The line is split into words in place.
+/// </summary>
+/// <returns>false if the command is not known.</returns>
+bool scConsole::Execute( char* pLine )
+{
+	char*		pArgs[SC_CONSOLE_ARGS];
+	uint32_t	nArgs = 0;
+
+	while( *pLine != '\0' )
+	{
+		while( *pLine == ' ' || *pLine == '\t' )
+		{
+			*pLine++ = '\0';
+		}
+		if ( *pLine == '\0' )
+		{
+			break;
+		}
+		if ( nArgs == SC_CONSOLE_ARGS )
+		{
+			Print( "more than %u words\n\r", (uint32_t)SC_CONSOLE_ARGS );
+			return true;
+		}
+		pArgs[nArgs++] = pLine;
+		while( *pLine != '\0' && *pLine != ' ' && *pLine != '\t' )
+		{
+			pLine++;
+		}
+	}
+
+	if ( nArgs == 0 )
+	{
+		return true;
+	}
+	for( uint32_t i = 0; i < _nCommands; i++ )
+	{
+		if ( strcmp( _Commands[i]._pName, pArgs[0] ) == 0 )
+		{
+			_Commands[i]._pHandler( *this, nArgs, pArgs, _Commands[i]._pContext );
+			return true;
+		}
+	}
+	Print( "unknown command %s, try help\n\r", pArgs[0] );
+	return false;
+}
+
+/// <summary>
+/// Answer the command, formatted as scDebugManager::Trace on a stack buffer.
+/// </summary>
+void scConsole::Print( const char* pFormat, ... )
+{
+	char	sText[SC_CONSOLE_LINE + 1];
+	va_list	ap;
+
+	va_start( ap, pFormat );
+	scFormat::vFormat( sText, sizeof(sText), pFormat, ap );
+	va_end( ap );
+	scDebugManager::Instance()->Trace_Info( _nLabel, sText );
+}
+
+/// <summary>
+/// Read a decimal or 0x prefixed hex number.
+/// </summary>
+/// <returns>false if the text is not a number.</returns>
+bool scConsole::ParseNumber( const char* pText, uint32_t& nValue )
+{
+	uint32_t	nBase = 10;
+
+	if ( pText[0] == '0' && ( pText[1] == 'x' || pText[1] == 'X' ) )
+	{
+		nBase = 16;
+		pText += 2;
+	}
+	if ( *pText == '\0' )
+	{
+		return false;
+	}
+	nValue = 0;
+	for( ; *pText != '\0'; pText++ )
+	{
+		uint32_t nDigit;
+		if ( *pText >= '0' && *pText <= '9' )
+		{
+			nDigit = *pText - '0';
+		}
+		else if ( nBase == 16 && *pText >= 'a' && *pText <= 'f' )
+		{
+			nDigit = *pText - 'a' + 10;
+		}
+		else if ( nBase == 16 && *pText >= 'A' && *pText <= 'F' )
+		{
+			nDigit = *pText - 'A' + 10;
+		}
+		else
+		{
+			return false;
+		}
+		nValue = nValue * nBase + nDigit;
+	}
+	return true;
+}
+
+/// <summary>
+/// help, one line per command.
+/// </summary>
+void scConsole::HelpCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext )
+{
+	(void)nArgs;
+	(void)pArgs;
+	(void)pContext;
+	for( uint32_t i = 0; i < console._nCommands; i++ )
+	{
+		console.Print( "%s - %s\n\r", console._Commands[i]._pName, console._Commands[i]._pHelp );
+	}
+}
+
+/// <summary>
+/// labels lists the labels and their state, labels n on|off or labels group on|off
+/// changes them.
+/// </summary>
+void scConsole::LabelsCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext )
+{
+	(void)pContext;
+	scDebugManager* pDm = scDebugManager::Instance();
+
+	if ( nArgs == 1 )
+	{
+		for( uint16_t nLabel = 0; nLabel < SC_CONSOLE_LABELS; nLabel++ )
+		{
+			const char* pText = pDm->LabelText( nLabel );
+			console.Print( "[%u] %s, %s\n\r", (uint32_t)nLabel, ( pText != NULL ) ? pText : "",
+				scDebugManager::StateText( pDm->LabelState( nLabel ) ) );
+		}
+		return;
+	}
+
+	scEnableState_t	nState;
+	if ( nArgs == 3 && strcmp( pArgs[2], "on" ) == 0 )
+	{
+		nState = scEnabled;
+	}
+	else if ( nArgs == 3 && strcmp( pArgs[2], "off" ) == 0 )
+	{
+		nState = scDisabled;
+	}
+	else
+	{
+		console.Print( "usage: labels <label|group> on|off\n\r" );
+		return;
+	}
+
+	uint32_t nLabel;
+	if ( ParseNumber( pArgs[1], nLabel ) )
+	{
+		if ( nLabel >= SC_CONSOLE_LABELS )
+		{
+			console.Print( "no label %u\n\r", nLabel );
+			return;
+		}
+		pDm->LabelState( (uint16_t)nLabel, nState );
+	}
+	else if ( !pDm->GroupState( pArgs[1], nState ) )
+	{
+		console.Print( "no group %s\n\r", pArgs[1] );
+		return;
+	}
+	console.Print( "%s %s\n\r", pArgs[1], scDebugManager::StateText( nState ) );
+}
+
+/// <summary>
+/// Statistics of an allocator.
+/// </summary>
+void scConsole::AllocatorCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext )
+{
+	(void)nArgs;
+	scAllocatorStats_t	stats;
+
+	if ( static_cast<scIAllocator*>( pContext )->Statistics( stats ) )
+	{
+		console.Print( "%s: %u allocations, %u releases, %u failures, %u bytes\n\r", pArgs[0],
+			stats._nAllocations, stats._nReleases, stats._nFailures, stats._nBytes );
+	}
+	else
+	{
+		console.Print( "%s: no statistics\n\r", pArgs[0] );
+	}
+}
+
+/// <summary>
+/// Depth of a queue.
+/// </summary>
+void scConsole::QueueCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext )
+{
+	(void)nArgs;
+	scIQueue* pQueue = static_cast<scIQueue*>( pContext );
+	console.Print( "%s: %u waiting, %u free\n\r", pArgs[0], pQueue->MessagesWaiting(), pQueue->SpacesAvailable() );
+}
+
+/// <summary>
+/// State of every device of the manager.
+/// </summary>
+void scConsole::DevicesCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext )
+{
+	(void)nArgs;
+	(void)pArgs;
+	scDeviceManager* pManager = static_cast<scDeviceManager*>( pContext );
+	size_t nCount = pManager->DeviceCount();
+
+	console.Print( "%u devices\n\r", (uint32_t)nCount );
+	for( size_t i = 0; i < nCount; i++ )
+	{
+		scDeviceGeneric* pDevice = pManager->Device( i );
+		uint32_t nState = (uint32_t)pDevice->SetupState();
+		console.Print( "[0x%04X] %s, %s, error 0x%08X\n\r",
+			(uint32_t)pDevice->Guid().Guid(),
+			( nState < sizeof(g_SetupStates) / sizeof(g_SetupStates[0]) ) ? g_SetupStates[nState] : "Unknown",
+			pDevice->IsConnected() ? "connected" : "not connected",
+			pDevice->GetLastError() );
+	}
+}
+
+/// <summary>
+/// Current state of a state machine.
+/// </summary>
+void scConsole::FSMCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext )
+{
+	(void)nArgs;
+	console.Print( "%s: state %d\n\r", pArgs[0], static_cast<scFSM*>( pContext )->CurrentState() );
+}
+
+/// <summary>
+/// metrics dumps the registry, metrics reset clears it.
+/// </summary>
+void scConsole::MetricsCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext )
+{
+	// unused when the feature is compiled out
+	(void)console;
+	(void)nArgs;
+	(void)pArgs;
+	(void)pContext;
+#if SC_METRICS_ENABLED
+	if ( nArgs > 1 && strcmp( pArgs[1], "reset" ) == 0 )
+	{
+		scMetrics::Reset();
+		console.Print( "metrics reset\n\r" );
+		return;
+	}
+	scMetrics::Dump( console._nLabel );
+#endif
+}
+
+/// <summary>
+/// profile dumps the probes, profile reset clears them.
+/// </summary>
+void scConsole::ProfileCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext )
+{
+	// unused when the feature is compiled out
+	(void)console;
+	(void)nArgs;
+	(void)pArgs;
+	(void)pContext;
+#if SC_PROFILER_ENABLED
+	if ( nArgs > 1 && strcmp( pArgs[1], "reset" ) == 0 )
+	{
+		scProfiler::Reset();
+		console.Print( "profile reset\n\r" );
+		return;
+	}
+	scProfiler::Dump( console._nLabel );
+#endif
+}
@@ -0,0 +1,239 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scConsole.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCCONSOLE_H__INCLUDED_)
+#define __SCCONSOLE_H__INCLUDED_
+
+#include "scTypes.h"
+#include "scDebugLabelCodes.h"
+#include "HAL/scBufferedIODriver.h"
+
+// Longest command line, longer lines are discarded. Define it in scConf.h to change
+// it.
+#ifndef SC_CONSOLE_LINE
+	#define SC_CONSOLE_LINE				(80)
+#endif
+
+// Most words in a command line, the command included. Define it in scConf.h to change
+// it.
+#ifndef SC_CONSOLE_ARGS
+	#define SC_CONSOLE_ARGS				(8)
+#endif
+
+// Size of the command table, the built in commands included. Define it in scConf.h to
+// change it.
+#ifndef SC_CONSOLE_COMMANDS
+	#define SC_CONSOLE_COMMANDS			(16)
+#endif
+
+// Number of debug labels listed by the labels command. Define it in scConf.h to change
+// it.
+#ifndef SC_CONSOLE_LABELS
+	#define SC_CONSOLE_LABELS			(scDEBUGLABEL_LAST)
+#endif
+
+namespace SharedCore
+{
+	class scIAllocator;
+	class scIQueue;
+	class scDeviceManager;
+	class scFSM;
+
+	/// <summary>
+	/// Command interpreter used to look into a running unit without adding Trace calls
+	/// and reflashing. Lines are read from any buffered driver, a UART or USB serial
+	/// port for example, and the answers are sent through scDebugManager on a debug
+	/// label, so they reach every debug path like the rest of the trace.
+	///
+	/// The commands are kept in a fixed table and a line is split into words in place,
+	/// so reading and running a command never allocates. The application adds the
+	/// objects it wants to look at once, at start up:
+	///
+	///   console.AddAllocator( "alloc", pAllocator );
+	///   console.AddFactory( "msgs", pFactory );
+	///   console.AddQueue( "rxq", pQueue );
+	///   console.AddDevices( pDeviceManager );
+	///   console.AddFSM( "link", pFsm );
+	///
+	/// and calls Poll from one task. help, labels, and when they are built metrics and
+	/// profile, are always there.
+	/// </summary>
+	class scConsole
+	{
+	public:
+		/// <summary>
+		/// Run a command.
+		/// </summary>
+		/// <param name="console">The console, used to answer with Print.</param>
+		/// <param name="nArgs">Number of words, the command included.</param>
+		/// <param name="pArgs">The words, pArgs[0] is the command.</param>
+		/// <param name="pContext">The context given to AddCommand.</param>
+		typedef void (*Handler_t)( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext );
+
+		/// <summary>
+		/// Constructor.
+		/// </summary>
+		/// <param name="pDriver">Driver the command lines are read from.</param>
+		/// <param name="nLabel">Debug label the answers are traced on.</param>
+		scConsole( HAL::scBufferIODriver* pDriver, uint16_t nLabel = scDEBUGLABEL_INFO_MESSAGE );
+
+		/// <summary>
+		/// Destructor.
+		/// </summary>
+		virtual ~scConsole();
+
+		/// <summary>
+		/// Add a command.
+		/// </summary>
+		/// <param name="pName">The command, must stay valid.</param>
+		/// <param name="pHelp">One line shown by help, must stay valid.</param>
+		/// <param name="pHandler">Runs the command.</param>
+		/// <param name="pContext">Given to the handler.</param>
+		/// <returns>false if the table is full or the command exists.</returns>
+		bool AddCommand( const char* pName, const char* pHelp, Handler_t pHandler, void* pContext );
+
+		/// <summary>
+		/// Add a command showing the statistics of an allocator.
+		/// </summary>
+		bool AddAllocator( const char* pName, scIAllocator* pAllocator );
+
+		/// <summary>
+		/// Add a command showing the slots of a message factory, in use and available
+		/// followed by the DebugDump of the factory.
+		/// </summary>
+		template<class Factory_T>
+		bool AddFactory( const char* pName, Factory_T* pFactory )
+		{
+			return AddCommand( pName, "message factory slots", &scConsole::FactoryCommand<Factory_T>, pFactory );
+		}
+
+		/// <summary>
+		/// Add a command showing the depth of a queue.
+		/// </summary>
+		bool AddQueue( const char* pName, scIQueue* pQueue );
+
+		/// <summary>
+		/// Add the devices command, showing the state of every device of the manager.
+		/// </summary>
+		bool AddDevices( scDeviceManager* pManager );
+
+		/// <summary>
+		/// Add a command showing the current state of a state machine.
+		/// </summary>
+		bool AddFSM( const char* pName, scFSM* pFsm );
+
+		/// <summary>
+		/// Read what the driver received and run every complete line. Backspace removes
+		/// the last character, a line is ended by CR or LF.
+		/// </summary>
+		/// <returns>Number of lines run.</returns>
+		uint32_t Poll( void );
+
+		/// <summary>
+		/// Run one command line. The line is split into words in place.
+		/// </summary>
+		/// <returns>false if the command is not known.</returns>
+		bool Execute( char* pLine );
+
+		/// <summary>
+		/// Answer the command, formatted as scDebugManager::Trace on a stack buffer of
+		/// SC_CONSOLE_LINE characters.
+		/// </summary>
+		void Print( const char* pFormat, ... );
+
+		/// <summary>
+		/// Read a decimal or 0x prefixed hex number.
+		/// </summary>
+		/// <returns>false if the text is not a number.</returns>
+		static bool ParseNumber( const char* pText, uint32_t& nValue );
+
+	private:
+		/// <summary>
+		/// An entry of the command table.
+		/// </summary>
+		typedef struct
+		{
+			const char*			_pName;
+			const char*			_pHelp;
+			Handler_t			_pHandler;
+			void*				_pContext;
+		} Command_t;
+
+		template<class Factory_T>
+		static void FactoryCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext )
+		{
+			(void)nArgs;
+			Factory_T* pFactory = static_cast<Factory_T*>( pContext );
+			console.Print( "%s: %u in use, %u available\n\r", pArgs[0],
+				(uint32_t)pFactory->MessagesInUse(), (uint32_t)pFactory->MessagesAvailable() );
+			pFactory->DebugDump();
+		}
+
+		static void HelpCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext );
+		static void LabelsCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext );
+		static void AllocatorCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext );
+		static void QueueCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext );
+		static void DevicesCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext );
+		static void FSMCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext );
+		static void MetricsCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext );
+		static void ProfileCommand( scConsole& console, uint32_t nArgs, char** pArgs, void* pContext );
+
+		/// <summary>
+		/// Driver the lines are read from.
+		/// </summary>
+		HAL::scBufferIODriver*		_pDriver;
+
+		/// <summary>
+		/// Debug label of the answers.
+		/// </summary>
+		uint16_t					_nLabel;
+
+		/// <summary>
+		/// The command table.
+		/// </summary>
+		Command_t					_Commands[SC_CONSOLE_COMMANDS];
+		uint32_t					_nCommands;
+
+		/// <summary>
+		/// The line being received.
+		/// </summary>
+		char						_sLine[SC_CONSOLE_LINE + 1];
+		uint32_t					_nLength;
+
+		/// <summary>
+		/// Set when the line being received is too long, it is discarded at its end.
+		/// </summary>
+		bool						_bOverflow;
+	};
+}
+
+#endif // !defined(__SCCONSOLE_H__INCLUDED_)
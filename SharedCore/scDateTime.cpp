@@ -22,9 +22,10 @@
 //==============================================================================
 
 #include "scDateTime.h"
-#include <stdio.h>
+#include "scFormat.h"
 
 using SharedCore::scDateTime;
+using SharedCore::scFormat;
 
 
 /// <summary>
@@ -87,7 +88,7 @@ scDateTime& scDateTime::operator=( const scDateTime& source )
 
 /// <summary>
 /// Converts the time to a simple string in the HH:MM:SS time format
-/// the length must be at least 9 characters in order for the sprintf
+/// the length must be at least 9 characters in order for the formatter
 /// function to fill in the string.
 /// </summary>
 /// <param name="pString">buffer to receive the formatted string</param>
@@ -98,13 +99,13 @@ void scDateTime::TimeString( char* pString, uint32_t nLength )
 	tm ltime;
 	if ( localtime_s( &ltime, &m_time ) == 0 )
 	{
-		sprintf_s( pString, nLength, "%02u:%02u:%02u", ltime.tm_hour, ltime.tm_min, ltime.tm_sec);
+		scFormat::Format( pString, nLength, "%02u:%02u:%02u", ltime.tm_hour, ltime.tm_min, ltime.tm_sec);
 	}
 #else
 	tm* pltime =  localtime( &m_time );
 	if ( nLength >= 9 )
 	{
-		sprintf( pString, "%02u:%02u:%02u",
+		scFormat::Format( pString, nLength, "%02u:%02u:%02u",
 			pltime->tm_hour, pltime->tm_min, pltime->tm_sec);
 	}
 #endif
@@ -112,7 +113,7 @@ void scDateTime::TimeString( char* pString, uint32_t nLength )
 
 /// <summary>
 /// Converts the date to a simple string in the YYYY-MM-DD date format
-/// the length must be at least 11 characters in order for the sprintf
+/// the length must be at least 11 characters in order for the formatter
 /// function to fill in the string.
 /// </summary>
 /// <param name="pString">buffer to receive the formatted string</param>
@@ -121,13 +122,8 @@ void scDateTime::DateString( char* pString, uint32_t nLength )
 {
 	if ( nLength >= 11 )
 	{
-#ifdef USE_SECURE_CALLS
-		sprintf_s( pString, nLength, "%04u-%02u-%02u",
-			GetYear(), GetMonth(), GetDay() );
-#else
-		sprintf( pString, "%04u-%02u-%02u",
+		scFormat::Format( pString, nLength, "%04u-%02u-%02u",
 			GetYear(), GetMonth(), GetDay() );
-#endif
 	}
 }
 
@@ -300,7 +300,7 @@ namespace SharedCore
 
 		/// <summary>
 		/// Converts the time to a simple string in the HH:MM:SS time format
-		/// the length must be at least 9 characters in order for the sprintf
+		/// the length must be at least 9 characters in order for the formatter
 		/// function to fill in the string.
 		/// </summary>
 		/// <param name="pString">buffer to receive the formatted string</param>
@@ -309,7 +309,7 @@ namespace SharedCore
 
 		/// <summary>
 		/// Converts the date to a simple string in the YYYY-MM-DD date format
-		/// the length must be at least 11 characters in order for the sprintf
+		/// the length must be at least 11 characters in order for the formatter
 		/// function to fill in the string.
 		/// </summary>
 		/// <param name="pString">buffer to receive the formatted string</param>
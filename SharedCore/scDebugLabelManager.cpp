@@ -27,6 +27,7 @@
 //==============================================================================
 
 
+#include <string.h>
 #include "scDebugLabelManager.h"
 
 using namespace SharedCore;
@@ -37,6 +38,11 @@ using namespace std;
 /// </summary>
 scDebugLabelManager::~scDebugLabelManager()
 {
+	vector<Group_t>::iterator itr = _Groups.begin();
+	for( ; itr != _Groups.end(); ++itr )
+	{
+		delete (*itr)._pMask;
+	}
 }
 
 /// <summary>
@@ -46,6 +52,7 @@ scDebugLabelManager::~scDebugLabelManager()
 /// </param>
 scDebugLabelManager::scDebugLabelManager( uint16_t nMaxLabels, scEnableState_t nDefault )
 	: _nLabelState(nMaxLabels)
+	, _Groups()
 {
 	LabelState( nDefault );
 }
@@ -57,9 +64,9 @@ scDebugLabelManager::scDebugLabelManager( uint16_t nMaxLabels, scEnableState_t n
 scEnableState_t scDebugLabelManager::LabelState(uint16_t nLabel) const 
 {
 	scEnableState_t nResult = scDisabled;
-	if ( nLabel < _nLabelState.size() )
+	if ( nLabel < _nLabelState.Size() && _nLabelState.Test( nLabel ) )
 	{
-		nResult = _nLabelState[nLabel];
+		nResult = scEnabled;
 	}
 	return nResult;
 }
@@ -71,10 +78,7 @@ scEnableState_t scDebugLabelManager::LabelState(uint16_t nLabel) const
 /// <param name="nState">The new state of the label.</param>
 void scDebugLabelManager::LabelState( uint16_t nLabel, scEnableState_t nState) 
 {
-	if ( nLabel < _nLabelState.size() )
-	{
-		_nLabelState[nLabel] = nState;
-	}
+	_nLabelState.Set( nLabel, nState );
 }
 
 /// <summary>
@@ -83,11 +87,7 @@ void scDebugLabelManager::LabelState( uint16_t nLabel, scEnableState_t nState)
 /// <param name="nState">The new state of the label.</param>
 void scDebugLabelManager::LabelState( scEnableState_t nState )
 {
-	vector<scEnableState_t>::iterator itr = _nLabelState.begin();
-	for( ; itr != _nLabelState.end(); ++itr )
-	{
-		(*itr) = nState;
-	}
+	_nLabelState.SetAll( nState );
 }
 
 /// <summary>
@@ -120,3 +120,55 @@ const char* scDebugLabelManager::LabelText(uint16_t nLabel)
 	return pLabel;
 }
 
+/// <summary>
+/// Add a named group of labels.
+/// </summary>
+/// <param name="pName">Name of the group, the string must stay valid.</param>
+/// <param name="pLabels">The labels in the group.</param>
+/// <param name="nCount">Number of labels.</param>
+/// <returns>The mask of the group, usable with scDebugPath::LabelMask.</returns>
+const scLabelMask* scDebugLabelManager::AddGroup( const char* pName, const uint16_t* pLabels, uint16_t nCount )
+{
+	Group_t group;
+	group._pName = pName;
+	group._pMask = new scLabelMask( _nLabelState.Size(), scDisabled );
+	for( uint16_t i=0; i < nCount; ++i )
+	{
+		group._pMask->Set( pLabels[i], scEnabled );
+	}
+	_Groups.push_back( group );
+	return group._pMask;
+}
+
+/// <summary>
+/// Locate a group.
+/// </summary>
+/// <param name="pName">Name of the group.</param>
+/// <returns>The mask of the group or NULL.</returns>
+const scLabelMask* scDebugLabelManager::Group( const char* pName ) const
+{
+	vector<Group_t>::const_iterator itr = _Groups.begin();
+	for( ; itr != _Groups.end(); ++itr )
+	{
+		if ( strcmp( (*itr)._pName, pName ) == 0 )
+		{
+			return (*itr)._pMask;
+		}
+	}
+	return NULL;
+}
+
+/// <summary>
+/// Changes the state of every label in a named group.
+/// </summary>
+/// <param name="pName">Name of the group.</param>
+/// <param name="nState">The new state of the labels.</param>
+bool scDebugLabelManager::GroupState( const char* pName, scEnableState_t nState )
+{
+	const scLabelMask* pGroup = Group( pName );
+	if ( pGroup != NULL )
+	{
+		_nLabelState.Merge( *pGroup, nState );
+	}
+	return pGroup != NULL;
+}
@@ -37,6 +37,7 @@
 #include "scTypes.h"
 #include "scIDebugLabelManager.h"
 #include "scDebugLabelCodes.h"
+#include "scLabelMask.h"
 #include <vector>
 
 namespace SharedCore
@@ -47,6 +48,9 @@ namespace SharedCore
 	/// This class is used to move the label tracking and customization out of the
 	/// DebugManager and place it in a stand alone class. This then is the class that
 	/// will be subclassed to customize the labels actually used in the debug manager.
+	/// The states are kept one bit per label so thousands of labels cost little memory
+	/// and a lookup is the same bit test for any label. Labels can be collected in
+	/// named groups to change a whole subsystem at once.
 	/// </summary>
 	class scDebugLabelManager : public scIDebugLabelManager
 	{
@@ -88,11 +92,53 @@ namespace SharedCore
 		/// <param name="nLabel">The label to look up</param>
 		virtual const char* LabelText(uint16_t nLabel);
 
+		/// <summary>
+		/// Number of labels that exist in the system.
+		/// </summary>
+		virtual uint16_t LabelCount(void) const
+		{
+			return _nLabelState.Size();
+		}
+
+		/// <summary>
+		/// Add a named group of labels.
+		/// </summary>
+		/// <param name="pName">Name of the group, the string must stay valid.</param>
+		/// <param name="pLabels">The labels in the group.</param>
+		/// <param name="nCount">Number of labels.</param>
+		/// <returns>The mask of the group, usable with scDebugPath::LabelMask.</returns>
+		const scLabelMask* AddGroup( const char* pName, const uint16_t* pLabels, uint16_t nCount );
+
+		/// <summary>
+		/// Locate a group.
+		/// </summary>
+		/// <param name="pName">Name of the group.</param>
+		/// <returns>The mask of the group or NULL.</returns>
+		const scLabelMask* Group( const char* pName ) const;
+
+		/// <summary>
+		/// Changes the state of every label in a named group.
+		/// </summary>
+		/// <param name="pName">Name of the group.</param>
+		/// <param name="nState">The new state of the labels.</param>
+		virtual bool GroupState( const char* pName, scEnableState_t nState );
+
 	private:
+		typedef struct
+		{
+			const char*			_pName;
+			scLabelMask*		_pMask;
+		} Group_t;
+
+		/// <summary>
+		/// The enable state of every label.
+		/// </summary>
+		scLabelMask					_nLabelState;
+
 		/// <summary>
-		/// Vector of all the labels and their enable state.
+		/// The label groups.
 		/// </summary>
-		vector<scEnableState_t>		_nLabelState;
+		vector<Group_t>				_Groups;
 
 		/// <summary>
 		/// Prevent copy operators
@@ -27,9 +27,11 @@
 //==============================================================================
 
 #include <string.h>
-#include <stdio.h>
 #include "scDebugManager.h"
 #include "scSingletonPtr.h"
+#include "scFormat.h"
+#include "scAtomic.h"
+#include "scHiResClock.h"
 
 #ifndef assert_param
 #define assert_param(X)	if ( !(X) ) { for(;;) ; }
@@ -42,8 +44,26 @@
 	#define MAX_STRING_LEN 256
 #endif
 
+// Set in the queue tag of binary records so the drain can rewrite them for each
+// path, the label is in the other bits.
+#define TRACE_TAG_BINARY	(0x8000)
+
 using namespace SharedCore;
 
+const char scDebugManager::s_HexPairs[] =
+	"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+	"202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+	"404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+	"606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+	"808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+	"a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+	"c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+	"e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+uint32_t scDebugManager::s_LabelBits[( SC_TRACE_INLINE_LABELS + 31 ) / 32];
+
+scDebugPath* scDebugManager::s_NoPaths[1] = { NULL };
+
 // If the DebugManager is subclassed, then define this macro in the
 // scConf.h header and then implement the Instance function in the body
 // of the subclass. Simply copy the code below and replace the scDebugManager
@@ -73,10 +93,21 @@ scDebugManager::~scDebugManager()
 /// </summary>
 scDebugManager::scDebugManager(void)
 	: _nState(scDisabled)
-	, _Paths(0)
+	, _pPaths( s_NoPaths )
+	, _pLimits( NULL )
+	, _nReaderHalf( 0 )
+	, _nPathWriter( 0 )
 	, _pLabelManager(NULL)
 	, _Allocator( NULL )
+	, _pTimestampSource( NULL )
+	, _nTimestampOptions( scTRACE_TIMESTAMP_TEXT | scTRACE_TIMESTAMP_DELTA )
+	, _pDecoder( NULL )
+	, _pQueue( NULL )
+	, _pYield( NULL )
+	, _pPathWait( NULL )
 {
+	_nReaders[0] = 0;
+	_nReaders[1] = 0;
 }
 
 /// <summary>
@@ -89,8 +120,8 @@ scDebugManager::scDebugManager(void)
 /// path</param>
 void scDebugManager::SetPathEnable(uint8_t nPathId, scEnableState_t nState )
 {
-	vector<scDebugPath*>::iterator itr = _Paths.begin();
-	for( ; itr != _Paths.end(); itr++ )
+	PathReader reader( *this );
+	for( scDebugPath* const* itr = reader.Paths(); *itr != NULL; itr++ )
 	{
 		if ( (*itr)->PathId() == nPathId )
 		{
@@ -106,8 +137,8 @@ void scDebugManager::SetPathEnable(uint8_t nPathId, scEnableState_t nState )
 scEnableState_t scDebugManager::GetPathEnable(uint8_t nPathId)
 {
 	scEnableState_t nResult = scDisabled;
-	vector<scDebugPath*>::iterator itr = _Paths.begin();
-	for( ; itr != _Paths.end(); itr++ )
+	PathReader reader( *this );
+	for( scDebugPath* const* itr = reader.Paths(); *itr != NULL; itr++ )
 	{
 		if ( (*itr)->PathId() == nPathId )
 		{
@@ -125,6 +156,7 @@ scEnableState_t scDebugManager::GetPathEnable(uint8_t nPathId)
 void scDebugManager::Enable(void)
 {
 	_nState = scEnabled;
+	RefreshLabelBits();
 }
 
 /// <summary>
@@ -134,6 +166,7 @@ void scDebugManager::Enable(void)
 void scDebugManager::Disable(void)
 {
 	_nState = scDisabled;
+	RefreshLabelBits();
 }
 
 /// <summary>
@@ -152,8 +185,26 @@ scEnableState_t scDebugManager::State(void) const
 /// <param name="pPath">A pointer to the new path.</param>
 size_t scDebugManager::Add(scDebugPath* pPath)
 {
-	_Paths.push_back( pPath );
-	return  _Paths.size();
+	// size the mask while no other task can see the path, it is never resized after
+	uint16_t nLabels = ( _pLabelManager != NULL ) ? _pLabelManager->LabelCount() : scDEBUGLABEL_LAST;
+	if ( pPath->_Labels.Size() < nLabels )
+	{
+		pPath->_Labels.Resize( nLabels );
+	}
+
+	LockPaths();
+	size_t nCount = 0;
+	while( _pPaths[nCount] != NULL )
+	{
+		nCount++;
+	}
+	scDebugPath** pPaths = new scDebugPath*[nCount + 2];
+	memcpy( pPaths, _pPaths, nCount * sizeof(scDebugPath*) );
+	pPaths[nCount++] = pPath;
+	pPaths[nCount] = NULL;
+	FreePaths( ReplacePaths( pPaths ) );
+	UnlockPaths();
+	return nCount;
 }
 
 /// <summary>
@@ -163,27 +214,139 @@ size_t scDebugManager::Add(scDebugPath* pPath)
 scDebugPath* scDebugManager::Remove( uint8_t nPathId )
 {
 	scDebugPath* pResult = NULL;
-	vector<scDebugPath*>::iterator itr = _Paths.begin();
-	for( ; pResult == NULL && itr != _Paths.end(); itr++ )
+	LockPaths();
+	size_t nCount = 0;
+	while( _pPaths[nCount] != NULL )
 	{
-		if ( (*itr)->PathId() == nPathId )
+		nCount++;
+	}
+	scDebugPath** pPaths = new scDebugPath*[nCount + 1];
+	size_t nKept = 0;
+	for( size_t i=0; i < nCount; ++i )
+	{
+		if ( pResult == NULL && _pPaths[i]->PathId() == nPathId )
 		{
-			pResult = *itr;
-			itr = _Paths.erase( itr );
-			break;
+			pResult = _pPaths[i];
 		}
+		else
+		{
+			pPaths[nKept++] = _pPaths[i];
+		}
+	}
+	pPaths[nKept] = NULL;
+
+	if ( pResult != NULL )
+	{
+		pPaths = ReplacePaths( pPaths );
 	}
+	FreePaths( pPaths );
+	UnlockPaths();
 	return pResult;
 }
 
+/// <summary>
+/// Count the caller as a reader of the path list. The half is checked again after
+/// counting, a reader that counted in the half Add or Remove just left tries again
+/// in the other, so a writer only ever waits for the readers that could have seen
+/// the list it replaced.
+/// </summary>
+scDebugManager::PathReader::PathReader( const scDebugManager& manager )
+	: _Manager( manager )
+	, _nHalf( 0 )
+	, _pPaths( NULL )
+{
+	for(;;)
+	{
+		_nHalf = scAtomicLoad( &_Manager._nReaderHalf ) & 1;
+		scAtomicAdd( &_Manager._nReaders[_nHalf], 1 );
+		scAtomicFence();
+		if ( ( scAtomicLoad( &_Manager._nReaderHalf ) & 1 ) == _nHalf )
+		{
+			break;
+		}
+		scAtomicAdd( &_Manager._nReaders[_nHalf], (uint32_t)-1 );
+	}
+	_pPaths = scAtomicLoadPointer( &_Manager._pPaths );
+}
+
+/// <summary>
+/// Done with the path list.
+/// </summary>
+scDebugManager::PathReader::~PathReader()
+{
+	scAtomicAdd( &_Manager._nReaders[_nHalf], (uint32_t)-1 );
+}
+
+/// <summary>
+/// Publish a new path list, then move new readers to the other half and wait for
+/// the readers in the old half, the only ones that can hold the old list. Called
+/// with the path list locked.
+/// </summary>
+/// <returns>The old list, no longer in use.</returns>
+scDebugPath** scDebugManager::ReplacePaths( scDebugPath** pPaths )
+{
+	scDebugPath** pOld = _pPaths;
+	scAtomicStorePointer( &_pPaths, pPaths );
+
+	uint32_t nOldHalf = scAtomicAdd( &_nReaderHalf, 1 ) & 1;
+	nOldHalf ^= 1;
+	scAtomicFence();
+	while( scAtomicLoad( &_nReaders[nOldHalf] ) != 0 )
+	{
+		WaitForPaths();
+	}
+
+	return pOld;
+}
+
+/// <summary>
+/// Free a path list that is not in use.
+/// </summary>
+void scDebugManager::FreePaths( scDebugPath** pPaths )
+{
+	if ( pPaths != s_NoPaths )
+	{
+		delete [] pPaths;
+	}
+}
+
+/// <summary>
+/// Make the caller the only writer of the path list.
+/// </summary>
+void scDebugManager::LockPaths( void )
+{
+	while( !scAtomicCompareExchange( &_nPathWriter, 0, 1 ) )
+	{
+		WaitForPaths();
+	}
+}
+
+/// <summary>
+/// Let the task holding up a path list change run. Only reached when the list is
+/// changed while other tasks use it, which needs the path wait function.
+/// </summary>
+void scDebugManager::WaitForPaths( void ) const
+{
+	assert_param( _pPathWait != NULL );
+	_pPathWait();
+}
+
+/// <summary>
+/// Let the next writer change the path list.
+/// </summary>
+void scDebugManager::UnlockPaths( void )
+{
+	scAtomicStore( &_nPathWriter, 0 );
+}
+
 /// <summary>
 /// Change the enable state of all paths known to the debugger.
 /// </summary>
 /// <param name="nState">the new state of all paths.</param>
 void scDebugManager::SetPaths( scEnableState_t nState )
 {
-	vector<scDebugPath*>::iterator itr = _Paths.begin();
-	for( ; itr != _Paths.end(); itr++ )
+	PathReader reader( *this );
+	for( scDebugPath* const* itr = reader.Paths(); *itr != NULL; itr++ )
 	{
 		(*itr)->State(nState);
 	}
@@ -213,6 +376,7 @@ void scDebugManager::LabelState(uint16_t nLabel, scEnableState_t nState)
 	if ( _pLabelManager != NULL )
 	{
 		_pLabelManager->LabelState( nLabel, nState );
+		RefreshLabelBits();
 	}
 }
 
@@ -225,35 +389,53 @@ void scDebugManager::LabelState( scEnableState_t nState)
 	if ( _pLabelManager != NULL )
 	{
 		_pLabelManager->LabelState( nState );
+		RefreshLabelBits();
 	}
 }
 
 /// <summary>
-/// Will get a text string for the enable state enum.
+/// Changes the state of every label in a group registered with the label
+/// manager.
 /// </summary>
-/// <param name="nState">the state</param>
-const char* scDebugManager::StateText(scEnableState_t nState)
+/// <param name="pName">Name of the group.</param>
+/// <param name="nState">The new state for the labels.</param>
+/// <returns>false if the label manager has no such group.</returns>
+bool scDebugManager::GroupState( const char* pName, scEnableState_t nState )
 {
-	return ( nState == scEnabled ? "Enabled" : "Disabled" );
+	bool bResult = false;
+	if ( _pLabelManager != NULL )
+	{
+		bResult = _pLabelManager->GroupState( pName, nState );
+		RefreshLabelBits();
+	}
+	return bResult;
 }
 
 /// <summary>
-/// Convert a byte value to a hex value.
+/// Get the text of a debug label from the label manager.
 /// </summary>
-/// <param name="pOut"></param>
-/// <param name="nByte"></param>
-char* scDebugManager::ByteToHex(char* pOut, uint8_t nByte)
+/// <param name="nLabel">the id of the debug label.</param>
+/// <returns>NULL if there is no label manager.</returns>
+const char* scDebugManager::LabelText( uint16_t nLabel )
 {
-	(*pOut) = nByte >> 4;
-	(*pOut)+= ((*pOut) < 0xA ? 0x30 : 0x57 );		// Use 0x37 for upper case
-	pOut++;											// Use 0x57 for lower case
-	(*pOut) = nByte & 0x0F;
-	(*pOut)+= ((*pOut) < 0xA ? 0x30 : 0x57 );
-	return ++pOut;
+	return ( _pLabelManager != NULL ) ? _pLabelManager->LabelText( nLabel ) : NULL;
 }
 
 /// <summary>
-/// This method will convert a memory array to a hex dump.
+/// Will get a text string for the enable state enum.
+/// </summary>
+/// <param name="nState">the state</param>
+const char* scDebugManager::StateText(scEnableState_t nState)
+{
+	return ( nState == scEnabled ? "Enabled" : "Disabled" );
+}
+
+/// <summary>
+/// This method will convert a memory array to a hex dump. Each row is built on
+/// the stack and sent to the paths as soon as it is complete, no working buffer
+/// is used. Before a row is sent the free space of the paths is checked and,
+/// when a yield function is assigned, the caller yields until the row fits so a
+/// large dump does not overrun a slow device.
 /// </summary>
 /// <param name="nLabel">the label.</param>
 /// <param name="pBuffer">Pointer to the memory to be printed.</param>
@@ -264,77 +446,66 @@ void scDebugManager::PrintArray( uint16_t nLabel, const uint8_t* pBuffer, uint32
 
 	if ( _pLabelManager->LabelState( nLabel ) == scEnabled )
 	{
-		char* sLine = WorkingBuffer_Lock();
-
-		int nCol = 0;
-		int nRow = 0;
-		uint32_t i;
-		int p = 0;
-		const char* pText = reinterpret_cast<const char*> (pBuffer);
-
-		i=0;
+		// "0xRR " + 16 * "HH " + "[" + 16 characters + "]\r\n"
+		const uint32_t	nRowLength = 5 + 16 * 3 + 1 + 16 + 3;
+		char			sLine[nRowLength];
+		uint8_t			nRow = 0;
+		uint32_t		i = 0;
 
 		while( i < nLength )
 		{
-			p=0;
-			sLine[p++] = '0';
-			sLine[p++] = 'x';
-			ByteToHex( sLine+p, (uint8_t)nRow );
-			p+=2;
-			sLine[p++] = ' ';
+			char*		p = sLine;
+			uint32_t	nCount = ( nLength - i < 16 ) ? nLength - i : 16;
+			uint32_t	nCol;
+
+			*p++ = '0';
+			*p++ = 'x';
+			p = ByteToHex( p, nRow );
+			*p++ = ' ';
 
+			for( nCol=0; nCol < nCount; ++nCol )
+			{
+				p = ByteToHex( p, pBuffer[i + nCol] );
+				*p++ = ' ';
+			}
+			for( ; nCol < 16; ++nCol )
+			{
+				*p++ = ' ';
+				*p++ = ' ';
+				*p++ = ' ';
+			}
+
+			*p++ = '[';
 			for( nCol=0; nCol < 16; ++nCol )
 			{
-				if ( i < nLength )
+				if ( nCol < nCount )
 				{
-					ByteToHex( sLine+p, pBuffer[i++] );
-					p+=2;
-					sLine[p++] = ' ';
+					char c = (char)pBuffer[i + nCol];
+					*p++ = ( c < 0x20 || c > 0x7E ) ? '.' : c;
 				}
 				else
 				{
-					sLine[p++] = ' ';
-					sLine[p++] = ' ';
-					sLine[p++] = ' ';
+					*p++ = ' ';
 				}
 			}
+			*p++ = ']';
+			*p++ = '\r';
+			*p++ = '\n';
 
-			sLine[p++] = '[';
-			for( nCol = 0; nCol < 16; nCol++ )
+			// Wait for the slowest path to have room for the row rather than spinning
+			// for a fixed time. The limit keeps a stalled path from hanging the caller.
+			if ( _pYield != NULL && _pQueue == NULL )
 			{
-				if ( pText < reinterpret_cast<const char*>(pBuffer + nLength) )
+				for( uint32_t nWait=10000; nWait > 0 && PathSpace( nLabel ) < nRowLength; --nWait )
 				{
-					if ( *pText < 0x20 || *pText > 0x7E )
-					{
-						sLine[p++] = '.';
-					}
-					else if ( *pText == '%' )
-					{
-						// Since this string goes into a printf function you need to escape the % symbol
-						sLine[p++] = '%'; //sLine[p++] = '%';
-					}
-					else
-					{
-						sLine[p++] = *pText;
-					}
-					pText++;
-				}
-				else
-				{
-					sLine[p++] = ' ';
+					_pYield();
 				}
 			}
-			sLine[p++] = ']';
-			sLine[p++] = '\r'; sLine[p++] = '\n'; sLine[p++] = 0;
-			Trace_Info( nLabel, sLine );
+
+			Output( nLabel, reinterpret_cast<const uint8_t*>(sLine), (uint32_t)( p - sLine ) );
+			i += nCount;
 			++nRow;
-			if ( nRow > 8 )
-			{
-				// force a delay so the uart can send
-				for( int j=0; j < 100000; ++j ) ;
-			}
 		}
-		WorkingBuffer_Release(sLine);
 	}
 }
 
@@ -367,16 +538,352 @@ void scDebugManager::Trace_Info(uint16_t nLabel, const char* pBuffer)
 	assert_param( _pLabelManager != NULL );
 	if ( _pLabelManager->LabelState( nLabel ) == scEnabled )
 	{
-		int nLogLength = strlen( pBuffer );
-		vector<scDebugPath*>::iterator itr = _Paths.begin();
-		for( ; itr != _Paths.end(); itr++ )
+		char		sStamp[24];
+		uint32_t	nStamp = TextTimestamp( sStamp, sizeof(sStamp) );
+		if ( nStamp == 0 )
 		{
-			if ( (*itr)->State() == scEnabled )
+			Output( nLabel, reinterpret_cast<const uint8_t*>(pBuffer), strlen( pBuffer ) );
+		}
+		else
+		{
+			// the message is still not copied, it follows the timestamp as a second span
+			scIOSpan_t spans[2];
+			spans[0]._pData = reinterpret_cast<const uint8_t*>(sStamp);
+			spans[0]._nLength = nStamp;
+			spans[1]._pData = reinterpret_cast<const uint8_t*>(pBuffer);
+			spans[1]._nLength = strlen( pBuffer );
+			if ( _pQueue != NULL )
 			{
-				(*itr)->Capture( reinterpret_cast<const uint8_t*>(pBuffer), nLogLength );
+				_pQueue->Push_v( spans, 2, nLabel );
 			}
+			else
+			{
+				PathReader reader( *this );
+				for( scDebugPath* const* itr = reader.Paths(); *itr != NULL; itr++ )
+				{
+					if ( (*itr)->State() == scEnabled && (*itr)->Accepts( nLabel ) )
+					{
+						(*itr)->Capture_v( spans, 2 );
+					}
+				}
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Trace with a rate limit, normally through scTRACE_LIMITED. Messages over the
+/// limit cost little more than the label check, they are only counted. A message
+/// with the same text as the one before from this call site is counted as a repeat
+/// instead of sent. The counts are reported ahead of the next message sent from
+/// the call site, and by ReportSuppressed.
+/// </summary>
+/// <param name="limit">The limit of the call site.</param>
+/// <param name="nLabel">The debug label.</param>
+/// <param name="pFormat">The format string.</param>
+void scDebugManager::TraceLimited( scTraceLimit_t& limit, uint16_t nLabel, const char* pFormat, ... )
+{
+	assert_param( _pLabelManager != NULL );
+
+	if ( _nState != scEnabled || _pLabelManager->LabelState( nLabel ) != scEnabled )
+	{
+		return;
+	}
+	limit._nLabel = nLabel;
+	if ( !Allow( limit ) )
+	{
+		return;
+	}
+
+	char* pBuffer = WorkingBuffer_Lock();
+	if ( pBuffer == NULL )
+	{
+		return;
+	}
+
+	va_list ap;
+	//lint -e{ 64 }
+	va_start( ap, pFormat );
+	uint32_t nStamp = TextTimestamp( pBuffer, MAX_STRING_LEN );
+	uint32_t nLength = nStamp + scFormat::vFormat( pBuffer + nStamp, MAX_STRING_LEN - nStamp, pFormat, ap );
+	va_end( ap );
+	if ( nLength >= MAX_STRING_LEN )
+	{
+		nLength = MAX_STRING_LEN - 1;
+	}
+
+	// FNV-1a of the text, the timestamp left out
+	uint32_t nHash = 2166136261UL;
+	for( uint32_t i=nStamp; i < nLength; ++i )
+	{
+		nHash = ( nHash ^ (uint8_t)pBuffer[i] ) * 16777619UL;
+	}
+
+	if ( nHash == limit._nHash )
+	{
+		scAtomicAdd( &limit._nRepeats, 1 );
+		ListLimit( limit );
+	}
+	else
+	{
+		ReportLimit( limit );
+		limit._nHash = nHash;
+		Output( nLabel, reinterpret_cast<const uint8_t*>(pBuffer), nLength );
+	}
+	WorkingBuffer_Release( pBuffer );
+}
+
+/// <summary>
+/// Take one message from the bucket of a limit, counting it as suppressed when the
+/// bucket is empty. The credit grows with the time since the last call, up to a
+/// full bucket. Two tasks using the same call site at once can make the counts a
+/// little off, never more. Without a clock the credit would never grow back, so
+/// every message is allowed rather than all but the first burst lost.
+/// </summary>
+/// <returns>true if the message may be sent.</returns>
+bool scDebugManager::Allow( scTraceLimit_t& limit )
+{
+	if ( _pTimestampSource == NULL && scHiResClock::Frequency() == 0 )
+	{
+		return true;
+	}
+
+	uint64_t nNow = Now();
+	uint64_t nElapsed = nNow - limit._nLast;
+	if ( _pTimestampSource != NULL )
+	{
+		// the source wraps at 32 bits
+		nElapsed &= 0xFFFFFFFFULL;
+	}
+	limit._nLast = nNow;
+
+	uint32_t nCredit = limit._nCapacity;
+	if ( nElapsed < limit._nCapacity - limit._nCredit )
+	{
+		nCredit = limit._nCredit + (uint32_t)nElapsed;
+	}
+
+	if ( nCredit >= limit._nInterval )
+	{
+		limit._nCredit = nCredit - limit._nInterval;
+		return true;
+	}
+	limit._nCredit = nCredit;
+	scAtomicAdd( &limit._nSuppressed, 1 );
+	ListLimit( limit );
+	return false;
+}
+
+/// <summary>
+/// Report the messages suppressed and repeated at every limited call site since
+/// they were last reported, so an error storm that stopped is still seen. Call it
+/// periodically from the task owning the debug output, once a second say.
+/// </summary>
+/// <returns>The number of messages reported.</returns>
+uint32_t scDebugManager::ReportSuppressed( void )
+{
+	uint32_t nResult = 0;
+	for( scTraceLimit_t* pLimit = scAtomicLoadPointer( &_pLimits ); pLimit != NULL; pLimit = pLimit->_pNext )
+	{
+		nResult += ReportLimit( *pLimit );
+	}
+	return nResult;
+}
+
+/// <summary>
+/// The time used by the rate limits, in microseconds. The timestamp source when one
+/// is assigned, else scHiResClock, whose 64 bits do not wrap.
+/// </summary>
+uint64_t scDebugManager::Now( void ) const
+{
+	return ( _pTimestampSource != NULL ) ? _pTimestampSource() : scHiResClock::Microseconds();
+}
+
+uint32_t scDebugManager::Timestamp( void ) const
+{
+	return ( _pTimestampSource != NULL ) ? _pTimestampSource() : scHiResClock::Timestamp();
+}
+
+/// <summary>
+/// Put a limit in the list walked by ReportSuppressed, once. The limits are static
+/// so they never leave the list.
+/// </summary>
+void scDebugManager::ListLimit( scTraceLimit_t& limit )
+{
+	if ( scAtomicLoad( &limit._nListed ) == 0 && scAtomicCompareExchange( &limit._nListed, 0, 1 ) )
+	{
+		scTraceLimit_t* pHead;
+		do
+		{
+			pHead = scAtomicLoadPointer( &_pLimits );
+			limit._pNext = pHead;
+		} while( !scAtomicCompareExchangePointer( &_pLimits, pHead, &limit ) );
+	}
+}
+
+/// <summary>
+/// Trace the counts of a limit and clear them. The call site is named by the file,
+/// without its directories, and the line.
+/// </summary>
+/// <returns>The number of messages reported.</returns>
+uint32_t scDebugManager::ReportLimit( scTraceLimit_t& limit )
+{
+	uint32_t nRepeats = scAtomicExchange( &limit._nRepeats, 0 );
+	uint32_t nSuppressed = scAtomicExchange( &limit._nSuppressed, 0 );
+
+	if ( nRepeats + nSuppressed > 0 )
+	{
+		const char* pFile = limit._pFile;
+		for( const char* p = limit._pFile; *p != '\0'; ++p )
+		{
+			if ( *p == '/' || *p == '\\' )
+			{
+				pFile = p + 1;
+			}
+		}
+		if ( nRepeats > 0 )
+		{
+			Trace( limit._nLabel, "%s:%u last message repeated %u times\n\r", pFile, limit._nLine, nRepeats );
 		}
+		if ( nSuppressed > 0 )
+		{
+			Trace( limit._nLabel, "%s:%u %u messages suppressed\n\r", pFile, limit._nLine, nSuppressed );
+		}
+	}
+	return nRepeats + nSuppressed;
+}
+
+/// <summary>
+/// Binary version of Trace. Only the format ID, the label, a timestamp and the
+/// raw arguments are sent to the paths as a scTraceRecord_t, the text is produced
+/// later by a scTraceDecoder holding the format string table. No formatting and
+/// no working buffer are used on the target, which makes this suitable for
+/// drivers and other time critical code. If a decoder has been assigned with
+/// SetTraceDecoder the paths receive the text instead.
+/// </summary>
+/// <param name="nLabel">The debug label.</param>
+/// <param name="nFormatId">ID of the format string.</param>
+void scDebugManager::TraceBinary(uint16_t nLabel, uint16_t nFormatId)
+{
+	vTraceBinary( nLabel, nFormatId, NULL, 0 );
+}
+
+/// <summary>
+/// Binary version of Trace with one argument.
+/// </summary>
+void scDebugManager::TraceBinary(uint16_t nLabel, uint16_t nFormatId, uint32_t nArg1)
+{
+	uint32_t args[1] = { nArg1 };
+	vTraceBinary( nLabel, nFormatId, args, 1 );
+}
+
+/// <summary>
+/// Binary version of Trace with two arguments.
+/// </summary>
+void scDebugManager::TraceBinary(uint16_t nLabel, uint16_t nFormatId, uint32_t nArg1, uint32_t nArg2)
+{
+	uint32_t args[2] = { nArg1, nArg2 };
+	vTraceBinary( nLabel, nFormatId, args, 2 );
+}
+
+/// <summary>
+/// Binary version of Trace with three arguments.
+/// </summary>
+void scDebugManager::TraceBinary(uint16_t nLabel, uint16_t nFormatId, uint32_t nArg1, uint32_t nArg2, uint32_t nArg3)
+{
+	uint32_t args[3] = { nArg1, nArg2, nArg3 };
+	vTraceBinary( nLabel, nFormatId, args, 3 );
+}
+
+/// <summary>
+/// Binary version of Trace with four arguments.
+/// </summary>
+void scDebugManager::TraceBinary(uint16_t nLabel, uint16_t nFormatId, uint32_t nArg1, uint32_t nArg2, uint32_t nArg3, uint32_t nArg4)
+{
+	uint32_t args[4] = { nArg1, nArg2, nArg3, nArg4 };
+	vTraceBinary( nLabel, nFormatId, args, 4 );
+}
+
+/// <summary>
+/// Assign the function providing the timestamp of the trace records. When
+/// none is assigned the timestamp is zero.
+/// </summary>
+/// <param name="pSource">The timestamp function.</param>
+void scDebugManager::SetTimestampSource( TimestampSource_t pSource )
+{
+	_pTimestampSource = pSource;
+	RestartDeltas();
+}
+
+/// <summary>
+/// Choose how the timestamp is recorded. scTRACE_TIMESTAMP_DELTA is the default,
+/// a decoder older than the delta records needs it cleared.
+/// </summary>
+/// <param name="nOptions">scTRACE_TIMESTAMP_TEXT and scTRACE_TIMESTAMP_DELTA
+/// combined.</param>
+void scDebugManager::SetTimestampOptions( uint32_t nOptions )
+{
+	_nTimestampOptions = nOptions;
+	RestartDeltas();
+}
+
+/// <summary>
+/// Assign the function PrintArray calls while waiting for the paths to make room,
+/// normally the task yield of the RTOS. NULL, the default, sends the rows without
+/// waiting and leaves the flow control to the paths.
+/// </summary>
+/// <param name="pYield">The yield function.</param>
+void scDebugManager::SetYieldFunction( Yield_t pYield )
+{
+	_pYield = pYield;
+}
+
+/// <summary>
+/// Assign the function Add and Remove call while they wait for the tasks using
+/// the path list, see PathWait_t.
+/// </summary>
+/// <param name="pWait">The wait function.</param>
+void scDebugManager::SetPathWaitFunction( PathWait_t pWait )
+{
+	_pPathWait = pWait;
+}
+
+/// <summary>
+/// Assign a decoder to have TraceBinary produce text on the target. NULL, the
+/// default, sends the binary records to the paths.
+/// </summary>
+/// <param name="pDecoder">The decoder, the caller keeps ownership.</param>
+void scDebugManager::SetTraceDecoder( const scTraceDecoder* pDecoder )
+{
+	_pDecoder = pDecoder;
+}
+
+/// <summary>
+/// Assign a queue to make the output asynchronous. Trace and the other output
+/// methods then only add a record to the queue and return, the paths are called
+/// from Drain. NULL, the default, calls the paths directly from Trace.
+/// </summary>
+/// <param name="pQueue">The queue, the caller keeps ownership.</param>
+void scDebugManager::SetTraceQueue( scTraceQueue* pQueue )
+{
+	_pQueue = pQueue;
+	RestartDeltas();
+}
+
+/// <summary>
+/// Send the records waiting in the trace queue to the enabled paths. Called
+/// periodically by the task that owns the debug output.
+/// </summary>
+/// <param name="nMax">Most records to send.</param>
+/// <returns>The number of records sent.</returns>
+uint32_t scDebugManager::Drain( uint32_t nMax )
+{
+	uint32_t nResult = 0;
+	if ( _pQueue != NULL )
+	{
+		nResult = _pQueue->Drain( &DrainRecord, this, nMax );
 	}
+	return nResult;
 }
 
 /// <summary>
@@ -391,8 +898,55 @@ void scDebugManager::vTrace(uint16_t nLabel, const char* pFormat, va_list ap)
 	int nLogLength = 0;
 	assert_param( _pLabelManager != NULL );
 
+	if ( _nState == scEnabled &&  _pLabelManager->LabelState(nLabel) == scEnabled && _pQueue != NULL )
+	{
+		// Format straight into the queue slot, the caller never touches a path.
+		uint32_t	nSize;
+		uint8_t*	pSlot = _pQueue->Reserve( nSize );
+		if ( pSlot != NULL )
+		{
+			nLogLength = TextTimestamp( reinterpret_cast<char*>(pSlot), nSize );
+			nLogLength += scFormat::vFormat( reinterpret_cast<char*>(pSlot) + nLogLength, nSize - nLogLength, pFormat, ap );
+			if ( (uint32_t)nLogLength >= nSize )
+			{
+				nLogLength = nSize - 1;
+			}
+			_pQueue->Commit( pSlot, nLogLength, nLabel );
+		}
+		return;
+	}
+
 	if ( _nState == scEnabled &&  _pLabelManager->LabelState(nLabel) == scEnabled )
 	{
+		// Paths that format for themselves take the text straight into their own
+		// buffer, the working buffer is only needed for the others. The text
+		// timestamp is only added in the working buffer.
+		bool bDirect = ( _nTimestampOptions & scTRACE_TIMESTAMP_TEXT ) == 0;
+		bool bText = false;
+		PathReader reader( *this );
+		scDebugPath* const* itr = reader.Paths();
+		for( ; *itr != NULL; itr++ )
+		{
+			if ( (*itr)->State() == scEnabled && (*itr)->Accepts( nLabel ) )
+			{
+				if ( bDirect && (*itr)->Formats() )
+				{
+					va_list copy;
+					va_copy( copy, ap );
+					(*itr)->Capture_f( pFormat, copy );
+					va_end( copy );
+				}
+				else
+				{
+					bText = true;
+				}
+			}
+		}
+		if ( !bText )
+		{
+			return;
+		}
+
 		// This buffer may need to be obtained from a memory manager of some sort.
 		// Also this length may be made configurable. Also what to do about multithreaded
 		// apps where there may be collisions on the debug output.
@@ -401,31 +955,16 @@ void scDebugManager::vTrace(uint16_t nLabel, const char* pFormat, va_list ap)
 //lint --e(774)      // depends of the compiler options if true
 		if ( pBuffer != NULL )
 		{
-#ifdef _DEBUG
-			if ( strlen( pFormat ) > MAX_STRING_LEN )
-			{
-				// BAD just overran the buffer. Can't do this. Make debug statements much shorter.
-				assert_param( strlen( pFormat ) > MAX_STRING_LEN );
-				return;
-			}
-#endif
-#ifdef _WIN32
-			nLogLength = vsprintf_s( pBuffer, MAX_STRING_LEN, pFormat, ap );
-#else
-			nLogLength = vsprintf( pBuffer, pFormat, ap );
-#endif
-#ifdef _DEBUG
+			// The formatter is bounded, long messages are cut to the working buffer.
+			nLogLength = TextTimestamp( pBuffer, MAX_STRING_LEN );
+			nLogLength += scFormat::vFormat( pBuffer + nLogLength, MAX_STRING_LEN - nLogLength, pFormat, ap );
 			if ( nLogLength >= MAX_STRING_LEN )
 			{
-				// BAD just overran the buffer. Can't do this. Make debug statements much shorter.
-				assert_param( nLogLength >= MAX_STRING_LEN );
-				return;
+				nLogLength = MAX_STRING_LEN - 1;
 			}
-#endif
-			vector<scDebugPath*>::iterator itr = _Paths.begin();
-			for( ; itr != _Paths.end(); itr++ )
+			for( itr = reader.Paths(); *itr != NULL; itr++ )
 			{
-				if ( (*itr)->State() == scEnabled )
+				if ( (*itr)->State() == scEnabled && (*itr)->Accepts( nLabel ) && !( bDirect && (*itr)->Formats() ) )
 				{
 					(*itr)->Capture( reinterpret_cast<const uint8_t*>(pBuffer), nLogLength );
 				}
@@ -439,6 +978,241 @@ void scDebugManager::vTrace(uint16_t nLabel, const char* pFormat, va_list ap)
 	}
 }
 
+/// <summary>
+/// This is the implementation that will send a binary trace record, or the text
+/// of the record if a decoder is assigned, to the output.
+/// </summary>
+/// <param name="nLabel">The debug label.</param>
+/// <param name="nFormatId">ID of the format string.</param>
+/// <param name="pArgs">The arguments.</param>
+/// <param name="nArgs">Number of arguments.</param>
+void scDebugManager::vTraceBinary(uint16_t nLabel, uint16_t nFormatId, const uint32_t* pArgs, uint8_t nArgs)
+{
+	assert_param( _pLabelManager != NULL );
+	assert_param( nArgs <= scTRACE_MAX_ARGS );
+	assert_param( ( nLabel & TRACE_TAG_BINARY ) == 0 );
+
+	if ( _nState == scEnabled &&  _pLabelManager->LabelState(nLabel) == scEnabled )
+	{
+		// The record is small enough to live on the stack, no allocator is involved.
+		// It carries the whole timestamp, the drain turns it into a delta record for
+		// each path.
+		uint8_t				record[sizeof(scTraceRecord_t) + scTRACE_MAX_ARGS * sizeof(uint32_t)];
+		scTraceRecord_t		header;
+		uint32_t			nLength = sizeof(scTraceRecord_t) + nArgs * sizeof(uint32_t);
+
+		header._nSync = scTRACE_RECORD_SYNC;
+		header._nArgs = nArgs;
+		header._nLabel = nLabel;
+		header._nFormatId = nFormatId;
+		header._nTimestamp = Timestamp();
+
+		if ( _pDecoder != NULL && _pQueue != NULL )
+		{
+			// Decode straight into the queue slot, as vTrace formats.
+			uint32_t	nSize;
+			uint8_t*	pSlot = _pQueue->Reserve( nSize );
+			if ( pSlot != NULL )
+			{
+				nLength = _pDecoder->Format( header, pArgs, reinterpret_cast<char*>(pSlot), nSize );
+				_pQueue->Commit( pSlot, nLength, nLabel );
+			}
+		}
+		else if ( _pDecoder != NULL )
+		{
+			// The decoded text is bounded, it lives on the stack like the record.
+			char sText[MAX_STRING_LEN];
+			nLength = _pDecoder->Format( header, pArgs, sText, sizeof(sText) );
+			Capture( nLabel, reinterpret_cast<const uint8_t*>(sText), nLength );
+		}
+		else
+		{
+			memcpy( record, &header, sizeof(scTraceRecord_t) );
+			if ( nArgs > 0 )
+			{
+				memcpy( record + sizeof(scTraceRecord_t), pArgs, nArgs * sizeof(uint32_t) );
+			}
+			if ( _pQueue != NULL )
+			{
+				_pQueue->Push( record, nLength, nLabel | TRACE_TAG_BINARY );
+			}
+			else
+			{
+				Capture( nLabel, record, nLength );
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Send a finished record to the trace queue, or to the enabled paths when there
+/// is no queue. The label travels with the record so the paths can filter it.
+/// </summary>
+/// <returns>false if the queue had no room for the record.</returns>
+bool scDebugManager::Output( uint16_t nLabel, const uint8_t* pData, uint32_t nLength )
+{
+	bool bResult = true;
+	if ( _pQueue != NULL )
+	{
+		bResult = _pQueue->Push( pData, nLength, nLabel );
+	}
+	else
+	{
+		Capture( nLabel, pData, nLength );
+	}
+	return bResult;
+}
+
+/// <summary>
+/// Write the text timestamp when it is enabled, the timestamp is taken as
+/// microseconds.
+/// </summary>
+/// <returns>The length of the text, zero when disabled.</returns>
+uint32_t scDebugManager::TextTimestamp( char* pText, uint32_t nSize ) const
+{
+	uint32_t nResult = 0;
+	if ( ( _nTimestampOptions & scTRACE_TIMESTAMP_TEXT ) != 0 )
+	{
+		uint32_t nNow = Timestamp();
+		nResult = scFormat::Format( pText, nSize, "[%u.%06u] ", nNow / 1000000, nNow % 1000000 );
+		if ( nResult >= nSize )
+		{
+			nResult = nSize - 1;
+		}
+	}
+	return nResult;
+}
+
+/// <summary>
+/// Rewrite a binary record for one path. The time since the record the path
+/// received before goes out in one to three bytes of seven bits, lowest first, the
+/// top bit set on all but the last. The whole timestamp is kept for the first
+/// record, every SC_TRACE_DELTA_INTERVAL records so a reader joining late catches
+/// up, and when the time does not fit. Records stamped by two tasks at once can
+/// reach the queue out of order and give a negative time, which does not fit
+/// either. Only called by the task draining the queue.
+/// </summary>
+/// <returns>The length of the record.</returns>
+uint32_t scDebugManager::DeltaRecord( scDebugPath& path, uint8_t* pRecord, const uint8_t* pData, uint32_t nLength )
+{
+	scTraceRecord_t header;
+	memcpy( &header, pData, sizeof(scTraceRecord_t) );
+
+	uint32_t nDelta = header._nTimestamp - path._nTraceBase;
+	bool bWhole = path._nTraceCount == 0 || path._nTraceCount >= SC_TRACE_DELTA_INTERVAL || nDelta > scTRACE_DELTA_MAX;
+	path._nTraceBase = header._nTimestamp;
+	path._nTraceCount = bWhole ? 1 : path._nTraceCount + 1;
+	if ( bWhole )
+	{
+		memcpy( pRecord, pData, nLength );
+		return nLength;
+	}
+
+	scTraceDeltaRecord_t	delta;
+	delta._nSync = scTRACE_DELTA_SYNC;
+	delta._nArgs = header._nArgs;
+	delta._nLabel = header._nLabel;
+	delta._nFormatId = header._nFormatId;
+	memcpy( pRecord, &delta, sizeof(scTraceDeltaRecord_t) );
+
+	uint32_t nResult = sizeof(scTraceDeltaRecord_t);
+	while( nDelta >= 0x80 )
+	{
+		pRecord[nResult++] = (uint8_t)( nDelta | 0x80 );
+		nDelta >>= 7;
+	}
+	pRecord[nResult++] = (uint8_t)nDelta;
+
+	memcpy( pRecord + nResult, pData + sizeof(scTraceRecord_t), nLength - sizeof(scTraceRecord_t) );
+	return nResult + nLength - sizeof(scTraceRecord_t);
+}
+
+/// <summary>
+/// Have the next binary record sent to every path carry the whole timestamp, the
+/// bases the paths hold no longer apply.
+/// </summary>
+void scDebugManager::RestartDeltas( void )
+{
+	PathReader reader( *this );
+	for( scDebugPath* const* itr = reader.Paths(); *itr != NULL; itr++ )
+	{
+		(*itr)->RestartDelta();
+	}
+}
+
+/// <summary>
+/// Send a finished record to the enabled paths that accept its label. A binary
+/// record from the queue is rewritten for each path, so the delta a path receives
+/// is from the record it received before and not one only other paths took.
+/// </summary>
+void scDebugManager::Capture( uint16_t nTag, const uint8_t* pData, uint32_t nLength )
+{
+	uint16_t	nLabel = nTag & ~TRACE_TAG_BINARY;
+	bool		bDelta = ( nTag & TRACE_TAG_BINARY ) != 0 && ( _nTimestampOptions & scTRACE_TIMESTAMP_DELTA ) != 0 &&
+					nLength >= sizeof(scTraceRecord_t) && nLength <= sizeof(scTraceRecord_t) + scTRACE_MAX_ARGS * sizeof(uint32_t);
+
+	PathReader reader( *this );
+	for( scDebugPath* const* itr = reader.Paths(); *itr != NULL; itr++ )
+	{
+		if ( (*itr)->State() == scEnabled && (*itr)->Accepts( nLabel ) )
+		{
+			if ( bDelta )
+			{
+				uint8_t record[sizeof(scTraceRecord_t) + scTRACE_MAX_ARGS * sizeof(uint32_t)];
+				(*itr)->Capture( record, DeltaRecord( **itr, record, pData, nLength ) );
+			}
+			else
+			{
+				(*itr)->Capture( pData, nLength );
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Rebuild the bits used by IsEnabled from the label manager.
+/// </summary>
+void scDebugManager::RefreshLabelBits(void)
+{
+	for( uint16_t i=0; i < SC_TRACE_INLINE_LABELS; ++i )
+	{
+		uint32_t nBit = 1UL << ( i & 31 );
+		if ( _nState == scEnabled && _pLabelManager != NULL && _pLabelManager->LabelState( i ) == scEnabled )
+		{
+			s_LabelBits[i >> 5] |= nBit;
+		}
+		else
+		{
+			s_LabelBits[i >> 5] &= ~nBit;
+		}
+	}
+}
+
+/// <summary>
+/// The least free space of the enabled paths taking this label.
+/// </summary>
+uint32_t scDebugManager::PathSpace( uint16_t nLabel ) const
+{
+	uint32_t nResult = 0xFFFFFFFF;
+	PathReader reader( *this );
+	for( scDebugPath* const* itr = reader.Paths(); *itr != NULL; itr++ )
+	{
+		if ( (*itr)->State() == scEnabled && (*itr)->Accepts( nLabel ) && (*itr)->Space() < nResult )
+		{
+			nResult = (*itr)->Space();
+		}
+	}
+	return nResult;
+}
+
+/// <summary>
+/// Reader used when draining the trace queue.
+/// </summary>
+void scDebugManager::DrainRecord( const uint8_t* pData, uint32_t nLength, uint16_t nTag, void* pContext )
+{
+	reinterpret_cast<scDebugManager*>( pContext )->Capture( nTag, pData, nLength );
+}
+
 /// <summary>
 /// set the label manager.
 /// By design the there should only be one label manager ever assigned.
@@ -450,6 +1224,7 @@ scIDebugLabelManager* scDebugManager::SetLabelManager( scIDebugLabelManager* pLa
 	assert_param( pLabelManager != NULL );
 	scIDebugLabelManager* pOld = _pLabelManager;
 	_pLabelManager = pLabelManager;
+	RefreshLabelBits();
 	return pOld;
 }
 
@@ -496,12 +1271,14 @@ void scDebugManager::Shutdown(void)
 	Disable();
 	delete []_pLabelManager;
 	_pLabelManager = NULL;
-	vector<scDebugPath*>::iterator itr = _Paths.begin();
-	for( ; itr != _Paths.end(); itr++ )
+	LockPaths();
+	scDebugPath** pPaths = ReplacePaths( s_NoPaths );
+	UnlockPaths();
+	for( scDebugPath** itr = pPaths; *itr != NULL; itr++ )
 	{
 		delete (*itr);
-		(*itr) = NULL;
 	}
+	FreePaths( pPaths );
 }
 
 
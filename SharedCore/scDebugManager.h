@@ -41,11 +41,113 @@
 #include "scIDebugLabelManager.h"
 #include "scSingletonPtr.h"
 #include "scAllocator.h"
+#include "scTraceDecoder.h"
+#include "scTraceQueue.h"
 
 using namespace std;
 
+// Number of labels covered by the inline label test, labels past this always take
+// the full check inside Trace. Define it in scConf.h to change it.
+#ifndef SC_TRACE_INLINE_LABELS
+	#define SC_TRACE_INLINE_LABELS		(64)
+#endif
+
+// Number of binary trace records a path receives between two that carry the whole
+// timestamp, the others only carry the time since the record before. Define it in
+// scConf.h to change it.
+#ifndef SC_TRACE_DELTA_INTERVAL
+	#define SC_TRACE_DELTA_INTERVAL		(32)
+#endif
+
 namespace SharedCore
 {
+	/// <summary>
+	/// Start the text of every trace with the timestamp, "[sss.uuuuuu] ".
+	/// </summary>
+	#define scTRACE_TIMESTAMP_TEXT		(0x01)
+
+	/// <summary>
+	/// Binary trace records carry the time since the record before, see
+	/// scTraceDeltaRecord_t. Only records sent from the trace queue, the drain
+	/// delivers them in order and keeps the base of each path. Without a queue every
+	/// record carries the whole timestamp.
+	/// </summary>
+	#define scTRACE_TIMESTAMP_DELTA		(0x02)
+
+	/// <summary>
+	/// Rate limit of one trace call site, a token bucket kept as microseconds of
+	/// credit. Each message costs one interval of credit and the credit grows back
+	/// with time up to a full bucket of nBurst messages. Declared static at the call
+	/// site with scTRACE_LIMIT_INIT so it needs no construction, see scTRACE_LIMITED.
+	/// </summary>
+	typedef struct scTraceLimit_s
+	{
+		/// <summary>
+		/// Microseconds of credit each message costs.
+		/// </summary>
+		uint32_t					_nInterval;
+
+		/// <summary>
+		/// Credit of a full bucket.
+		/// </summary>
+		uint32_t					_nCapacity;
+
+		/// <summary>
+		/// Microseconds of credit left.
+		/// </summary>
+		uint32_t					_nCredit;
+
+		/// <summary>
+		/// Time of the last call, 64 bits so a long quiet spell is not taken for a
+		/// short one once the microseconds pass 32 bits.
+		/// </summary>
+		uint64_t					_nLast;
+
+		/// <summary>
+		/// Messages dropped by the limit since they were last reported.
+		/// </summary>
+		volatile uint32_t			_nSuppressed;
+
+		/// <summary>
+		/// Messages dropped as repeats of the one before since last reported.
+		/// </summary>
+		volatile uint32_t			_nRepeats;
+
+		/// <summary>
+		/// Hash of the text last sent.
+		/// </summary>
+		uint32_t					_nHash;
+
+		/// <summary>
+		/// The call site, used in the reports.
+		/// </summary>
+		const char*					_pFile;
+		uint32_t					_nLine;
+
+		/// <summary>
+		/// Label of the last message, used for the reports.
+		/// </summary>
+		uint16_t					_nLabel;
+
+		/// <summary>
+		/// Set once the limit is in the list walked by ReportSuppressed.
+		/// </summary>
+		volatile uint32_t			_nListed;
+
+		/// <summary>
+		/// Next limit in that list.
+		/// </summary>
+		struct scTraceLimit_s*		_pNext;
+	} scTraceLimit_t;
+
+	/// <summary>
+	/// Initializer of a scTraceLimit_t allowing nPerSecond messages on average and
+	/// nBurst at once, the bucket starts full.
+	/// </summary>
+	#define scTRACE_LIMIT_INIT( nPerSecond, nBurst ) \
+		{ 1000000UL / (nPerSecond), (nBurst) * ( 1000000UL / (nPerSecond) ), (nBurst) * ( 1000000UL / (nPerSecond) ), \
+		  0, 0, 0, 0, __FILE__, __LINE__, 0, 0, NULL }
+
 	/// <summary>
 	/// A singleton class, the child must implement the static Instance() method. This
 	/// class will manage the debug paths to allow the system to enable and disable
@@ -53,10 +155,33 @@ namespace SharedCore
 	/// possibilities for debug messages to be used. For example they can go out a UART,
 	/// or saved to memory as a log, a disk, or a message system. These can be any path
 	/// that can handle writing a block of memory.
+	///
+	/// Any number of tasks can trace at once without a lock. The path list is copy on
+	/// write: Add and Remove publish a new list and free the old one once no trace can
+	/// still be walking it. With a trace queue assigned the callers only reserve a slot
+	/// of the lock-free queue and the paths are called from Drain alone, without one
+	/// the paths are called by every tracing task and must protect themselves.
 	/// </summary>
 	class scDebugManager
 	{
 	public:
+		/// <summary>
+		/// Function used to obtain the timestamp of the trace records. The text
+		/// timestamp takes it as microseconds, as scHiResClock::Timestamp provides.
+		/// </summary>
+		typedef uint32_t (*TimestampSource_t)( void );
+
+		/// <summary>
+		/// Function called by PrintArray while it waits for the paths to make room.
+		/// </summary>
+		typedef void (*Yield_t)( void );
+
+		/// <summary>
+		/// Function called by Add and Remove while they wait for the tasks still using
+		/// the path list. It has to block the caller long enough for a lower priority
+		/// task to run, such as a delay of one tick, a yield is not enough.
+		/// </summary>
+		typedef void (*PathWait_t)( void );
 
 		/// <summary>
 		/// Access to the singleton object
@@ -104,7 +229,9 @@ namespace SharedCore
 		size_t Add(scDebugPath* pPath);
 
 		/// <summary>
-		/// This path will remove the path from the list and return the pointer.
+		/// This path will remove the path from the list and return the pointer. Waits,
+		/// calling the path wait function, until no trace is using the path any more,
+		/// so the caller may delete it.
 		/// </summary>
 		/// <param name="nPathId">The path id</param>
 		scDebugPath* Remove( uint8_t nPathId );
@@ -126,6 +253,19 @@ namespace SharedCore
 		/// <param name="nLabel">the id of the debug label.</param>
 		scEnableState_t LabelState(uint16_t nLabel) const;
 
+		/// <summary>
+		/// Quick test used by the trace macros before the arguments are evaluated. True
+		/// if the manager and the label are enabled, or if the label is past
+		/// SC_TRACE_INLINE_LABELS. The bits mirror the label manager, so labels must be
+		/// changed through this class and not on the label manager directly.
+		/// </summary>
+		/// <param name="nLabel">the id of the debug label.</param>
+		static bool IsEnabled(uint16_t nLabel)
+		{
+			return nLabel >= SC_TRACE_INLINE_LABELS ||
+				( s_LabelBits[nLabel >> 5] & ( 1UL << ( nLabel & 31 ) ) ) != 0;
+		}
+
 		/// <summary>
 		/// Set the current state of the debug label.
 		/// </summary>
@@ -139,6 +279,22 @@ namespace SharedCore
 		/// <param name="nState">The new state for the label.</param>
 		void LabelState( scEnableState_t nState);
 
+		/// <summary>
+		/// Changes the state of every label in a group registered with the label
+		/// manager.
+		/// </summary>
+		/// <param name="pName">Name of the group.</param>
+		/// <param name="nState">The new state for the labels.</param>
+		/// <returns>false if the label manager has no such group.</returns>
+		bool GroupState( const char* pName, scEnableState_t nState );
+
+		/// <summary>
+		/// Get the text of a debug label from the label manager.
+		/// </summary>
+		/// <param name="nLabel">the id of the debug label.</param>
+		/// <returns>NULL if there is no label manager.</returns>
+		const char* LabelText( uint16_t nLabel );
+
 		/// <summary>
 		/// Will get a text string for the enable state enum.
 		/// </summary>
@@ -150,10 +306,19 @@ namespace SharedCore
 		/// </summary>
 		/// <param name="pOut"></param>
 		/// <param name="nByte"></param>
-		static char* ByteToHex(char* pOut, uint8_t nByte);
+		static char* ByteToHex(char* pOut, uint8_t nByte)
+		{
+			pOut[0] = s_HexPairs[nByte * 2];
+			pOut[1] = s_HexPairs[nByte * 2 + 1];
+			return pOut + 2;
+		}
 
 		/// <summary>
-		/// This method will convert a memory array to a hex dump.
+		/// This method will convert a memory array to a hex dump. Each row is built on
+		/// the stack and sent to the paths as soon as it is complete, no working buffer
+		/// is used. Before a row is sent the free space of the paths is checked and,
+		/// when a yield function is assigned, the caller yields until the row fits so a
+		/// large dump does not overrun a slow device.
 		/// </summary>
 		/// <param name="nLabel">the label.</param>
 		/// <param name="pBuffer">Pointer to the memory to be printed.</param>
@@ -179,11 +344,129 @@ namespace SharedCore
 		/// <param name="pBuffer">The message, must be null terminated.</param>
 		virtual void Trace_Info(uint16_t nLabel, const char* pBuffer);
 
+		/// <summary>
+		/// Binary version of Trace. Only the format ID, the label, a timestamp and the
+		/// raw arguments are sent to the paths as a scTraceRecord_t, the text is produced
+		/// later by a scTraceDecoder holding the format string table. No formatting and
+		/// no working buffer are used on the target, which makes this suitable for
+		/// drivers and other time critical code. If a decoder has been assigned with
+		/// SetTraceDecoder the paths receive the text instead.
+		/// </summary>
+		/// <param name="nLabel">The debug label.</param>
+		/// <param name="nFormatId">ID of the format string.</param>
+		void TraceBinary(uint16_t nLabel, uint16_t nFormatId);
+
+		/// <summary>
+		/// Binary version of Trace with one argument.
+		/// </summary>
+		void TraceBinary(uint16_t nLabel, uint16_t nFormatId, uint32_t nArg1);
+
+		/// <summary>
+		/// Binary version of Trace with two arguments.
+		/// </summary>
+		void TraceBinary(uint16_t nLabel, uint16_t nFormatId, uint32_t nArg1, uint32_t nArg2);
+
+		/// <summary>
+		/// Binary version of Trace with three arguments.
+		/// </summary>
+		void TraceBinary(uint16_t nLabel, uint16_t nFormatId, uint32_t nArg1, uint32_t nArg2, uint32_t nArg3);
+
+		/// <summary>
+		/// Binary version of Trace with four arguments.
+		/// </summary>
+		void TraceBinary(uint16_t nLabel, uint16_t nFormatId, uint32_t nArg1, uint32_t nArg2, uint32_t nArg3, uint32_t nArg4);
+
+		/// <summary>
+		/// Trace with a rate limit, normally through scTRACE_LIMITED. Messages over
+		/// the limit cost little more than the label check, they are only counted. A
+		/// message with the same text as the one before from this call site is counted
+		/// as a repeat instead of sent. The counts are reported ahead of the next message
+		/// sent from the call site, and by ReportSuppressed.
+		/// </summary>
+		/// <param name="limit">The limit of the call site, static since it joins a list
+		/// kept by the manager.</param>
+		/// <param name="nLabel">The debug label.</param>
+		/// <param name="pFormat">The format string.</param>
+		void TraceLimited( scTraceLimit_t& limit, uint16_t nLabel, const char* pFormat, ... );
+
+		/// <summary>
+		/// Take one message from the bucket of a limit, counting it as suppressed when
+		/// the bucket is empty. Lets a call site limit output other than Trace. With
+		/// no timestamp source and no running scHiResClock the bucket could never
+		/// refill, so every message is allowed.
+		/// </summary>
+		/// <returns>true if the message may be sent.</returns>
+		bool Allow( scTraceLimit_t& limit );
+
+		/// <summary>
+		/// Report the messages suppressed and repeated at every limited call site since
+		/// they were last reported, so an error storm that stopped is still seen. Call
+		/// it periodically from the task owning the debug output, once a second say.
+		/// </summary>
+		/// <returns>The number of messages reported.</returns>
+		uint32_t ReportSuppressed( void );
+
+		/// <summary>
+		/// Assign the function providing the timestamp of the trace records. When
+		/// none is assigned scHiResClock::Timestamp is used.
+		/// </summary>
+		/// <param name="pSource">The timestamp function.</param>
+		void SetTimestampSource( TimestampSource_t pSource );
+
+		/// <summary>
+		/// Choose how the timestamp is recorded. Both are on by default, a decoder older
+		/// than the delta records needs scTRACE_TIMESTAMP_DELTA cleared.
+		/// </summary>
+		/// <param name="nOptions">scTRACE_TIMESTAMP_TEXT and scTRACE_TIMESTAMP_DELTA
+		/// combined.</param>
+		void SetTimestampOptions( uint32_t nOptions );
+
+		/// <summary>
+		/// Assign the function PrintArray calls while waiting for the paths to make room,
+		/// normally the task yield of the RTOS. NULL, the default, sends the rows without
+		/// waiting and leaves the flow control to the paths.
+		/// </summary>
+		/// <param name="pYield">The yield function.</param>
+		void SetYieldFunction( Yield_t pYield );
+
+		/// <summary>
+		/// Assign the function Add and Remove call while they wait for the tasks using
+		/// the path list, see PathWait_t. It is required once paths can be added or
+		/// removed while other tasks trace; without it a change that has to wait traps
+		/// in assert_param rather than spinning, which would never end on a single core
+		/// when the task it waits for has a lower priority.
+		/// </summary>
+		/// <param name="pWait">The wait function.</param>
+		void SetPathWaitFunction( PathWait_t pWait );
+
+		/// <summary>
+		/// Assign a decoder to have TraceBinary produce text on the target. NULL, the
+		/// default, sends the binary records to the paths.
+		/// </summary>
+		/// <param name="pDecoder">The decoder, the caller keeps ownership.</param>
+		void SetTraceDecoder( const scTraceDecoder* pDecoder );
+
+		/// <summary>
+		/// Assign a queue to make the output asynchronous. Trace and the other output
+		/// methods then only add a record to the queue and return, the paths are called
+		/// from Drain. NULL, the default, calls the paths directly from Trace.
+		/// </summary>
+		/// <param name="pQueue">The queue, the caller keeps ownership.</param>
+		void SetTraceQueue( scTraceQueue* pQueue );
+
+		/// <summary>
+		/// Send the records waiting in the trace queue to the enabled paths. Called
+		/// periodically by the task that owns the debug output.
+		/// </summary>
+		/// <param name="nMax">Most records to send.</param>
+		/// <returns>The number of records sent.</returns>
+		uint32_t Drain( uint32_t nMax = 0xFFFFFFFF );
+
 		/// <summary>
 		/// set the label manager.
 		/// By design the there should only be one label manager ever assigned.
 		/// Any additional manager assignments are rejected because possible memory
-		/// leaks.
+		/// leaks. Set it before adding the paths, their label masks are sized from it.
 		/// </summary>
 		virtual scIDebugLabelManager* SetLabelManager( scIDebugLabelManager* pLabelManager );
 
@@ -220,6 +503,16 @@ namespace SharedCore
 		/// <param name="ap">the variable argument list.</param>
 		virtual void vTrace(uint16_t nLabel, const char* pFormat, va_list ap);
 
+		/// <summary>
+		/// This is the implementation that will send a binary trace record, or the text
+		/// of the record if a decoder is assigned, to the output.
+		/// </summary>
+		/// <param name="nLabel">The debug label.</param>
+		/// <param name="nFormatId">ID of the format string.</param>
+		/// <param name="pArgs">The arguments.</param>
+		/// <param name="nArgs">Number of arguments.</param>
+		virtual void vTraceBinary(uint16_t nLabel, uint16_t nFormatId, const uint32_t* pArgs, uint8_t nArgs);
+
 		/// <summary>
 		/// get access to the buffer used by the DebugManager.
 		/// to change the buffer management subclass this manager and use a different memory allocator
@@ -236,6 +529,128 @@ namespace SharedCore
 
 		friend class scSingletonPtr< scDebugManager >;
 
+		/// <summary>
+		/// Holds on to the path list for the life of the object. A list replaced by Add
+		/// or Remove meanwhile is not freed before the reader is gone. The readers are
+		/// counted in two halves, Add and Remove swap the half new readers go to and
+		/// wait for the other half to empty.
+		/// </summary>
+		class PathReader
+		{
+		public:
+			PathReader( const scDebugManager& manager );
+			~PathReader();
+
+			/// <summary>
+			/// The paths, ending with NULL.
+			/// </summary>
+			scDebugPath* const* Paths( void ) const
+			{
+				return _pPaths;
+			}
+
+		private:
+			const scDebugManager&		_Manager;
+			uint32_t					_nHalf;
+			scDebugPath* const*			_pPaths;
+		};
+		friend class PathReader;
+
+		/// <summary>
+		/// Publish a new path list and wait until the readers of the old one are done.
+		/// </summary>
+		/// <returns>The old list.</returns>
+		scDebugPath** ReplacePaths( scDebugPath** pPaths );
+
+		/// <summary>
+		/// Free a path list that is not in use.
+		/// </summary>
+		static void FreePaths( scDebugPath** pPaths );
+
+		/// <summary>
+		/// Make the path list the only writer.
+		/// </summary>
+		void LockPaths( void );
+		void UnlockPaths( void );
+
+		/// <summary>
+		/// Let the task holding up a path list change run.
+		/// </summary>
+		void WaitForPaths( void ) const;
+
+		/// <summary>
+		/// Send a finished record to the trace queue, or to the enabled paths when there
+		/// is no queue.
+		/// </summary>
+		/// <returns>false if the queue had no room for the record.</returns>
+		bool Output( uint16_t nLabel, const uint8_t* pData, uint32_t nLength );
+
+		/// <summary>
+		/// The time used by the rate limits, in microseconds. The timestamp source when
+		/// one is assigned, else scHiResClock.
+		/// </summary>
+		uint64_t Now( void ) const;
+
+		/// <summary>
+		/// The timestamp of a trace record, in microseconds. The timestamp source when
+		/// one is assigned, else scHiResClock.
+		/// </summary>
+		uint32_t Timestamp( void ) const;
+
+		/// <summary>
+		/// Put a limit in the list walked by ReportSuppressed, once.
+		/// </summary>
+		void ListLimit( scTraceLimit_t& limit );
+
+		/// <summary>
+		/// Trace the counts of a limit and clear them.
+		/// </summary>
+		/// <returns>The number of messages reported.</returns>
+		uint32_t ReportLimit( scTraceLimit_t& limit );
+
+		/// <summary>
+		/// Write the text timestamp when it is enabled.
+		/// </summary>
+		/// <returns>The length of the text, zero when disabled.</returns>
+		uint32_t TextTimestamp( char* pText, uint32_t nSize ) const;
+
+		/// <summary>
+		/// Rewrite a binary record for one path, as a delta record when the time since
+		/// the record the path received before fits and a whole timestamp is not due.
+		/// </summary>
+		/// <returns>The length of the record.</returns>
+		static uint32_t DeltaRecord( scDebugPath& path, uint8_t* pRecord, const uint8_t* pData, uint32_t nLength );
+
+		/// <summary>
+		/// Have the next binary record sent to every path carry the whole timestamp.
+		/// </summary>
+		void RestartDeltas( void );
+
+		/// <summary>
+		/// Send a finished record to the enabled paths.
+		/// </summary>
+		void Capture( uint16_t nTag, const uint8_t* pData, uint32_t nLength );
+
+		/// <summary>
+		/// Reader used when draining the trace queue.
+		/// </summary>
+		static void DrainRecord( const uint8_t* pData, uint32_t nLength, uint16_t nTag, void* pContext );
+
+		/// <summary>
+		/// Rebuild the bits used by IsEnabled from the label manager.
+		/// </summary>
+		void RefreshLabelBits(void);
+
+		/// <summary>
+		/// The least free space of the enabled paths taking this label.
+		/// </summary>
+		uint32_t PathSpace( uint16_t nLabel ) const;
+
+		/// <summary>
+		/// One bit per label, set while the manager and the label are enabled.
+		/// </summary>
+		static uint32_t					s_LabelBits[( SC_TRACE_INLINE_LABELS + 31 ) / 32];
+
 		/// <summary>
 		/// Enables or disables the entire debug manager behavior. By default the debug
 		/// manager is disabled.
@@ -243,9 +658,35 @@ namespace SharedCore
 		scEnableState_t					_nState;
 
 		/// <summary>
-		/// The list of all the paths managed by the debug manager.
+		/// The list of all the paths managed by the debug manager, ending with NULL.
+		/// Never changed once published, see PathReader.
+		/// </summary>
+		scDebugPath** volatile			_pPaths;
+
+		/// <summary>
+		/// The limits that dropped messages, walked by ReportSuppressed.
+		/// </summary>
+		scTraceLimit_t* volatile		_pLimits;
+
+		/// <summary>
+		/// Selects the half of _nReaders new readers count in.
+		/// </summary>
+		volatile uint32_t				_nReaderHalf;
+
+		/// <summary>
+		/// Number of readers of the path list in each half.
+		/// </summary>
+		mutable volatile uint32_t		_nReaders[2];
+
+		/// <summary>
+		/// Set while Add, Remove or Shutdown change the path list.
 		/// </summary>
-		vector<scDebugPath*>			_Paths;
+		volatile uint32_t				_nPathWriter;
+
+		/// <summary>
+		/// The path list when there are no paths.
+		/// </summary>
+		static scDebugPath*				s_NoPaths[1];
 
 		/// <summary>
 		/// The list of all the labels.
@@ -258,6 +699,41 @@ namespace SharedCore
 		/// </summary>
 		scAllocator						_Allocator;
 
+		/// <summary>
+		/// Provides the timestamp of the trace records.
+		/// </summary>
+		TimestampSource_t				_pTimestampSource;
+
+		/// <summary>
+		/// scTRACE_TIMESTAMP_TEXT and scTRACE_TIMESTAMP_DELTA.
+		/// </summary>
+		uint32_t						_nTimestampOptions;
+
+		/// <summary>
+		/// When assigned the binary trace records are converted to text.
+		/// </summary>
+		const scTraceDecoder*			_pDecoder;
+
+		/// <summary>
+		/// When assigned the output is queued and sent to the paths by Drain.
+		/// </summary>
+		scTraceQueue*					_pQueue;
+
+		/// <summary>
+		/// Called by PrintArray while waiting for room in the paths.
+		/// </summary>
+		Yield_t							_pYield;
+
+		/// <summary>
+		/// Called by Add and Remove while waiting for the path list.
+		/// </summary>
+		PathWait_t						_pPathWait;
+
+		/// <summary>
+		/// Two hex digits for every byte value, used by ByteToHex.
+		/// </summary>
+		static const char				s_HexPairs[];
+
 	};
 
 }
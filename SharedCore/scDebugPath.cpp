@@ -31,6 +31,12 @@
 
 using SharedCore::scDebugPath;
 using SharedCore::scEnableState_t;
+using SharedCore::scIOSpan_t;
+using SharedCore::scLabelMask;
+
+#ifndef assert_param
+#define assert_param(X)	if ( !(X) ) { for(;;) ; }
+#endif
 
 /// <summary>
 /// Simple destructor
@@ -46,7 +52,56 @@ scDebugPath::~scDebugPath()
 scDebugPath::scDebugPath( uint8_t nPathID )
 	: _nPathId( nPathID )
 	, _nState(scEnabled)
+	, _Labels( scDEBUGLABEL_LAST, SharedCore::scEnabled )
+	, _nTraceBase( 0 )
+	, _nTraceCount( 0 )
+{
+}
+
+/// <summary>
+/// Scatter-gather version of Capture. The segments together make up a single
+/// debug record. The default implementation calls Capture for each segment, paths
+/// that can accept the segments in one operation should override this.
+/// </summary>
+/// <param name="pSpans">Array of segments that make up the record.</param>
+/// <param name="nCount">Number of segments in the array.</param>
+void scDebugPath::Capture_v( const scIOSpan_t* pSpans, uint32_t nCount )
+{
+	for( uint32_t i=0; i < nCount; ++i )
+	{
+		Capture( pSpans[i]._pData, pSpans[i]._nLength );
+	}
+}
+
+/// <summary>
+/// True if the path formats the text itself through Capture_f. The manager then
+/// skips the working buffer for this path. By default paths take finished text.
+/// </summary>
+bool scDebugPath::Formats(void) const
+{
+	return false;
+}
+
+/// <summary>
+/// Format the text straight into the destination of the path, such as the
+/// transmit queue of a driver. Only called when Formats returns true.
+/// </summary>
+/// <param name="pFormat">The format string, see scFormat.</param>
+/// <param name="ap">The arguments.</param>
+void scDebugPath::Capture_f( const char* pFormat, va_list ap )
+{
+	(void)pFormat;
+	(void)ap;
+	assert_param( Formats() );
+}
+
+/// <summary>
+/// Number of bytes the path can take now without waiting or losing data. Used to
+/// pace large output such as PrintArray. By default there is no limit.
+/// </summary>
+uint32_t scDebugPath::Space(void) const
 {
+	return 0xFFFFFFFF;
 }
 
 /// <summary>
@@ -88,3 +143,36 @@ scEnableState_t scDebugPath::State(void) const
 {
 	return _nState;
 }
+
+/// <summary>
+/// Change whether the path takes messages with this label. This allows, for
+/// example, a UART path to take only errors while a recorder takes everything.
+/// The mask is never resized here, other tasks may be testing it; it is sized
+/// from the label manager when the path is added to the debug manager.
+/// </summary>
+/// <param name="nLabel">The debug label.</param>
+/// <param name="nState">The new state for the label.</param>
+void scDebugPath::LabelState( uint16_t nLabel, scEnableState_t nState )
+{
+	_Labels.Set( nLabel, nState );
+}
+
+/// <summary>
+/// Change whether the path takes messages with any label.
+/// </summary>
+/// <param name="nState">The new state for all labels.</param>
+void scDebugPath::LabelState( scEnableState_t nState )
+{
+	_Labels.SetAll( nState );
+}
+
+/// <summary>
+/// Change whether the path takes messages with the labels of a group, see
+/// scDebugLabelManager::AddGroup.
+/// </summary>
+/// <param name="mask">The labels to change.</param>
+/// <param name="nState">The new state for the labels.</param>
+void scDebugPath::LabelMask( const scLabelMask& mask, scEnableState_t nState )
+{
+	_Labels.Merge( mask, nState );
+}
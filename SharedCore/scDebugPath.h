@@ -34,7 +34,10 @@
 #if !defined(__SCDEBUGPATH_H__INCLUDED_)
 #define __SCDEBUGPATH_H__INCLUDED_
 
+#include <stdarg.h>
 #include "scTypes.h"
+#include "scLabelMask.h"
+#include "scDebugLabelCodes.h"
 
 namespace SharedCore
 {
@@ -68,6 +71,35 @@ namespace SharedCore
 		/// </summary>
 		virtual void Capture( const uint8_t* pData, uint32_t nLength ) = 0;
 
+		/// <summary>
+		/// Scatter-gather version of Capture. The segments together make up a single
+		/// debug record. The default implementation calls Capture for each segment, paths
+		/// that can accept the segments in one operation should override this.
+		/// </summary>
+		/// <param name="pSpans">Array of segments that make up the record.</param>
+		/// <param name="nCount">Number of segments in the array.</param>
+		virtual void Capture_v( const scIOSpan_t* pSpans, uint32_t nCount );
+
+		/// <summary>
+		/// True if the path formats the text itself through Capture_f. The manager then
+		/// skips the working buffer for this path. By default paths take finished text.
+		/// </summary>
+		virtual bool Formats(void) const;
+
+		/// <summary>
+		/// Format the text straight into the destination of the path, such as the
+		/// transmit queue of a driver. Only called when Formats returns true.
+		/// </summary>
+		/// <param name="pFormat">The format string, see scFormat.</param>
+		/// <param name="ap">The arguments.</param>
+		virtual void Capture_f( const char* pFormat, va_list ap );
+
+		/// <summary>
+		/// Number of bytes the path can take now without waiting or losing data. Used to
+		/// pace large output such as PrintArray. By default there is no limit.
+		/// </summary>
+		virtual uint32_t Space(void) const;
+
 		/// <summary>
 		/// This method will change the flag that permits the use of this debug path.
 		/// </summary>
@@ -94,7 +126,54 @@ namespace SharedCore
 		/// </summary>
 		void State(scEnableState_t nState );
 
+		/// <summary>
+		/// Check if the path takes messages with this label. Every label is taken until
+		/// the path is told otherwise.
+		/// </summary>
+		/// <param name="nLabel">The debug label.</param>
+		bool Accepts( uint16_t nLabel ) const
+		{
+			return _Labels.Test( nLabel );
+		}
+
+		/// <summary>
+		/// Change whether the path takes messages with this label. This allows, for
+		/// example, a UART path to take only errors while a recorder takes everything.
+		/// The mask holds the labels of the label manager, labels past them follow
+		/// LabelState( nState ).
+		/// </summary>
+		/// <param name="nLabel">The debug label.</param>
+		/// <param name="nState">The new state for the label.</param>
+		void LabelState( uint16_t nLabel, scEnableState_t nState );
+
+		/// <summary>
+		/// Change whether the path takes messages with any label.
+		/// </summary>
+		/// <param name="nState">The new state for all labels.</param>
+		void LabelState( scEnableState_t nState );
+
+		/// <summary>
+		/// Change whether the path takes messages with the labels of a group, see
+		/// scDebugLabelManager::AddGroup.
+		/// </summary>
+		/// <param name="mask">The labels to change.</param>
+		/// <param name="nState">The new state for the labels.</param>
+		void LabelMask( const scLabelMask& mask, scEnableState_t nState );
+
+	protected:
+		/// <summary>
+		/// Have the next binary trace record sent to the path carry the whole timestamp.
+		/// Called by paths that lose their oldest output, so a reader of what is left
+		/// finds the base of the delta records soon.
+		/// </summary>
+		void RestartDelta( void )
+		{
+			_nTraceCount = 0;
+		}
+
 	private:
+		friend class scDebugManager;
+
 		/// <summary>
 		/// This variable is used to identify this path from other paths available in a
 		/// given project. The actual value is not to important other than it is different
@@ -107,6 +186,23 @@ namespace SharedCore
 		/// </summary>
 		scEnableState_t			_nState;
 
+		/// <summary>
+		/// The labels taken by this path.
+		/// </summary>
+		scLabelMask				_Labels;
+
+		/// <summary>
+		/// Timestamp of the last binary trace record sent to the path, the base of the
+		/// next delta record. Kept by scDebugManager.
+		/// </summary>
+		uint32_t				_nTraceBase;
+
+		/// <summary>
+		/// Binary trace records sent to the path since the last one carrying the whole
+		/// timestamp, zero when the next one has to carry it.
+		/// </summary>
+		uint32_t				_nTraceCount;
+
 		/// <summary>
 		/// Copy constructors are not allowed.
 		/// </summary>
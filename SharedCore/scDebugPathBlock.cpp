@@ -0,0 +1,396 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scDebugPathBlock.cpp
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#include <string.h>
+#include "scDebugPathBlock.h"
+#include "scScopeLock.h"
+#include "scErrorCodes.h"
+
+#ifndef assert_param
+#define assert_param(X)	if ( !(X) ) { for(;;) ; }
+#endif
+
+using namespace SharedCore;
+using namespace SharedCore::HAL;
+
+/// <summary>
+/// Combine the fields of a block header for the check.
+/// </summary>
+#define scTRACE_BLOCK_CHECK( header )	\
+	( (header)._nMagic ^ (header)._nSequence ^ ( (uint32_t)(header)._nUsed | ( (uint32_t)(header)._nFirst << 16 ) ) )
+
+/// <summary>
+/// Construct the path.
+/// </summary>
+/// <param name="nPathID">The path Id.</param>
+/// <param name="pDevice">The block device.</param>
+/// <param name="nStartBlock">First block of the area.</param>
+/// <param name="nBlockCount">Number of blocks in the area, a multiple of the
+/// erase size.</param>
+/// <param name="nEraseBlocks">Number of blocks erased at once.</param>
+/// <param name="nEraseAhead">Number of erase units kept erased ahead of the
+/// block being filled.</param>
+scDebugPathBlock::scDebugPathBlock( uint8_t nPathID, scBlockMemoryIF* pDevice, uint32_t nStartBlock, uint32_t nBlockCount,
+	uint32_t nEraseBlocks, uint32_t nEraseAhead )
+	: scDebugPath( nPathID )
+	, _pDevice( pDevice )
+	, _nStartBlock( nStartBlock )
+	, _nBlockCount( nBlockCount )
+	, _nEraseBlocks( nEraseBlocks )
+	, _nEraseAhead( nEraseAhead * nEraseBlocks )
+	, _nBlockSize( 0 )
+	, _pBlock( NULL )
+	, _nUsed( 0 )
+	, _nFirst( scTRACE_BLOCK_NO_RECORD )
+	, _nBlock( 0 )
+	, _nSequence( 1 )
+	, _nEraseNext( 0 )
+	, _nErased( 0 )
+	, _nProbes( 0 )
+	, _nLastError( ERROR_SUCCESS )
+	, _pProtect( NULL )
+	, _Allocator()
+{
+	assert_param( _pDevice != NULL );
+	assert_param( nEraseBlocks > 0 && nEraseAhead > 0 && ( nBlockCount % nEraseBlocks ) == 0 );
+	// the unit being filled and the units ahead never meet
+	assert_param( _nEraseAhead + nEraseBlocks <= nBlockCount );
+}
+
+/// <summary>
+/// Destructor.
+/// </summary>
+scDebugPathBlock::~scDebugPathBlock()
+{
+	if ( _pBlock != NULL )
+	{
+		_Allocator.Destroy( _pBlock );
+		_pBlock = NULL;
+	}
+}
+
+/// <summary>
+/// Allocate the staging block and find the end of the log already in the area, so
+/// the new trace follows it.
+/// </summary>
+/// <param name="allocator">Allocator used for the staging block.</param>
+/// <param name="pProtect">Protects the path when it is used from several tasks,
+/// may be NULL.</param>
+uint32_t scDebugPathBlock::Initialize( scAllocator allocator, scIMutex* pProtect )
+{
+	_Allocator = allocator;
+	_pProtect = pProtect;
+	_nBlockSize = _pDevice->DefaultBlockSize();
+	assert_param( _nBlockSize > sizeof(scTraceBlockHeader_t) && _nBlockSize <= 0xFFFF );
+
+	_pBlock = _Allocator.Allocate( _nBlockSize, true );
+	if ( _pBlock == NULL )
+	{
+		_nLastError = ERROR_SC_MEMORY_ALLOCATION_FAILURE;
+		return _nLastError;
+	}
+
+	uint32_t nNewest;
+	uint32_t nSequence;
+	if ( FindNewest( nNewest, nSequence ) )
+	{
+		_nBlock = ( nNewest + 1 ) % _nBlockCount;
+		_nSequence = nSequence + 1;
+		// the rest of the unit was erased with it
+		_nErased = ( _nBlock % _nEraseBlocks == 0 ) ? 0 : _nEraseBlocks - ( _nBlock % _nEraseBlocks );
+	}
+	else
+	{
+		_nBlock = 0;
+		_nSequence = 1;
+		_nErased = 0;
+	}
+	_nEraseNext = ( _nBlock + _nErased ) % _nBlockCount;
+	_nUsed = 0;
+	_nFirst = scTRACE_BLOCK_NO_RECORD;
+	EraseAhead();
+	return _nLastError;
+}
+
+/// <summary>
+/// Add the record to the staging block, writing the block once it is full.
+/// </summary>
+void scDebugPathBlock::Capture( const uint8_t* pData, uint32_t nLength )
+{
+	scIOSpan_t span;
+	span._pData = pData;
+	span._nLength = nLength;
+	Capture_v( &span, 1 );
+}
+
+/// <summary>
+/// Add the segments of the record to the staging block.
+/// </summary>
+/// <param name="pSpans">Array of segments that make up the record.</param>
+/// <param name="nCount">Number of segments in the array.</param>
+void scDebugPathBlock::Capture_v( const scIOSpan_t* pSpans, uint32_t nCount )
+{
+	scScopeLock lock( _pProtect );
+	if ( _pBlock == NULL )
+	{
+		return;
+	}
+
+	uint32_t nCapacity = _nBlockSize - sizeof(scTraceBlockHeader_t);
+	if ( _nFirst == scTRACE_BLOCK_NO_RECORD )
+	{
+		_nFirst = _nUsed;
+	}
+
+	for( uint32_t i=0; i < nCount; ++i )
+	{
+		const uint8_t*	pData = pSpans[i]._pData;
+		uint32_t		nLength = pSpans[i]._nLength;
+		while( nLength > 0 )
+		{
+			uint32_t nCopy = nCapacity - _nUsed;
+			if ( nCopy > nLength )
+			{
+				nCopy = nLength;
+			}
+			memcpy( _pBlock + sizeof(scTraceBlockHeader_t) + _nUsed, pData, nCopy );
+			_nUsed += nCopy;
+			pData += nCopy;
+			nLength -= nCopy;
+			if ( _nUsed == nCapacity )
+			{
+				WriteStaged();
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Write the staging block even though it is not full, before a power down for
+/// example. The rest of the block is left unused.
+/// </summary>
+uint32_t scDebugPathBlock::Flush( void )
+{
+	scScopeLock lock( _pProtect );
+	uint32_t nResult = ERROR_SUCCESS;
+	if ( _pBlock != NULL && _nUsed > 0 )
+	{
+		nResult = WriteStaged();
+	}
+	return nResult;
+}
+
+/// <summary>
+/// Find the newest block in the area with a binary search over the headers. The
+/// blocks from the oldest kept at the start of the area up to the newest all have
+/// a sequence number at least that of the first, the erased blocks ahead of the
+/// newest and the older blocks after them do not, so the newest is the last block
+/// for which that holds. When the erased blocks are at the start of the area they
+/// are skipped first, there are only as many as are erased ahead.
+/// </summary>
+/// <param name="nBlock">Receives the block, relative to the start of the area.
+/// </param>
+/// <param name="nSequence">Receives its sequence number.</param>
+/// <returns>false if the area holds no log.</returns>
+bool scDebugPathBlock::FindNewest( uint32_t& nBlock, uint32_t& nSequence )
+{
+	scScopeLock				lock( _pProtect );
+	scTraceBlockHeader_t	header;
+	uint32_t				nLow = 0;
+
+	assert_param( _pBlock != NULL && _nUsed == 0 );
+	_nProbes = 0;
+
+	while( !ReadBlock( nLow, header ) )
+	{
+		if ( ++nLow == _nBlockCount )
+		{
+			return false;
+		}
+	}
+
+	uint32_t nFirst = header._nSequence;
+	uint32_t nHigh = _nBlockCount;
+	nSequence = header._nSequence;
+	while( nHigh - nLow > 1 )
+	{
+		uint32_t nMiddle = nLow + ( nHigh - nLow ) / 2;
+		if ( ReadBlock( nMiddle, header ) && header._nSequence >= nFirst )
+		{
+			nLow = nMiddle;
+			nSequence = header._nSequence;
+		}
+		else
+		{
+			nHigh = nMiddle;
+		}
+	}
+	nBlock = nLow;
+	return true;
+}
+
+/// <summary>
+/// Read the newest part of the log, oldest byte first, starting with a whole
+/// record. The staging block is written first.
+/// </summary>
+/// <param name="pData">Receives the trace.</param>
+/// <param name="nSize">Size of pData.</param>
+/// <param name="nLength">Receives the number of bytes read.</param>
+/// <returns>ERROR_SUCCESS or the error of the device.</returns>
+uint32_t scDebugPathBlock::ReadNewest( uint8_t* pData, uint32_t nSize, uint32_t& nLength )
+{
+	scScopeLock				lock( _pProtect );
+	scTraceBlockHeader_t	header;
+	uint32_t				nResult = ERROR_SUCCESS;
+
+	nLength = 0;
+	if ( _pBlock == NULL )
+	{
+		return ERROR_SC_MEMORY_ALLOCATION_FAILURE;
+	}
+	if ( _nUsed > 0 )
+	{
+		nResult = WriteStaged();
+	}
+
+	// gather whole blocks from the newest back, filling pData from its end
+	uint32_t nEnd = nSize;
+	uint32_t nBlock = ( _nBlock + _nBlockCount - 1 ) % _nBlockCount;
+	uint32_t nSequence = _nSequence - 1;
+	uint32_t nBlocks = 0;
+	uint32_t nOldest = nBlock;
+	uint32_t nOldestFirst = 0;
+	uint32_t nOldestUsed = 0;
+	while( nBlocks < _nBlockCount && ReadBlock( nBlock, header ) && header._nSequence == nSequence
+		&& header._nUsed <= nEnd )
+	{
+		nEnd -= header._nUsed;
+		memcpy( pData + nEnd, _pBlock + sizeof(scTraceBlockHeader_t), header._nUsed );
+		nOldest = nBlock;
+		nOldestFirst = header._nFirst;
+		nOldestUsed = header._nUsed;
+		nBlocks++;
+		nBlock = ( nBlock + _nBlockCount - 1 ) % _nBlockCount;
+		nSequence--;
+	}
+
+	// the oldest block may begin with the end of a record that was not kept
+	while( nBlocks > 0 && nOldestFirst == scTRACE_BLOCK_NO_RECORD )
+	{
+		nEnd += nOldestUsed;
+		nOldest = ( nOldest + 1 ) % _nBlockCount;
+		if ( --nBlocks > 0 && ReadBlock( nOldest, header ) )
+		{
+			nOldestFirst = header._nFirst;
+			nOldestUsed = header._nUsed;
+		}
+	}
+	if ( nBlocks > 0 )
+	{
+		nEnd += nOldestFirst;
+	}
+
+	nLength = nSize - nEnd;
+	memmove( pData, pData + nEnd, nLength );
+	if ( _nLastError != ERROR_SUCCESS )
+	{
+		nResult = _nLastError;
+	}
+	return nResult;
+}
+
+/// <summary>
+/// Write the staging block and move to the next one, which is already erased.
+/// </summary>
+uint32_t scDebugPathBlock::WriteStaged( void )
+{
+	scTraceBlockHeader_t header;
+	header._nMagic = scTRACE_BLOCK_MAGIC;
+	header._nSequence = _nSequence;
+	header._nUsed = (uint16_t)_nUsed;
+	header._nFirst = (uint16_t)_nFirst;
+	header._nCheck = scTRACE_BLOCK_CHECK( header );
+	memcpy( _pBlock, &header, sizeof(header) );
+
+	// flash keeps what is left erased
+	memset( _pBlock + sizeof(header) + _nUsed, 0xFF, _nBlockSize - sizeof(header) - _nUsed );
+
+	uint32_t nResult = _pDevice->Write( _pBlock, _nStartBlock + _nBlock, 1 );
+	if ( nResult != ERROR_SUCCESS )
+	{
+		_nLastError = nResult;
+	}
+
+	_nBlock = ( _nBlock + 1 ) % _nBlockCount;
+	_nSequence++;
+	_nErased--;
+	_nUsed = 0;
+	_nFirst = scTRACE_BLOCK_NO_RECORD;
+	EraseAhead();
+	return nResult;
+}
+
+/// <summary>
+/// Erase the units ahead of the block being filled, without waiting for the erase
+/// to finish. On wrapping these are the oldest blocks of the log.
+/// </summary>
+void scDebugPathBlock::EraseAhead( void )
+{
+	while( _nErased < _nEraseAhead )
+	{
+		uint32_t nResult = _pDevice->BulkErase( _nStartBlock + _nEraseNext, _nEraseBlocks, false );
+		if ( nResult != ERROR_SUCCESS && nResult != ERROR_SC_DEVICE_FEATURE_UNSUPPORTED )
+		{
+			_nLastError = nResult;
+		}
+		_nEraseNext = ( _nEraseNext + _nEraseBlocks ) % _nBlockCount;
+		_nErased += _nEraseBlocks;
+	}
+}
+
+/// <summary>
+/// Read a block into the staging block and check its header.
+/// </summary>
+bool scDebugPathBlock::ReadBlock( uint32_t nBlock, scTraceBlockHeader_t& header )
+{
+	_nProbes++;
+	uint32_t nResult = _pDevice->Read( _pBlock, _nBlockSize, _nStartBlock + nBlock, 1 );
+	if ( nResult != ERROR_SUCCESS )
+	{
+		_nLastError = nResult;
+		return false;
+	}
+	memcpy( &header, _pBlock, sizeof(header) );
+	return header._nMagic == scTRACE_BLOCK_MAGIC
+		&& header._nCheck == scTRACE_BLOCK_CHECK( header )
+		&& header._nUsed <= _nBlockSize - sizeof(scTraceBlockHeader_t);
+}
@@ -0,0 +1,297 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scDebugPathBlock.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCDEBUGPATHBLOCK_H__INCLUDED_)
+#define __SCDEBUGPATHBLOCK_H__INCLUDED_
+
+#include "scDebugPath.h"
+#include "scAllocator.h"
+#include "scIMutex.h"
+#include "HAL/scBlockMemoryIF.h"
+
+namespace SharedCore
+{
+	/// <summary>
+	/// Marks a block of a persistent trace log.
+	/// </summary>
+	#define scTRACE_BLOCK_MAGIC			(0x4B4C4254)
+
+	/// <summary>
+	/// Value of scTraceBlockHeader_t::_nFirst when no record starts in the block.
+	/// </summary>
+	#define scTRACE_BLOCK_NO_RECORD		(0xFFFF)
+
+	/// <summary>
+	/// Start of every block of a persistent trace log, the trace bytes follow it. The
+	/// sequence numbers rise by one from block to block around the area, so the newest
+	/// block is found with a binary search over the headers instead of reading the
+	/// whole log.
+	/// </summary>
+	typedef struct
+	{
+		/// <summary>
+		/// scTRACE_BLOCK_MAGIC.
+		/// </summary>
+		uint32_t			_nMagic;
+
+		/// <summary>
+		/// Number of the block in the order it was written.
+		/// </summary>
+		uint32_t			_nSequence;
+
+		/// <summary>
+		/// Number of trace bytes in the block.
+		/// </summary>
+		uint16_t			_nUsed;
+
+		/// <summary>
+		/// Offset of the first record starting in the block, counted from the end of
+		/// the header, or scTRACE_BLOCK_NO_RECORD. A reader starting mid-log skips the
+		/// bytes ahead of it.
+		/// </summary>
+		uint16_t			_nFirst;
+
+		/// <summary>
+		/// The other fields combined, tells a written header from erased or torn data.
+		/// </summary>
+		uint32_t			_nCheck;
+	} scTraceBlockHeader_t;
+
+	/// <summary>
+	/// Debug path keeping the trace in block memory, such as SPI flash, so it survives
+	/// a power loss. Records are gathered in one block of RAM and the device is only
+	/// written a whole block at a time, each block once after it was erased, so there
+	/// is never a read-modify-write. The blocks ahead are erased in advance with
+	/// BulkErase, without waiting, so an erase is rarely in the way of a write. The
+	/// log wraps around the area, the oldest blocks being erased to make room, which
+	/// also spreads the wear evenly over the area.
+	///
+	/// The device is written from Capture, so the path is best used behind the trace
+	/// queue of scDebugManager where the debug task does the writing. Addresses given
+	/// to BulkErase are block numbers.
+	/// </summary>
+	class scDebugPathBlock : public scDebugPath
+	{
+	public:
+		/// <summary>
+		/// Construct the path.
+		/// </summary>
+		/// <param name="nPathID">The path Id.</param>
+		/// <param name="pDevice">The block device.</param>
+		/// <param name="nStartBlock">First block of the area.</param>
+		/// <param name="nBlockCount">Number of blocks in the area, a multiple of the
+		/// erase size.</param>
+		/// <param name="nEraseBlocks">Number of blocks erased at once.</param>
+		/// <param name="nEraseAhead">Number of erase units kept erased ahead of the
+		/// block being filled.</param>
+		scDebugPathBlock( uint8_t nPathID, HAL::scBlockMemoryIF* pDevice, uint32_t nStartBlock, uint32_t nBlockCount,
+			uint32_t nEraseBlocks = 1, uint32_t nEraseAhead = 2 );
+
+		/// <summary>
+		/// Destructor.
+		/// </summary>
+		virtual ~scDebugPathBlock();
+
+		/// <summary>
+		/// Allocate the staging block and find the end of the log already in the
+		/// area, so the new trace follows it.
+		/// </summary>
+		/// <param name="allocator">Allocator used for the staging block.</param>
+		/// <param name="pProtect">Protects the path when it is used from several
+		/// tasks, may be NULL.</param>
+		uint32_t Initialize( scAllocator allocator, scIMutex* pProtect );
+
+		/// <summary>
+		/// Add the record to the staging block, writing the block once it is full.
+		/// </summary>
+		virtual void Capture( const uint8_t* pData, uint32_t nLength );
+
+		/// <summary>
+		/// Add the segments of the record to the staging block.
+		/// </summary>
+		/// <param name="pSpans">Array of segments that make up the record.</param>
+		/// <param name="nCount">Number of segments in the array.</param>
+		virtual void Capture_v( const scIOSpan_t* pSpans, uint32_t nCount );
+
+		/// <summary>
+		/// Write the staging block even though it is not full, before a power down for
+		/// example. The rest of the block is left unused.
+		/// </summary>
+		uint32_t Flush( void );
+
+		/// <summary>
+		/// Find the newest block in the area with a binary search over the headers.
+		/// </summary>
+		/// <param name="nBlock">Receives the block, relative to the start of the
+		/// area.</param>
+		/// <param name="nSequence">Receives its sequence number.</param>
+		/// <returns>false if the area holds no log.</returns>
+		bool FindNewest( uint32_t& nBlock, uint32_t& nSequence );
+
+		/// <summary>
+		/// Read the newest part of the log, oldest byte first, starting with a whole
+		/// record. The staging block is written first.
+		/// </summary>
+		/// <param name="pData">Receives the trace.</param>
+		/// <param name="nSize">Size of pData.</param>
+		/// <param name="nLength">Receives the number of bytes read.</param>
+		/// <returns>ERROR_SUCCESS or the error of the device.</returns>
+		uint32_t ReadNewest( uint8_t* pData, uint32_t nSize, uint32_t& nLength );
+
+		/// <summary>
+		/// The block being filled, relative to the start of the area.
+		/// </summary>
+		uint32_t CurrentBlock( void ) const
+		{
+			return _nBlock;
+		}
+
+		/// <summary>
+		/// Number of blocks read since FindNewest last started, the cost of the search.
+		/// </summary>
+		uint32_t Probes( void ) const
+		{
+			return _nProbes;
+		}
+
+		/// <summary>
+		/// Obtain the result of the last device operation that failed.
+		/// </summary>
+		uint32_t GetLastError( void ) const
+		{
+			return _nLastError;
+		}
+
+	private:
+		/// <summary>
+		/// Write the staging block and move to the next one.
+		/// </summary>
+		uint32_t WriteStaged( void );
+
+		/// <summary>
+		/// Erase the units ahead of the block being filled.
+		/// </summary>
+		void EraseAhead( void );
+
+		/// <summary>
+		/// Read a block into the staging block and check its header.
+		/// </summary>
+		bool ReadBlock( uint32_t nBlock, scTraceBlockHeader_t& header );
+
+		/// <summary>
+		/// The block device.
+		/// </summary>
+		HAL::scBlockMemoryIF*		_pDevice;
+
+		/// <summary>
+		/// First block of the area.
+		/// </summary>
+		uint32_t					_nStartBlock;
+
+		/// <summary>
+		/// Number of blocks in the area.
+		/// </summary>
+		uint32_t					_nBlockCount;
+
+		/// <summary>
+		/// Number of blocks erased at once.
+		/// </summary>
+		uint32_t					_nEraseBlocks;
+
+		/// <summary>
+		/// Number of blocks kept erased ahead.
+		/// </summary>
+		uint32_t					_nEraseAhead;
+
+		/// <summary>
+		/// Size of a block in bytes.
+		/// </summary>
+		uint32_t					_nBlockSize;
+
+		/// <summary>
+		/// The staging block, header included.
+		/// </summary>
+		uint8_t*					_pBlock;
+
+		/// <summary>
+		/// Trace bytes in the staging block.
+		/// </summary>
+		uint32_t					_nUsed;
+
+		/// <summary>
+		/// Offset of the first record starting in the staging block.
+		/// </summary>
+		uint32_t					_nFirst;
+
+		/// <summary>
+		/// The block being filled, relative to the start of the area.
+		/// </summary>
+		uint32_t					_nBlock;
+
+		/// <summary>
+		/// Sequence number of the block being filled.
+		/// </summary>
+		uint32_t					_nSequence;
+
+		/// <summary>
+		/// The next block to erase, relative to the start of the area.
+		/// </summary>
+		uint32_t					_nEraseNext;
+
+		/// <summary>
+		/// Number of erased blocks from the block being filled on.
+		/// </summary>
+		uint32_t					_nErased;
+
+		/// <summary>
+		/// Blocks read since FindNewest last started.
+		/// </summary>
+		uint32_t					_nProbes;
+
+		/// <summary>
+		/// The result of the last device operation that failed.
+		/// </summary>
+		uint32_t					_nLastError;
+
+		/// <summary>
+		/// Protects the path.
+		/// </summary>
+		scIMutex*					_pProtect;
+
+		/// <summary>
+		/// The allocator used.
+		/// </summary>
+		scAllocator					_Allocator;
+	};
+}
+
+#endif // !defined(__SCDEBUGPATHBLOCK_H__INCLUDED_)
@@ -66,3 +66,43 @@ void scDebugPathDevice::Capture( const uint8_t* pData, uint32_t nLength )
 	assert_param( _pPipe != NULL );
 	_pPipe->Send_n( pData, nLength );
 }
+
+/// <summary>
+/// Sends all of the segments to the device as one transmission.
+/// </summary>
+/// <param name="pSpans">Array of segments that make up the record.</param>
+/// <param name="nCount">Number of segments in the array.</param>
+void scDebugPathDevice::Capture_v( const scIOSpan_t* pSpans, uint32_t nCount )
+{
+	assert_param( _pPipe != NULL );
+	_pPipe->Send_v( pSpans, nCount );
+}
+
+/// <summary>
+/// The device path formats the text straight into the transmit queue.
+/// </summary>
+bool scDebugPathDevice::Formats(void) const
+{
+	return true;
+}
+
+/// <summary>
+/// Format the text straight into the transmit queue of the device, avoiding the
+/// working buffer and the copy out of it.
+/// </summary>
+/// <param name="pFormat">The format string, see scFormat.</param>
+/// <param name="ap">The arguments.</param>
+void scDebugPathDevice::Capture_f( const char* pFormat, va_list ap )
+{
+	assert_param( _pPipe != NULL );
+	_pPipe->Send_f( pFormat, ap );
+}
+
+/// <summary>
+/// The free space in the transmit queue of the device.
+/// </summary>
+uint32_t scDebugPathDevice::Space(void) const
+{
+	assert_param( _pPipe != NULL );
+	return _pPipe->SendSpace();
+}
@@ -60,6 +60,31 @@ namespace SharedCore
 		/// </summary>
 		virtual void Capture( const uint8_t* pData, uint32_t nLength );
 
+		/// <summary>
+		/// Sends all of the segments to the device as one transmission.
+		/// </summary>
+		/// <param name="pSpans">Array of segments that make up the record.</param>
+		/// <param name="nCount">Number of segments in the array.</param>
+		virtual void Capture_v( const scIOSpan_t* pSpans, uint32_t nCount );
+
+		/// <summary>
+		/// The device path formats the text straight into the transmit queue.
+		/// </summary>
+		virtual bool Formats(void) const;
+
+		/// <summary>
+		/// Format the text straight into the transmit queue of the device, avoiding the
+		/// working buffer and the copy out of it.
+		/// </summary>
+		/// <param name="pFormat">The format string, see scFormat.</param>
+		/// <param name="ap">The arguments.</param>
+		virtual void Capture_f( const char* pFormat, va_list ap );
+
+		/// <summary>
+		/// The free space in the transmit queue of the device.
+		/// </summary>
+		virtual uint32_t Space(void) const;
+
 	private:
 		HAL::scBufferIODriver*				_pPipe;
 
@@ -0,0 +1,913 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scDebugPathFile.cpp
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#include "scDebugPathFile.h"
+
+#if defined(__linux__) || defined(_WIN32)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scErrorCodes.h"
+#include "scFormat.h"
+
+#if !defined(_WIN32)
+	#include <errno.h>
+	#include <time.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+#endif
+
+#ifndef assert_param
+#define assert_param(X)	if ( !(X) ) { for(;;) ; }
+#endif
+
+#ifndef MAP_POPULATE
+#define MAP_POPULATE	0
+#endif
+
+using namespace SharedCore;
+
+/// <summary>
+/// How long the writer thread lets a partly filled block wait, in milliseconds.
+/// </summary>
+static const uint32_t g_nIdleFlush = 100;
+
+// The little the path needs from the file system, for each platform. A file is
+// created empty, for writing, or for mapping as well.
+#if defined(_WIN32)
+
+#define FILE_NONE		INVALID_HANDLE_VALUE
+
+static uint32_t PageSize( void )
+{
+	SYSTEM_INFO info;
+	GetSystemInfo( &info );
+	return (uint32_t)info.dwPageSize;
+}
+
+static uint8_t* PageAllocate( uint32_t nSize )
+{
+	return reinterpret_cast<uint8_t*>( VirtualAlloc( NULL, nSize, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE ) );
+}
+
+static void PageFree( uint8_t* pData )
+{
+	if ( pData != NULL )
+	{
+		VirtualFree( pData, 0, MEM_RELEASE );
+	}
+}
+
+static HANDLE FileCreate( const char* pName, bool bMapped )
+{
+	// shared for delete so a file still open can be renamed by the rotation
+	return CreateFileA( pName, bMapped ? GENERIC_READ | GENERIC_WRITE : GENERIC_WRITE,
+		FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+}
+
+static bool FileWrite( HANDLE hFile, const uint8_t* pData, uint32_t nLength )
+{
+	while( nLength > 0 )
+	{
+		DWORD nWritten = 0;
+		if ( !WriteFile( hFile, pData, nLength, &nWritten, NULL ) )
+		{
+			return false;
+		}
+		pData += nWritten;
+		nLength -= nWritten;
+	}
+	return true;
+}
+
+static bool FileTruncate( HANDLE hFile, uint32_t nLength )
+{
+	LARGE_INTEGER nPosition;
+	nPosition.QuadPart = nLength;
+	return SetFilePointerEx( hFile, nPosition, NULL, FILE_BEGIN ) && SetEndOfFile( hFile );
+}
+
+static void FileClose( HANDLE hFile )
+{
+	CloseHandle( hFile );
+}
+
+static uint8_t* FileMap( HANDLE hFile, uint32_t nSize )
+{
+	// the mapping grows the file to the size, the view keeps the mapping open
+	HANDLE hMapping = CreateFileMappingA( hFile, NULL, PAGE_READWRITE, 0, nSize, NULL );
+	if ( hMapping == NULL )
+	{
+		return NULL;
+	}
+	void* pData = MapViewOfFile( hMapping, FILE_MAP_WRITE, 0, 0, nSize );
+	CloseHandle( hMapping );
+	return reinterpret_cast<uint8_t*>( pData );
+}
+
+static void FileUnmap( uint8_t* pData, uint32_t nSize )
+{
+	(void)nSize;
+	UnmapViewOfFile( pData );
+}
+
+static bool FileRename( const char* pFrom, const char* pTo )
+{
+	return MoveFileExA( pFrom, pTo, MOVEFILE_REPLACE_EXISTING ) != FALSE;
+}
+
+static void FileRemove( const char* pName )
+{
+	DeleteFileA( pName );
+}
+
+#else
+
+#define FILE_NONE		(-1)
+
+static uint32_t PageSize( void )
+{
+	return (uint32_t)sysconf( _SC_PAGESIZE );
+}
+
+static uint8_t* PageAllocate( uint32_t nSize )
+{
+	void* pData = NULL;
+	if ( posix_memalign( &pData, PageSize(), nSize ) != 0 )
+	{
+		pData = NULL;
+	}
+	return reinterpret_cast<uint8_t*>( pData );
+}
+
+static void PageFree( uint8_t* pData )
+{
+	free( pData );
+}
+
+static int FileCreate( const char* pName, bool bMapped )
+{
+	return open( pName, ( bMapped ? O_RDWR : O_WRONLY ) | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+}
+
+static bool FileWrite( int nFile, const uint8_t* pData, uint32_t nLength )
+{
+	while( nLength > 0 )
+	{
+		ssize_t nWritten = write( nFile, pData, nLength );
+		if ( nWritten < 0 )
+		{
+			if ( errno == EINTR )
+			{
+				continue;
+			}
+			return false;
+		}
+		pData += nWritten;
+		nLength -= (uint32_t)nWritten;
+	}
+	return true;
+}
+
+static bool FileTruncate( int nFile, uint32_t nLength )
+{
+	return ftruncate( nFile, nLength ) == 0;
+}
+
+static void FileClose( int nFile )
+{
+	close( nFile );
+}
+
+static uint8_t* FileMap( int nFile, uint32_t nSize )
+{
+	// the pages are faulted in here so the callers copying into the mapping do not
+	// take the faults
+	if ( ftruncate( nFile, nSize ) != 0 )
+	{
+		return NULL;
+	}
+	void* pData = mmap( NULL, nSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, nFile, 0 );
+	return ( pData != MAP_FAILED ) ? reinterpret_cast<uint8_t*>( pData ) : NULL;
+}
+
+static void FileUnmap( uint8_t* pData, uint32_t nSize )
+{
+	munmap( pData, nSize );
+}
+
+static bool FileRename( const char* pFrom, const char* pTo )
+{
+	return rename( pFrom, pTo ) == 0;
+}
+
+static void FileRemove( const char* pName )
+{
+	unlink( pName );
+}
+
+#endif
+
+/// <summary>
+/// Round a size up to a multiple of the page size.
+/// </summary>
+static uint32_t PageRound( uint32_t nSize )
+{
+	uint32_t nPage = PageSize();
+	return ( nSize + nPage - 1 ) / nPage * nPage;
+}
+
+/// <summary>
+/// Construct the path. Nothing is written until Open is called.
+/// </summary>
+/// <param name="nPathID">The path Id.</param>
+/// <param name="nBlockSize">Size of one write in the buffered mode, rounded up
+/// to a multiple of the page size.</param>
+/// <param name="nBlocks">Number of blocks in the buffered mode, at least two.
+/// Together they hold the output that has not been written yet.</param>
+scDebugPathFile::scDebugPathFile( uint8_t nPathID, uint32_t nBlockSize, uint32_t nBlocks )
+	: scDebugPath( nPathID )
+	, _nBlockSize( PageRound( nBlockSize ) )
+	, _nBlocks( nBlocks )
+	, _pBlocks( NULL )
+	, _nFill( 0 )
+	, _nQueued( 0 )
+	, _nWrite( 0 )
+	, _bStandby( false )
+	, _bRetire( false )
+	, _nMode( file_Buffered )
+	, _File( FILE_NONE )
+	, _nFileSize( 0 )
+	, _nRotateSize( 0 )
+	, _nFiles( 1 )
+	, _bOpen( false )
+	, _bStop( false )
+	, _nError( ERROR_SUCCESS )
+	, _nWritten( 0 )
+	, _nCaptured( 0 )
+	, _nDropped( 0 )
+	, _nRotations( 0 )
+{
+	assert_param( nBlocks >= 2 );
+	_sName[0] = '\0';
+#if defined(_WIN32)
+	InitializeSRWLock( &_Lock );
+	InitializeConditionVariable( &_Work );
+	InitializeConditionVariable( &_Done );
+	_Thread = NULL;
+#else
+	pthread_mutex_init( &_Lock, NULL );
+	pthread_cond_init( &_Work, NULL );
+	pthread_cond_init( &_Done, NULL );
+#endif
+}
+
+/// <summary>
+/// Closes the file.
+/// </summary>
+scDebugPathFile::~scDebugPathFile()
+{
+	Close();
+#if !defined(_WIN32)
+	pthread_cond_destroy( &_Done );
+	pthread_cond_destroy( &_Work );
+	pthread_mutex_destroy( &_Lock );
+#endif
+}
+
+/// <summary>
+/// Create the file and start the writer thread.
+/// </summary>
+/// <param name="pFileName">Name of the file.</param>
+/// <param name="nMode">Buffered or mapped.</param>
+/// <param name="nRotateSize">Size at which the file is rotated, 0 to never
+/// rotate. Required for the mapped mode.</param>
+/// <param name="nFiles">Number of files kept, including the current one.
+/// </param>
+/// <returns>ERROR_SUCCESS or the error.</returns>
+uint32_t scDebugPathFile::Open( const char* pFileName, Mode_t nMode, uint32_t nRotateSize, uint32_t nFiles )
+{
+	assert_param( !_bOpen );
+	assert_param( pFileName != NULL && strlen( pFileName ) + 8 < sizeof(_sName) );
+	assert_param( nMode == file_Buffered || nRotateSize > 0 );
+	assert_param( nFiles >= 1 );
+
+	strcpy( _sName, pFileName );
+	_nMode = nMode;
+	_nRotateSize = ( nMode == file_Mapped ) ? PageRound( nRotateSize ) : nRotateSize;
+	_nFiles = nFiles;
+	_nFill = 0;
+	_nQueued = 0;
+	_nWrite = 0;
+	_bStandby = false;
+	_bRetire = false;
+	_nFileSize = 0;
+	_bStop = false;
+	_nError = ERROR_SUCCESS;
+	_nCaptured = 0;
+	_nWritten = 0;
+	_nDropped = 0;
+	_nRotations = 0;
+
+	// keep the log of the previous run
+	ShiftFiles();
+
+	uint32_t nResult = ERROR_SUCCESS;
+	if ( _nMode == file_Buffered )
+	{
+		_pBlocks = new Block_t[_nBlocks];
+		memset( _pBlocks, 0, _nBlocks * sizeof(Block_t) );
+		for( uint32_t i=0; i < _nBlocks && nResult == ERROR_SUCCESS; ++i )
+		{
+			_pBlocks[i]._pData = PageAllocate( _nBlockSize );
+			_pBlocks[i]._File = FILE_NONE;
+			if ( _pBlocks[i]._pData == NULL )
+			{
+				nResult = ERROR_SC_MEMORY_ALLOCATION_FAILURE;
+			}
+		}
+		_File = FileCreate( _sName, false );
+		if ( nResult == ERROR_SUCCESS && _File == FILE_NONE )
+		{
+			nResult = ERROR_SC_FILE_FAILURE;
+		}
+	}
+	else
+	{
+		_pBlocks = new Block_t[2];
+		memset( _pBlocks, 0, 2 * sizeof(Block_t) );
+		_pBlocks[0]._File = FILE_NONE;
+		_pBlocks[1]._File = FILE_NONE;
+		if ( !Map( _sName, _pBlocks[0] ) )
+		{
+			nResult = ERROR_SC_FILE_FAILURE;
+		}
+	}
+
+#if defined(_WIN32)
+	if ( nResult == ERROR_SUCCESS && ( _Thread = CreateThread( NULL, 0, &WriterEntry, this, 0, NULL ) ) == NULL )
+#else
+	if ( nResult == ERROR_SUCCESS && pthread_create( &_Thread, NULL, &WriterEntry, this ) != 0 )
+#endif
+	{
+		nResult = ERROR_SC_FILE_FAILURE;
+	}
+
+	if ( nResult == ERROR_SUCCESS )
+	{
+		_bOpen = true;
+	}
+	else
+	{
+		Release();
+	}
+	return nResult;
+}
+
+/// <summary>
+/// Write out everything captured so far, stop the writer thread and close the
+/// file. A mapped file is cut to the length used.
+/// </summary>
+void scDebugPathFile::Close( void )
+{
+	Lock();
+	if ( !_bOpen )
+	{
+		Unlock();
+		return;
+	}
+	// the writer finishes the queued blocks before it stops
+	_bOpen = false;
+	_bStop = true;
+	Signal( _Work );
+	Unlock();
+
+#if defined(_WIN32)
+	WaitForSingleObject( _Thread, INFINITE );
+	CloseHandle( _Thread );
+	_Thread = NULL;
+#else
+	pthread_join( _Thread, NULL );
+#endif
+	Release();
+}
+
+/// <summary>
+/// Wait until everything captured so far has been handed to the file system.
+/// </summary>
+/// <returns>ERROR_SUCCESS or ERROR_SC_FILE_FAILURE if a write failed.</returns>
+uint32_t scDebugPathFile::Flush( void )
+{
+	Lock();
+	if ( _nMode == file_Buffered )
+	{
+		uint64_t nTarget = _nCaptured;
+		while( _bOpen && _nWritten < nTarget )
+		{
+			if ( _nQueued == 0 && _pBlocks[_nFill]._nUsed > 0 )
+			{
+				Queue();
+			}
+			Wait( _Done );
+		}
+	}
+	uint32_t nResult = _nError;
+	Unlock();
+	return nResult;
+}
+
+/// <summary>
+/// Copy the record into memory for the writer thread.
+/// </summary>
+void scDebugPathFile::Capture( const uint8_t* pData, uint32_t nLength )
+{
+	scIOSpan_t span;
+	span._pData = pData;
+	span._nLength = nLength;
+	Capture_v( &span, 1 );
+}
+
+/// <summary>
+/// Copy the segments of the record into memory as one record, so records from
+/// different tasks are never interleaved.
+/// </summary>
+/// <param name="pSpans">Array of segments that make up the record.</param>
+/// <param name="nCount">Number of segments in the array.</param>
+void scDebugPathFile::Capture_v( const scIOSpan_t* pSpans, uint32_t nCount )
+{
+	uint32_t nTotal = 0;
+	for( uint32_t i=0; i < nCount; ++i )
+	{
+		nTotal += pSpans[i]._nLength;
+	}
+
+	Lock();
+	if ( !_bOpen || nTotal > Available() )
+	{
+		// never make the caller wait for the disk
+		_nDropped++;
+		Unlock();
+		return;
+	}
+
+	uint32_t nSize = BlockSize();
+	for( uint32_t i=0; i < nCount; ++i )
+	{
+		const uint8_t*	pData = pSpans[i]._pData;
+		uint32_t		nLength = pSpans[i]._nLength;
+		while( nLength > 0 )
+		{
+			Block_t* pBlock = &_pBlocks[_nFill];
+			if ( pBlock->_nUsed == nSize )
+			{
+				// Available made sure the next block is there
+				if ( _nMode == file_Buffered )
+				{
+					Queue();
+				}
+				else
+				{
+					Block_t full = _pBlocks[0];
+					_pBlocks[0] = _pBlocks[1];
+					_pBlocks[1] = full;
+					_bStandby = false;
+					_bRetire = true;
+					Signal( _Work );
+				}
+				pBlock = &_pBlocks[_nFill];
+			}
+			uint32_t nCopy = nSize - pBlock->_nUsed;
+			if ( nCopy > nLength )
+			{
+				nCopy = nLength;
+			}
+			memcpy( pBlock->_pData + pBlock->_nUsed, pData, nCopy );
+			pBlock->_nUsed += nCopy;
+			pData += nCopy;
+			nLength -= nCopy;
+		}
+	}
+
+	// hand a full block to the writer right away when there is another to fill
+	if ( _nMode == file_Buffered && _pBlocks[_nFill]._nUsed == nSize && _nQueued + 1 < _nBlocks )
+	{
+		Queue();
+	}
+	_nCaptured += nTotal;
+	Unlock();
+}
+
+/// <summary>
+/// Number of bytes that can be captured now without dropping.
+/// </summary>
+uint32_t scDebugPathFile::Space( void ) const
+{
+	Lock();
+	uint32_t nResult = _bOpen ? Available() : 0;
+	Unlock();
+	return nResult;
+}
+
+/// <summary>
+/// Entry point of the writer thread.
+/// </summary>
+#if defined(_WIN32)
+DWORD WINAPI scDebugPathFile::WriterEntry( LPVOID pContext )
+{
+	reinterpret_cast<scDebugPathFile*>( pContext )->Writer();
+	return 0;
+}
+#else
+void* scDebugPathFile::WriterEntry( void* pContext )
+{
+	reinterpret_cast<scDebugPathFile*>( pContext )->Writer();
+	return NULL;
+}
+#endif
+
+/// <summary>
+/// The writer thread. The lock is only held to pick up or hand back a block, the
+/// file system is used without it.
+/// </summary>
+void scDebugPathFile::Writer( void )
+{
+	Lock();
+	for(;;)
+	{
+		if ( _nMode == file_Buffered )
+		{
+			if ( _nQueued == 0 && _pBlocks[_nFill]._nUsed > 0 && _bStop )
+			{
+				Queue();
+			}
+			if ( _nQueued > 0 )
+			{
+				Block_t block = _pBlocks[_nWrite];
+				Unlock();
+				bool bWritten = WriteBlock( block );
+				Lock();
+				if ( !bWritten )
+				{
+					_nError = ERROR_SC_FILE_FAILURE;
+				}
+				_nWritten += block._nUsed;
+				_pBlocks[_nWrite]._nUsed = 0;
+				_nWrite = ( _nWrite + 1 ) % _nBlocks;
+				_nQueued--;
+				// a block filled while none was free can go now
+				if ( _pBlocks[_nFill]._nUsed == _nBlockSize )
+				{
+					Queue();
+				}
+				Signal( _Done, true );
+				continue;
+			}
+		}
+		else
+		{
+			if ( _bRetire )
+			{
+				Block_t block = _pBlocks[1];
+				Unlock();
+				bool bRetired = RetireMapping( block );
+				Lock();
+				if ( !bRetired )
+				{
+					_nError = ERROR_SC_FILE_FAILURE;
+				}
+				_bRetire = false;
+				_nRotations++;
+				Signal( _Done, true );
+				continue;
+			}
+			if ( !_bStandby && !_bStop )
+			{
+				char	sNext[sizeof(_sName)];
+				Block_t	block;
+				FileName( sNext, _nFiles );
+				Unlock();
+				bool bMapped = Map( sNext, block );
+				Lock();
+				if ( bMapped )
+				{
+					_pBlocks[1] = block;
+					_bStandby = true;
+					Signal( _Done, true );
+					continue;
+				}
+				_nError = ERROR_SC_FILE_FAILURE;
+			}
+		}
+
+		if ( _bStop )
+		{
+			break;
+		}
+
+		// wake up now and then to write out a block that is only partly filled
+		if ( !Wait( _Work, g_nIdleFlush )
+			&& _nMode == file_Buffered && _nQueued == 0 && _pBlocks[_nFill]._nUsed > 0 )
+		{
+			Queue();
+		}
+	}
+
+	if ( _nMode == file_Mapped && _bStandby )
+	{
+		char sNext[sizeof(_sName)];
+		FileName( sNext, _nFiles );
+		_pBlocks[1]._nUsed = 0;
+		Unmap( _pBlocks[1] );
+		FileRemove( sNext );
+		_bStandby = false;
+	}
+	Unlock();
+}
+
+/// <summary>
+/// Write one block to the file and rotate the file when it is full. Called by the
+/// writer thread without the lock.
+/// </summary>
+bool scDebugPathFile::WriteBlock( const Block_t& block )
+{
+	bool bResult = FileWrite( _File, block._pData, block._nUsed );
+
+	_nFileSize += block._nUsed;
+	if ( _nRotateSize > 0 && _nFileSize >= _nRotateSize )
+	{
+		FileClose( _File );
+		ShiftFiles();
+		_File = FileCreate( _sName, false );
+		bResult = bResult && ( _File != FILE_NONE );
+		_nFileSize = 0;
+		_nRotations++;
+	}
+	return bResult;
+}
+
+/// <summary>
+/// Unmap and close a full mapped file and give it its place among the old files.
+/// The file mapped ahead, which the callers are now filling, takes the name.
+/// Called by the writer thread without the lock.
+/// </summary>
+bool scDebugPathFile::RetireMapping( Block_t& block )
+{
+	char sNext[sizeof(_sName)];
+	FileName( sNext, _nFiles );
+	bool bResult = Unmap( block );
+	ShiftFiles();
+	return FileRename( sNext, _sName ) && bResult;
+}
+
+/// <summary>
+/// Create and map a file of the rotation size.
+/// </summary>
+bool scDebugPathFile::Map( const char* pFileName, Block_t& block )
+{
+	block._pData = NULL;
+	block._nUsed = 0;
+	block._File = FileCreate( pFileName, true );
+	if ( block._File == FILE_NONE )
+	{
+		return false;
+	}
+	block._pData = FileMap( block._File, _nRotateSize );
+	if ( block._pData != NULL )
+	{
+		return true;
+	}
+	FileClose( block._File );
+	block._File = FILE_NONE;
+	return false;
+}
+
+/// <summary>
+/// Unmap and close a mapped file keeping the part used.
+/// </summary>
+bool scDebugPathFile::Unmap( Block_t& block )
+{
+	bool bResult = true;
+	if ( block._pData != NULL )
+	{
+		FileUnmap( block._pData, _nRotateSize );
+		block._pData = NULL;
+	}
+	if ( block._File != FILE_NONE )
+	{
+		bResult = FileTruncate( block._File, block._nUsed );
+		FileClose( block._File );
+		block._File = FILE_NONE;
+	}
+	return bResult;
+}
+
+/// <summary>
+/// Move the current file to name.1 and the older files up by one. The oldest is
+/// replaced.
+/// </summary>
+void scDebugPathFile::ShiftFiles( void )
+{
+	char sFrom[sizeof(_sName)];
+	char sTo[sizeof(_sName)];
+	for( uint32_t i = _nFiles - 1; i > 0; --i )
+	{
+		FileName( sFrom, i - 1 );
+		FileName( sTo, i );
+		FileRename( sFrom, sTo );
+	}
+}
+
+/// <summary>
+/// Build the name of a file: the current file for 0, name.N for the old files and
+/// name.next for the file mapped ahead when nIndex is the number of files.
+/// </summary>
+void scDebugPathFile::FileName( char* pName, uint32_t nIndex ) const
+{
+	if ( nIndex == 0 )
+	{
+		strcpy( pName, _sName );
+	}
+	else if ( nIndex == _nFiles )
+	{
+		scFormat::Format( pName, sizeof(_sName), "%s.next", _sName );
+	}
+	else
+	{
+		scFormat::Format( pName, sizeof(_sName), "%s.%u", _sName, nIndex );
+	}
+}
+
+/// <summary>
+/// Hand the block being filled to the writer and move on to the next one, which
+/// must be free.
+/// </summary>
+void scDebugPathFile::Queue( void )
+{
+	assert_param( _nQueued + 1 < _nBlocks );
+	_nQueued++;
+	_nFill = ( _nFill + 1 ) % _nBlocks;
+	Signal( _Work );
+}
+
+/// <summary>
+/// Free space with the lock held.
+/// </summary>
+uint32_t scDebugPathFile::Available( void ) const
+{
+	uint64_t nSpace = BlockSize() - _pBlocks[_nFill]._nUsed;
+	if ( _nMode == file_Buffered )
+	{
+		nSpace += (uint64_t)( _nBlocks - _nQueued - 1 ) * _nBlockSize;
+	}
+	else if ( _bStandby )
+	{
+		nSpace += _nRotateSize;
+	}
+	return ( nSpace > 0xFFFFFFFF ) ? 0xFFFFFFFF : (uint32_t)nSpace;
+}
+
+/// <summary>
+/// Size of a block, or of the mapping.
+/// </summary>
+uint32_t scDebugPathFile::BlockSize( void ) const
+{
+	return ( _nMode == file_Buffered ) ? _nBlockSize : _nRotateSize;
+}
+
+/// <summary>
+/// Free the blocks and close the files after Close or a failed Open.
+/// </summary>
+void scDebugPathFile::Release( void )
+{
+	if ( _pBlocks != NULL )
+	{
+		if ( _nMode == file_Buffered )
+		{
+			for( uint32_t i=0; i < _nBlocks; ++i )
+			{
+				PageFree( _pBlocks[i]._pData );
+			}
+		}
+		else if ( !Unmap( _pBlocks[0] ) )
+		{
+			_nError = ERROR_SC_FILE_FAILURE;
+		}
+		delete [] _pBlocks;
+		_pBlocks = NULL;
+	}
+	if ( _File != FILE_NONE )
+	{
+		FileClose( _File );
+		_File = FILE_NONE;
+	}
+}
+
+/// <summary>
+/// Take the lock.
+/// </summary>
+void scDebugPathFile::Lock( void ) const
+{
+#if defined(_WIN32)
+	AcquireSRWLockExclusive( &_Lock );
+#else
+	pthread_mutex_lock( &_Lock );
+#endif
+}
+
+/// <summary>
+/// Give back the lock.
+/// </summary>
+void scDebugPathFile::Unlock( void ) const
+{
+#if defined(_WIN32)
+	ReleaseSRWLockExclusive( &_Lock );
+#else
+	pthread_mutex_unlock( &_Lock );
+#endif
+}
+
+/// <summary>
+/// Wake one or all of the threads waiting on a condition.
+/// </summary>
+void scDebugPathFile::Signal( Condition_t& condition, bool bAll )
+{
+#if defined(_WIN32)
+	if ( bAll )
+	{
+		WakeAllConditionVariable( &condition );
+	}
+	else
+	{
+		WakeConditionVariable( &condition );
+	}
+#else
+	if ( bAll )
+	{
+		pthread_cond_broadcast( &condition );
+	}
+	else
+	{
+		pthread_cond_signal( &condition );
+	}
+#endif
+}
+
+/// <summary>
+/// Wait on a condition with the lock held, at most nMilliseconds when it is not
+/// zero.
+/// </summary>
+/// <returns>false if the time ran out.</returns>
+bool scDebugPathFile::Wait( Condition_t& condition, uint32_t nMilliseconds )
+{
+#if defined(_WIN32)
+	return SleepConditionVariableSRW( &condition, &_Lock, ( nMilliseconds > 0 ) ? nMilliseconds : INFINITE, 0 ) != FALSE;
+#else
+	if ( nMilliseconds == 0 )
+	{
+		return pthread_cond_wait( &condition, &_Lock ) == 0;
+	}
+	struct timespec	until;
+	clock_gettime( CLOCK_REALTIME, &until );
+	until.tv_sec += nMilliseconds / 1000;
+	until.tv_nsec += ( nMilliseconds % 1000 ) * 1000000L;
+	if ( until.tv_nsec >= 1000000000L )
+	{
+		until.tv_sec++;
+		until.tv_nsec -= 1000000000L;
+	}
+	return pthread_cond_timedwait( &condition, &_Lock, &until ) != ETIMEDOUT;
+#endif
+}
+
+#endif // defined(__linux__) || defined(_WIN32)
@@ -0,0 +1,400 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scDebugPathFile.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCDEBUGPATHFILE_H__INCLUDED_)
+#define __SCDEBUGPATHFILE_H__INCLUDED_
+
+#include "scDebugPath.h"
+
+// The file path is only available on hosted builds, Linux or Windows.
+#if defined(__linux__) || defined(_WIN32)
+
+#if defined(_WIN32)
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <pthread.h>
+#endif
+
+namespace SharedCore
+{
+	/// <summary>
+	/// Debug path that logs to a file on a hosted build. Capture only copies the
+	/// record into memory, a writer thread owned by the path does the file system
+	/// work, so callers never wait for the disk. When the memory is used up the
+	/// record is dropped and counted rather than making the caller wait.
+	///
+	/// In the buffered mode records are gathered into page aligned blocks and each
+	/// full block is written with a single call. In the mapped mode the whole file is
+	/// mapped and records are copied straight into it; the next file is mapped ahead
+	/// by the writer thread so the change to it costs the caller nothing.
+	///
+	/// With a rotation size the file is closed once it reaches that size and renamed
+	/// to name.1, the older files moving up to name.2 and so on, keeping the number of
+	/// files requested. Existing files are moved up the same way when the path is
+	/// opened.
+	/// </summary>
+	class scDebugPathFile : public scDebugPath
+	{
+	public:
+		/// <summary>
+		/// How the records get to the file.
+		/// </summary>
+		typedef enum
+		{
+			/// <summary>
+			/// Records are gathered into blocks and written by the writer thread.
+			/// </summary>
+			file_Buffered,
+
+			/// <summary>
+			/// The file is mapped and records are copied into it. Needs a rotation
+			/// size, which is the size of the mapping.
+			/// </summary>
+			file_Mapped
+		} Mode_t;
+
+		/// <summary>
+		/// Construct the path. Nothing is written until Open is called.
+		/// </summary>
+		/// <param name="nPathID">The path Id.</param>
+		/// <param name="nBlockSize">Size of one write in the buffered mode, rounded up
+		/// to a multiple of the page size.</param>
+		/// <param name="nBlocks">Number of blocks in the buffered mode, at least two.
+		/// Together they hold the output that has not been written yet.</param>
+		scDebugPathFile( uint8_t nPathID, uint32_t nBlockSize = 1024 * 1024, uint32_t nBlocks = 8 );
+
+		/// <summary>
+		/// Closes the file.
+		/// </summary>
+		virtual ~scDebugPathFile();
+
+		/// <summary>
+		/// Create the file and start the writer thread.
+		/// </summary>
+		/// <param name="pFileName">Name of the file.</param>
+		/// <param name="nMode">Buffered or mapped.</param>
+		/// <param name="nRotateSize">Size at which the file is rotated, 0 to never
+		/// rotate. Required for the mapped mode.</param>
+		/// <param name="nFiles">Number of files kept, including the current one.
+		/// </param>
+		/// <returns>ERROR_SUCCESS or the error.</returns>
+		uint32_t Open( const char* pFileName, Mode_t nMode = file_Buffered, uint32_t nRotateSize = 0, uint32_t nFiles = 4 );
+
+		/// <summary>
+		/// Write out everything captured so far, stop the writer thread and close the
+		/// file. A mapped file is cut to the length used.
+		/// </summary>
+		void Close( void );
+
+		/// <summary>
+		/// Wait until everything captured so far has been handed to the file system.
+		/// </summary>
+		/// <returns>ERROR_SUCCESS or ERROR_SC_FILE_FAILURE if a write failed.</returns>
+		uint32_t Flush( void );
+
+		/// <summary>
+		/// Copy the record into memory for the writer thread.
+		/// </summary>
+		virtual void Capture( const uint8_t* pData, uint32_t nLength );
+
+		/// <summary>
+		/// Copy the segments of the record into memory as one record, so records from
+		/// different tasks are never interleaved.
+		/// </summary>
+		/// <param name="pSpans">Array of segments that make up the record.</param>
+		/// <param name="nCount">Number of segments in the array.</param>
+		virtual void Capture_v( const scIOSpan_t* pSpans, uint32_t nCount );
+
+		/// <summary>
+		/// Number of bytes that can be captured now without dropping.
+		/// </summary>
+		virtual uint32_t Space( void ) const;
+
+		/// <summary>
+		/// Number of bytes captured.
+		/// </summary>
+		uint64_t Captured( void ) const
+		{
+			return _nCaptured;
+		}
+
+		/// <summary>
+		/// Number of records dropped because the memory was used up.
+		/// </summary>
+		uint32_t Dropped( void ) const
+		{
+			return _nDropped;
+		}
+
+		/// <summary>
+		/// Number of times the file has been rotated.
+		/// </summary>
+		uint32_t Rotations( void ) const
+		{
+			return _nRotations;
+		}
+
+	private:
+#if defined(_WIN32)
+		typedef HANDLE				File_t;
+		typedef SRWLOCK				Mutex_t;
+		typedef CONDITION_VARIABLE	Condition_t;
+		typedef HANDLE				Thread_t;
+#else
+		typedef int					File_t;
+		typedef pthread_mutex_t		Mutex_t;
+		typedef pthread_cond_t		Condition_t;
+		typedef pthread_t			Thread_t;
+#endif
+
+		/// <summary>
+		/// Memory the records are copied into, a buffer or a mapped file.
+		/// </summary>
+		typedef struct
+		{
+			uint8_t*			_pData;
+			uint32_t			_nUsed;
+			File_t				_File;
+		} Block_t;
+
+		/// <summary>
+		/// Entry point of the writer thread.
+		/// </summary>
+#if defined(_WIN32)
+		static DWORD WINAPI WriterEntry( LPVOID pContext );
+#else
+		static void* WriterEntry( void* pContext );
+#endif
+
+		/// <summary>
+		/// The writer thread.
+		/// </summary>
+		void Writer( void );
+
+		/// <summary>
+		/// Write one block to the file and rotate the file when it is full. Called by
+		/// the writer thread without the lock.
+		/// </summary>
+		bool WriteBlock( const Block_t& block );
+
+		/// <summary>
+		/// Unmap and close a full mapped file and give it its place among the old
+		/// files. Called by the writer thread without the lock.
+		/// </summary>
+		bool RetireMapping( Block_t& block );
+
+		/// <summary>
+		/// Create and map a file of the rotation size.
+		/// </summary>
+		bool Map( const char* pFileName, Block_t& block );
+
+		/// <summary>
+		/// Unmap and close a mapped file keeping the part used.
+		/// </summary>
+		bool Unmap( Block_t& block );
+
+		/// <summary>
+		/// Move the current file to name.1 and the older files up by one.
+		/// </summary>
+		void ShiftFiles( void );
+
+		/// <summary>
+		/// Build the name of an old file, or of the file being prepared when nIndex is
+		/// the number of files.
+		/// </summary>
+		void FileName( char* pName, uint32_t nIndex ) const;
+
+		/// <summary>
+		/// Hand the block being filled to the writer and move on to the next one.
+		/// </summary>
+		void Queue( void );
+
+		/// <summary>
+		/// Free space with the lock held.
+		/// </summary>
+		uint32_t Available( void ) const;
+
+		/// <summary>
+		/// Size of a block, or of the mapping.
+		/// </summary>
+		uint32_t BlockSize( void ) const;
+
+		/// <summary>
+		/// Free the blocks and close the files after Close or a failed Open.
+		/// </summary>
+		void Release( void );
+
+		/// <summary>
+		/// Take and give back the lock.
+		/// </summary>
+		void Lock( void ) const;
+		void Unlock( void ) const;
+
+		/// <summary>
+		/// Wake one or all of the threads waiting on a condition.
+		/// </summary>
+		static void Signal( Condition_t& condition, bool bAll = false );
+
+		/// <summary>
+		/// Wait on a condition with the lock held, at most nMilliseconds when it is
+		/// not zero.
+		/// </summary>
+		/// <returns>false if the time ran out.</returns>
+		bool Wait( Condition_t& condition, uint32_t nMilliseconds = 0 );
+
+		/// <summary>
+		/// Size of a block, or of the mapping.
+		/// </summary>
+		uint32_t				_nBlockSize;
+
+		/// <summary>
+		/// Number of blocks.
+		/// </summary>
+		uint32_t				_nBlocks;
+
+		/// <summary>
+		/// The blocks. In the mapped mode the first is the current file and the second
+		/// the file mapped ahead, or the file waiting to be retired.
+		/// </summary>
+		Block_t*				_pBlocks;
+
+		/// <summary>
+		/// The block being filled.
+		/// </summary>
+		uint32_t				_nFill;
+
+		/// <summary>
+		/// Number of full blocks waiting for the writer, they follow the block being
+		/// written.
+		/// </summary>
+		uint32_t				_nQueued;
+
+		/// <summary>
+		/// The block the writer takes next.
+		/// </summary>
+		uint32_t				_nWrite;
+
+		/// <summary>
+		/// True while the mapped file ahead is ready.
+		/// </summary>
+		bool					_bStandby;
+
+		/// <summary>
+		/// True when the full mapped file is waiting to be retired.
+		/// </summary>
+		bool					_bRetire;
+
+		/// <summary>
+		/// Buffered or mapped.
+		/// </summary>
+		Mode_t					_nMode;
+
+		/// <summary>
+		/// The file being written in the buffered mode.
+		/// </summary>
+		File_t					_File;
+
+		/// <summary>
+		/// Bytes in the current file in the buffered mode.
+		/// </summary>
+		uint32_t				_nFileSize;
+
+		/// <summary>
+		/// Size at which the file is rotated.
+		/// </summary>
+		uint32_t				_nRotateSize;
+
+		/// <summary>
+		/// Number of files kept.
+		/// </summary>
+		uint32_t				_nFiles;
+
+		/// <summary>
+		/// Name of the current file.
+		/// </summary>
+		char					_sName[256];
+
+		/// <summary>
+		/// True while the writer thread runs.
+		/// </summary>
+		bool					_bOpen;
+
+		/// <summary>
+		/// Tells the writer thread to finish.
+		/// </summary>
+		bool					_bStop;
+
+		/// <summary>
+		/// ERROR_SUCCESS or the error of the last failed write.
+		/// </summary>
+		uint32_t				_nError;
+
+		/// <summary>
+		/// Bytes handed to the file system by the writer thread in the buffered mode.
+		/// </summary>
+		uint64_t				_nWritten;
+
+		/// <summary>
+		/// Statistics.
+		/// </summary>
+		uint64_t				_nCaptured;
+		uint32_t				_nDropped;
+		uint32_t				_nRotations;
+
+		/// <summary>
+		/// Protects the blocks, held only to copy a record or to hand over a block.
+		/// </summary>
+		mutable Mutex_t			_Lock;
+
+		/// <summary>
+		/// Wakes the writer thread.
+		/// </summary>
+		Condition_t				_Work;
+
+		/// <summary>
+		/// Signalled by the writer thread when it finishes a block.
+		/// </summary>
+		Condition_t				_Done;
+
+		/// <summary>
+		/// The writer thread.
+		/// </summary>
+		Thread_t				_Thread;
+	};
+}
+
+#endif // defined(__linux__) || defined(_WIN32)
+
+#endif // !defined(__SCDEBUGPATHFILE_H__INCLUDED_)
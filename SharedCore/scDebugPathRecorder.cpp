@@ -0,0 +1,366 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scDebugPathRecorder.cpp
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#include <string.h>
+#include "scDebugPathRecorder.h"
+#include "scErrorCodes.h"
+
+#ifndef assert_param
+#define assert_param(X)	if ( !(X) ) { for(;;) ; }
+#endif
+
+using namespace SharedCore;
+using namespace SharedCore::HAL;
+
+/// <summary>
+/// Most times a dump calls the yield function for one piece before it sends the
+/// piece anyway.
+/// </summary>
+#define scRECORDER_MAX_YIELDS		(10000)
+
+/// <summary>
+/// Construct the recorder.
+/// </summary>
+/// <param name="nPathID">The path Id.</param>
+/// <param name="nSize">Size of the buffer in bytes, a power of two.</param>
+scDebugPathRecorder::scDebugPathRecorder( uint8_t nPathID, uint32_t nSize )
+	: scDebugPath( nPathID )
+	, _nMask( nSize - 1 )
+	, _pBuffer( NULL )
+	, _nHead( 0 )
+	, _nTail( 0 )
+	, _nFrozen( 0 )
+	, _Allocator()
+{
+	assert_param( nSize >= sizeof(scRecorderHeader_t) && ( nSize & _nMask ) == 0 );
+}
+
+/// <summary>
+/// Destructor.
+/// </summary>
+scDebugPathRecorder::~scDebugPathRecorder()
+{
+	if ( _pBuffer != NULL )
+	{
+		_Allocator.Destroy( _pBuffer );
+		_pBuffer = NULL;
+	}
+}
+
+/// <summary>
+/// Allocate the buffer.
+/// </summary>
+/// <param name="allocator">Allocator used for the buffer.</param>
+uint32_t scDebugPathRecorder::Initialize( scAllocator allocator )
+{
+	_Allocator = allocator;
+	_pBuffer = _Allocator.Allocate( _nMask + 1, true );
+	if ( _pBuffer == NULL )
+	{
+		return ERROR_SC_MEMORY_ALLOCATION_FAILURE;
+	}
+	Clear();
+	return ERROR_SUCCESS;
+}
+
+/// <summary>
+/// Keep the record, overwriting the oldest output.
+/// </summary>
+void scDebugPathRecorder::Capture( const uint8_t* pData, uint32_t nLength )
+{
+	scIOSpan_t span;
+	span._pData = pData;
+	span._nLength = nLength;
+	Capture_v( &span, 1 );
+}
+
+/// <summary>
+/// Keep the segments of the record together. The place for the whole record is
+/// claimed at once so records from different tasks never mix.
+/// </summary>
+/// <param name="pSpans">Array of segments that make up the record.</param>
+/// <param name="nCount">Number of segments in the array.</param>
+void scDebugPathRecorder::Capture_v( const scIOSpan_t* pSpans, uint32_t nCount )
+{
+	if ( _pBuffer == NULL || Frozen() )
+	{
+		return;
+	}
+
+	uint32_t nTotal = 0;
+	for( uint32_t i=0; i < nCount; ++i )
+	{
+		nTotal += pSpans[i]._nLength;
+	}
+
+	uint32_t nEnd = scAtomicAdd( &_nHead, nTotal );
+	uint32_t nPosition = nEnd - nTotal;
+	for( uint32_t i=0; i < nCount; ++i )
+	{
+		Store( nPosition, pSpans[i]._pData, pSpans[i]._nLength );
+		nPosition += pSpans[i]._nLength;
+	}
+
+	// the oldest byte follows the head around, a late writer only moves it back
+	// further than the buffer which Length ignores
+	if ( nEnd - _nTail > _nMask )
+	{
+		_nTail = nEnd - _nMask - 1;
+	}
+
+	// once a lap the next binary trace record carries the whole timestamp, so a
+	// dump starting part way into the delta records soon has a base again
+	if ( ( ( nEnd - 1 ) & ~_nMask ) != ( ( nEnd - nTotal ) & ~_nMask ) )
+	{
+		RestartDelta();
+	}
+}
+
+/// <summary>
+/// Stop recording, the content stays as it is until Resume.
+/// </summary>
+void scDebugPathRecorder::Freeze( void )
+{
+	scAtomicStore( &_nFrozen, 1 );
+}
+
+/// <summary>
+/// Start recording again after Freeze.
+/// </summary>
+/// <param name="bClear">True to discard the content.</param>
+void scDebugPathRecorder::Resume( bool bClear )
+{
+	if ( bClear )
+	{
+		Clear();
+	}
+	scAtomicStore( &_nFrozen, 0 );
+}
+
+/// <summary>
+/// Discard the content.
+/// </summary>
+void scDebugPathRecorder::Clear( void )
+{
+	_nTail = scAtomicLoad( &_nHead );
+}
+
+/// <summary>
+/// Number of bytes held.
+/// </summary>
+uint32_t scDebugPathRecorder::Length( void ) const
+{
+	uint32_t nLength = scAtomicLoad( &_nHead ) - _nTail;
+	return ( nLength > _nMask ) ? _nMask + 1 : nLength;
+}
+
+/// <summary>
+/// Copy the content, oldest byte first.
+/// </summary>
+/// <param name="pData">Receives the content.</param>
+/// <param name="nSize">Size of pData.</param>
+/// <returns>Number of bytes copied, the newest are kept if pData is too
+/// small.</returns>
+uint32_t scDebugPathRecorder::Read( uint8_t* pData, uint32_t nSize ) const
+{
+	uint32_t nLength = Length();
+	if ( nLength > nSize )
+	{
+		nLength = nSize;
+	}
+
+	uint32_t nStart = ( scAtomicLoad( &_nHead ) - nLength ) & _nMask;
+	uint32_t nFirst = _nMask + 1 - nStart;
+	if ( nFirst > nLength )
+	{
+		nFirst = nLength;
+	}
+	memcpy( pData, _pBuffer + nStart, nFirst );
+	memcpy( pData + nFirst, _pBuffer, nLength - nFirst );
+	return nLength;
+}
+
+/// <summary>
+/// Freeze the recorder and send the content to another path, oldest byte first.
+/// The content is sent in pieces no larger than the room the path reports. With a
+/// yield function the dump waits for room, without one, as in a fault handler, the
+/// pieces are sent regardless.
+/// </summary>
+/// <param name="pPath">The destination, such as a device path.</param>
+/// <param name="pYield">Called while waiting for room, or NULL.</param>
+/// <returns>Number of bytes sent.</returns>
+uint32_t scDebugPathRecorder::Dump( scDebugPath* pPath, Yield_t pYield )
+{
+	assert_param( pPath != NULL && pPath != this );
+	Freeze();
+
+	uint32_t nLength = Length();
+	uint32_t nPosition = scAtomicLoad( &_nHead ) - nLength;
+	uint32_t nSent = 0;
+	uint32_t nYields = 0;
+
+	while( nSent < nLength )
+	{
+		uint32_t nStart = ( nPosition + nSent ) & _nMask;
+		uint32_t nPiece = _nMask + 1 - nStart;
+		if ( nPiece > nLength - nSent )
+		{
+			nPiece = nLength - nSent;
+		}
+
+		uint32_t nSpace = pPath->Space();
+		if ( nSpace == 0 && pYield != NULL && nYields < scRECORDER_MAX_YIELDS )
+		{
+			pYield();
+			nYields++;
+			continue;
+		}
+		if ( nSpace > 0 && nPiece > nSpace )
+		{
+			nPiece = nSpace;
+		}
+
+		pPath->Capture( _pBuffer + nStart, nPiece );
+		nSent += nPiece;
+		nYields = 0;
+	}
+	return nSent;
+}
+
+/// <summary>
+/// Freeze the recorder and write the content to block memory, behind a
+/// scRecorderHeader_t at the start of the first block. The content is put in order
+/// inside the buffer first so it is written straight from it, the oldest bytes give
+/// way to the header. The area is erased first when the device supports it.
+/// Sectors are taken to be blocks.
+/// </summary>
+/// <param name="pDevice">The block device.</param>
+/// <param name="nStartBlock">First block of the area.</param>
+/// <param name="nBlockCount">Number of blocks in the area, the newest output is
+/// kept if it does not all fit.</param>
+/// <returns>ERROR_SUCCESS or the error of the device.</returns>
+uint32_t scDebugPathRecorder::Dump( scBlockMemoryIF* pDevice, uint32_t nStartBlock, uint32_t nBlockCount )
+{
+	assert_param( pDevice != NULL && _pBuffer != NULL );
+	Freeze();
+
+	uint32_t nBlockSize = pDevice->DefaultBlockSize();
+	uint32_t nSize = _nMask + 1;
+	assert_param( nBlockSize >= sizeof(scRecorderHeader_t) && ( nSize % nBlockSize ) == 0 );
+
+	// the header and the newest output that fits in the buffer and the area
+	uint32_t nLimit = ( nBlockCount * nBlockSize < nSize ) ? nBlockCount * nBlockSize : nSize;
+	uint32_t nLength = Length();
+	if ( nLength > nLimit - sizeof(scRecorderHeader_t) )
+	{
+		nLength = nLimit - sizeof(scRecorderHeader_t);
+	}
+	uint32_t nHead = scAtomicLoad( &_nHead );
+	uint32_t nBlocks = ( sizeof(scRecorderHeader_t) + nLength + nBlockSize - 1 ) / nBlockSize;
+
+	uint32_t nResult = pDevice->BulkErase( nStartBlock, nBlocks, true );
+	if ( nResult != ERROR_SUCCESS && nResult != ERROR_SC_DEVICE_FEATURE_UNSUPPORTED )
+	{
+		return nResult;
+	}
+
+	// put the oldest byte kept just after the header, no second buffer needed
+	Rotate( ( nHead - nLength - sizeof(scRecorderHeader_t) ) & _nMask );
+
+	scRecorderHeader_t header;
+	header._nMagic = scRECORDER_MAGIC;
+	header._nLength = nLength;
+	header._nPosition = nHead;
+	header._nCheck = header._nMagic ^ header._nLength ^ header._nPosition;
+	memcpy( _pBuffer, &header, sizeof(header) );
+	memset( _pBuffer + sizeof(header) + nLength, 0xFF, nBlocks * nBlockSize - sizeof(header) - nLength );
+
+	// the content is now in order behind the header
+	_nTail = sizeof(header);
+	_nHead = sizeof(header) + nLength;
+
+	return pDevice->Write( _pBuffer, nStartBlock, nBlocks );
+}
+
+/// <summary>
+/// Copy a piece of a record to its place in the buffer. Only the end of a piece
+/// larger than the buffer is kept.
+/// </summary>
+void scDebugPathRecorder::Store( uint32_t nPosition, const uint8_t* pData, uint32_t nLength )
+{
+	if ( nLength > _nMask )
+	{
+		pData += nLength - _nMask - 1;
+		nPosition += nLength - _nMask - 1;
+		nLength = _nMask + 1;
+	}
+
+	uint32_t nStart = nPosition & _nMask;
+	uint32_t nFirst = _nMask + 1 - nStart;
+	if ( nFirst >= nLength )
+	{
+		memcpy( _pBuffer + nStart, pData, nLength );
+	}
+	else
+	{
+		memcpy( _pBuffer + nStart, pData, nFirst );
+		memcpy( _pBuffer, pData + nFirst, nLength - nFirst );
+	}
+}
+
+/// <summary>
+/// Rotate the buffer left in place by reversing both parts and then the whole.
+/// </summary>
+void scDebugPathRecorder::Rotate( uint32_t nCount )
+{
+	if ( nCount != 0 )
+	{
+		Reverse( 0, nCount );
+		Reverse( nCount, _nMask + 1 );
+		Reverse( 0, _nMask + 1 );
+	}
+}
+
+/// <summary>
+/// Reverse part of the buffer.
+/// </summary>
+void scDebugPathRecorder::Reverse( uint32_t nStart, uint32_t nEnd )
+{
+	uint8_t* pLow = _pBuffer + nStart;
+	uint8_t* pHigh = _pBuffer + nEnd - 1;
+	while( pLow < pHigh )
+	{
+		uint8_t nByte = *pLow;
+		*pLow++ = *pHigh;
+		*pHigh-- = nByte;
+	}
+}
@@ -0,0 +1,237 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scDebugPathRecorder.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCDEBUGPATHRECORDER_H__INCLUDED_)
+#define __SCDEBUGPATHRECORDER_H__INCLUDED_
+
+#include "scDebugPath.h"
+#include "scAllocator.h"
+#include "scAtomic.h"
+#include "HAL/scBlockMemoryIF.h"
+
+namespace SharedCore
+{
+	/// <summary>
+	/// Marks a flight recorder image written to block memory.
+	/// </summary>
+	#define scRECORDER_MAGIC		(0x43455246)
+
+	/// <summary>
+	/// Start of the first block of a flight recorder image in block memory. The trace
+	/// follows it, oldest byte first.
+	/// </summary>
+	typedef struct
+	{
+		/// <summary>
+		/// scRECORDER_MAGIC.
+		/// </summary>
+		uint32_t			_nMagic;
+
+		/// <summary>
+		/// Number of trace bytes following the header.
+		/// </summary>
+		uint32_t			_nLength;
+
+		/// <summary>
+		/// Running count of the bytes captured when the image was written. The
+		/// difference between two images tells how much output was in between.
+		/// </summary>
+		uint32_t			_nPosition;
+
+		/// <summary>
+		/// The other fields combined, tells a valid header from old data.
+		/// </summary>
+		uint32_t			_nCheck;
+	} scRecorderHeader_t;
+
+	/// <summary>
+	/// Debug path keeping the most recent output in RAM, the flight recorder. When a
+	/// unit hangs or faults the output that never made it out of a slow path, or was
+	/// never sent to one, is still here. The oldest output is overwritten, so the
+	/// recorder always holds the last N bytes.
+	///
+	/// Capture reserves its place with one atomic add and copies the record, it never
+	/// locks and can be used from any task or interrupt. Freeze stops the recording,
+	/// usually from a fault handler or on command, and the content can then be sent to
+	/// another path or written to block memory for a post-mortem.
+	/// </summary>
+	class scDebugPathRecorder : public scDebugPath
+	{
+	public:
+		/// <summary>
+		/// Called while a dump waits for the destination path to make room.
+		/// </summary>
+		typedef void (*Yield_t)( void );
+
+		/// <summary>
+		/// Construct the recorder.
+		/// </summary>
+		/// <param name="nPathID">The path Id.</param>
+		/// <param name="nSize">Size of the buffer in bytes, a power of two.</param>
+		scDebugPathRecorder( uint8_t nPathID, uint32_t nSize );
+
+		/// <summary>
+		/// Destructor.
+		/// </summary>
+		virtual ~scDebugPathRecorder();
+
+		/// <summary>
+		/// Allocate the buffer.
+		/// </summary>
+		/// <param name="allocator">Allocator used for the buffer.</param>
+		uint32_t Initialize( scAllocator allocator );
+
+		/// <summary>
+		/// Keep the record, overwriting the oldest output.
+		/// </summary>
+		virtual void Capture( const uint8_t* pData, uint32_t nLength );
+
+		/// <summary>
+		/// Keep the segments of the record together.
+		/// </summary>
+		/// <param name="pSpans">Array of segments that make up the record.</param>
+		/// <param name="nCount">Number of segments in the array.</param>
+		virtual void Capture_v( const scIOSpan_t* pSpans, uint32_t nCount );
+
+		/// <summary>
+		/// Stop recording, the content stays as it is until Resume.
+		/// </summary>
+		void Freeze( void );
+
+		/// <summary>
+		/// Start recording again after Freeze.
+		/// </summary>
+		/// <param name="bClear">True to discard the content.</param>
+		void Resume( bool bClear = true );
+
+		/// <summary>
+		/// Check if the recorder has been frozen.
+		/// </summary>
+		bool Frozen( void ) const
+		{
+			return scAtomicLoad( &_nFrozen ) != 0;
+		}
+
+		/// <summary>
+		/// Discard the content.
+		/// </summary>
+		void Clear( void );
+
+		/// <summary>
+		/// Number of bytes held.
+		/// </summary>
+		uint32_t Length( void ) const;
+
+		/// <summary>
+		/// Copy the content, oldest byte first.
+		/// </summary>
+		/// <param name="pData">Receives the content.</param>
+		/// <param name="nSize">Size of pData.</param>
+		/// <returns>Number of bytes copied, the newest are kept if pData is too
+		/// small.</returns>
+		uint32_t Read( uint8_t* pData, uint32_t nSize ) const;
+
+		/// <summary>
+		/// Freeze the recorder and send the content to another path, oldest byte first.
+		/// The content is sent in pieces no larger than the room the path reports. With
+		/// a yield function the dump waits for room, without one, as in a fault handler,
+		/// the pieces are sent regardless.
+		/// </summary>
+		/// <param name="pPath">The destination, such as a device path.</param>
+		/// <param name="pYield">Called while waiting for room, or NULL.</param>
+		/// <returns>Number of bytes sent.</returns>
+		uint32_t Dump( scDebugPath* pPath, Yield_t pYield = NULL );
+
+		/// <summary>
+		/// Freeze the recorder and write the content to block memory, behind a
+		/// scRecorderHeader_t at the start of the first block. The content is put in
+		/// order inside the buffer first so it is written straight from it, the
+		/// oldest bytes give way to the header. The area is erased first when the
+		/// device supports it. Sectors are taken to be blocks.
+		/// </summary>
+		/// <param name="pDevice">The block device.</param>
+		/// <param name="nStartBlock">First block of the area.</param>
+		/// <param name="nBlockCount">Number of blocks in the area, the newest output
+		/// is kept if it does not all fit.</param>
+		/// <returns>ERROR_SUCCESS or the error of the device.</returns>
+		uint32_t Dump( HAL::scBlockMemoryIF* pDevice, uint32_t nStartBlock, uint32_t nBlockCount );
+
+	private:
+		/// <summary>
+		/// Copy a piece of a record to its place in the buffer.
+		/// </summary>
+		void Store( uint32_t nPosition, const uint8_t* pData, uint32_t nLength );
+
+		/// <summary>
+		/// Rotate the buffer left in place.
+		/// </summary>
+		void Rotate( uint32_t nCount );
+
+		/// <summary>
+		/// Reverse part of the buffer.
+		/// </summary>
+		void Reverse( uint32_t nStart, uint32_t nEnd );
+
+		/// <summary>
+		/// Size of the buffer minus one.
+		/// </summary>
+		uint32_t				_nMask;
+
+		/// <summary>
+		/// The buffer.
+		/// </summary>
+		uint8_t*				_pBuffer;
+
+		/// <summary>
+		/// Total bytes claimed by Capture, the position is this masked by the size.
+		/// </summary>
+		volatile uint32_t		_nHead;
+
+		/// <summary>
+		/// Running count of the oldest byte held, kept within the size of the buffer
+		/// from the head.
+		/// </summary>
+		volatile uint32_t		_nTail;
+
+		/// <summary>
+		/// Not zero while frozen.
+		/// </summary>
+		volatile uint32_t		_nFrozen;
+
+		/// <summary>
+		/// The allocator used.
+		/// </summary>
+		scAllocator				_Allocator;
+	};
+}
+
+#endif // !defined(__SCDEBUGPATHRECORDER_H__INCLUDED_)
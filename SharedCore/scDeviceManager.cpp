@@ -28,6 +28,7 @@
 
 #include <stddef.h>
 #include "scDeviceManager.h"
+#include "scMetrics.h"
 
 using SharedCore::scDeviceManager;
 using SharedCore::scDeviceDescriptor;
@@ -46,6 +47,10 @@ scDeviceManager::~scDeviceManager()
 {
 	for( size_t i=0; i < _devices.size(); ++i )
 	{
+		if ( _devices[i] != NULL )
+		{
+			scMETRIC_SUBTRACT( SharedCore::scMETRIC_DEVICE_COUNT, 1 );
+		}
 		delete _devices[i];
 		_devices[i] = NULL;
 	}
@@ -123,6 +128,7 @@ void scDeviceManager::DeviceInitialize( const scDeviceDescriptor& dd, uint8_t nC
 						else
 						{
 							// Didn't find a dependant driver. This could be bad. So lets assert
+							scMETRIC_ADD( SharedCore::scMETRIC_DEVICE_MISSING, 1 );
 							assert_param( pGoFirst != NULL );
 						}
 					}
@@ -140,6 +146,7 @@ void scDeviceManager::DeviceInitialize( const scDeviceDescriptor& dd, uint8_t nC
 		else
 		{
 			// did not find the driver to initialize. This is bad
+			scMETRIC_ADD( SharedCore::scMETRIC_DEVICE_MISSING, 1 );
 			assert_param( pToConfigure != NULL );
 		}
 	}
@@ -164,6 +171,7 @@ size_t scDeviceManager::Add( scDeviceGeneric* pDevice )
 	{
 		// Driver doesn't exist. Good to add
 		_devices.push_back( pDevice );
+		scMETRIC_ADD( SharedCore::scMETRIC_DEVICE_COUNT, 1 );
 	}
 	else
 	{
@@ -173,6 +181,24 @@ size_t scDeviceManager::Add( scDeviceGeneric* pDevice )
 	return _devices.size();
 }
 
+/// <summary>
+/// Obtain the number of devices in the device list.
+/// </summary>
+size_t scDeviceManager::DeviceCount( void ) const
+{
+	return _devices.size();
+}
+
+/// <summary>
+/// Obtain a device by its position in the device list, used to walk the list.
+/// </summary>
+/// <param name="nIndex">Position of the device, less than DeviceCount.</param>
+/// <returns>NULL if nIndex is out of range.</returns>
+scDeviceGeneric* scDeviceManager::Device( size_t nIndex ) const
+{
+	return ( nIndex < _devices.size() ) ? _devices[nIndex] : NULL;
+}
+
 /// <summary>
 /// This method will find the specified driver in the list and return it. False is
 /// return if the driver is not found.
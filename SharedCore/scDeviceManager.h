@@ -81,6 +81,18 @@ namespace SharedCore
 		/// drivers in the device list to prevent memory leaks in test applications.</param>
 		size_t Add( scDeviceGeneric* pDevice );
 
+		/// <summary>
+		/// Obtain the number of devices in the device list.
+		/// </summary>
+		size_t DeviceCount( void ) const;
+
+		/// <summary>
+		/// Obtain a device by its position in the device list, used to walk the list.
+		/// </summary>
+		/// <param name="nIndex">Position of the device, less than DeviceCount.</param>
+		/// <returns>NULL if nIndex is out of range.</returns>
+		scDeviceGeneric* Device( size_t nIndex ) const;
+
 		/// <summary>
 		/// This method will call Enable on the specified driver
 		/// </summary>
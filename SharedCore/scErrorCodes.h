@@ -50,5 +50,11 @@
 
 #define ERROR_SC_MODULE_NOT_FOUND										(ERROR_SC_GENERIC_ERROR + 10)
 
+#define ERROR_SC_ROUTE_TABLE_FULL										(ERROR_SC_GENERIC_ERROR + 11)
+#define ERROR_SC_ROUTE_OUT_OF_RANGE										(ERROR_SC_GENERIC_ERROR + 12)
+#define ERROR_SC_WINDOW_FULL											(ERROR_SC_GENERIC_ERROR + 13)
+#define ERROR_SC_FILE_FAILURE											(ERROR_SC_GENERIC_ERROR + 14)
+#define ERROR_SC_ROUTE_FANOUT_LIMIT										(ERROR_SC_GENERIC_ERROR + 15)
+
 #endif // !defined(__SHARED_CORE_ERROR_CODES_H)
 
@@ -23,6 +23,7 @@
 
 #include <vector>
 #include <algorithm>
+#include "scTimeline.h"
 
 namespace SharedCore
 {
@@ -145,6 +146,7 @@ namespace SharedCore
 		  */
 		  void FireEvent(EventArgType eventArg)
 		  {
+			  scTIMELINE_SCOPE_ARG( "event", "FireEvent", (uint32_t)Subscribers.size() );
 			  for (unsigned int i = 0; i < Subscribers.size(); i++)
 			  {
 				  Subscribers[i].handlerProc(eventSource, eventArg,
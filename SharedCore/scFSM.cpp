@@ -27,6 +27,8 @@
 //==============================================================================
 
 #include "scFSM.h"
+#include "scProfiler.h"
+#include "scTimeline.h"
 
 using namespace SharedCore;
 
@@ -178,6 +180,8 @@ bool scFSM::HandleInput( uint32_t nTimeout )
 	uint32_t nTimeRemaining = nTimeout;
 	uint16_t nMaxWait = MAX_UINT16;
 	uint16_t nDelay = 0;
+	scPROFILE_SCOPE( scPROBE_HANDLE_INPUT );
+	scTIMELINE_SCOPE( "fsm", "HandleInput" );
 
 	assert_param( _pQueue != NULL );
 
@@ -191,6 +195,7 @@ bool scFSM::HandleInput( uint32_t nTimeout )
 
 			if ( current != nEnterState )
 			{
+				scTIMELINE_INSTANT( "fsm", "Transition", (uint32_t)current );
 				OnLeave( nEnterState );
 				OnEnter( current );
 			}
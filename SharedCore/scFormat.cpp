@@ -0,0 +1,698 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scFormat.cpp
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#include <string.h>
+#include "scFormat.h"
+
+using namespace SharedCore;
+
+#ifndef assert_param
+#define assert_param(X)	if ( !(X) ) { for(;;) ; }
+#endif
+
+static const char g_Spaces[] = "                ";
+static const char g_Zeros[] = "0000000000000000";
+static const char g_HexLower[] = "0123456789abcdef";
+static const char g_HexUpper[] = "0123456789ABCDEF";
+static const char g_DecimalPairs[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+/// <summary>
+/// Passes the text to the sink and counts the length of the whole text. Once the
+/// sink is full nothing more is passed to it, the rest is only counted.
+/// </summary>
+class scFormat::Output
+{
+public:
+	Output( scIFormatSink& sink )
+		: _Sink( sink )
+		, _nLength( 0 )
+		, _bFull( false )
+	{
+	}
+
+	/// <summary>
+	/// Pass a piece of text to the sink.
+	/// </summary>
+	void Put( const char* pText, uint32_t nLength )
+	{
+		if ( !_bFull && nLength > 0 )
+		{
+			_bFull = _Sink.Write( pText, nLength ) < nLength;
+		}
+		_nLength += nLength;
+	}
+
+	/// <summary>
+	/// Pass a run of one of the padding characters to the sink.
+	/// </summary>
+	void Fill( const char* pPad, uint32_t nCount )
+	{
+		while( nCount > 0 )
+		{
+			uint32_t nChunk = ( nCount < sizeof(g_Spaces) - 1 ) ? nCount : sizeof(g_Spaces) - 1;
+			Put( pPad, nChunk );
+			nCount -= nChunk;
+		}
+	}
+
+	scIFormatSink&		_Sink;
+	uint32_t			_nLength;
+	bool				_bFull;
+};
+
+/// <summary>
+/// Sink writing to a character buffer. One character is kept back for the null
+/// terminator.
+/// </summary>
+class scFormat::BufferSink : public scIFormatSink
+{
+public:
+	BufferSink( char* pText, uint32_t nSize )
+		: _pText( pText )
+		, _nSize( nSize )
+		, _nLength( 0 )
+	{
+	}
+
+	virtual uint32_t Write( const char* pText, uint32_t nLength )
+	{
+		uint32_t nRoom = ( _nSize > _nLength + 1 ) ? _nSize - _nLength - 1 : 0;
+		if ( nLength > nRoom )
+		{
+			nLength = nRoom;
+		}
+		memcpy( _pText + _nLength, pText, nLength );
+		_nLength += nLength;
+		return nLength;
+	}
+
+	/// <summary>
+	/// Terminate the text.
+	/// </summary>
+	void Close(void)
+	{
+		if ( _nSize > 0 )
+		{
+			_pText[_nLength] = '\0';
+		}
+	}
+
+	char*				_pText;
+	uint32_t			_nSize;
+	uint32_t			_nLength;
+};
+
+/// <summary>
+/// Supplies the arguments to Run.
+/// </summary>
+class scFormat::Args
+{
+public:
+	virtual ~Args() {}
+
+	/// <summary>
+	/// The next argument. The conversion and length modifier are only needed when
+	/// the type is not already known.
+	/// </summary>
+	virtual scFormatArg Next( char nConversion, int nLong ) = 0;
+};
+
+/// <summary>
+/// Reads the arguments from a va_list, trusting the format string for the type.
+/// </summary>
+class scFormat::ListArgs : public scFormat::Args
+{
+public:
+	ListArgs( va_list ap )
+	{
+		va_copy( _ap, ap );
+	}
+
+	virtual ~ListArgs()
+	{
+		va_end( _ap );
+	}
+
+	virtual scFormatArg Next( char nConversion, int nLong )
+	{
+		switch( nConversion )
+		{
+		case 'd':
+		case 'i':
+		case '*':
+			if ( nLong >= 2 )
+			{
+				return scFormatArg( va_arg( _ap, long long ) );
+			}
+			if ( nLong == 1 )
+			{
+				return scFormatArg( va_arg( _ap, long ) );
+			}
+			return scFormatArg( va_arg( _ap, int ) );
+
+		case 'u':
+		case 'x':
+		case 'X':
+			if ( nLong >= 2 )
+			{
+				return scFormatArg( va_arg( _ap, unsigned long long ) );
+			}
+			if ( nLong == 1 )
+			{
+				return scFormatArg( va_arg( _ap, unsigned long ) );
+			}
+			return scFormatArg( va_arg( _ap, unsigned int ) );
+
+		case 'c':
+			return scFormatArg( (char)va_arg( _ap, int ) );
+
+		case 's':
+			return scFormatArg( va_arg( _ap, const char* ) );
+
+		case 'p':
+			return scFormatArg( va_arg( _ap, const void* ) );
+
+		default:
+			return scFormatArg( va_arg( _ap, double ) );
+		}
+	}
+
+	va_list				_ap;
+};
+
+/// <summary>
+/// Reads the arguments from an array, the types were recorded by the compiler.
+/// </summary>
+class scFormat::ArrayArgs : public scFormat::Args
+{
+public:
+	ArrayArgs( const scFormatArg* pArgs, uint32_t nCount )
+		: _pArgs( pArgs )
+		, _nCount( nCount )
+		, _nNext( 0 )
+	{
+	}
+
+	virtual scFormatArg Next( char, int )
+	{
+		if ( _nNext < _nCount )
+		{
+			return _pArgs[_nNext++];
+		}
+		return scFormatArg();
+	}
+
+	const scFormatArg*	_pArgs;
+	uint32_t			_nCount;
+	uint32_t			_nNext;
+};
+
+/// <summary>
+/// Format the text into a sink.
+/// </summary>
+/// <param name="sink">Receives the text.</param>
+/// <param name="pFormat">The format string.</param>
+/// <param name="ap">The arguments.</param>
+/// <returns>The length of the whole text, which is more than the sink kept if
+/// it filled up.</returns>
+uint32_t scFormat::vFormat( scIFormatSink& sink, const char* pFormat, va_list ap )
+{
+	ListArgs args( ap );
+	return Run( sink, pFormat, args );
+}
+
+/// <summary>
+/// Format the text into a character buffer. The text is always null
+/// terminated and truncated to fit.
+/// </summary>
+/// <param name="pText">The buffer.</param>
+/// <param name="nSize">Size of the buffer including the terminator.</param>
+/// <param name="pFormat">The format string.</param>
+/// <param name="ap">The arguments.</param>
+/// <returns>The length of the whole text, as vsnprintf.</returns>
+uint32_t scFormat::vFormat( char* pText, uint32_t nSize, const char* pFormat, va_list ap )
+{
+	BufferSink	sink( pText, nSize );
+	ListArgs	args( ap );
+	uint32_t	nResult = Run( sink, pFormat, args );
+	sink.Close();
+	return nResult;
+}
+
+/// <summary>
+/// Format the text into a character buffer with the type-safe arguments. The
+/// text is always null terminated and truncated to fit.
+/// </summary>
+/// <param name="pText">The buffer.</param>
+/// <param name="nSize">Size of the buffer including the terminator.</param>
+/// <param name="pFormat">The format string.</param>
+/// <returns>The length of the whole text, as snprintf.</returns>
+uint32_t scFormat::Format( char* pText, uint32_t nSize, const char* pFormat )
+{
+	return Run( pText, nSize, pFormat, NULL, 0 );
+}
+
+uint32_t scFormat::Format( char* pText, uint32_t nSize, const char* pFormat, const scFormatArg& a1 )
+{
+	return Run( pText, nSize, pFormat, &a1, 1 );
+}
+
+uint32_t scFormat::Format( char* pText, uint32_t nSize, const char* pFormat, const scFormatArg& a1,
+	const scFormatArg& a2 )
+{
+	scFormatArg args[2] = { a1, a2 };
+	return Run( pText, nSize, pFormat, args, 2 );
+}
+
+uint32_t scFormat::Format( char* pText, uint32_t nSize, const char* pFormat, const scFormatArg& a1,
+	const scFormatArg& a2, const scFormatArg& a3 )
+{
+	scFormatArg args[3] = { a1, a2, a3 };
+	return Run( pText, nSize, pFormat, args, 3 );
+}
+
+uint32_t scFormat::Format( char* pText, uint32_t nSize, const char* pFormat, const scFormatArg& a1,
+	const scFormatArg& a2, const scFormatArg& a3, const scFormatArg& a4 )
+{
+	scFormatArg args[4] = { a1, a2, a3, a4 };
+	return Run( pText, nSize, pFormat, args, 4 );
+}
+
+uint32_t scFormat::Format( char* pText, uint32_t nSize, const char* pFormat, const scFormatArg& a1,
+	const scFormatArg& a2, const scFormatArg& a3, const scFormatArg& a4, const scFormatArg& a5 )
+{
+	scFormatArg args[5] = { a1, a2, a3, a4, a5 };
+	return Run( pText, nSize, pFormat, args, 5 );
+}
+
+uint32_t scFormat::Format( char* pText, uint32_t nSize, const char* pFormat, const scFormatArg& a1,
+	const scFormatArg& a2, const scFormatArg& a3, const scFormatArg& a4, const scFormatArg& a5,
+	const scFormatArg& a6 )
+{
+	scFormatArg args[6] = { a1, a2, a3, a4, a5, a6 };
+	return Run( pText, nSize, pFormat, args, 6 );
+}
+
+/// <summary>
+/// Format the text into a sink with an array of type-safe arguments.
+/// </summary>
+/// <param name="sink">Receives the text.</param>
+/// <param name="pFormat">The format string.</param>
+/// <param name="pArgs">The arguments.</param>
+/// <param name="nCount">Number of arguments.</param>
+/// <returns>The length of the whole text.</returns>
+uint32_t scFormat::Format( scIFormatSink& sink, const char* pFormat, const scFormatArg* pArgs, uint32_t nCount )
+{
+	ArrayArgs args( pArgs, nCount );
+	return Run( sink, pFormat, args );
+}
+
+/// <summary>
+/// Write the decimal digits of a value so they end just before pEnd. Two digits
+/// are produced per division from a table, and values that fit in 32 bits never
+/// use 64 bit division.
+/// </summary>
+/// <param name="pEnd">One past the last digit, at least 20 characters must be
+/// available before it.</param>
+/// <param name="nValue">The value.</param>
+/// <returns>The first digit.</returns>
+char* scFormat::Decimal( char* pEnd, uint64_t nValue )
+{
+	char* p = pEnd;
+	while( nValue > 0xFFFFFFFFUL )
+	{
+		uint64_t	nQuotient = nValue / 100;
+		uint32_t	nPair = (uint32_t)( nValue - nQuotient * 100 ) * 2;
+		*--p = g_DecimalPairs[nPair + 1];
+		*--p = g_DecimalPairs[nPair];
+		nValue = nQuotient;
+	}
+
+	uint32_t n = (uint32_t)nValue;
+	while( n >= 100 )
+	{
+		uint32_t	nQuotient = n / 100;
+		uint32_t	nPair = ( n - nQuotient * 100 ) * 2;
+		*--p = g_DecimalPairs[nPair + 1];
+		*--p = g_DecimalPairs[nPair];
+		n = nQuotient;
+	}
+	if ( n >= 10 )
+	{
+		*--p = g_DecimalPairs[n * 2 + 1];
+		*--p = g_DecimalPairs[n * 2];
+	}
+	else
+	{
+		*--p = (char)( '0' + n );
+	}
+	return p;
+}
+
+/// <summary>
+/// Write the hexadecimal digits of a value so they end just before pEnd.
+/// </summary>
+/// <param name="pEnd">One past the last digit, at least 16 characters must be
+/// available before it.</param>
+/// <param name="nValue">The value.</param>
+/// <param name="bUpper">true for A-F, false for a-f.</param>
+/// <returns>The first digit.</returns>
+char* scFormat::Hex( char* pEnd, uint64_t nValue, bool bUpper )
+{
+	const char*	pHex = bUpper ? g_HexUpper : g_HexLower;
+	char*		p = pEnd;
+	do
+	{
+		*--p = pHex[nValue & 0x0F];
+		nValue >>= 4;
+	} while( nValue != 0 );
+	return p;
+}
+
+/// <summary>
+/// Format into a character buffer with an array of arguments.
+/// </summary>
+uint32_t scFormat::Run( char* pText, uint32_t nSize, const char* pFormat, const scFormatArg* pArgs, uint32_t nCount )
+{
+	BufferSink	sink( pText, nSize );
+	ArrayArgs	args( pArgs, nCount );
+	uint32_t	nResult = Run( sink, pFormat, args );
+	sink.Close();
+	return nResult;
+}
+
+/// <summary>
+/// The formatter shared by all of the public methods. The conversion picks how a
+/// number is shown, the type of the argument decides whether it is a number at all.
+/// </summary>
+uint32_t scFormat::Run( scIFormatSink& sink, const char* pFormat, Args& args )
+{
+	Output			out( sink );
+	const char*		p = pFormat;
+
+	assert_param( pFormat != NULL );
+
+	while( *p != '\0' )
+	{
+		// the text up to the next conversion goes out in one piece
+		const char* pStart = p;
+		while( *p != '\0' && *p != '%' )
+		{
+			++p;
+		}
+		out.Put( pStart, (uint32_t)( p - pStart ) );
+		if ( *p == '\0' )
+		{
+			break;
+		}
+		pStart = p++;
+
+		bool		bLeft = false;
+		bool		bZero = false;
+		uint32_t	nWidth = 0;
+		int			nPrecision = -1;
+		int			nLong = 0;
+
+		for( ;; ++p )
+		{
+			if ( *p == '-' )
+			{
+				bLeft = true;
+			}
+			else if ( *p == '0' )
+			{
+				bZero = true;
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		if ( *p == '*' )
+		{
+			scFormatArg star = args.Next( '*', 0 );
+			int64_t n = ( star._nType == scFormatArg::arg_Signed ) ? star._Value._nSigned : (int64_t)star._Value._nUnsigned;
+			if ( n < 0 )
+			{
+				bLeft = true;
+				n = -n;
+			}
+			nWidth = (uint32_t)n;
+			++p;
+		}
+		else
+		{
+			while( *p >= '0' && *p <= '9' )
+			{
+				nWidth = nWidth * 10 + ( *p++ - '0' );
+			}
+		}
+
+		if ( *p == '.' )
+		{
+			++p;
+			nPrecision = 0;
+			if ( *p == '*' )
+			{
+				scFormatArg star = args.Next( '*', 0 );
+				int64_t n = ( star._nType == scFormatArg::arg_Signed ) ? star._Value._nSigned : (int64_t)star._Value._nUnsigned;
+				nPrecision = ( n < 0 ) ? -1 : (int)n;
+				++p;
+			}
+			else
+			{
+				while( *p >= '0' && *p <= '9' )
+				{
+					nPrecision = nPrecision * 10 + ( *p++ - '0' );
+				}
+			}
+		}
+
+		for( ;; ++p )
+		{
+			if ( *p == 'l' )
+			{
+				++nLong;
+			}
+			else if ( *p == 'z' )
+			{
+				nLong = ( sizeof(size_t) > sizeof(long) ) ? 2 : 1;
+			}
+			else if ( *p == 'j' )
+			{
+				nLong = 2;
+			}
+			else if ( *p != 'h' )
+			{
+				break;
+			}
+		}
+
+		const char nConversion = *p;
+		switch( nConversion )
+		{
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'p':
+		case 'c':
+		case 's':
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+			++p;
+			break;
+
+		case '%':
+			out.Put( p, 1 );
+			++p;
+			continue;
+
+		default:
+			// not a conversion this formatter knows, show it as written
+			if ( *p != '\0' )
+			{
+				++p;
+			}
+			out.Put( pStart, (uint32_t)( p - pStart ) );
+			continue;
+		}
+
+		scFormatArg		arg = args.Next( nConversion, nLong );
+		char			digits[24];
+		char* const		pEnd = digits + sizeof(digits);
+		const char*		pPrefix = "";
+		uint32_t		nPrefix = 0;
+		const char*		pText = NULL;
+		uint32_t		nText = 0;
+		bool			bNumber = false;
+		uint64_t		nValue = 0;
+		bool			bHex = ( nConversion == 'x' || nConversion == 'X' || nConversion == 'p' );
+
+		switch( arg._nType )
+		{
+		case scFormatArg::arg_Signed:
+			if ( arg._Value._nSigned < 0 && !bHex && nConversion != 'u' )
+			{
+				pPrefix = "-";
+				nPrefix = 1;
+				nValue = 0 - (uint64_t)arg._Value._nSigned;
+			}
+			else if ( arg._Value._nSigned < 0 && arg._nBytes <= sizeof(uint32_t) )
+			{
+				// shown as unsigned, keep the width of the original type
+				nValue = (uint32_t)arg._Value._nSigned;
+			}
+			else
+			{
+				nValue = (uint64_t)arg._Value._nSigned;
+			}
+			bNumber = true;
+			break;
+
+		case scFormatArg::arg_Unsigned:
+			nValue = arg._Value._nUnsigned;
+			bNumber = true;
+			break;
+
+		case scFormatArg::arg_Char:
+			nValue = arg._Value._nUnsigned;
+			bNumber = ( nConversion != 'c' && nConversion != 's' );
+			if ( !bNumber )
+			{
+				digits[0] = (char)nValue;
+				pText = digits;
+				nText = 1;
+			}
+			break;
+
+		case scFormatArg::arg_Text:
+			pText = ( arg._Value._pText != NULL ) ? arg._Value._pText : "(null)";
+			// the precision may stop the text before an unterminated end
+			while( ( nPrecision < 0 || nText < (uint32_t)nPrecision ) && pText[nText] != '\0' )
+			{
+				++nText;
+			}
+			break;
+
+		case scFormatArg::arg_Pointer:
+			nValue = (uint64_t)(uintptr_t)arg._Value._pPointer;
+			pPrefix = "0x";
+			nPrefix = 2;
+			bHex = true;
+			bNumber = true;
+			break;
+
+		case scFormatArg::arg_Float:
+			pText = "?";
+			nText = 1;
+			break;
+
+		default:
+			// a missing argument prints nothing
+			continue;
+		}
+
+		if ( bNumber && nConversion == 'c' )
+		{
+			digits[0] = (char)nValue;
+			pText = digits;
+			nText = 1;
+			bNumber = false;
+		}
+
+		if ( bNumber )
+		{
+			if ( nConversion == 'p' && nPrefix == 0 )
+			{
+				pPrefix = "0x";
+				nPrefix = 2;
+			}
+
+			char*		pDigits = bHex ? Hex( pEnd, nValue, nConversion == 'X' ) : Decimal( pEnd, nValue );
+			uint32_t	nDigits = (uint32_t)( pEnd - pDigits );
+			uint32_t	nZeros = 0;
+
+			if ( nPrecision == 0 && nValue == 0 )
+			{
+				nDigits = 0;
+			}
+			if ( nPrecision > 0 && (uint32_t)nPrecision > nDigits )
+			{
+				nZeros = (uint32_t)nPrecision - nDigits;
+			}
+
+			uint32_t nTotal = nPrefix + nZeros + nDigits;
+			if ( bZero && !bLeft && nPrecision < 0 && nWidth > nTotal )
+			{
+				nZeros += nWidth - nTotal;
+				nTotal = nWidth;
+			}
+			uint32_t nPad = ( nWidth > nTotal ) ? nWidth - nTotal : 0;
+
+			if ( !bLeft )
+			{
+				out.Fill( g_Spaces, nPad );
+			}
+			out.Put( pPrefix, nPrefix );
+			out.Fill( g_Zeros, nZeros );
+			out.Put( pEnd - nDigits, nDigits );
+			if ( bLeft )
+			{
+				out.Fill( g_Spaces, nPad );
+			}
+		}
+		else
+		{
+			uint32_t nPad = ( nWidth > nText ) ? nWidth - nText : 0;
+			if ( !bLeft )
+			{
+				out.Fill( g_Spaces, nPad );
+			}
+			out.Put( pText, nText );
+			if ( bLeft )
+			{
+				out.Fill( g_Spaces, nPad );
+			}
+		}
+	}
+	return out._nLength;
+}
@@ -0,0 +1,243 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scFormat.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCFORMAT_H__INCLUDED_)
+#define __SCFORMAT_H__INCLUDED_
+
+#include <stdarg.h>
+#include "scTypes.h"
+
+#ifndef va_copy
+	#define va_copy( dest, src )	( (dest) = (src) )
+#endif
+
+namespace SharedCore
+{
+	/// <summary>
+	/// Receives the text produced by scFormat. The text arrives in pieces as it is
+	/// formatted, so the destination does not have to be contiguous. A ring buffer,
+	/// for example, can take the text straight into its free space and wrap at the
+	/// end.
+	/// </summary>
+	class scIFormatSink
+	{
+	public:
+		/// <summary>
+		/// Simple destructor.
+		/// </summary>
+		virtual ~scIFormatSink() {}
+
+		/// <summary>
+		/// Take the next piece of the text.
+		/// </summary>
+		/// <param name="pText">The text, not null terminated.</param>
+		/// <param name="nLength">Number of characters.</param>
+		/// <returns>The number of characters kept, fewer than nLength once the
+		/// destination is full.</returns>
+		virtual uint32_t Write( const char* pText, uint32_t nLength ) = 0;
+	};
+
+	/// <summary>
+	/// One argument of the type-safe scFormat::Format. The type is recorded when the
+	/// argument is built, so the formatter can never read it as something else: a
+	/// number given to %s is printed as a number and a missing argument prints
+	/// nothing, where vsprintf would read past the end of the argument list.
+	/// </summary>
+	class scFormatArg
+	{
+	public:
+		typedef enum
+		{
+			arg_None,
+			arg_Signed,
+			arg_Unsigned,
+			arg_Char,
+			arg_Text,
+			arg_Pointer,
+			arg_Float
+		} Type_t;
+
+		scFormatArg() : _nType( arg_None ), _nBytes( 0 ) { _Value._nUnsigned = 0; }
+		scFormatArg( int nValue ) : _nType( arg_Signed ), _nBytes( sizeof(nValue) ) { _Value._nSigned = nValue; }
+		scFormatArg( long nValue ) : _nType( arg_Signed ), _nBytes( sizeof(nValue) ) { _Value._nSigned = nValue; }
+		scFormatArg( long long nValue ) : _nType( arg_Signed ), _nBytes( sizeof(nValue) ) { _Value._nSigned = nValue; }
+		scFormatArg( unsigned int nValue ) : _nType( arg_Unsigned ), _nBytes( sizeof(nValue) ) { _Value._nUnsigned = nValue; }
+		scFormatArg( unsigned long nValue ) : _nType( arg_Unsigned ), _nBytes( sizeof(nValue) ) { _Value._nUnsigned = nValue; }
+		scFormatArg( unsigned long long nValue ) : _nType( arg_Unsigned ), _nBytes( sizeof(nValue) ) { _Value._nUnsigned = nValue; }
+		scFormatArg( char cValue ) : _nType( arg_Char ), _nBytes( 1 ) { _Value._nUnsigned = (uint8_t)cValue; }
+		scFormatArg( const char* pText ) : _nType( arg_Text ), _nBytes( sizeof(pText) ) { _Value._pText = pText; }
+		scFormatArg( const void* pValue ) : _nType( arg_Pointer ), _nBytes( sizeof(pValue) ) { _Value._pPointer = pValue; }
+		scFormatArg( double ) : _nType( arg_Float ), _nBytes( sizeof(double) ) { _Value._nUnsigned = 0; }
+
+		/// <summary>
+		/// The type of the value.
+		/// </summary>
+		Type_t					_nType;
+
+		/// <summary>
+		/// Size of the original value, a negative number shown as unsigned or hex
+		/// keeps this many bytes as printf would.
+		/// </summary>
+		uint8_t					_nBytes;
+
+		/// <summary>
+		/// The value, selected by the type.
+		/// </summary>
+		union
+		{
+			int64_t				_nSigned;
+			uint64_t			_nUnsigned;
+			const char*			_pText;
+			const void*			_pPointer;
+		}						_Value;
+	};
+
+	/// <summary>
+	/// Small, bounded replacement for vsprintf covering the conversions used by the
+	/// framework: %d %i %u %x %X %c %s %p and %%, with the '-' and '0' flags, width,
+	/// precision, '*' and the h, l, ll, z and j length modifiers. Floating point is
+	/// not supported, the argument is consumed and '?' is written. Nothing is
+	/// allocated and the output never runs past the end of the destination.
+	///
+	/// Format takes its arguments as scFormatArg, so the types are checked by the
+	/// compiler and the text does not depend on the format string matching them.
+	/// vFormat takes a va_list for the printf style interfaces such as
+	/// scDebugManager::Trace.
+	/// </summary>
+	class scFormat
+	{
+	public:
+		/// <summary>
+		/// Format the text into a sink.
+		/// </summary>
+		/// <param name="sink">Receives the text.</param>
+		/// <param name="pFormat">The format string.</param>
+		/// <param name="ap">The arguments.</param>
+		/// <returns>The length of the whole text, which is more than the sink kept if
+		/// it filled up.</returns>
+		static uint32_t vFormat( scIFormatSink& sink, const char* pFormat, va_list ap );
+
+		/// <summary>
+		/// Format the text into a character buffer. The text is always null
+		/// terminated and truncated to fit.
+		/// </summary>
+		/// <param name="pText">The buffer.</param>
+		/// <param name="nSize">Size of the buffer including the terminator.</param>
+		/// <param name="pFormat">The format string.</param>
+		/// <param name="ap">The arguments.</param>
+		/// <returns>The length of the whole text, as vsnprintf.</returns>
+		static uint32_t vFormat( char* pText, uint32_t nSize, const char* pFormat, va_list ap );
+
+		/// <summary>
+		/// Format the text into a character buffer with the type-safe arguments. The
+		/// text is always null terminated and truncated to fit.
+		/// </summary>
+		/// <param name="pText">The buffer.</param>
+		/// <param name="nSize">Size of the buffer including the terminator.</param>
+		/// <param name="pFormat">The format string.</param>
+		/// <returns>The length of the whole text, as snprintf.</returns>
+		static uint32_t Format( char* pText, uint32_t nSize, const char* pFormat );
+		static uint32_t Format( char* pText, uint32_t nSize, const char* pFormat, const scFormatArg& a1 );
+		static uint32_t Format( char* pText, uint32_t nSize, const char* pFormat, const scFormatArg& a1,
+			const scFormatArg& a2 );
+		static uint32_t Format( char* pText, uint32_t nSize, const char* pFormat, const scFormatArg& a1,
+			const scFormatArg& a2, const scFormatArg& a3 );
+		static uint32_t Format( char* pText, uint32_t nSize, const char* pFormat, const scFormatArg& a1,
+			const scFormatArg& a2, const scFormatArg& a3, const scFormatArg& a4 );
+		static uint32_t Format( char* pText, uint32_t nSize, const char* pFormat, const scFormatArg& a1,
+			const scFormatArg& a2, const scFormatArg& a3, const scFormatArg& a4, const scFormatArg& a5 );
+		static uint32_t Format( char* pText, uint32_t nSize, const char* pFormat, const scFormatArg& a1,
+			const scFormatArg& a2, const scFormatArg& a3, const scFormatArg& a4, const scFormatArg& a5,
+			const scFormatArg& a6 );
+
+		/// <summary>
+		/// Format the text into a sink with an array of type-safe arguments.
+		/// </summary>
+		/// <param name="sink">Receives the text.</param>
+		/// <param name="pFormat">The format string.</param>
+		/// <param name="pArgs">The arguments.</param>
+		/// <param name="nCount">Number of arguments.</param>
+		/// <returns>The length of the whole text.</returns>
+		static uint32_t Format( scIFormatSink& sink, const char* pFormat, const scFormatArg* pArgs, uint32_t nCount );
+
+		/// <summary>
+		/// Write the decimal digits of a value so they end just before pEnd. Two digits
+		/// are produced per division from a table, and values that fit in 32 bits never
+		/// use 64 bit division.
+		/// </summary>
+		/// <param name="pEnd">One past the last digit, at least 20 characters must be
+		/// available before it.</param>
+		/// <param name="nValue">The value.</param>
+		/// <returns>The first digit.</returns>
+		static char* Decimal( char* pEnd, uint64_t nValue );
+
+		/// <summary>
+		/// Write the hexadecimal digits of a value so they end just before pEnd.
+		/// </summary>
+		/// <param name="pEnd">One past the last digit, at least 16 characters must be
+		/// available before it.</param>
+		/// <param name="nValue">The value.</param>
+		/// <param name="bUpper">true for A-F, false for a-f.</param>
+		/// <returns>The first digit.</returns>
+		static char* Hex( char* pEnd, uint64_t nValue, bool bUpper );
+
+	private:
+		/// <summary>
+		/// Passes the text to the sink and counts the length of the whole text.
+		/// </summary>
+		class Output;
+
+		/// <summary>
+		/// Sink writing to a character buffer.
+		/// </summary>
+		class BufferSink;
+
+		/// <summary>
+		/// Supplies the arguments to Run, from a va_list or from an array.
+		/// </summary>
+		class Args;
+		class ListArgs;
+		class ArrayArgs;
+
+		/// <summary>
+		/// The formatter shared by all of the public methods.
+		/// </summary>
+		static uint32_t Run( scIFormatSink& sink, const char* pFormat, Args& args );
+
+		/// <summary>
+		/// Format into a character buffer with an array of arguments.
+		/// </summary>
+		static uint32_t Run( char* pText, uint32_t nSize, const char* pFormat, const scFormatArg* pArgs, uint32_t nCount );
+	};
+}
+
+#endif // !defined(__SCFORMAT_H__INCLUDED_)
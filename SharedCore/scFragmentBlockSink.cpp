@@ -0,0 +1,235 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scFragmentBlockSink.cpp
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#include "scFragmentBlockSink.h"
+#include "scErrorCodes.h"
+#include "scDebugManager.h"
+#include "scDebugLabelCodes.h"
+#include <string.h>
+
+#ifndef assert_param
+#define assert_param(X)	if ( !(X) ) { for(;;) ; }
+#endif
+
+using namespace SharedCore;
+using namespace SharedCore::HAL;
+
+#define scNO_BLOCK		(0xFFFFFFFF)
+
+/// <summary>
+/// Construct the sink.
+/// </summary>
+/// <param name="pDevice">The block device receiving the data.</param>
+/// <param name="nStartBlock">First block of the storage area.</param>
+/// <param name="nBlockCount">Number of blocks in the storage area.</param>
+scFragmentBlockSink::scFragmentBlockSink( scBlockMemoryIF* pDevice, uint32_t nStartBlock, uint32_t nBlockCount )
+	: _pDevice( pDevice )
+	, _nStartBlock( nStartBlock )
+	, _nBlockCount( nBlockCount )
+	, _nBlockSize( 0 )
+	, _pBlock( NULL )
+	, _nStaged( scNO_BLOCK )
+	, _bBusy( false )
+	, _nSource( 0 )
+	, _nStream( 0 )
+	, _nTotal( 0 )
+	, _nStored( 0 )
+	, _nLastError( ERROR_SUCCESS )
+	, _Allocator()
+{
+	assert_param( _pDevice != NULL );
+}
+
+/// <summary>
+/// Destructor.
+/// </summary>
+scFragmentBlockSink::~scFragmentBlockSink()
+{
+	if ( _pBlock != NULL )
+	{
+		_Allocator.Destroy( _pBlock );
+		_pBlock = NULL;
+	}
+}
+
+/// <summary>
+/// Allocate the staging block.
+/// </summary>
+/// <param name="allocator">Allocator used for the staging block.</param>
+uint32_t scFragmentBlockSink::Initialize( scAllocator allocator )
+{
+	_Allocator = allocator;
+	_nBlockSize = _pDevice->DefaultBlockSize();
+	assert_param( _nBlockSize > 0 );
+
+	_pBlock = _Allocator.Allocate( _nBlockSize, true );
+	if ( _pBlock == NULL )
+	{
+		scDebugManager::Instance()->Trace( scDEBUGLABEL_ERROR_MESSAGE,
+			"scFragmentBlockSink: Unable to allocate the staging block.\n\r" );
+		_nLastError = ERROR_SC_MEMORY_ALLOCATION_FAILURE;
+	}
+	return _nLastError;
+}
+
+/// <summary>
+/// A new stream is starting. Refused while another stream is open or if the
+/// stream is larger than the storage area.
+/// </summary>
+bool scFragmentBlockSink::Open( uint16_t nSource, uint16_t nStream, uint16_t nId, uint32_t nTotal )
+{
+	(void)nId;
+
+	if ( _bBusy || _pBlock == NULL || nTotal > ( _nBlockCount * _nBlockSize ) )
+	{
+		return false;
+	}
+
+	_bBusy = true;
+	_nSource = nSource;
+	_nStream = nStream;
+	_nTotal = nTotal;
+	_nStaged = scNO_BLOCK;
+
+	// the new stream overwrites what was stored before
+	_nStored = 0;
+	return true;
+}
+
+/// <summary>
+/// Store the next piece of the stream.
+/// </summary>
+uint32_t scFragmentBlockSink::Write( uint16_t nSource, uint16_t nStream, uint32_t nOffset, const uint8_t* pData, uint32_t nLength )
+{
+	if ( !_bBusy || nSource != _nSource || nStream != _nStream )
+	{
+		return ERROR_SC_MEMORY_INVALID_POINTER;
+	}
+	if ( nOffset + nLength > _nTotal )
+	{
+		return ERROR_SC_BUFFER_OVERFLOW;
+	}
+
+	uint32_t nResult = ERROR_SUCCESS;
+
+	while( nLength > 0 && nResult == ERROR_SUCCESS )
+	{
+		uint32_t nBlock = nOffset / _nBlockSize;
+		uint32_t nPosition = nOffset % _nBlockSize;
+		uint32_t nCopy = _nBlockSize - nPosition;
+		if ( nCopy > nLength )
+		{
+			nCopy = nLength;
+		}
+
+		if ( nBlock != _nStaged )
+		{
+			if ( _nStaged != scNO_BLOCK )
+			{
+				nResult = FlushBlock();
+			}
+
+			// keep what the device holds ahead of the data when starting mid-block
+			if ( nResult == ERROR_SUCCESS && nPosition != 0 )
+			{
+				nResult = _pDevice->Read( _pBlock, _nBlockSize, _nStartBlock + nBlock, 1 );
+			}
+			else
+			{
+				memset( _pBlock, 0xFF, _nBlockSize );
+			}
+			_nStaged = nBlock;
+		}
+
+		if ( nResult == ERROR_SUCCESS )
+		{
+			memcpy( _pBlock + nPosition, pData, nCopy );
+			if ( nPosition + nCopy == _nBlockSize )
+			{
+				nResult = FlushBlock();
+			}
+		}
+
+		nOffset += nCopy;
+		pData += nCopy;
+		nLength -= nCopy;
+	}
+
+	if ( nResult != ERROR_SUCCESS )
+	{
+		_nLastError = nResult;
+	}
+	return nResult;
+}
+
+/// <summary>
+/// The stream has ended, the staged block is written if it completed. The stream
+/// only counts as stored if that write succeeds.
+/// </summary>
+void scFragmentBlockSink::Close( uint16_t nSource, uint16_t nStream, bool bComplete )
+{
+	if ( _bBusy && nSource == _nSource && nStream == _nStream )
+	{
+		if ( bComplete )
+		{
+			uint32_t nResult = ERROR_SUCCESS;
+			if ( _nStaged != scNO_BLOCK )
+			{
+				nResult = FlushBlock();
+			}
+			if ( nResult == ERROR_SUCCESS )
+			{
+				_nStored = _nTotal;
+			}
+		}
+		_nStaged = scNO_BLOCK;
+		_bBusy = false;
+	}
+}
+
+/// <summary>
+/// Flush the staged block to the device.
+/// </summary>
+uint32_t scFragmentBlockSink::FlushBlock(void)
+{
+	uint32_t nResult = _pDevice->Write( _pBlock, _nStartBlock + _nStaged, 1 );
+	if ( nResult != ERROR_SUCCESS )
+	{
+		_nLastError = nResult;
+		scDebugManager::Instance()->Trace( scDEBUGLABEL_ERROR_MESSAGE,
+			"scFragmentBlockSink: Block %u write failed.\n\r", _nStartBlock + _nStaged );
+	}
+	_nStaged = scNO_BLOCK;
+	return nResult;
+}
@@ -0,0 +1,187 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scFragmentBlockSink.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCFRAGMENTBLOCKSINK_H__INCLUDED_)
+#define __SCFRAGMENTBLOCKSINK_H__INCLUDED_
+
+#include "scTypes.h"
+#include "scAllocator.h"
+#include "scIFragmentSink.h"
+#include "HAL/scBlockMemoryIF.h"
+
+namespace SharedCore
+{
+	/// <summary>
+	/// Stores a fragmented transfer directly into a range of blocks of a block device,
+	/// such as an SD card or external flash, so a file larger than the available RAM
+	/// can be received. Only one block is staged in memory. A block is written as soon
+	/// as it has been filled and the last partial block is written when the stream
+	/// completes. Addresses passed to the device are block numbers. One stream can be
+	/// received at a time.
+	/// </summary>
+	class scFragmentBlockSink : public scIFragmentSink
+	{
+	public:
+		/// <summary>
+		/// Construct the sink.
+		/// </summary>
+		/// <param name="pDevice">The block device receiving the data.</param>
+		/// <param name="nStartBlock">First block of the storage area.</param>
+		/// <param name="nBlockCount">Number of blocks in the storage area.</param>
+		scFragmentBlockSink( HAL::scBlockMemoryIF* pDevice, uint32_t nStartBlock, uint32_t nBlockCount );
+
+		/// <summary>
+		/// Destructor.
+		/// </summary>
+		virtual ~scFragmentBlockSink();
+
+		/// <summary>
+		/// Allocate the staging block.
+		/// </summary>
+		/// <param name="allocator">Allocator used for the staging block.</param>
+		uint32_t Initialize( scAllocator allocator );
+
+		/// <summary>
+		/// A new stream is starting. Refused while another stream is open or if the
+		/// stream is larger than the storage area.
+		/// </summary>
+		virtual bool Open( uint16_t nSource, uint16_t nStream, uint16_t nId, uint32_t nTotal );
+
+		/// <summary>
+		/// Store the next piece of the stream.
+		/// </summary>
+		virtual uint32_t Write( uint16_t nSource, uint16_t nStream, uint32_t nOffset, const uint8_t* pData, uint32_t nLength );
+
+		/// <summary>
+		/// The stream has ended, the staged block is written if it completed. The stream
+		/// only counts as stored if that write succeeds.
+		/// </summary>
+		virtual void Close( uint16_t nSource, uint16_t nStream, bool bComplete );
+
+		/// <summary>
+		/// Size of the last stream that completed and was written to the device, zero
+		/// if none or while a new stream is open.
+		/// </summary>
+		uint32_t StoredLength(void) const
+		{
+			return _nStored;
+		}
+
+		/// <summary>
+		/// Check if a stream is open.
+		/// </summary>
+		bool Busy(void) const
+		{
+			return _bBusy;
+		}
+
+		/// <summary>
+		/// Obtain the result of the last device operation that failed.
+		/// </summary>
+		uint32_t GetLastError(void) const
+		{
+			return _nLastError;
+		}
+
+	private:
+		/// <summary>
+		/// Flush the staged block to the device.
+		/// </summary>
+		uint32_t FlushBlock(void);
+
+		/// <summary>
+		/// The device receiving the data.
+		/// </summary>
+		HAL::scBlockMemoryIF*		_pDevice;
+
+		/// <summary>
+		/// First block of the storage area.
+		/// </summary>
+		uint32_t					_nStartBlock;
+
+		/// <summary>
+		/// Number of blocks in the storage area.
+		/// </summary>
+		uint32_t					_nBlockCount;
+
+		/// <summary>
+		/// Size of a block in bytes.
+		/// </summary>
+		uint32_t					_nBlockSize;
+
+		/// <summary>
+		/// Holds the block being filled.
+		/// </summary>
+		uint8_t*					_pBlock;
+
+		/// <summary>
+		/// Index of the staged block relative to the start of the area, or
+		/// scNO_BLOCK if nothing is staged.
+		/// </summary>
+		uint32_t					_nStaged;
+
+		/// <summary>
+		/// Set while a stream is open.
+		/// </summary>
+		bool						_bBusy;
+
+		/// <summary>
+		/// Source and stream of the open stream.
+		/// </summary>
+		uint16_t					_nSource;
+		uint16_t					_nStream;
+
+		/// <summary>
+		/// Size of the open stream.
+		/// </summary>
+		uint32_t					_nTotal;
+
+		/// <summary>
+		/// Size of the last stream that completed.
+		/// </summary>
+		uint32_t					_nStored;
+
+		/// <summary>
+		/// The last device error.
+		/// </summary>
+		uint32_t					_nLastError;
+
+		/// <summary>
+		/// Used for the staging block.
+		/// </summary>
+		scAllocator					_Allocator;
+	};
+}
+
+#endif // !defined(__SCFRAGMENTBLOCKSINK_H__INCLUDED_)
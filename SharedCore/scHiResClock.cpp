@@ -0,0 +1,207 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scHiResClock.cpp
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#include "scHiResClock.h"
+
+#if defined(scHIRESCLOCK_DWT)
+	// registers of the cycle counter, the same on every Cortex-M3 and up
+	#define DEMCR				(*(volatile uint32_t*)0xE000EDFCUL)
+	#define DEMCR_TRCENA		(1UL << 24)
+	#define DWT_CTRL			(*(volatile uint32_t*)0xE0001000UL)
+	#define DWT_CTRL_CYCCNTENA	(1UL)
+	#define DWT_CYCCNT			(*(volatile uint32_t*)0xE0001004UL)
+	#define DWT_LAR				(*(volatile uint32_t*)0xE0001FB0UL)
+	#define DWT_LAR_KEY			(0xC5ACCE55UL)
+#elif defined(_WIN32)
+	#include <windows.h>
+#else
+	#include <time.h>
+#endif
+
+using namespace SharedCore;
+
+scHiResClock::Counter_t	scHiResClock::s_pCounter = NULL;
+uint32_t				scHiResClock::s_nFrequency = 0;
+uint32_t				scHiResClock::s_nHigh = 0;
+uint32_t				scHiResClock::s_nLast = 0;
+
+#if defined(__arm__) && defined(__GNUC__)
+/// <summary>
+/// Mask the interrupts, returning the previous mask.
+/// </summary>
+static inline uint32_t LockInterrupts( void )
+{
+	uint32_t nMask;
+	__asm volatile ( "mrs %0, primask\n\tcpsid i" : "=r" (nMask) : : "memory" );
+	return nMask;
+}
+
+/// <summary>
+/// Restore the interrupt mask.
+/// </summary>
+static inline void RestoreInterrupts( uint32_t nMask )
+{
+	__asm volatile ( "msr primask, %0" : : "r" (nMask) : "memory" );
+}
+#else
+static inline uint32_t LockInterrupts( void )
+{
+	return 0;
+}
+
+static inline void RestoreInterrupts( uint32_t )
+{
+}
+#endif
+
+#if defined(scHIRESCLOCK_DWT)
+/// <summary>
+/// Read the cycle counter.
+/// </summary>
+static uint32_t CycleCounter( void )
+{
+	return DWT_CYCCNT;
+}
+#endif
+
+/// <summary>
+/// Start the cycle counter. Does nothing on the host.
+/// </summary>
+/// <param name="nCoreClock">The core clock in Hz, the rate of the cycle
+/// counter.</param>
+void scHiResClock::Initialize( uint32_t nCoreClock )
+{
+#if defined(scHIRESCLOCK_DWT)
+	DEMCR |= DEMCR_TRCENA;
+	DWT_LAR = DWT_LAR_KEY;			// only the Cortex-M7 locks the DWT
+	DWT_CYCCNT = 0;
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+	SetCounter( &CycleCounter, nCoreClock );
+#else
+	(void)nCoreClock;
+#endif
+}
+
+/// <summary>
+/// Use another counter than the one of the platform, NULL returns to the
+/// platform counter.
+/// </summary>
+/// <param name="pCounter">The counter.</param>
+/// <param name="nFrequency">Rate of the counter in Hz.</param>
+void scHiResClock::SetCounter( Counter_t pCounter, uint32_t nFrequency )
+{
+	uint32_t nMask = LockInterrupts();
+	s_pCounter = pCounter;
+	s_nFrequency = ( pCounter != NULL ) ? nFrequency : 0;
+	s_nHigh = 0;
+	s_nLast = ( pCounter != NULL ) ? pCounter() : 0;
+	RestoreInterrupts( nMask );
+}
+
+/// <summary>
+/// The time in ticks of the clock.
+/// </summary>
+uint64_t scHiResClock::Ticks( void )
+{
+	if ( s_pCounter != NULL )
+	{
+		return Extend();
+	}
+#if defined(scHIRESCLOCK_DWT)
+	return 0;
+#elif defined(_WIN32)
+	LARGE_INTEGER nCount;
+	QueryPerformanceCounter( &nCount );
+	return (uint64_t)nCount.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+#else
+	return 0;
+#endif
+}
+
+/// <summary>
+/// The rate of the ticks in Hz, zero when the clock is not running.
+/// </summary>
+uint64_t scHiResClock::Frequency( void )
+{
+	if ( s_pCounter != NULL )
+	{
+		return s_nFrequency;
+	}
+#if defined(scHIRESCLOCK_DWT)
+	return 0;
+#elif defined(_WIN32)
+	LARGE_INTEGER nFrequency;
+	QueryPerformanceFrequency( &nFrequency );
+	return (uint64_t)nFrequency.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+	return 1000000000ULL;
+#else
+	return 0;
+#endif
+}
+
+/// <summary>
+/// Convert a number of ticks to microseconds.
+/// </summary>
+uint64_t scHiResClock::ToMicroseconds( uint64_t nTicks )
+{
+	uint64_t nFrequency = Frequency();
+	if ( nFrequency == 0 )
+	{
+		return 0;
+	}
+	// whole seconds first so the product cannot overflow
+	return ( nTicks / nFrequency ) * 1000000ULL + ( ( nTicks % nFrequency ) * 1000000ULL ) / nFrequency;
+}
+
+/// <summary>
+/// Read the 32 bit counter and extend it to 64 bits. The count is compared with the
+/// one last read, a smaller count means the counter wrapped since. It is read with
+/// the interrupts masked so an interrupt reading the clock cannot get in between.
+/// </summary>
+uint64_t scHiResClock::Extend( void )
+{
+	uint32_t nMask = LockInterrupts();
+	uint32_t nCount = s_pCounter();
+	if ( nCount < s_nLast )
+	{
+		s_nHigh++;
+	}
+	s_nLast = nCount;
+	uint64_t nResult = ( (uint64_t)s_nHigh << 32 ) | nCount;
+	RestoreInterrupts( nMask );
+	return nResult;
+}
@@ -0,0 +1,143 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scHiResClock.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCHIRESCLOCK_H__INCLUDED_)
+#define __SCHIRESCLOCK_H__INCLUDED_
+
+#include "scTypes.h"
+
+namespace SharedCore
+{
+	/// <summary>
+	/// Defined when the core has the DWT cycle counter, Cortex-M3 and up.
+	/// </summary>
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+	#define scHIRESCLOCK_DWT
+#endif
+
+	/// <summary>
+	/// Monotonic clock with the finest resolution the platform offers, used to time
+	/// the trace records. On a Cortex-M3 and up it is the DWT cycle counter, on the
+	/// host clock_gettime( CLOCK_MONOTONIC ) or the performance counter of Windows.
+	/// Cores without a cycle counter, a Cortex-M0 for example, supply a free running
+	/// 32 bit timer with SetCounter.
+	///
+	/// A 32 bit counter is extended to 64 bits in software by noticing when it wraps,
+	/// so it has to be read at least once per wrap, every 35 seconds at 120 MHz. A
+	/// target tracing less often than that should call Ticks from a periodic task.
+	/// On the target the extension briefly masks the interrupts, on the host a
+	/// counter given to SetCounter must only be read from one thread.
+	/// </summary>
+	class scHiResClock
+	{
+	public:
+		/// <summary>
+		/// Free running 32 bit counter counting up.
+		/// </summary>
+		typedef uint32_t (*Counter_t)( void );
+
+		/// <summary>
+		/// Start the cycle counter. Does nothing on the host.
+		/// </summary>
+		/// <param name="nCoreClock">The core clock in Hz, the rate of the cycle
+		/// counter.</param>
+		static void Initialize( uint32_t nCoreClock );
+
+		/// <summary>
+		/// Use another counter than the one of the platform, NULL returns to the
+		/// platform counter.
+		/// </summary>
+		/// <param name="pCounter">The counter.</param>
+		/// <param name="nFrequency">Rate of the counter in Hz.</param>
+		static void SetCounter( Counter_t pCounter, uint32_t nFrequency );
+
+		/// <summary>
+		/// The time in ticks of the clock.
+		/// </summary>
+		static uint64_t Ticks( void );
+
+		/// <summary>
+		/// The rate of the ticks in Hz, zero when the clock is not running.
+		/// </summary>
+		static uint64_t Frequency( void );
+
+		/// <summary>
+		/// Convert a number of ticks to microseconds.
+		/// </summary>
+		static uint64_t ToMicroseconds( uint64_t nTicks );
+
+		/// <summary>
+		/// The time in microseconds.
+		/// </summary>
+		static uint64_t Microseconds( void )
+		{
+			return ToMicroseconds( Ticks() );
+		}
+
+		/// <summary>
+		/// The time in microseconds cut to 32 bits, wraps after 71 minutes. Suits
+		/// scDebugManager::SetTimestampSource.
+		/// </summary>
+		static uint32_t Timestamp( void )
+		{
+			return (uint32_t)Microseconds();
+		}
+
+	private:
+		/// <summary>
+		/// Read the 32 bit counter and extend it to 64 bits.
+		/// </summary>
+		static uint64_t Extend( void );
+
+		/// <summary>
+		/// Counter given to SetCounter.
+		/// </summary>
+		static Counter_t			s_pCounter;
+
+		/// <summary>
+		/// Rate of the 32 bit counter.
+		/// </summary>
+		static uint32_t				s_nFrequency;
+
+		/// <summary>
+		/// Number of times the 32 bit counter wrapped.
+		/// </summary>
+		static uint32_t				s_nHigh;
+
+		/// <summary>
+		/// The count last read.
+		/// </summary>
+		static uint32_t				s_nLast;
+	};
+}
+
+#endif // !defined(__SCHIRESCLOCK_H__INCLUDED_)
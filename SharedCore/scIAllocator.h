@@ -39,6 +39,32 @@
 
 namespace SharedCore
 {
+	/// <summary>
+	/// Usage counts of an allocator, see scIAllocator::Statistics.
+	/// </summary>
+	typedef struct
+	{
+		/// <summary>
+		/// Number of blocks handed out.
+		/// </summary>
+		uint32_t			_nAllocations;
+
+		/// <summary>
+		/// Number of blocks given back.
+		/// </summary>
+		uint32_t			_nReleases;
+
+		/// <summary>
+		/// Number of requests that could not be met.
+		/// </summary>
+		uint32_t			_nFailures;
+
+		/// <summary>
+		/// Total bytes handed out.
+		/// </summary>
+		uint32_t			_nBytes;
+	} scAllocatorStats_t;
+
 	/// <summary>
 	/// The scIAllocator provides an interface for allocating memory within the shared
 	/// core framework. Subclasses of the allocator can perform custom memory
@@ -85,6 +111,18 @@ namespace SharedCore
 		/// </param>
 		virtual void Destroy( void* pBuffer) = 0;
 
+		/// <summary>
+		/// Obtain the usage counts of the allocator. Implementations that do not keep
+		/// them leave the default.
+		/// </summary>
+		/// <param name="stats">Receives the counts.</param>
+		/// <returns>false if the allocator keeps no counts.</returns>
+		virtual bool Statistics( scAllocatorStats_t& stats ) const
+		{
+			(void)stats;
+			return false;
+		}
+
 	};
 
 }
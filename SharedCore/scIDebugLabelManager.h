@@ -86,6 +86,28 @@ namespace SharedCore
 		/// <param name="nLabel">The label to look up</param>
 		virtual const char* LabelText(uint16_t nLabel) = 0;
 
+		/// <summary>
+		/// Number of labels that exist in the system. The label masks of the debug
+		/// paths are sized from it when they are added to the debug manager.
+		/// </summary>
+		virtual uint16_t LabelCount(void) const
+		{
+			return scDEBUGLABEL_LAST;
+		}
+
+		/// <summary>
+		/// Changes the state of every label in a named group. Label managers without
+		/// groups return false.
+		/// </summary>
+		/// <param name="pName">Name of the group.</param>
+		/// <param name="nState">The new state of the labels.</param>
+		virtual bool GroupState( const char* pName, scEnableState_t nState )
+		{
+			(void)pName;
+			(void)nState;
+			return false;
+		}
+
 	private:
 		/// <summary>
 		/// Prevent copy operators
@@ -0,0 +1,86 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scIFragmentSink.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCIFRAGMENTSINK_H__INCLUDED_)
+#define __SCIFRAGMENTSINK_H__INCLUDED_
+
+#include "scTypes.h"
+
+namespace SharedCore
+{
+	/// <summary>
+	/// Receives the data of a fragmented transfer as the pieces arrive so a large
+	/// block never has to be held in memory. Streams are identified by the source
+	/// address and the stream number picked by the sender.
+	/// </summary>
+	class scIFragmentSink
+	{
+	public:
+		/// <summary>
+		/// Simple destructor.
+		/// </summary>
+		virtual ~scIFragmentSink() {}
+
+		/// <summary>
+		/// A new stream is starting. Return false to refuse it.
+		/// </summary>
+		/// <param name="nSource">Address of the sender.</param>
+		/// <param name="nStream">Stream number.</param>
+		/// <param name="nId">Message ID the stream was sent with.</param>
+		/// <param name="nTotal">Number of bytes in the complete block.</param>
+		virtual bool Open( uint16_t nSource, uint16_t nStream, uint16_t nId, uint32_t nTotal ) = 0;
+
+		/// <summary>
+		/// Store the next piece of a stream. The pieces arrive in order.
+		/// </summary>
+		/// <param name="nSource">Address of the sender.</param>
+		/// <param name="nStream">Stream number.</param>
+		/// <param name="nOffset">Position of the data in the complete block.</param>
+		/// <param name="pData">The data.</param>
+		/// <param name="nLength">Number of bytes.</param>
+		/// <returns>ERROR_SUCCESS or an error code that will abort the stream.</returns>
+		virtual uint32_t Write( uint16_t nSource, uint16_t nStream, uint32_t nOffset, const uint8_t* pData, uint32_t nLength ) = 0;
+
+		/// <summary>
+		/// The stream has ended.
+		/// </summary>
+		/// <param name="nSource">Address of the sender.</param>
+		/// <param name="nStream">Stream number.</param>
+		/// <param name="bComplete">true if every byte arrived, false if the stream was
+		/// aborted.</param>
+		virtual void Close( uint16_t nSource, uint16_t nStream, bool bComplete ) = 0;
+	};
+}
+
+#endif // !defined(__SCIFRAGMENTSINK_H__INCLUDED_)
@@ -49,6 +49,16 @@ namespace SharedCore
 	{
 
 	public:
+		/// <summary>
+		/// The type used for the message IDs.
+		/// </summary>
+		typedef MsgType		MsgType_t;
+
+		/// <summary>
+		/// The utility class used to read and write the message header.
+		/// </summary>
+		typedef HeaderType	HeaderType_t;
+
 		/// <summary>
 		/// Simple destructor. Does not delete the memory pointer.
 		/// </summary>
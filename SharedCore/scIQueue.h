@@ -103,6 +103,12 @@ namespace SharedCore
 		/// </summary>
 		virtual uint32_t SpacesAvailable(void) = 0;
 
+		/// <summary>
+		/// Return the number of items waiting in the queue. Queues that cannot tell
+		/// return 0.
+		/// </summary>
+		virtual uint32_t MessagesWaiting(void) { return 0; }
+
 	};
 }	// Namespace SharedCore
 #endif // __scIQueue_H
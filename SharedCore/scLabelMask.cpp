@@ -0,0 +1,156 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scLabelMask.cpp
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#include "scLabelMask.h"
+
+using namespace SharedCore;
+
+/// <summary>
+/// Construct the mask.
+/// </summary>
+/// <param name="nLabels">Number of labels held individually.</param>
+/// <param name="nDefault">State of every label.</param>
+scLabelMask::scLabelMask( uint16_t nLabels, scEnableState_t nDefault )
+	: _Words( ( nLabels + 31 ) / 32, 0 )
+	, _nLabels( nLabels )
+	, _bOthers( nDefault == scEnabled )
+{
+	SetAll( nDefault );
+}
+
+/// <summary>
+/// Simple destructor.
+/// </summary>
+scLabelMask::~scLabelMask()
+{
+}
+
+/// <summary>
+/// Change one label. Labels past the size of the mask are ignored.
+/// </summary>
+/// <param name="nLabel">The label.</param>
+/// <param name="nState">The new state.</param>
+void scLabelMask::Set( uint16_t nLabel, scEnableState_t nState )
+{
+	if ( nLabel < _nLabels )
+	{
+		uint32_t nBit = 1UL << ( nLabel & 31 );
+		if ( nState == scEnabled )
+		{
+			scAtomicOr( &_Words[nLabel >> 5], nBit );
+		}
+		else
+		{
+			scAtomicAnd( &_Words[nLabel >> 5], ~nBit );
+		}
+	}
+}
+
+/// <summary>
+/// Change every label, including those past the size of the mask.
+/// </summary>
+/// <param name="nState">The new state.</param>
+void scLabelMask::SetAll( scEnableState_t nState )
+{
+	uint32_t nValue = ( nState == scEnabled ) ? 0xFFFFFFFF : 0;
+	for( uint32_t i=0; i < _Words.size(); ++i )
+	{
+		scAtomicStore( &_Words[i], nValue );
+	}
+	_bOthers = ( nState == scEnabled );
+}
+
+/// <summary>
+/// Change every label set in another mask, such as a label group. Labels past
+/// the size of the mask are ignored, the mask is never resized so it can be used
+/// while other tasks test it.
+/// </summary>
+/// <param name="mask">The labels to change.</param>
+/// <param name="nState">The new state.</param>
+void scLabelMask::Merge( const scLabelMask& mask, scEnableState_t nState )
+{
+	uint16_t nLabels = ( mask._nLabels < _nLabels ) ? mask._nLabels : _nLabels;
+
+	for( uint32_t i=0; i < ( nLabels + 31U ) / 32; ++i )
+	{
+		uint32_t nBits = scAtomicLoad( &mask._Words[i] );
+
+		// the unused bits of the last word stay equal to the labels past the end
+		if ( ( i + 1 ) * 32 > nLabels )
+		{
+			nBits &= ( 1UL << ( nLabels & 31 ) ) - 1;
+		}
+		if ( nBits != 0 )
+		{
+			if ( nState == scEnabled )
+			{
+				scAtomicOr( &_Words[i], nBits );
+			}
+			else
+			{
+				scAtomicAnd( &_Words[i], ~nBits );
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Change the number of labels held individually. New labels take the state of
+/// the labels past the end.
+/// </summary>
+/// <param name="nLabels">Number of labels.</param>
+void scLabelMask::Resize( uint16_t nLabels )
+{
+	uint32_t nFill = _bOthers ? 0xFFFFFFFF : 0;
+
+	// the unused bits of the last word are kept equal to the labels past the end
+	_Words.resize( ( nLabels + 31 ) / 32, nFill );
+	_nLabels = nLabels;
+}
+
+/// <summary>
+/// Number of labels set, counting only those held individually.
+/// </summary>
+uint16_t scLabelMask::Count(void) const
+{
+	uint16_t nCount = 0;
+	for( uint16_t i=0; i < _nLabels; ++i )
+	{
+		if ( Test( i ) )
+		{
+			nCount++;
+		}
+	}
+	return nCount;
+}
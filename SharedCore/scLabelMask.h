@@ -0,0 +1,138 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scLabelMask.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCLABELMASK_H__INCLUDED_)
+#define __SCLABELMASK_H__INCLUDED_
+
+#include "scTypes.h"
+#include "scAtomic.h"
+#include <vector>
+
+namespace SharedCore
+{
+	/// <summary>
+	/// One bit per debug label. Testing a label is a single bit test whatever the
+	/// number of labels, and changing a label is an atomic operation on one word so
+	/// labels can be changed while other tasks are tracing. Labels past the size of
+	/// the mask all share one state, set with SetAll. Resize is not atomic and should
+	/// only be used while setting up.
+	/// </summary>
+	class scLabelMask
+	{
+	public:
+		/// <summary>
+		/// Construct the mask.
+		/// </summary>
+		/// <param name="nLabels">Number of labels held individually.</param>
+		/// <param name="nDefault">State of every label.</param>
+		scLabelMask( uint16_t nLabels = 0, scEnableState_t nDefault = scDisabled );
+
+		/// <summary>
+		/// Simple destructor.
+		/// </summary>
+		virtual ~scLabelMask();
+
+		/// <summary>
+		/// Check if a label is set.
+		/// </summary>
+		/// <param name="nLabel">The label.</param>
+		bool Test( uint16_t nLabel ) const
+		{
+			if ( nLabel < _nLabels )
+			{
+				return ( scAtomicLoad( &_Words[nLabel >> 5] ) & ( 1UL << ( nLabel & 31 ) ) ) != 0;
+			}
+			return _bOthers;
+		}
+
+		/// <summary>
+		/// Change one label. Labels past the size of the mask are ignored.
+		/// </summary>
+		/// <param name="nLabel">The label.</param>
+		/// <param name="nState">The new state.</param>
+		void Set( uint16_t nLabel, scEnableState_t nState );
+
+		/// <summary>
+		/// Change every label, including those past the size of the mask.
+		/// </summary>
+		/// <param name="nState">The new state.</param>
+		void SetAll( scEnableState_t nState );
+
+		/// <summary>
+		/// Change every label set in another mask, such as a label group. Labels past
+		/// the size of the mask are ignored.
+		/// </summary>
+		/// <param name="mask">The labels to change.</param>
+		/// <param name="nState">The new state.</param>
+		void Merge( const scLabelMask& mask, scEnableState_t nState );
+
+		/// <summary>
+		/// Change the number of labels held individually. New labels take the state of
+		/// the labels past the end.
+		/// </summary>
+		/// <param name="nLabels">Number of labels.</param>
+		void Resize( uint16_t nLabels );
+
+		/// <summary>
+		/// Number of labels held individually.
+		/// </summary>
+		uint16_t Size(void) const
+		{
+			return _nLabels;
+		}
+
+		/// <summary>
+		/// Number of labels set, counting only those held individually.
+		/// </summary>
+		uint16_t Count(void) const;
+
+	private:
+		/// <summary>
+		/// The bits, 32 labels to a word.
+		/// </summary>
+		std::vector<uint32_t>		_Words;
+
+		/// <summary>
+		/// Number of labels held individually.
+		/// </summary>
+		uint16_t					_nLabels;
+
+		/// <summary>
+		/// State of the labels past the end.
+		/// </summary>
+		bool						_bOthers;
+	};
+}
+
+#endif // !defined(__SCLABELMASK_H__INCLUDED_)
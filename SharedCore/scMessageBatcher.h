@@ -0,0 +1,694 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scMessageBatcher.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCMESSAGEBATCHER_H__INCLUDED_)
+#define __SCMESSAGEBATCHER_H__INCLUDED_
+
+#include "scTypes.h"
+#include "scAllocator.h"
+#include "scIMutex.h"
+#include "scScopeLock.h"
+#include "scDebugManager.h"
+#include "scDebugLabelCodes.h"
+#include "scErrorCodes.h"
+#include "scProfiler.h"
+#include "scStandardHeader_t.h"
+#include "scMessageFactory.h"
+#include "scMessageRouter.h"
+#include "HAL/scBufferedIODriver.h"
+
+
+#ifndef assert_param
+#define assert_param(X)	if ( !(X) ) { for(;;) ; }
+#endif
+
+
+namespace SharedCore
+{
+	/// <summary>
+	/// Combines small messages going to the same destination into a single container
+	/// message so they share one header and one transmission. The container is marked
+	/// with STANDARD_HEADER_FLAG_BATCH and its payload is the complete inner messages,
+	/// headers included, one after the other. A batch is sent when the next message
+	/// will not fit, when the fill threshold is reached, when the oldest message has
+	/// waited longer than the deadline or when Flush is called. A batch holding a
+	/// single message is sent as that message. On the receive side Receive passes
+	/// normal messages to the router and splits containers back into individual
+	/// messages first.
+	/// </summary>
+	template<class IMessage>
+	class scMessageBatcher
+	{
+	public:
+		/// <summary>
+		/// Function used to obtain a free running tick count for the flush deadline.
+		/// </summary>
+		typedef uint32_t (*TickSource_t)( void );
+
+		/// <summary>
+		/// Construct the batcher.
+		/// </summary>
+		/// <param name="nSlots">Number of destinations that can be batched at one time.
+		/// </param>
+		/// <param name="nBatchSize">Maximum payload of a container message.</param>
+		/// <param name="nContainerId">Message ID used for the container messages.</param>
+		scMessageBatcher( uint8_t nSlots, uint32_t nBatchSize, typename IMessage::MsgType_t nContainerId );
+
+		/// <summary>
+		/// Destructor. Pending messages are discarded, call Flush first to send them.
+		/// </summary>
+		virtual ~scMessageBatcher();
+
+		/// <summary>
+		/// Allocate the batch buffers.
+		/// </summary>
+		/// <param name="allocator">Allocator used for the batch buffers.</param>
+		/// <param name="pProtect">Mutex protecting the batches.</param>
+		/// <param name="pDriver">Driver the messages are sent to.</param>
+		virtual uint32_t Initialize( scAllocator allocator, scIMutex* pProtect, HAL::scBufferIODriver* pDriver );
+
+		/// <summary>
+		/// Provide the objects used to deliver the received messages.
+		/// </summary>
+		/// <param name="pFactory">Used to create the messages unpacked from a container.
+		/// </param>
+		/// <param name="pRouter">Receives every message.</param>
+		void SetReceiver( scMessageFactory<IMessage>* pFactory, scMessageRouter<IMessage>* pRouter )
+		{
+			_pFactory = pFactory;
+			_pRouter = pRouter;
+		}
+
+		/// <summary>
+		/// Set the function used to time the batches. NULL disables the deadline.
+		/// </summary>
+		/// <param name="pSource">Tick function.</param>
+		void SetTickSource( TickSource_t pSource )
+		{
+			_pTickSource = pSource;
+		}
+
+		/// <summary>
+		/// Set the longest time a message may wait in a batch before it is sent.
+		/// </summary>
+		/// <param name="nTicks">Deadline in ticks of the tick source.</param>
+		void SetDeadline( uint32_t nTicks )
+		{
+			_nDeadline = nTicks;
+		}
+
+		/// <summary>
+		/// Send a batch as soon as it holds this many bytes. Defaults to the batch size.
+		/// </summary>
+		/// <param name="nBytes">Fill level that triggers the send.</param>
+		void SetFlushThreshold( uint32_t nBytes )
+		{
+			_nThreshold = ( nBytes < _nBatchSize ) ? nBytes : _nBatchSize;
+		}
+
+		/// <summary>
+		/// Get the last error.
+		/// </summary>
+		uint32_t GetLastError()
+		{
+			return _nLastError;
+		}
+
+		/// <summary>
+		/// Queue a message for sending. The message contents are copied so the caller
+		/// keeps ownership of the message. Messages too large to batch are sent at once
+		/// after the pending batch for the same destination.
+		/// </summary>
+		/// <param name="pMessage">The message to send.</param>
+		uint32_t Send( const IMessage* pMessage );
+
+		/// <summary>
+		/// Send all the pending batches.
+		/// </summary>
+		void Flush(void);
+
+		/// <summary>
+		/// Send the pending batch for a single destination.
+		/// </summary>
+		/// <param name="nDestination">Destination address.</param>
+		void Flush( uint16_t nDestination );
+
+		/// <summary>
+		/// Send the batches that have been waiting longer than the deadline. Call this
+		/// periodically from the owning task.
+		/// </summary>
+		void Poll(void);
+
+		/// <summary>
+		/// Deliver a received message to the router, splitting containers into the
+		/// individual messages. The caller keeps ownership of the message.
+		/// </summary>
+		/// <param name="pMessage">The received message.</param>
+		/// <returns>Number of messages delivered.</returns>
+		uint16_t Receive( const IMessage* pMessage );
+
+		/// <summary>
+		/// Number of messages that have been sent inside a container.
+		/// </summary>
+		uint32_t MessagesBatched(void) const
+		{
+			return _nBatched;
+		}
+
+		/// <summary>
+		/// Number of container messages sent.
+		/// </summary>
+		uint32_t ContainersSent(void) const
+		{
+			return _nContainers;
+		}
+
+		/// <summary>
+		/// Number of containers received with damaged inner messages.
+		/// </summary>
+		uint32_t ReceiveErrors(void) const
+		{
+			return _nReceiveErrors;
+		}
+
+	private:
+		typedef typename IMessage::HeaderType_t		Header_t;
+
+		typedef struct
+		{
+			/// <summary>
+			/// Pointer to the memory holding the inner messages.
+			/// </summary>
+			uint8_t*		_pBuffer;
+
+			/// <summary>
+			/// Number of bytes used in the buffer.
+			/// </summary>
+			uint32_t		_nFill;
+
+			/// <summary>
+			/// Number of messages in the buffer, 0 when the slot is free.
+			/// </summary>
+			uint16_t		_nCount;
+
+			/// <summary>
+			/// The destination of every message in the batch.
+			/// </summary>
+			uint16_t		_nDestination;
+
+			/// <summary>
+			/// The source of the first message, used for the container.
+			/// </summary>
+			uint16_t		_nSource;
+
+			/// <summary>
+			/// Tick count when the first message was added.
+			/// </summary>
+			uint32_t		_nStart;
+		} Batch_t;
+
+		/// <summary>
+		/// If an error occurs this value will reflect the last one.
+		/// </summary>
+		uint32_t					_nLastError;
+
+		/// <summary>
+		/// Number of batch slots.
+		/// </summary>
+		uint8_t						_nSlots;
+
+		/// <summary>
+		/// The size of each batch buffer.
+		/// </summary>
+		uint32_t					_nBatchSize;
+
+		/// <summary>
+		/// The fill level that triggers the send.
+		/// </summary>
+		uint32_t					_nThreshold;
+
+		/// <summary>
+		/// Longest time a message can wait.
+		/// </summary>
+		uint32_t					_nDeadline;
+
+		/// <summary>
+		/// Message ID of the container messages.
+		/// </summary>
+		typename IMessage::MsgType_t	_nContainerId;
+
+		/// <summary>
+		/// The batch slots.
+		/// </summary>
+		Batch_t*					_pBatches;
+
+		/// <summary>
+		/// Protects the batches.
+		/// </summary>
+		scIMutex*					_pProtect;
+
+		/// <summary>
+		/// The messages are sent here.
+		/// </summary>
+		HAL::scBufferIODriver*		_pDriver;
+
+		/// <summary>
+		/// Creates the unpacked messages.
+		/// </summary>
+		scMessageFactory<IMessage>*	_pFactory;
+
+		/// <summary>
+		/// Receives the messages.
+		/// </summary>
+		scMessageRouter<IMessage>*	_pRouter;
+
+		/// <summary>
+		/// The allocator used for the batch buffers.
+		/// </summary>
+		scAllocator					_Allocator;
+
+		/// <summary>
+		/// Used for the deadline.
+		/// </summary>
+		TickSource_t				_pTickSource;
+
+		/// <summary>
+		/// Number of messages sent inside a container.
+		/// </summary>
+		uint32_t					_nBatched;
+
+		/// <summary>
+		/// Number of containers sent.
+		/// </summary>
+		uint32_t					_nContainers;
+
+		/// <summary>
+		/// Number of damaged containers received.
+		/// </summary>
+		uint32_t					_nReceiveErrors;
+
+		/// <summary>
+		/// Write the batch to the driver and empty the slot. Must be called with the lock.
+		/// </summary>
+		void SendBatch( Batch_t& batch );
+
+		/// <summary>
+		/// Locate the slot for a destination, making room if necessary. Must be called
+		/// with the lock.
+		/// </summary>
+		Batch_t& FindBatch( uint16_t nDestination );
+
+		/// <summary>
+		/// Read the tick source.
+		/// </summary>
+		uint32_t Now(void) const
+		{
+			return ( _pTickSource != NULL ) ? _pTickSource() : 0;
+		}
+	};
+
+//////////////////////////////////////////////////////////////////////////////////////
+/// Public Methods
+//////////////////////////////////////////////////////////////////////////////////////
+
+	/// <summary>
+	/// Construct the batcher.
+	/// </summary>
+	/// <param name="nSlots">Number of destinations that can be batched at one time.
+	/// </param>
+	/// <param name="nBatchSize">Maximum payload of a container message.</param>
+	/// <param name="nContainerId">Message ID used for the container messages.</param>
+	template<class IMessage>
+	scMessageBatcher<IMessage>::scMessageBatcher( uint8_t nSlots, uint32_t nBatchSize, typename IMessage::MsgType_t nContainerId )
+		:	_nLastError(ERROR_SUCCESS)
+		,	_nSlots(nSlots)
+		,	_nBatchSize(nBatchSize)
+		,	_nThreshold(nBatchSize)
+		,	_nDeadline(0)
+		,	_nContainerId(nContainerId)
+		,	_pBatches(NULL)
+		,	_pProtect(NULL)
+		,	_pDriver(NULL)
+		,	_pFactory(NULL)
+		,	_pRouter(NULL)
+		,	_Allocator()
+		,	_pTickSource(NULL)
+		,	_nBatched(0)
+		,	_nContainers(0)
+		,	_nReceiveErrors(0)
+	{
+		assert_param( _nSlots > 0 );
+	}
+
+	/// <summary>
+	/// Destructor. Pending messages are discarded, call Flush first to send them.
+	/// </summary>
+	template<class IMessage>
+	scMessageBatcher<IMessage>::~scMessageBatcher()
+	{
+		if ( _pBatches != NULL )
+		{
+			for( uint8_t i=0; i < _nSlots; ++i )
+			{
+				_Allocator.Destroy( _pBatches[i]._pBuffer );
+			}
+			_Allocator.Destroy( _pBatches );
+			_pBatches = NULL;
+		}
+	}
+
+	/// <summary>
+	/// Allocate the batch buffers.
+	/// </summary>
+	/// <param name="allocator">Allocator used for the batch buffers.</param>
+	/// <param name="pProtect">Mutex protecting the batches.</param>
+	/// <param name="pDriver">Driver the messages are sent to.</param>
+	template<class IMessage>
+	uint32_t scMessageBatcher<IMessage>::Initialize( scAllocator allocator, scIMutex* pProtect, HAL::scBufferIODriver* pDriver )
+	{
+		assert_param( pProtect != NULL );
+		assert_param( pDriver != NULL );
+
+		_pProtect = pProtect;
+		_pDriver = pDriver;
+		_Allocator = allocator;
+
+		_pBatches = reinterpret_cast<Batch_t*>( _Allocator.Allocate( _nSlots * sizeof(Batch_t), true ) );
+		if ( _pBatches != NULL )
+		{
+			memset( _pBatches, 0, _nSlots * sizeof(Batch_t) );
+			for( uint8_t i=0; i < _nSlots; ++i )
+			{
+				_pBatches[i]._pBuffer = _Allocator.Allocate( _nBatchSize, true );
+				if ( _pBatches[i]._pBuffer == NULL )
+				{
+					_nLastError = ERROR_SC_MEMORY_ALLOCATION_FAILURE;
+				}
+			}
+		}
+		else
+		{
+			_nLastError = ERROR_SC_MEMORY_ALLOCATION_FAILURE;
+		}
+
+		if ( _nLastError != ERROR_SUCCESS )
+		{
+			scDebugManager::Instance()->Trace( scDEBUGLABEL_ERROR_MESSAGE,
+				"scMessageBatcher: Unable to allocate the batch buffers.\n\r" );
+		}
+
+		return _nLastError;
+	}
+
+	/// <summary>
+	/// Queue a message for sending. The message contents are copied so the caller
+	/// keeps ownership of the message. Messages too large to batch are sent at once
+	/// after the pending batch for the same destination.
+	/// </summary>
+	/// <param name="pMessage">The message to send.</param>
+	template<class IMessage>
+	uint32_t scMessageBatcher<IMessage>::Send( const IMessage* pMessage )
+	{
+		assert_param( _pProtect != NULL );
+
+		uint32_t nResult = ERROR_SUCCESS;
+
+		if ( pMessage != NULL )
+		{
+			scScopeLock		protect( _pProtect );
+			uint16_t		nDestination = pMessage->Header().Destination();
+			uint32_t		nLength = pMessage->LengthOfMessage();
+			Batch_t&		batch = FindBatch( nDestination );
+
+			if ( nLength > _nBatchSize )
+			{
+				// keep the order with the messages already waiting
+				SendBatch( batch );
+				nResult = _pDriver->Send_n( pMessage->Buffer(), nLength );
+			}
+			else
+			{
+				if ( batch._nFill + nLength > _nBatchSize )
+				{
+					SendBatch( batch );
+				}
+
+				if ( batch._nCount == 0 )
+				{
+					batch._nDestination = nDestination;
+					batch._nSource = pMessage->Header().Source();
+					batch._nStart = Now();
+				}
+
+				memcpy( batch._pBuffer + batch._nFill, pMessage->Buffer(), nLength );
+				batch._nFill += nLength;
+				batch._nCount++;
+
+				if ( batch._nFill >= _nThreshold )
+				{
+					SendBatch( batch );
+					nResult = _pDriver->GetLastError();
+				}
+			}
+		}
+
+		if ( pMessage != NULL && _pFactory != NULL )
+		{
+			_pFactory->Stamp( pMessage, scMESSAGE_STAGE_FRAMED );
+		}
+
+		return nResult;
+	}
+
+	/// <summary>
+	/// Send all the pending batches.
+	/// </summary>
+	template<class IMessage>
+	void scMessageBatcher<IMessage>::Flush(void)
+	{
+		assert_param( _pProtect != NULL );
+
+		scScopeLock		protect( _pProtect );
+		for( uint8_t i=0; i < _nSlots; ++i )
+		{
+			SendBatch( _pBatches[i] );
+		}
+	}
+
+	/// <summary>
+	/// Send the pending batch for a single destination.
+	/// </summary>
+	/// <param name="nDestination">Destination address.</param>
+	template<class IMessage>
+	void scMessageBatcher<IMessage>::Flush( uint16_t nDestination )
+	{
+		assert_param( _pProtect != NULL );
+
+		scScopeLock		protect( _pProtect );
+		for( uint8_t i=0; i < _nSlots; ++i )
+		{
+			if ( _pBatches[i]._nCount > 0 && _pBatches[i]._nDestination == nDestination )
+			{
+				SendBatch( _pBatches[i] );
+			}
+		}
+	}
+
+	/// <summary>
+	/// Send the batches that have been waiting longer than the deadline. Call this
+	/// periodically from the owning task.
+	/// </summary>
+	template<class IMessage>
+	void scMessageBatcher<IMessage>::Poll(void)
+	{
+		assert_param( _pProtect != NULL );
+		scPROFILE_SCOPE( scPROBE_BATCHER_POLL );
+
+		if ( _pTickSource != NULL )
+		{
+			scScopeLock		protect( _pProtect );
+			uint32_t		nNow = Now();
+			for( uint8_t i=0; i < _nSlots; ++i )
+			{
+				if ( _pBatches[i]._nCount > 0 && ( nNow - _pBatches[i]._nStart ) >= _nDeadline )
+				{
+					SendBatch( _pBatches[i] );
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Deliver a received message to the router, splitting containers into the
+	/// individual messages. The caller keeps ownership of the message.
+	/// </summary>
+	/// <param name="pMessage">The received message.</param>
+	/// <returns>Number of messages delivered.</returns>
+	template<class IMessage>
+	uint16_t scMessageBatcher<IMessage>::Receive( const IMessage* pMessage )
+	{
+		assert_param( _pRouter != NULL );
+
+		uint16_t nResult = 0;
+
+		if ( pMessage == NULL )
+		{
+		}
+		else if ( ( pMessage->Header().Flags() & STANDARD_HEADER_FLAG_BATCH ) == 0 )
+		{
+			_pRouter->Dispatch( pMessage );
+			nResult = 1;
+		}
+		else
+		{
+			assert_param( _pFactory != NULL );
+
+			const uint8_t*	pData = pMessage->Buffer() + pMessage->LengthOfHeader();
+			uint32_t		nRemain = pMessage->LengthOfPayload();
+
+			while( nRemain > 0 )
+			{
+				// The inner message is copied out so a handler may keep it after the
+				// container has been released.
+				IMessage	inner( pData, nRemain );
+				uint32_t	nLength = inner.LengthOfMessage();
+
+				if ( nRemain < inner.LengthOfHeader() ||
+					 !inner.Header().Valid() ||
+					 inner.LengthOfPayload() > ( nRemain - inner.LengthOfHeader() ) )
+				{
+					scDebugManager::Instance()->Trace( scDEBUGLABEL_WARNING_MESSAGE,
+						"scMessageBatcher: Damaged container, %u bytes dropped.\n\r", nRemain );
+					_nReceiveErrors++;
+					break;
+				}
+
+				inner = IMessage( pData, nLength );
+				IMessage* pCopy = _pFactory->Copy( &inner );
+				if ( pCopy != NULL )
+				{
+					_pRouter->Dispatch( pCopy );
+					_pFactory->Release( pCopy );
+					nResult++;
+				}
+
+				pData += nLength;
+				nRemain -= nLength;
+			}
+		}
+
+		return nResult;
+	}
+
+//////////////////////////////////////////////////////////////////////////////////////
+/// Private Methods
+//////////////////////////////////////////////////////////////////////////////////////
+
+	/// <summary>
+	/// Write the batch to the driver and empty the slot. Must be called with the lock.
+	/// </summary>
+	template<class IMessage>
+	void scMessageBatcher<IMessage>::SendBatch( Batch_t& batch )
+	{
+		if ( batch._nCount == 1 )
+		{
+			// no point in wrapping a single message
+			_pDriver->Send_n( batch._pBuffer, batch._nFill );
+		}
+		else if ( batch._nCount > 1 )
+		{
+			Header_t	header;
+			header.SetFlags( STANDARD_HEADER_FLAG_BATCH );
+			header.SetDestination( batch._nDestination );
+			header.SetSource( batch._nSource );
+			header.SetId( _nContainerId );
+			header.SetLength( batch._nFill );
+			header.UpdateChecksum();
+
+			scIOSpan_t	spans[2];
+			spans[0]._pData = reinterpret_cast<const uint8_t*>( &header.Data() );
+			spans[0]._nLength = sizeof(scStandardHeader_t);
+			spans[1]._pData = batch._pBuffer;
+			spans[1]._nLength = batch._nFill;
+			_pDriver->Send_v( &spans[0], 2 );
+
+			_nBatched += batch._nCount;
+			_nContainers++;
+		}
+
+		batch._nFill = 0;
+		batch._nCount = 0;
+	}
+
+	/// <summary>
+	/// Locate the slot for a destination, making room if necessary. Must be called
+	/// with the lock.
+	/// </summary>
+	template<class IMessage>
+	typename scMessageBatcher<IMessage>::Batch_t& scMessageBatcher<IMessage>::FindBatch( uint16_t nDestination )
+	{
+		Batch_t*	pFree = NULL;
+		Batch_t*	pOldest = &_pBatches[0];
+		uint32_t	nNow = Now();
+
+		for( uint8_t i=0; i < _nSlots; ++i )
+		{
+			Batch_t& batch = _pBatches[i];
+			if ( batch._nCount == 0 )
+			{
+				if ( pFree == NULL )
+				{
+					pFree = &batch;
+				}
+			}
+			else if ( batch._nDestination == nDestination )
+			{
+				return batch;
+			}
+			else if ( ( nNow - batch._nStart ) > ( nNow - pOldest->_nStart ) )
+			{
+				pOldest = &batch;
+			}
+		}
+
+		if ( pFree == NULL )
+		{
+			// all slots are busy, send the batch that has waited the longest
+			SendBatch( *pOldest );
+			pFree = pOldest;
+		}
+		return *pFree;
+	}
+
+}
+#endif // !defined(__SCMESSAGEBATCHER_H__INCLUDED_)
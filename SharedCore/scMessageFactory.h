@@ -38,6 +38,11 @@
 #include "scIAllocator.h"
 #include "scIMutex.h"
 #include "scDebugManager.h"
+#include "scTrace.h"
+#include "scTimeline.h"
+#include "scMetrics.h"
+#include "scFormat.h"
+#include "scHiResClock.h"
 #include "scRingBuffer.h"
 #include "scScopeLock.h"
 #include "scDebugLabelCodes.h"
@@ -49,9 +54,101 @@
 #define assert_param(X)	if ( !(X) ) { for(;;) ; }
 #endif
 
+// Failure messages of Create allowed per second and at once, so an overload does
+// not flood the debug output. Define them in scConf.h to change them.
+#ifndef SC_FACTORY_TRACE_RATE
+	#define SC_FACTORY_TRACE_RATE		(2)
+#endif
+#ifndef SC_FACTORY_TRACE_BURST
+	#define SC_FACTORY_TRACE_BURST		(4)
+#endif
+
+// Latency tracking of the messages, the time each one spends in the pipeline. Off
+// by default as it adds to every record and to every Create and Release. Also the
+// number of message IDs tracked, and the age in microseconds after which a message
+// still in use is a probable leak. Define them in scConf.h to change them.
+#ifndef SC_FACTORY_LATENCY_ENABLED
+	#define SC_FACTORY_LATENCY_ENABLED	(0)
+#endif
+#ifndef SC_FACTORY_LATENCY_IDS
+	#define SC_FACTORY_LATENCY_IDS		(16)
+#endif
+#ifndef SC_FACTORY_LEAK_THRESHOLD
+	#define SC_FACTORY_LEAK_THRESHOLD	(1000000)
+#endif
+
 
 namespace SharedCore
 {
+	/// <summary>
+	/// Points in the pipeline a message passes, recorded by scMessageFactory::Stamp.
+	/// The creation and the final release are recorded by the factory itself.
+	/// </summary>
+	typedef enum
+	{
+		/// <summary>
+		/// The message was framed for sending, such as added to a batch.
+		/// </summary>
+		scMESSAGE_STAGE_FRAMED,
+
+		/// <summary>
+		/// The message reached the router, the time before this is the queueing delay.
+		/// </summary>
+		scMESSAGE_STAGE_ROUTED,
+
+		/// <summary>
+		/// The handlers of the message returned.
+		/// </summary>
+		scMESSAGE_STAGE_HANDLED,
+
+		/// <summary>
+		/// Number of stages.
+		/// </summary>
+		scMESSAGE_STAGES
+	} scMessageStage_t;
+
+	/// <summary>
+	/// Latency of the messages of one ID, from creation to each stage and to the final
+	/// release, in microseconds.
+	/// </summary>
+	typedef struct
+	{
+		/// <summary>
+		/// The message ID.
+		/// </summary>
+		uint32_t		_nId;
+
+		/// <summary>
+		/// Number of messages released.
+		/// </summary>
+		uint32_t		_nCount;
+
+		/// <summary>
+		/// Total and longest time from creation to the final release.
+		/// </summary>
+		uint64_t		_nLifetime;
+		uint32_t		_nLifetimeMax;
+
+		/// <summary>
+		/// Number of messages that reached each stage, and the total time from creation
+		/// to the stage.
+		/// </summary>
+		uint32_t		_nStaged[scMESSAGE_STAGES];
+		uint64_t		_nStageTime[scMESSAGE_STAGES];
+
+		/// <summary>
+		/// Longest queueing delay, from creation to scMESSAGE_STAGE_ROUTED.
+		/// </summary>
+		uint32_t		_nQueueingMax;
+
+		/// <summary>
+		/// Histograms of the lifetime and of the queueing delay, bucket n counts the
+		/// times from 2^n up to 2^(n+1) - 1, the last one everything longer.
+		/// </summary>
+		uint32_t		_nLifetimeBuckets[scMETRIC_BUCKETS];
+		uint32_t		_nQueueingBuckets[scMETRIC_BUCKETS];
+	} scMessageLatency_t;
+
 	/// <summary>
 	/// The message factory is used to provide two services. The first is to create
 	/// messages for each message ID in the system. This is handled by application
@@ -150,6 +247,39 @@ namespace SharedCore
 		/// </summary>
 		uint16_t MessagesInUse(void) const;
 
+		/// <summary>
+		/// Record the time a message reached a stage of the pipeline, only the first
+		/// time is kept. Does nothing unless SC_FACTORY_LATENCY_ENABLED is set, or when
+		/// the message is not one of the factory.
+		/// </summary>
+		/// <param name="pMessage">The message.</param>
+		/// <param name="nStage">The stage it reached.</param>
+		void Stamp( const IMessage* pMessage, scMessageStage_t nStage );
+
+		/// <summary>
+		/// Obtain the latency of the messages of one ID released so far.
+		/// </summary>
+		/// <param name="nId">The message ID.</param>
+		/// <param name="latency">Receives the latency.</param>
+		/// <returns>false if no message of the ID was released, or the tracking is
+		/// not enabled.</returns>
+		bool Latency( uint32_t nId, scMessageLatency_t& latency ) const;
+
+		/// <summary>
+		/// Trace the latency of every message ID, the average and longest lifetime and
+		/// queueing delay, the average time to each stage and the lifetime histogram.
+		/// </summary>
+		/// <param name="nLabel">The debug label to trace with.</param>
+		void LatencyDump( uint16_t nLabel );
+
+		/// <summary>
+		/// Find the messages in use for longer than the threshold, most likely never
+		/// released, and trace each one as a warning.
+		/// </summary>
+		/// <param name="nThreshold">Age in microseconds.</param>
+		/// <returns>Number of messages found.</returns>
+		uint16_t CheckLeaks( uint32_t nThreshold = SC_FACTORY_LEAK_THRESHOLD );
+
 	protected:
 		/// <summary>
 		/// If an error occurs this value will reflect the last one.
@@ -247,6 +377,19 @@ namespace SharedCore
 			/// over when the max is reached.
 			/// </summary>
 			uint32_t		_nId;
+
+#if SC_FACTORY_LATENCY_ENABLED
+			/// <summary>
+			/// Time the message was created, in microseconds.
+			/// </summary>
+			uint32_t		_nCreated;
+
+			/// <summary>
+			/// Time each stage was reached, valid when its bit is set in _nStamped.
+			/// </summary>
+			uint32_t		_nStages[scMESSAGE_STAGES];
+			uint32_t		_nStamped;
+#endif
 		} InternalRecord_t;
 
 		typedef vector<InternalRecord_t*>	SlotVector_t;
@@ -305,6 +448,44 @@ namespace SharedCore
 		/// </summary>
 		scAllocator					_OverFlowAllocator;
 
+#if SC_FACTORY_LATENCY_ENABLED
+		/// <summary>
+		/// Latency of each message ID seen, in the order they were first released.
+		/// </summary>
+		scMessageLatency_t			_Latency[SC_FACTORY_LATENCY_IDS];
+
+		/// <summary>
+		/// Number of entries of _Latency used.
+		/// </summary>
+		uint16_t					_nLatencyIds;
+
+		/// <summary>
+		/// Messages not counted because _Latency was full.
+		/// </summary>
+		uint32_t					_nLatencyOverflow;
+#endif
+
+		/// <summary>
+		/// Add the lifetime and the stages of a message being released to the latency
+		/// of its ID. Must be called with the lock.
+		/// </summary>
+		void SampleLatency( InternalRecord_t* pRecord );
+
+		/// <summary>
+		/// Locate the record of a message. Must be called with the lock.
+		/// </summary>
+		InternalRecord_t* FindRecord( const IMessage* pMessage ) const;
+
+		/// <summary>
+		/// Bucket of a latency histogram a time falls in.
+		/// </summary>
+		static uint32_t LatencyBucket( uint32_t nValue );
+
+		/// <summary>
+		/// Trace the non empty buckets of a latency histogram on one line.
+		/// </summary>
+		static void LatencyBucketsDump( uint16_t nLabel, const char* pName, const uint32_t* pBuckets );
+
 		/// <summary>
 		/// This will loop through the vector table looking for an available message slot,
 		/// and will return the index in the table that contains the record to use. If a
@@ -387,6 +568,11 @@ namespace SharedCore
 		,	_OverFlowAllocator()
 		,	_nLastError(ERROR_SUCCESS)
 	{
+#if SC_FACTORY_LATENCY_ENABLED
+		memset( _Latency, 0, sizeof(_Latency) );
+		_nLatencyIds = 0;
+		_nLatencyOverflow = 0;
+#endif
 	}
 
 //////////////////////////////////////////////////////////////////////////////////////
@@ -498,6 +684,7 @@ namespace SharedCore
 	IMessage* scMessageFactory<IMessage>::Create( uint8_t* pBuffer, uint32_t nSize )
 	{
 		assert_param( _pProtoect != NULL );
+		scTIMELINE_SCOPE( "message", "Create" );
 
 		IMessage*		pResult = NULL;
 		scScopeLock		protect( _pProtoect );
@@ -514,10 +701,10 @@ namespace SharedCore
 		}
 		else
 		{
-			scDebugManager::Instance()->Trace( 
-				scDEBUGLABEL_WARNING_MESSAGE, 
+			scTRACE_LIMITED( scDEBUGLABEL_WARNING_MESSAGE, SC_FACTORY_TRACE_RATE, SC_FACTORY_TRACE_BURST,
 				"scMessageFactory: No record slots open.\n\r" );
 			_nLastError = ERROR_SC_MESSAGEFACTORY_FULL;
+			scMETRIC_ADD( scMETRIC_FACTORY_FAILURES, 1 );
 		}
 
 		return pResult;
@@ -533,6 +720,7 @@ namespace SharedCore
 	IMessage* scMessageFactory<IMessage>::Create( uint32_t nSize )
 	{
 		assert_param( _pProtoect != NULL );
+		scTIMELINE_SCOPE( "message", "Create" );
 
 		IMessage*		pResult = NULL;
 		scScopeLock		protect( _pProtoect );
@@ -544,7 +732,7 @@ namespace SharedCore
 		}
 		else
 		{
-			scDebugManager::Instance()->Trace( scDEBUGLABEL_ERROR_MESSAGE, 
+			scTRACE_LIMITED( scDEBUGLABEL_ERROR_MESSAGE, SC_FACTORY_TRACE_RATE, SC_FACTORY_TRACE_BURST,
 				"scMessageFactory: Create failure memory full. %u bytes\n\r", nSize );
 			_nLastError = ERROR_SC_MESSAGEFACTORY_FULL;
 		}
@@ -562,6 +750,7 @@ namespace SharedCore
 	IMessage* scMessageFactory<IMessage>::Create( scRingBuffer* pRing )
 	{
 		assert_param( _pProtoect != NULL );
+		scTIMELINE_SCOPE( "message", "Create" );
 
 		IMessage*		pResult = NULL;
 		scScopeLock		protect( _pProtoect );
@@ -578,10 +767,10 @@ namespace SharedCore
 		}
 		else
 		{
-			scDebugManager::Instance()->Trace( 
-				scDEBUGLABEL_WARNING_MESSAGE, 
+			scTRACE_LIMITED( scDEBUGLABEL_WARNING_MESSAGE, SC_FACTORY_TRACE_RATE, SC_FACTORY_TRACE_BURST,
 				"scMessageFactory: No record slots open.\n\r" );
 			_nLastError = ERROR_SC_MESSAGEFACTORY_FULL;
+			scMETRIC_ADD( scMETRIC_FACTORY_FAILURES, 1 );
 		}
 
 		return pResult;
@@ -596,6 +785,7 @@ namespace SharedCore
 	IMessage* scMessageFactory<IMessage>::Copy( const IMessage* pMessage )
 	{
 		assert_param( _pProtoect != NULL );
+		scTIMELINE_SCOPE( "message", "Copy" );
 
 		IMessage*		pResult = NULL;
 		scScopeLock		protect( _pProtoect );
@@ -617,7 +807,7 @@ namespace SharedCore
 			}
 			else
 			{
-				scDebugManager::Instance()->Trace( scDEBUGLABEL_ERROR_MESSAGE, 
+				scTRACE_LIMITED( scDEBUGLABEL_ERROR_MESSAGE, SC_FACTORY_TRACE_RATE, SC_FACTORY_TRACE_BURST,
 					"scMessageFactory: Copy failure memory full. %u bytes\n\r", nSize );
 				_nLastError = ERROR_SC_MESSAGEFACTORY_FULL;
 			}
@@ -668,19 +858,10 @@ namespace SharedCore
 		if ( pMessage != NULL )
 		{
 			assert_param( _pProtoect != NULL );
+			scTIMELINE_SCOPE( "message", "Release" );
 
 			scScopeLock			protect( _pProtoect );
-			InternalRecord_t*	pRecord = NULL;
-
-			// First locate the record for this message
-			SlotVector_t::iterator itr = _Records.begin();
-			for( ; pRecord == NULL && itr != _Records.end(); ++itr )
-			{
-				if ( (*itr)->_pMessage == pMessage )
-				{
-					pRecord = (*itr);
-				}
-			}
+			InternalRecord_t*	pRecord = FindRecord( pMessage );
 
 			if ( pRecord != NULL && pRecord->_nInUse > 0 )
 			{
@@ -732,12 +913,13 @@ namespace SharedCore
 							break;
 						}
 					}
+					SampleLatency( pRecord );
 					ClearInUse( pRecord );
+					scMETRIC_SUBTRACT( scMETRIC_FACTORY_IN_USE, 1 );
 					bResult = true;
 				}
 
-				// This is a point where a check for old messages could be performed.
-				// leaving out for now.
+				// Messages held for too long are found by CheckLeaks.
 			}
 			else
 			{
@@ -762,20 +944,177 @@ namespace SharedCore
 		scDebugManager* pDm = scDebugManager::Instance();
 		pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "scMessageFactory: Records Dump\n\r" );
 
-		size_t i = 0;
+		// The arguments are type checked, so the size_t index and the enum are safe to
+		// pass on any target. The line is formatted on the stack, not in the working
+		// buffer of the debug manager.
+		char	sLine[80];
+		size_t	i = 0;
 		SlotVector_t::iterator itr = _Records.begin();
 		for( ; itr != _Records.end(); itr++ )
 		{
-			pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, 
+			scFormat::Format( sLine, sizeof(sLine),
 				"MessageFactory: [%u] %s, %u, #%u, %u\n\r",
 				i++,
 				((*itr)->_nInUse == 0 ? "Open" : "Used" ),
 				(*itr)->_pMessage->GetID(),	// this could cause problems later
 				(*itr)->_nSize,
-				(*itr)->_BufferType );
+				(int)(*itr)->_BufferType );
+			pDm->Trace_Info( scDEBUGLABEL_INFO_MESSAGE, sLine );
 		}
 	}
 
+	/// <summary>
+	/// Record the time a message reached a stage of the pipeline, only the first
+	/// time is kept. Does nothing unless SC_FACTORY_LATENCY_ENABLED is set, or when
+	/// the message is not one of the factory.
+	/// </summary>
+	/// <param name="pMessage">The message.</param>
+	/// <param name="nStage">The stage it reached.</param>
+	template<class IMessage>
+	void scMessageFactory<IMessage>::Stamp( const IMessage* pMessage, scMessageStage_t nStage )
+	{
+#if SC_FACTORY_LATENCY_ENABLED
+		if ( pMessage != NULL && nStage < scMESSAGE_STAGES )
+		{
+			assert_param( _pProtoect != NULL );
+
+			scScopeLock			protect( _pProtoect );
+			InternalRecord_t*	pRecord = FindRecord( pMessage );
+
+			if ( pRecord != NULL && pRecord->_nInUse > 0 && ( pRecord->_nStamped & ( 1UL << nStage ) ) == 0 )
+			{
+				pRecord->_nStages[nStage] = scHiResClock::Timestamp();
+				pRecord->_nStamped |= ( 1UL << nStage );
+			}
+		}
+#else
+		(void)pMessage;
+		(void)nStage;
+#endif
+	}
+
+	/// <summary>
+	/// Obtain the latency of the messages of one ID released so far.
+	/// </summary>
+	/// <param name="nId">The message ID.</param>
+	/// <param name="latency">Receives the latency.</param>
+	/// <returns>false if no message of the ID was released, or the tracking is
+	/// not enabled.</returns>
+	template<class IMessage>
+	bool scMessageFactory<IMessage>::Latency( uint32_t nId, scMessageLatency_t& latency ) const
+	{
+		bool bResult = false;
+
+#if SC_FACTORY_LATENCY_ENABLED
+		assert_param( _pProtoect != NULL );
+		scScopeLock		protect( _pProtoect );
+
+		for( uint16_t i=0; !bResult && i < _nLatencyIds; ++i )
+		{
+			if ( _Latency[i]._nId == nId )
+			{
+				latency = _Latency[i];
+				bResult = true;
+			}
+		}
+#else
+		(void)nId;
+		(void)latency;
+#endif
+		return bResult;
+	}
+
+	/// <summary>
+	/// Trace the latency of every message ID, the average and longest lifetime and
+	/// queueing delay, the average time to each stage and the lifetime histogram.
+	/// </summary>
+	/// <param name="nLabel">The debug label to trace with.</param>
+	template<class IMessage>
+	void scMessageFactory<IMessage>::LatencyDump( uint16_t nLabel )
+	{
+#if SC_FACTORY_LATENCY_ENABLED
+		assert_param( _pProtoect != NULL );
+
+		scScopeLock		protect( _pProtoect );
+		scDebugManager* pDm = scDebugManager::Instance();
+		pDm->Trace( nLabel, "scMessageFactory: Latency Dump, %u not tracked\n\r", _nLatencyOverflow );
+
+		char	sLine[160];
+		for( uint16_t i=0; i < _nLatencyIds; ++i )
+		{
+			const scMessageLatency_t&	latency = _Latency[i];
+			uint32_t					nAverage[scMESSAGE_STAGES];
+
+			for( uint32_t s=0; s < scMESSAGE_STAGES; ++s )
+			{
+				nAverage[s] = ( latency._nStaged[s] > 0 ) ? (uint32_t)( latency._nStageTime[s] / latency._nStaged[s] ) : 0;
+			}
+
+			scFormat::Format( sLine, sizeof(sLine),
+				"MessageFactory: id %u, %u released, lifetime %u us max %u, queueing %u us max %u\n\r",
+				latency._nId,
+				latency._nCount,
+				( latency._nCount > 0 ) ? (uint32_t)( latency._nLifetime / latency._nCount ) : 0,
+				latency._nLifetimeMax,
+				nAverage[scMESSAGE_STAGE_ROUTED],
+				latency._nQueueingMax );
+			pDm->Trace_Info( nLabel, sLine );
+
+			scFormat::Format( sLine, sizeof(sLine),
+				"  stages framed %u us, routed %u us, handled %u us\n\r",
+				nAverage[scMESSAGE_STAGE_FRAMED],
+				nAverage[scMESSAGE_STAGE_ROUTED],
+				nAverage[scMESSAGE_STAGE_HANDLED] );
+			pDm->Trace_Info( nLabel, sLine );
+
+			LatencyBucketsDump( nLabel, "lifetime", latency._nLifetimeBuckets );
+			LatencyBucketsDump( nLabel, "queueing", latency._nQueueingBuckets );
+		}
+#else
+		(void)nLabel;
+#endif
+	}
+
+	/// <summary>
+	/// Find the messages in use for longer than the threshold, most likely never
+	/// released, and trace each one as a warning.
+	/// </summary>
+	/// <param name="nThreshold">Age in microseconds.</param>
+	/// <returns>Number of messages found.</returns>
+	template<class IMessage>
+	uint16_t scMessageFactory<IMessage>::CheckLeaks( uint32_t nThreshold )
+	{
+		uint16_t nCount = 0;
+
+#if SC_FACTORY_LATENCY_ENABLED
+		assert_param( _pProtoect != NULL );
+
+		scScopeLock		protect( _pProtoect );
+		scDebugManager* pDm = scDebugManager::Instance();
+		uint32_t		nNow = scHiResClock::Timestamp();
+		char			sLine[100];
+
+		SlotVector_t::iterator itr = _Records.begin();
+		for( ; itr != _Records.end(); ++itr )
+		{
+			uint32_t nAge = nNow - (*itr)->_nCreated;
+			if ( (*itr)->_nInUse > 0 && nAge > nThreshold )
+			{
+				scFormat::Format( sLine, sizeof(sLine),
+					"scMessageFactory: Message #%u id %u in use %u us, probable leak\n\r",
+					(*itr)->_nId,
+					(uint32_t)(*itr)->_pMessage->GetID(),
+					nAge );
+				pDm->Trace_Info( scDEBUGLABEL_WARNING_MESSAGE, sLine );
+				nCount++;
+			}
+		}
+#else
+		(void)nThreshold;
+#endif
+		return nCount;
+	}
+
 //////////////////////////////////////////////////////////////////////////////////////
 /// Private Methods
 //////////////////////////////////////////////////////////////////////////////////////
@@ -817,8 +1156,15 @@ namespace SharedCore
 		pRecord->_nSize				= nSize;
 		pRecord->_BufferType		= nType;
 		pRecord->_nId				= _nMessageCounter++;
+#if SC_FACTORY_LATENCY_ENABLED
+		pRecord->_nCreated			= scHiResClock::Timestamp();
+		pRecord->_nStamped			= 0;
+#endif
 
 		++_nInUseCounter;
+		scMETRIC_ADD( scMETRIC_FACTORY_CREATES, 1 );
+		scMETRIC_ADD( scMETRIC_FACTORY_IN_USE, 1 );
+		scMETRIC_SAMPLE( scMETRIC_FACTORY_SIZE, nSize );
 	}
 
 	/// <summary>
@@ -854,10 +1200,10 @@ namespace SharedCore
 		{
 			if ( !NextAvailableRecord( nIndex ) )
 			{
-				scDebugManager::Instance()->Trace( 
-				scDEBUGLABEL_WARNING_MESSAGE, 
-				"scMessageFactory: No record slots open.\n\r" );
+				scTRACE_LIMITED( scDEBUGLABEL_WARNING_MESSAGE, SC_FACTORY_TRACE_RATE, SC_FACTORY_TRACE_BURST,
+					"scMessageFactory: No record slots open.\n\r" );
 				_nLastError = ERROR_SC_MESSAGEFACTORY_FULL;
+				scMETRIC_ADD( scMETRIC_FACTORY_FAILURES, 1 );
 				break;
 			}
 
@@ -874,10 +1220,10 @@ namespace SharedCore
 
 			if ( pBuffer == NULL )
 			{
-				scDebugManager::Instance()->Trace( 
-								scDEBUGLABEL_ERROR_MESSAGE, 
-								"scMessageFactory: Message too Large %u bytes.\n\r", nSize );
+				scTRACE_LIMITED( scDEBUGLABEL_ERROR_MESSAGE, SC_FACTORY_TRACE_RATE, SC_FACTORY_TRACE_BURST,
+					"scMessageFactory: Message too Large %u bytes.\n\r", nSize );
 				_nLastError = ERROR_SC_MEMORY_ALLOCATION_FAILURE;
+				scMETRIC_ADD( scMETRIC_FACTORY_FAILURES, 1 );
 				*pRecord = NULL;
 				break;
 			}
@@ -910,7 +1256,7 @@ namespace SharedCore
 			if ( (*itr)->_nInUse > 0 && (*itr)->_BufferType == mem_LocalBuffer && (*itr)->_nSize > 0 )
 			{
 				pRecordBuffer = reinterpret_cast<uint8_t*>((*itr)->_pBuffer);
-				if ( pRangeEnd == NULL || (pRecordBuffer < pRangeEnd) )
+				if ( pRangeStart == NULL || (pRecordBuffer < pRangeStart) )
 				{
 					pRangeStart = pRecordBuffer;
 				}
@@ -946,6 +1292,128 @@ namespace SharedCore
 		return pStart;
 	}
 
+	/// <summary>
+	/// Add the lifetime and the stages of a message being released to the latency
+	/// of its ID. Must be called with the lock.
+	/// </summary>
+	template<class IMessage>
+	void scMessageFactory<IMessage>::SampleLatency( InternalRecord_t* pRecord )
+	{
+#if SC_FACTORY_LATENCY_ENABLED
+		uint32_t			nId = (uint32_t)pRecord->_pMessage->GetID();
+		scMessageLatency_t*	pLatency = NULL;
+
+		for( uint16_t i=0; pLatency == NULL && i < _nLatencyIds; ++i )
+		{
+			if ( _Latency[i]._nId == nId )
+			{
+				pLatency = &_Latency[i];
+			}
+		}
+		if ( pLatency == NULL && _nLatencyIds < SC_FACTORY_LATENCY_IDS )
+		{
+			pLatency = &_Latency[_nLatencyIds++];
+			pLatency->_nId = nId;
+		}
+
+		if ( pLatency != NULL )
+		{
+			uint32_t nLifetime = scHiResClock::Timestamp() - pRecord->_nCreated;
+
+			pLatency->_nCount++;
+			pLatency->_nLifetime += nLifetime;
+			if ( nLifetime > pLatency->_nLifetimeMax )
+			{
+				pLatency->_nLifetimeMax = nLifetime;
+			}
+			pLatency->_nLifetimeBuckets[ LatencyBucket( nLifetime ) ]++;
+
+			for( uint32_t s=0; s < scMESSAGE_STAGES; ++s )
+			{
+				if ( ( pRecord->_nStamped & ( 1UL << s ) ) != 0 )
+				{
+					uint32_t nTime = pRecord->_nStages[s] - pRecord->_nCreated;
+
+					pLatency->_nStaged[s]++;
+					pLatency->_nStageTime[s] += nTime;
+					if ( s == scMESSAGE_STAGE_ROUTED )
+					{
+						if ( nTime > pLatency->_nQueueingMax )
+						{
+							pLatency->_nQueueingMax = nTime;
+						}
+						pLatency->_nQueueingBuckets[ LatencyBucket( nTime ) ]++;
+					}
+				}
+			}
+		}
+		else
+		{
+			_nLatencyOverflow++;
+		}
+#else
+		(void)pRecord;
+#endif
+	}
+
+	/// <summary>
+	/// Locate the record of a message. Must be called with the lock.
+	/// </summary>
+	template<class IMessage>
+	typename scMessageFactory<IMessage>::InternalRecord_t* scMessageFactory<IMessage>::FindRecord( const IMessage* pMessage ) const
+	{
+		InternalRecord_t*	pRecord = NULL;
+
+		SlotVector_t::const_iterator itr = _Records.begin();
+		for( ; pRecord == NULL && itr != _Records.end(); ++itr )
+		{
+			if ( (*itr)->_pMessage == pMessage )
+			{
+				pRecord = (*itr);
+			}
+		}
+		return pRecord;
+	}
+
+	/// <summary>
+	/// Bucket of a latency histogram a time falls in, the power of two below it.
+	/// </summary>
+	template<class IMessage>
+	uint32_t scMessageFactory<IMessage>::LatencyBucket( uint32_t nValue )
+	{
+		uint32_t nBucket = 0;
+
+		while( ( nValue >>= 1 ) != 0 && nBucket < scMETRIC_BUCKETS - 1 )
+		{
+			nBucket++;
+		}
+		return nBucket;
+	}
+
+	/// <summary>
+	/// Trace the non empty buckets of a latency histogram, each as the lower bound
+	/// of the bucket in microseconds and its count.
+	/// </summary>
+	/// <param name="nLabel">The debug label to trace with.</param>
+	/// <param name="pName">Name of the histogram starting the line.</param>
+	/// <param name="pBuckets">scMETRIC_BUCKETS counts.</param>
+	template<class IMessage>
+	void scMessageFactory<IMessage>::LatencyBucketsDump( uint16_t nLabel, const char* pName, const uint32_t* pBuckets )
+	{
+		char		sLine[160];
+		uint32_t	nLength = scFormat::Format( sLine, sizeof(sLine), "  %s buckets", pName );
+
+		for( uint32_t b=0; b < scMETRIC_BUCKETS && nLength < sizeof(sLine); ++b )
+		{
+			if ( pBuckets[b] != 0 )
+			{
+				nLength += scFormat::Format( sLine + nLength, sizeof(sLine) - nLength, " %u:%u",
+					( b == 0 ) ? 0 : ( 1UL << b ), pBuckets[b] );
+			}
+		}
+		scDebugManager::Instance()->Trace( nLabel, "%s\n\r", sLine );
+	}
+
 	/// <summary>
 	/// Will obtain the number of message slots available
 	/// </summary>
@@ -0,0 +1,327 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scMessageFragmenter.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCMESSAGEFRAGMENTER_H__INCLUDED_)
+#define __SCMESSAGEFRAGMENTER_H__INCLUDED_
+
+#include "scTypes.h"
+#include "scErrorCodes.h"
+#include "scStandardHeader_t.h"
+#include "scMessageFactory.h"
+#include "scReliableLink.h"
+
+
+#ifndef assert_param
+#define assert_param(X)	if ( !(X) ) { for(;;) ; }
+#endif
+
+
+namespace SharedCore
+{
+	/// <summary>
+	/// Sends a block of data that is too large for a single message as a series of
+	/// fragment messages. Each fragment is marked with STANDARD_HEADER_FLAG_FRAGMENT
+	/// and carries a scFragmentHeader_t ahead of the data. Every fragment is built as
+	/// a message of the factory, no larger than the fragment size, and handed to a
+	/// send hook, normally scReliableLink::Send so a lost fragment is sent again. The
+	/// data can be supplied all at once or in parts as it becomes available, such as
+	/// while reading it from storage.
+	/// </summary>
+	template<class IMessage>
+	class scMessageFragmenter
+	{
+	public:
+		/// <summary>
+		/// Function the fragments are sent with. The fragmenter releases the message
+		/// once it returns, a hook that keeps it must take its own copy.
+		/// </summary>
+		typedef uint32_t (*SendHook_t)( const IMessage* pMessage, void* pContext );
+
+		/// <summary>
+		/// The state of a stream being sent. Owned by the caller.
+		/// </summary>
+		typedef struct
+		{
+			uint16_t						_nDestination;
+			uint16_t						_nSource;
+			typename IMessage::MsgType_t	_nId;
+			uint16_t						_nStream;
+			uint32_t						_nOffset;
+			uint32_t						_nTotal;
+		} Stream_t;
+
+		/// <summary>
+		/// Construct the fragmenter.
+		/// </summary>
+		/// <param name="nFragmentSize">Most data bytes placed in a single fragment.</param>
+		scMessageFragmenter( uint32_t nFragmentSize )
+			: _nFragmentSize( nFragmentSize )
+			, _nNextStream( 0 )
+			, _pFactory( NULL )
+			, _pSend( NULL )
+			, _pContext( NULL )
+		{
+			assert_param( _nFragmentSize > 0 );
+		}
+
+		/// <summary>
+		/// Simple destructor.
+		/// </summary>
+		virtual ~scMessageFragmenter() {}
+
+		/// <summary>
+		/// Set where the fragments are built and how they are sent.
+		/// </summary>
+		/// <param name="pFactory">Creates the fragment messages.</param>
+		/// <param name="pSend">Sends each fragment.</param>
+		/// <param name="pContext">Value passed to the hook.</param>
+		virtual uint32_t Initialize( scMessageFactory<IMessage>* pFactory, SendHook_t pSend, void* pContext )
+		{
+			assert_param( pFactory != NULL );
+			assert_param( pSend != NULL );
+			_pFactory = pFactory;
+			_pSend = pSend;
+			_pContext = pContext;
+			return ERROR_SUCCESS;
+		}
+
+		/// <summary>
+		/// Send the fragments over a reliable link.
+		/// </summary>
+		/// <param name="pFactory">Creates the fragment messages.</param>
+		/// <param name="pLink">The link, keeps each fragment until it is acknowledged.
+		/// </param>
+		uint32_t Initialize( scMessageFactory<IMessage>* pFactory, scReliableLink<IMessage>* pLink )
+		{
+			assert_param( pLink != NULL );
+			return Initialize( pFactory, &LinkSend, pLink );
+		}
+
+		/// <summary>
+		/// Start a new stream.
+		/// </summary>
+		/// <param name="stream">Receives the stream state.</param>
+		/// <param name="nDestination">Destination address.</param>
+		/// <param name="nSource">Source address.</param>
+		/// <param name="nId">Message ID used for every fragment.</param>
+		/// <param name="nTotal">Number of bytes that will be written to the stream.</param>
+		void Begin( Stream_t& stream, uint16_t nDestination, uint16_t nSource, typename IMessage::MsgType_t nId, uint32_t nTotal );
+
+		/// <summary>
+		/// Send the next part of the stream. Anything past the total given to Begin is
+		/// ignored. On an error the stream stops at the fragment that failed; _nOffset
+		/// of the stream tells how much was sent and the rest can be written again,
+		/// such as once the window of the link has room.
+		/// </summary>
+		/// <param name="stream">The stream state.</param>
+		/// <param name="pData">The data.</param>
+		/// <param name="nLength">Number of bytes.</param>
+		uint32_t Write( Stream_t& stream, const uint8_t* pData, uint32_t nLength );
+
+		/// <summary>
+		/// Send a complete block as a new stream.
+		/// </summary>
+		/// <param name="nDestination">Destination address.</param>
+		/// <param name="nSource">Source address.</param>
+		/// <param name="nId">Message ID used for every fragment.</param>
+		/// <param name="pData">The data.</param>
+		/// <param name="nLength">Number of bytes.</param>
+		uint32_t Send( uint16_t nDestination, uint16_t nSource, typename IMessage::MsgType_t nId, const uint8_t* pData, uint32_t nLength )
+		{
+			Stream_t stream;
+			Begin( stream, nDestination, nSource, nId, nLength );
+			return Write( stream, pData, nLength );
+		}
+
+		/// <summary>
+		/// Check if everything has been sent for the stream.
+		/// </summary>
+		/// <param name="stream">The stream state.</param>
+		static bool Complete( const Stream_t& stream )
+		{
+			return stream._nOffset >= stream._nTotal;
+		}
+
+	private:
+		typedef typename IMessage::HeaderType_t		Header_t;
+
+		/// <summary>
+		/// Most data bytes in a fragment.
+		/// </summary>
+		uint32_t					_nFragmentSize;
+
+		/// <summary>
+		/// Stream number used for the next stream.
+		/// </summary>
+		uint16_t					_nNextStream;
+
+		/// <summary>
+		/// Creates the fragment messages.
+		/// </summary>
+		scMessageFactory<IMessage>*	_pFactory;
+
+		/// <summary>
+		/// The fragments are sent with this hook.
+		/// </summary>
+		SendHook_t					_pSend;
+
+		/// <summary>
+		/// Value passed to the hook.
+		/// </summary>
+		void*						_pContext;
+
+		/// <summary>
+		/// Build and send a single fragment.
+		/// </summary>
+		uint32_t SendFragment( const Stream_t& stream, const uint8_t* pData, uint32_t nLength );
+
+		/// <summary>
+		/// Hook sending through a scReliableLink.
+		/// </summary>
+		static uint32_t LinkSend( const IMessage* pMessage, void* pContext )
+		{
+			return reinterpret_cast<scReliableLink<IMessage>*>( pContext )->Send( pMessage );
+		}
+	};
+
+//////////////////////////////////////////////////////////////////////////////////////
+/// Public Methods
+//////////////////////////////////////////////////////////////////////////////////////
+
+	/// <summary>
+	/// Start a new stream.
+	/// </summary>
+	/// <param name="stream">Receives the stream state.</param>
+	/// <param name="nDestination">Destination address.</param>
+	/// <param name="nSource">Source address.</param>
+	/// <param name="nId">Message ID used for every fragment.</param>
+	/// <param name="nTotal">Number of bytes that will be written to the stream.</param>
+	template<class IMessage>
+	void scMessageFragmenter<IMessage>::Begin( Stream_t& stream, uint16_t nDestination, uint16_t nSource, typename IMessage::MsgType_t nId, uint32_t nTotal )
+	{
+		stream._nDestination = nDestination;
+		stream._nSource = nSource;
+		stream._nId = nId;
+		stream._nStream = _nNextStream++;
+		stream._nOffset = 0;
+		stream._nTotal = nTotal;
+
+		// an empty block still needs one fragment so the receiver sees it
+		if ( nTotal == 0 )
+		{
+			SendFragment( stream, NULL, 0 );
+		}
+	}
+
+	/// <summary>
+	/// Send the next part of the stream. Anything past the total given to Begin is
+	/// ignored. On an error the stream stops at the fragment that failed.
+	/// </summary>
+	/// <param name="stream">The stream state.</param>
+	/// <param name="pData">The data.</param>
+	/// <param name="nLength">Number of bytes.</param>
+	template<class IMessage>
+	uint32_t scMessageFragmenter<IMessage>::Write( Stream_t& stream, const uint8_t* pData, uint32_t nLength )
+	{
+		assert_param( _pFactory != NULL && _pSend != NULL );
+
+		uint32_t nResult = ERROR_SUCCESS;
+
+		if ( nLength > stream._nTotal - stream._nOffset )
+		{
+			nLength = stream._nTotal - stream._nOffset;
+		}
+
+		while( nLength > 0 && nResult == ERROR_SUCCESS )
+		{
+			uint32_t nChunk = ( nLength < _nFragmentSize ) ? nLength : _nFragmentSize;
+
+			nResult = SendFragment( stream, pData, nChunk );
+			if ( nResult == ERROR_SUCCESS )
+			{
+				stream._nOffset += nChunk;
+				pData += nChunk;
+				nLength -= nChunk;
+			}
+		}
+
+		return nResult;
+	}
+
+//////////////////////////////////////////////////////////////////////////////////////
+/// Private Methods
+//////////////////////////////////////////////////////////////////////////////////////
+
+	/// <summary>
+	/// Build a single fragment as a message of the factory and send it.
+	/// </summary>
+	template<class IMessage>
+	uint32_t scMessageFragmenter<IMessage>::SendFragment( const Stream_t& stream, const uint8_t* pData, uint32_t nLength )
+	{
+		scFragmentHeader_t	fragment;
+		fragment._nStream = stream._nStream;
+		fragment._nOffset = stream._nOffset;
+		fragment._nTotal = stream._nTotal;
+
+		Header_t header;
+		header.SetFlags( STANDARD_HEADER_FLAG_FRAGMENT );
+		header.SetDestination( stream._nDestination );
+		header.SetSource( stream._nSource );
+		header.SetId( stream._nId );
+		header.SetLength( sizeof(scFragmentHeader_t) + nLength );
+		header.UpdateChecksum();
+
+		uint32_t	nSize = sizeof(scStandardHeader_t) + sizeof(scFragmentHeader_t) + nLength;
+		IMessage*	pMessage = _pFactory->Create( nSize );
+		if ( pMessage == NULL )
+		{
+			return _pFactory->GetLastError();
+		}
+
+		uint8_t* pBuffer = const_cast<uint8_t*>( pMessage->Buffer() );
+		memcpy( pBuffer, &header.Data(), sizeof(scStandardHeader_t) );
+		memcpy( pBuffer + sizeof(scStandardHeader_t), &fragment, sizeof(scFragmentHeader_t) );
+		if ( nLength > 0 )
+		{
+			memcpy( pBuffer + sizeof(scStandardHeader_t) + sizeof(scFragmentHeader_t), pData, nLength );
+		}
+		*pMessage = IMessage( pBuffer, nSize );
+
+		uint32_t nResult = _pSend( pMessage, _pContext );
+		_pFactory->Release( pMessage );
+		return nResult;
+	}
+
+}
+#endif // !defined(__SCMESSAGEFRAGMENTER_H__INCLUDED_)
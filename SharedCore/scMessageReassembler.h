@@ -0,0 +1,662 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scMessageReassembler.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCMESSAGEREASSEMBLER_H__INCLUDED_)
+#define __SCMESSAGEREASSEMBLER_H__INCLUDED_
+
+#include "scTypes.h"
+#include "scAllocator.h"
+#include "scIMutex.h"
+#include "scScopeLock.h"
+#include "scDebugManager.h"
+#include "scDebugLabelCodes.h"
+#include "scErrorCodes.h"
+#include "scStandardHeader_t.h"
+#include "scIFragmentSink.h"
+
+
+#ifndef assert_param
+#define assert_param(X)	if ( !(X) ) { for(;;) ; }
+#endif
+
+
+namespace SharedCore
+{
+	/// <summary>
+	/// Receives the fragments created by scMessageFragmenter and passes the data to a
+	/// sink as it arrives. Only the state of each stream is kept, never the data, so
+	/// the memory used depends on the number of streams and not on their size. The
+	/// fragments of a stream must arrive in order; on a link that can lose or reorder
+	/// messages the fragments should be sent through scReliableLink. A gap aborts the
+	/// stream, a repeated fragment is ignored. The last few completed streams are
+	/// remembered, for the length of the stream timeout, so a repeat of their first
+	/// fragment does not open them again. A sender that restarts its stream numbers
+	/// is only recognized once that time has passed, or at once if the size of the
+	/// block differs; without a timeout a completed stream is remembered until newer
+	/// ones push it out.
+	/// </summary>
+	template<class IMessage>
+	class scMessageReassembler
+	{
+	public:
+		/// <summary>
+		/// Function used to obtain a free running tick count for the stream timeout.
+		/// </summary>
+		typedef uint32_t (*TickSource_t)( void );
+
+		/// <summary>
+		/// Construct the reassembler.
+		/// </summary>
+		/// <param name="nStreams">Number of streams that can be received at one time.
+		/// </param>
+		scMessageReassembler( uint8_t nStreams );
+
+		/// <summary>
+		/// Destructor. Open streams are aborted.
+		/// </summary>
+		virtual ~scMessageReassembler();
+
+		/// <summary>
+		/// Allocate the stream table.
+		/// </summary>
+		/// <param name="allocator">Allocator used for the stream table.</param>
+		/// <param name="pProtect">Mutex protecting the stream table.</param>
+		/// <param name="pSink">Receives the data.</param>
+		virtual uint32_t Initialize( scAllocator allocator, scIMutex* pProtect, scIFragmentSink* pSink );
+
+		/// <summary>
+		/// Set the function used for the stream timeout. NULL disables the timeout.
+		/// </summary>
+		/// <param name="pSource">Tick function.</param>
+		void SetTickSource( TickSource_t pSource )
+		{
+			_pTickSource = pSource;
+		}
+
+		/// <summary>
+		/// Set how long a stream may go without a fragment before it is aborted, also
+		/// how long a completed stream is remembered.
+		/// </summary>
+		/// <param name="nTicks">Timeout in ticks of the tick source.</param>
+		void SetTimeout( uint32_t nTicks )
+		{
+			_nTimeout = nTicks;
+		}
+
+		/// <summary>
+		/// Process a received message.
+		/// </summary>
+		/// <param name="pMessage">The received message, the caller keeps ownership.
+		/// </param>
+		/// <returns>true if the message was a fragment and has been consumed, false if it
+		/// should be handled normally.</returns>
+		bool Receive( const IMessage* pMessage );
+
+		/// <summary>
+		/// Abort the streams that have timed out. Call this periodically from the owning
+		/// task.
+		/// </summary>
+		void Poll(void);
+
+		/// <summary>
+		/// Obtain the progress of a stream.
+		/// </summary>
+		/// <param name="nSource">Address of the sender.</param>
+		/// <param name="nStream">Stream number.</param>
+		/// <param name="nReceived">Receives the number of bytes received.</param>
+		/// <param name="nTotal">Receives the size of the complete block.</param>
+		/// <returns>false if the stream is not open.</returns>
+		bool GetProgress( uint16_t nSource, uint16_t nStream, uint32_t& nReceived, uint32_t& nTotal ) const;
+
+		/// <summary>
+		/// Number of streams currently open.
+		/// </summary>
+		uint8_t ActiveStreams(void) const;
+
+		/// <summary>
+		/// Number of streams received completely.
+		/// </summary>
+		uint32_t Completed(void) const
+		{
+			return _nCompleted;
+		}
+
+		/// <summary>
+		/// Number of streams aborted or refused.
+		/// </summary>
+		uint32_t Failed(void) const
+		{
+			return _nFailed;
+		}
+
+	private:
+		typedef struct
+		{
+			/// <summary>
+			/// Set while the stream is open.
+			/// </summary>
+			bool			_bActive;
+
+			/// <summary>
+			/// Address of the sender.
+			/// </summary>
+			uint16_t		_nSource;
+
+			/// <summary>
+			/// Stream number.
+			/// </summary>
+			uint16_t		_nStream;
+
+			/// <summary>
+			/// Size of the complete block.
+			/// </summary>
+			uint32_t		_nTotal;
+
+			/// <summary>
+			/// Number of bytes received, also the offset of the next fragment.
+			/// </summary>
+			uint32_t		_nReceived;
+
+			/// <summary>
+			/// Tick count of the last fragment.
+			/// </summary>
+			uint32_t		_nLast;
+		} Stream_t;
+
+		typedef struct
+		{
+			/// <summary>
+			/// Set once the entry holds a completed stream.
+			/// </summary>
+			bool			_bUsed;
+
+			/// <summary>
+			/// Address of the sender.
+			/// </summary>
+			uint16_t		_nSource;
+
+			/// <summary>
+			/// Stream number.
+			/// </summary>
+			uint16_t		_nStream;
+
+			/// <summary>
+			/// Size of the complete block.
+			/// </summary>
+			uint32_t		_nTotal;
+
+			/// <summary>
+			/// Tick count when the stream completed.
+			/// </summary>
+			uint32_t		_nTime;
+		} Finished_t;
+
+		/// <summary>
+		/// If an error occurs this value will reflect the last one.
+		/// </summary>
+		uint32_t					_nLastError;
+
+		/// <summary>
+		/// Number of stream slots.
+		/// </summary>
+		uint8_t						_nStreams;
+
+		/// <summary>
+		/// The stream slots.
+		/// </summary>
+		Stream_t*					_pStreams;
+
+		/// <summary>
+		/// The streams completed most recently, one entry for each stream slot.
+		/// </summary>
+		Finished_t*					_pFinished;
+
+		/// <summary>
+		/// The entry in _pFinished replaced next.
+		/// </summary>
+		uint8_t						_nFinishedNext;
+
+		/// <summary>
+		/// Receives the data.
+		/// </summary>
+		scIFragmentSink*			_pSink;
+
+		/// <summary>
+		/// Protects the stream table.
+		/// </summary>
+		scIMutex*					_pProtect;
+
+		/// <summary>
+		/// The allocator used for the stream table.
+		/// </summary>
+		scAllocator					_Allocator;
+
+		/// <summary>
+		/// Used for the stream timeout.
+		/// </summary>
+		TickSource_t				_pTickSource;
+
+		/// <summary>
+		/// Stream timeout.
+		/// </summary>
+		uint32_t					_nTimeout;
+
+		/// <summary>
+		/// Number of streams received completely.
+		/// </summary>
+		uint32_t					_nCompleted;
+
+		/// <summary>
+		/// Number of streams aborted or refused.
+		/// </summary>
+		uint32_t					_nFailed;
+
+		/// <summary>
+		/// Locate the open stream. Must be called with the lock.
+		/// </summary>
+		Stream_t* Find( uint16_t nSource, uint16_t nStream ) const;
+
+		/// <summary>
+		/// Check if the stream was one of the last ones completed. Must be called with
+		/// the lock.
+		/// </summary>
+		bool Finished( uint16_t nSource, uint16_t nStream, uint32_t nTotal ) const;
+
+		/// <summary>
+		/// Check if the stream timeout has passed since a tick count.
+		/// </summary>
+		bool Expired( uint32_t nTime ) const
+		{
+			return _pTickSource != NULL && _nTimeout > 0 && ( Now() - nTime ) >= _nTimeout;
+		}
+
+		/// <summary>
+		/// Close a stream and free the slot. Must be called with the lock.
+		/// </summary>
+		void Close( Stream_t* pStream, bool bComplete );
+
+		/// <summary>
+		/// Read the tick source.
+		/// </summary>
+		uint32_t Now(void) const
+		{
+			return ( _pTickSource != NULL ) ? _pTickSource() : 0;
+		}
+	};
+
+//////////////////////////////////////////////////////////////////////////////////////
+/// Public Methods
+//////////////////////////////////////////////////////////////////////////////////////
+
+	/// <summary>
+	/// Construct the reassembler.
+	/// </summary>
+	/// <param name="nStreams">Number of streams that can be received at one time.
+	/// </param>
+	template<class IMessage>
+	scMessageReassembler<IMessage>::scMessageReassembler( uint8_t nStreams )
+		:	_nLastError(ERROR_SUCCESS)
+		,	_nStreams(nStreams)
+		,	_pStreams(NULL)
+		,	_pFinished(NULL)
+		,	_nFinishedNext(0)
+		,	_pSink(NULL)
+		,	_pProtect(NULL)
+		,	_Allocator()
+		,	_pTickSource(NULL)
+		,	_nTimeout(0)
+		,	_nCompleted(0)
+		,	_nFailed(0)
+	{
+		assert_param( _nStreams > 0 );
+	}
+
+	/// <summary>
+	/// Destructor. Open streams are aborted.
+	/// </summary>
+	template<class IMessage>
+	scMessageReassembler<IMessage>::~scMessageReassembler()
+	{
+		if ( _pStreams != NULL )
+		{
+			for( uint8_t i=0; i < _nStreams; ++i )
+			{
+				if ( _pStreams[i]._bActive )
+				{
+					Close( &_pStreams[i], false );
+				}
+			}
+			_Allocator.Destroy( _pStreams );
+			_pStreams = NULL;
+		}
+		if ( _pFinished != NULL )
+		{
+			_Allocator.Destroy( _pFinished );
+			_pFinished = NULL;
+		}
+	}
+
+	/// <summary>
+	/// Allocate the stream table.
+	/// </summary>
+	/// <param name="allocator">Allocator used for the stream table.</param>
+	/// <param name="pProtect">Mutex protecting the stream table.</param>
+	/// <param name="pSink">Receives the data.</param>
+	template<class IMessage>
+	uint32_t scMessageReassembler<IMessage>::Initialize( scAllocator allocator, scIMutex* pProtect, scIFragmentSink* pSink )
+	{
+		assert_param( pProtect != NULL );
+		assert_param( pSink != NULL );
+
+		_pProtect = pProtect;
+		_pSink = pSink;
+		_Allocator = allocator;
+
+		_pStreams = reinterpret_cast<Stream_t*>( _Allocator.Allocate( _nStreams * sizeof(Stream_t), true ) );
+		_pFinished = reinterpret_cast<Finished_t*>( _Allocator.Allocate( _nStreams * sizeof(Finished_t), true ) );
+		if ( _pStreams != NULL && _pFinished != NULL )
+		{
+			memset( _pStreams, 0, _nStreams * sizeof(Stream_t) );
+			memset( _pFinished, 0, _nStreams * sizeof(Finished_t) );
+		}
+		else
+		{
+			if ( _pStreams != NULL )
+			{
+				_Allocator.Destroy( _pStreams );
+				_pStreams = NULL;
+			}
+			if ( _pFinished != NULL )
+			{
+				_Allocator.Destroy( _pFinished );
+				_pFinished = NULL;
+			}
+			scDebugManager::Instance()->Trace( scDEBUGLABEL_ERROR_MESSAGE,
+				"scMessageReassembler: Unable to allocate the stream table.\n\r" );
+			_nLastError = ERROR_SC_MEMORY_ALLOCATION_FAILURE;
+		}
+
+		return _nLastError;
+	}
+
+	/// <summary>
+	/// Process a received message.
+	/// </summary>
+	/// <param name="pMessage">The received message, the caller keeps ownership.
+	/// </param>
+	/// <returns>true if the message was a fragment and has been consumed, false if it
+	/// should be handled normally.</returns>
+	template<class IMessage>
+	bool scMessageReassembler<IMessage>::Receive( const IMessage* pMessage )
+	{
+		assert_param( _pProtect != NULL );
+
+		if ( pMessage == NULL || ( pMessage->Header().Flags() & STANDARD_HEADER_FLAG_FRAGMENT ) == 0 )
+		{
+			return false;
+		}
+
+		scScopeLock				protect( _pProtect );
+		scFragmentHeader_t		fragment;
+		uint16_t				nSource = pMessage->Header().Source();
+		uint32_t				nLength = pMessage->LengthOfPayload();
+		const uint8_t*			pData = pMessage->Buffer() + pMessage->LengthOfHeader();
+
+		if ( nLength < sizeof(scFragmentHeader_t) )
+		{
+			scDebugManager::Instance()->Trace( scDEBUGLABEL_WARNING_MESSAGE,
+				"scMessageReassembler: Fragment too short.\n\r" );
+			return true;
+		}
+
+		memcpy( &fragment, pData, sizeof(scFragmentHeader_t) );
+		pData += sizeof(scFragmentHeader_t);
+		nLength -= sizeof(scFragmentHeader_t);
+
+		Stream_t* pStream = Find( nSource, fragment._nStream );
+
+		if ( pStream == NULL && fragment._nOffset == 0 && Finished( nSource, fragment._nStream, fragment._nTotal ) )
+		{
+			// the first fragment of a stream already delivered was sent again
+			return true;
+		}
+
+		if ( pStream == NULL && fragment._nOffset == 0 )
+		{
+			// the first fragment opens the stream
+			for( uint8_t i=0; i < _nStreams && pStream == NULL; ++i )
+			{
+				if ( !_pStreams[i]._bActive )
+				{
+					pStream = &_pStreams[i];
+				}
+			}
+
+			if ( pStream == NULL || !_pSink->Open( nSource, fragment._nStream, (uint16_t)pMessage->GetID(), fragment._nTotal ) )
+			{
+				scDebugManager::Instance()->Trace( scDEBUGLABEL_WARNING_MESSAGE,
+					"scMessageReassembler: Stream %u:%u refused.\n\r", nSource, fragment._nStream );
+				_nFailed++;
+				return true;
+			}
+
+			pStream->_bActive = true;
+			pStream->_nSource = nSource;
+			pStream->_nStream = fragment._nStream;
+			pStream->_nTotal = fragment._nTotal;
+			pStream->_nReceived = 0;
+			pStream->_nLast = Now();
+		}
+
+		if ( pStream == NULL )
+		{
+			// the rest of a stream that was aborted or already finished
+		}
+		else if ( fragment._nOffset < pStream->_nReceived )
+		{
+			// repeated fragment
+			pStream->_nLast = Now();
+		}
+		else if ( fragment._nOffset > pStream->_nReceived ||
+				  nLength > ( pStream->_nTotal - pStream->_nReceived ) )
+		{
+			scDebugManager::Instance()->Trace( scDEBUGLABEL_WARNING_MESSAGE,
+				"scMessageReassembler: Stream %u:%u gap at %u.\n\r", nSource, fragment._nStream, pStream->_nReceived );
+			Close( pStream, false );
+		}
+		else
+		{
+			uint32_t nError = ERROR_SUCCESS;
+			if ( nLength > 0 )
+			{
+				nError = _pSink->Write( nSource, fragment._nStream, fragment._nOffset, pData, nLength );
+			}
+
+			if ( nError != ERROR_SUCCESS )
+			{
+				_nLastError = nError;
+				Close( pStream, false );
+			}
+			else
+			{
+				pStream->_nReceived += nLength;
+				pStream->_nLast = Now();
+				if ( pStream->_nReceived >= pStream->_nTotal )
+				{
+					Close( pStream, true );
+				}
+			}
+		}
+
+		return true;
+	}
+
+	/// <summary>
+	/// Abort the streams that have timed out and forget the completed streams that
+	/// are older than the timeout. Call this periodically from the owning task.
+	/// </summary>
+	template<class IMessage>
+	void scMessageReassembler<IMessage>::Poll(void)
+	{
+		assert_param( _pProtect != NULL );
+
+		if ( _pTickSource != NULL && _nTimeout > 0 )
+		{
+			scScopeLock		protect( _pProtect );
+			for( uint8_t i=0; i < _nStreams; ++i )
+			{
+				if ( _pStreams[i]._bActive && Expired( _pStreams[i]._nLast ) )
+				{
+					scDebugManager::Instance()->Trace( scDEBUGLABEL_WARNING_MESSAGE,
+						"scMessageReassembler: Stream %u:%u timed out.\n\r", _pStreams[i]._nSource, _pStreams[i]._nStream );
+					Close( &_pStreams[i], false );
+				}
+				if ( _pFinished[i]._bUsed && Expired( _pFinished[i]._nTime ) )
+				{
+					_pFinished[i]._bUsed = false;
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Obtain the progress of a stream.
+	/// </summary>
+	/// <param name="nSource">Address of the sender.</param>
+	/// <param name="nStream">Stream number.</param>
+	/// <param name="nReceived">Receives the number of bytes received.</param>
+	/// <param name="nTotal">Receives the size of the complete block.</param>
+	/// <returns>false if the stream is not open.</returns>
+	template<class IMessage>
+	bool scMessageReassembler<IMessage>::GetProgress( uint16_t nSource, uint16_t nStream, uint32_t& nReceived, uint32_t& nTotal ) const
+	{
+		assert_param( _pProtect != NULL );
+
+		scScopeLock		protect( _pProtect );
+		Stream_t*		pStream = Find( nSource, nStream );
+		if ( pStream != NULL )
+		{
+			nReceived = pStream->_nReceived;
+			nTotal = pStream->_nTotal;
+		}
+		return pStream != NULL;
+	}
+
+	/// <summary>
+	/// Number of streams currently open.
+	/// </summary>
+	template<class IMessage>
+	uint8_t scMessageReassembler<IMessage>::ActiveStreams(void) const
+	{
+		assert_param( _pProtect != NULL );
+
+		scScopeLock		protect( _pProtect );
+		uint8_t			nCount = 0;
+		for( uint8_t i=0; i < _nStreams; ++i )
+		{
+			if ( _pStreams[i]._bActive )
+			{
+				nCount++;
+			}
+		}
+		return nCount;
+	}
+
+//////////////////////////////////////////////////////////////////////////////////////
+/// Private Methods
+//////////////////////////////////////////////////////////////////////////////////////
+
+	/// <summary>
+	/// Locate the open stream. Must be called with the lock.
+	/// </summary>
+	template<class IMessage>
+	typename scMessageReassembler<IMessage>::Stream_t* scMessageReassembler<IMessage>::Find( uint16_t nSource, uint16_t nStream ) const
+	{
+		for( uint8_t i=0; i < _nStreams; ++i )
+		{
+			if ( _pStreams[i]._bActive && _pStreams[i]._nSource == nSource && _pStreams[i]._nStream == nStream )
+			{
+				return &_pStreams[i];
+			}
+		}
+		return NULL;
+	}
+
+	/// <summary>
+	/// Check if the stream was one of the last ones completed. An entry older than the
+	/// stream timeout, or for a block of another size, belongs to an earlier use of the
+	/// stream number by a sender that has since restarted. Must be called with the
+	/// lock.
+	/// </summary>
+	template<class IMessage>
+	bool scMessageReassembler<IMessage>::Finished( uint16_t nSource, uint16_t nStream, uint32_t nTotal ) const
+	{
+		for( uint8_t i=0; i < _nStreams; ++i )
+		{
+			const Finished_t& finished = _pFinished[i];
+			if ( finished._bUsed && finished._nSource == nSource && finished._nStream == nStream &&
+				 finished._nTotal == nTotal && !Expired( finished._nTime ) )
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// Close a stream and free the slot. Must be called with the lock.
+	/// </summary>
+	template<class IMessage>
+	void scMessageReassembler<IMessage>::Close( Stream_t* pStream, bool bComplete )
+	{
+		_pSink->Close( pStream->_nSource, pStream->_nStream, bComplete );
+		if ( bComplete )
+		{
+			_nCompleted++;
+			_pFinished[_nFinishedNext]._bUsed = true;
+			_pFinished[_nFinishedNext]._nSource = pStream->_nSource;
+			_pFinished[_nFinishedNext]._nStream = pStream->_nStream;
+			_pFinished[_nFinishedNext]._nTotal = pStream->_nTotal;
+			_pFinished[_nFinishedNext]._nTime = Now();
+			_nFinishedNext = ( _nFinishedNext + 1 ) % _nStreams;
+		}
+		else
+		{
+			_nFailed++;
+		}
+		pStream->_bActive = false;
+	}
+
+}
+#endif // !defined(__SCMESSAGEREASSEMBLER_H__INCLUDED_)
@@ -0,0 +1,799 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scMessageRouter.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCMESSAGEROUTER_H__INCLUDED_)
+#define __SCMESSAGEROUTER_H__INCLUDED_
+
+#include "scTypes.h"
+#include "scIAllocator.h"
+#include "scAllocator.h"
+#include "scIMutex.h"
+#include "scScopeLock.h"
+#include "scDebugManager.h"
+#include "scDebugLabelCodes.h"
+#include "scErrorCodes.h"
+#include "scProfiler.h"
+#include "scMessageFactory.h"
+
+
+#ifndef assert_param
+#define assert_param(X)	if ( !(X) ) { for(;;) ; }
+#endif
+
+/// <summary>
+/// Used for the destination or the message ID when registering a route to match
+/// any value.
+/// </summary>
+#define scROUTE_ANY					(0xFFFF)
+
+/// <summary>
+/// Returned when a route could not be registered.
+/// </summary>
+#define scROUTE_INVALID				(0xFFFF)
+
+/// <summary>
+/// The maximum number of handlers a single message can be delivered to. The matching
+/// routes are collected before any handler is called so the handlers are free to
+/// route other messages. Register refuses a route that would take any message past
+/// this limit.
+/// </summary>
+#ifndef scROUTE_MAX_FANOUT
+#define scROUTE_MAX_FANOUT			(8)
+#endif
+
+
+namespace SharedCore
+{
+	/// <summary>
+	/// The message router replaces the switch statements on the message ID and the
+	/// destination address. Handlers are registered for a destination and message ID
+	/// pair and are located using a flat table indexed by both values, so the cost of
+	/// finding the handlers does not depend on the number of routes. Either value can
+	/// be registered as a wildcard. A message is delivered to every matching route in
+	/// the order: exact match, destination match, message ID match, then any. Each
+	/// handler gets its own reference to the message from the factory, a handler that
+	/// needs to keep the message past the call returns true and releases it later.
+	/// </summary>
+	template<class IMessage>
+	class scMessageRouter
+	{
+	public:
+		/// <summary>
+		/// Handler for a route. Return true if the handler has kept the message and will
+		/// release it with the factory itself, otherwise the router releases it.
+		/// </summary>
+		typedef bool (*Handler_t)( const IMessage* pMessage, void* pContext );
+
+		/// <summary>
+		/// Function used to obtain a free running tick count for measuring the time spent
+		/// in the handlers.
+		/// </summary>
+		typedef uint32_t (*TickSource_t)( void );
+
+		/// <summary>
+		/// Statistics kept for each route.
+		/// </summary>
+		typedef struct
+		{
+			/// <summary>
+			/// Number of messages delivered to the handler.
+			/// </summary>
+			uint32_t		_nHits;
+
+			/// <summary>
+			/// Total ticks spent in the handler.
+			/// </summary>
+			uint32_t		_nTotalTicks;
+
+			/// <summary>
+			/// The longest single call into the handler.
+			/// </summary>
+			uint32_t		_nMaxTicks;
+		} RouteStats_t;
+
+		/// <summary>
+		/// Construct the router.
+		/// </summary>
+		/// <param name="nMaxDestinations">Destination addresses 0 to nMaxDestinations-1
+		/// can be routed exactly, larger addresses only match wildcard routes.</param>
+		/// <param name="nMaxMessageIds">Message IDs 0 to nMaxMessageIds-1 can be routed
+		/// exactly, larger IDs only match wildcard routes.</param>
+		/// <param name="nMaxRoutes">Total number of routes that can be registered.</param>
+		scMessageRouter( uint16_t nMaxDestinations, uint16_t nMaxMessageIds, uint16_t nMaxRoutes );
+
+		/// <summary>
+		/// Destructor. Releases the memory used by the table.
+		/// </summary>
+		virtual ~scMessageRouter();
+
+		/// <summary>
+		/// Allocate the lookup table and the route records.
+		/// </summary>
+		/// <param name="allocator">Allocator used for the table memory.</param>
+		/// <param name="pProtect">Mutex protecting the table.</param>
+		/// <param name="pFactory">The factory that owns the messages being routed.</param>
+		virtual uint32_t Initialize( scAllocator allocator, scIMutex* pProtect, scMessageFactory<IMessage>* pFactory );
+
+		/// <summary>
+		/// Get the last error.
+		/// </summary>
+		uint32_t GetLastError()
+		{
+			return _nLastError;
+		}
+
+		/// <summary>
+		/// Set the function used to time the handlers. NULL disables the timing.
+		/// </summary>
+		/// <param name="pSource">Tick function.</param>
+		void SetTickSource( TickSource_t pSource )
+		{
+			_pTickSource = pSource;
+		}
+
+		/// <summary>
+		/// Add a route. Handlers registered for the same key are called in the order
+		/// they were added.
+		/// </summary>
+		/// <param name="nDestination">Destination address or scROUTE_ANY.</param>
+		/// <param name="nMessageId">Message ID or scROUTE_ANY.</param>
+		/// <param name="pHandler">Function called with the message.</param>
+		/// <param name="pContext">Value passed back to the handler.</param>
+		/// <returns>The route index or scROUTE_INVALID. GetLastError is
+		/// ERROR_SC_ROUTE_FANOUT_LIMIT when a message matching the route would reach
+		/// more than scROUTE_MAX_FANOUT handlers.</returns>
+		uint16_t Register( uint16_t nDestination, uint16_t nMessageId, Handler_t pHandler, void* pContext );
+
+		/// <summary>
+		/// Remove a route that was added with Register.
+		/// </summary>
+		/// <param name="nRoute">The route index returned by Register.</param>
+		bool Unregister( uint16_t nRoute );
+
+		/// <summary>
+		/// Deliver a message to all the routes that match it. The caller keeps its own
+		/// reference to the message.
+		/// </summary>
+		/// <param name="pMessage">The message to deliver.</param>
+		/// <returns>Number of handlers the message was delivered to.</returns>
+		uint16_t Dispatch( const IMessage* pMessage );
+
+		/// <summary>
+		/// Obtain the statistics for a route.
+		/// </summary>
+		/// <param name="nRoute">Route index.</param>
+		/// <param name="stats">Filled in with the current values.</param>
+		bool GetRouteStats( uint16_t nRoute, RouteStats_t& stats ) const;
+
+		/// <summary>
+		/// Number of messages that did not match any route.
+		/// </summary>
+		uint32_t Unrouted(void) const
+		{
+			return _nUnrouted;
+		}
+
+		/// <summary>
+		/// Clear all the route statistics.
+		/// </summary>
+		void ResetStats(void);
+
+		/// <summary>
+		/// Utility method to dump the route table and the statistics.
+		/// </summary>
+		void DebugDump(void);
+
+	private:
+		typedef struct
+		{
+			/// <summary>
+			/// The handler, NULL when the record is not used.
+			/// </summary>
+			Handler_t		_pHandler;
+
+			/// <summary>
+			/// Value passed to the handler.
+			/// </summary>
+			void*			_pContext;
+
+			/// <summary>
+			/// The destination this route was registered with.
+			/// </summary>
+			uint16_t		_nDestination;
+
+			/// <summary>
+			/// The message ID this route was registered with.
+			/// </summary>
+			uint16_t		_nMessageId;
+
+			/// <summary>
+			/// Next route in the chain for the same table cell.
+			/// </summary>
+			uint16_t		_nNext;
+
+			/// <summary>
+			/// Identifies this registration, a slot reused by a new route gets a new
+			/// one. Zero when the record is not used.
+			/// </summary>
+			uint32_t		_nGeneration;
+
+			/// <summary>
+			/// The hit counter and handler timing.
+			/// </summary>
+			RouteStats_t	_Stats;
+		} Route_t;
+
+		/// <summary>
+		/// If an error occurs this value will reflect the last one.
+		/// </summary>
+		uint32_t					_nLastError;
+
+		/// <summary>
+		/// Number of exact destinations, the table has one more row for the wildcard.
+		/// </summary>
+		uint16_t					_nMaxDestinations;
+
+		/// <summary>
+		/// Number of exact message IDs, the table has one more column for the wildcard.
+		/// </summary>
+		uint16_t					_nMaxMessageIds;
+
+		/// <summary>
+		/// Number of route records.
+		/// </summary>
+		uint16_t					_nMaxRoutes;
+
+		/// <summary>
+		/// The first route for each destination and message ID cell.
+		/// </summary>
+		uint16_t*					_pTable;
+
+		/// <summary>
+		/// The route records.
+		/// </summary>
+		Route_t*					_pRoutes;
+
+		/// <summary>
+		/// Messages that did not match any route.
+		/// </summary>
+		uint32_t					_nUnrouted;
+
+		/// <summary>
+		/// Generation given to the last route registered.
+		/// </summary>
+		uint32_t					_nGeneration;
+
+		/// <summary>
+		/// Protects the table and the statistics.
+		/// </summary>
+		scIMutex*					_pProtect;
+
+		/// <summary>
+		/// The factory used to acquire and release the messages for the handlers.
+		/// </summary>
+		scMessageFactory<IMessage>*	_pFactory;
+
+		/// <summary>
+		/// The allocator used for the table memory.
+		/// </summary>
+		scAllocator					_Allocator;
+
+		/// <summary>
+		/// Used to time the handlers.
+		/// </summary>
+		TickSource_t				_pTickSource;
+
+		/// <summary>
+		/// Convert a destination and message ID into the index of the table cell. Values
+		/// outside of the table are mapped to the wildcard cell.
+		/// </summary>
+		size_t Cell( uint16_t nDestination, uint16_t nMessageId ) const
+		{
+			size_t nRow = ( nDestination < _nMaxDestinations ) ? nDestination : _nMaxDestinations;
+			size_t nCol = ( nMessageId < _nMaxMessageIds ) ? nMessageId : _nMaxMessageIds;
+			return ( nRow * ( _nMaxMessageIds + 1 ) ) + nCol;
+		}
+
+		/// <summary>
+		/// Add the routes in a single table cell to the delivery list.
+		/// </summary>
+		void Collect( size_t nCell, uint16_t* pList, uint16_t& nCount ) const;
+
+		/// <summary>
+		/// Number of routes chained on a single table cell.
+		/// </summary>
+		uint16_t Length( size_t nCell ) const;
+
+		/// <summary>
+		/// Number of handlers Dispatch would deliver a message with this destination and
+		/// message ID to.
+		/// </summary>
+		uint16_t FanOut( uint16_t nDestination, uint16_t nMessageId ) const;
+
+		/// <summary>
+		/// The largest fan out of any message a route registered with this destination
+		/// and message ID would match.
+		/// </summary>
+		uint16_t MaxFanOut( uint16_t nDestination, uint16_t nMessageId ) const;
+	};
+
+//////////////////////////////////////////////////////////////////////////////////////
+/// Public Methods
+//////////////////////////////////////////////////////////////////////////////////////
+
+	/// <summary>
+	/// Construct the router.
+	/// </summary>
+	/// <param name="nMaxDestinations">Destination addresses 0 to nMaxDestinations-1
+	/// can be routed exactly, larger addresses only match wildcard routes.</param>
+	/// <param name="nMaxMessageIds">Message IDs 0 to nMaxMessageIds-1 can be routed
+	/// exactly, larger IDs only match wildcard routes.</param>
+	/// <param name="nMaxRoutes">Total number of routes that can be registered.</param>
+	template<class IMessage>
+	scMessageRouter<IMessage>::scMessageRouter( uint16_t nMaxDestinations, uint16_t nMaxMessageIds, uint16_t nMaxRoutes )
+		:	_nLastError(ERROR_SUCCESS)
+		,	_nMaxDestinations(nMaxDestinations)
+		,	_nMaxMessageIds(nMaxMessageIds)
+		,	_nMaxRoutes(nMaxRoutes)
+		,	_pTable(NULL)
+		,	_pRoutes(NULL)
+		,	_nUnrouted(0)
+		,	_nGeneration(0)
+		,	_pProtect(NULL)
+		,	_pFactory(NULL)
+		,	_Allocator()
+		,	_pTickSource(NULL)
+	{
+		// scROUTE_ANY must never be a valid exact value
+		assert_param( _nMaxDestinations < scROUTE_ANY && _nMaxMessageIds < scROUTE_ANY );
+		assert_param( _nMaxRoutes < scROUTE_INVALID );
+	}
+
+	/// <summary>
+	/// Destructor. Releases the memory used by the table.
+	/// </summary>
+	template<class IMessage>
+	scMessageRouter<IMessage>::~scMessageRouter()
+	{
+		_Allocator.Destroy( _pTable );
+		_Allocator.Destroy( _pRoutes );
+		_pTable = NULL;
+		_pRoutes = NULL;
+	}
+
+	/// <summary>
+	/// Allocate the lookup table and the route records.
+	/// </summary>
+	/// <param name="allocator">Allocator used for the table memory.</param>
+	/// <param name="pProtect">Mutex protecting the table.</param>
+	/// <param name="pFactory">The factory that owns the messages being routed.</param>
+	template<class IMessage>
+	uint32_t scMessageRouter<IMessage>::Initialize( scAllocator allocator, scIMutex* pProtect, scMessageFactory<IMessage>* pFactory )
+	{
+		assert_param( pProtect != NULL );
+		assert_param( pFactory != NULL );
+
+		_pProtect = pProtect;
+		_pFactory = pFactory;
+		_Allocator = allocator;
+
+		size_t nCells = ( _nMaxDestinations + 1 ) * ( _nMaxMessageIds + 1 );
+		_pTable = reinterpret_cast<uint16_t*>( _Allocator.Allocate( nCells * sizeof(uint16_t), true ) );
+		_pRoutes = reinterpret_cast<Route_t*>( _Allocator.Allocate( _nMaxRoutes * sizeof(Route_t), true ) );
+
+		if ( _pTable != NULL && _pRoutes != NULL )
+		{
+			for( size_t i=0; i < nCells; ++i )
+			{
+				_pTable[i] = scROUTE_INVALID;
+			}
+			memset( _pRoutes, 0, _nMaxRoutes * sizeof(Route_t) );
+		}
+		else
+		{
+			scDebugManager::Instance()->Trace( scDEBUGLABEL_ERROR_MESSAGE,
+				"scMessageRouter: Unable to allocate the route table.\n\r" );
+			_nLastError = ERROR_SC_MEMORY_ALLOCATION_FAILURE;
+		}
+
+		return _nLastError;
+	}
+
+	/// <summary>
+	/// Add a route. Handlers registered for the same key are called in the order
+	/// they were added.
+	/// </summary>
+	/// <param name="nDestination">Destination address or scROUTE_ANY.</param>
+	/// <param name="nMessageId">Message ID or scROUTE_ANY.</param>
+	/// <param name="pHandler">Function called with the message.</param>
+	/// <param name="pContext">Value passed back to the handler.</param>
+	/// <returns>The route index or scROUTE_INVALID. GetLastError is
+	/// ERROR_SC_ROUTE_FANOUT_LIMIT when a message matching the route would reach
+	/// more than scROUTE_MAX_FANOUT handlers.</returns>
+	template<class IMessage>
+	uint16_t scMessageRouter<IMessage>::Register( uint16_t nDestination, uint16_t nMessageId, Handler_t pHandler, void* pContext )
+	{
+		assert_param( _pProtect != NULL );
+		assert_param( pHandler != NULL );
+
+		uint16_t		nResult = scROUTE_INVALID;
+		scScopeLock		protect( _pProtect );
+
+		// The wildcard row and column can only be reached by the wildcard
+		if ( ( nDestination != scROUTE_ANY && nDestination >= _nMaxDestinations ) ||
+			 ( nMessageId != scROUTE_ANY && nMessageId >= _nMaxMessageIds ) )
+		{
+			scDebugManager::Instance()->Trace( scDEBUGLABEL_WARNING_MESSAGE,
+				"scMessageRouter: Route %u:%u outside of the table.\n\r", nDestination, nMessageId );
+			_nLastError = ERROR_SC_ROUTE_OUT_OF_RANGE;
+		}
+		else if ( MaxFanOut( nDestination, nMessageId ) >= scROUTE_MAX_FANOUT )
+		{
+			scDebugManager::Instance()->Trace( scDEBUGLABEL_WARNING_MESSAGE,
+				"scMessageRouter: Route %u:%u exceeds the fan out limit.\n\r", nDestination, nMessageId );
+			_nLastError = ERROR_SC_ROUTE_FANOUT_LIMIT;
+		}
+		else
+		{
+			for( uint16_t i=0; i < _nMaxRoutes && nResult == scROUTE_INVALID; ++i )
+			{
+				if ( _pRoutes[i]._pHandler == NULL )
+				{
+					nResult = i;
+				}
+			}
+
+			if ( nResult != scROUTE_INVALID )
+			{
+				Route_t& route = _pRoutes[nResult];
+				memset( &route, 0, sizeof(Route_t) );
+				route._pHandler = pHandler;
+				route._pContext = pContext;
+				route._nDestination = nDestination;
+				route._nMessageId = nMessageId;
+				route._nNext = scROUTE_INVALID;
+
+				// zero marks a free slot, skip it when the counter wraps
+				if ( ++_nGeneration == 0 )
+				{
+					++_nGeneration;
+				}
+				route._nGeneration = _nGeneration;
+
+				// append to the end of the chain to keep the registration order
+				uint16_t* pLink = &_pTable[ Cell( nDestination, nMessageId ) ];
+				while( *pLink != scROUTE_INVALID )
+				{
+					pLink = &_pRoutes[ *pLink ]._nNext;
+				}
+				*pLink = nResult;
+			}
+			else
+			{
+				scDebugManager::Instance()->Trace( scDEBUGLABEL_WARNING_MESSAGE,
+					"scMessageRouter: No route slots open.\n\r" );
+				_nLastError = ERROR_SC_ROUTE_TABLE_FULL;
+			}
+		}
+
+		return nResult;
+	}
+
+	/// <summary>
+	/// Remove a route that was added with Register.
+	/// </summary>
+	/// <param name="nRoute">The route index returned by Register.</param>
+	template<class IMessage>
+	bool scMessageRouter<IMessage>::Unregister( uint16_t nRoute )
+	{
+		assert_param( _pProtect != NULL );
+
+		bool			bResult = false;
+		scScopeLock		protect( _pProtect );
+
+		if ( nRoute < _nMaxRoutes && _pRoutes[nRoute]._pHandler != NULL )
+		{
+			Route_t& route = _pRoutes[nRoute];
+			uint16_t* pLink = &_pTable[ Cell( route._nDestination, route._nMessageId ) ];
+			while( *pLink != scROUTE_INVALID && *pLink != nRoute )
+			{
+				pLink = &_pRoutes[ *pLink ]._nNext;
+			}
+			if ( *pLink == nRoute )
+			{
+				*pLink = route._nNext;
+			}
+			memset( &route, 0, sizeof(Route_t) );
+			bResult = true;
+		}
+
+		return bResult;
+	}
+
+	/// <summary>
+	/// Deliver a message to all the routes that match it. The caller keeps its own
+	/// reference to the message.
+	/// </summary>
+	/// <param name="pMessage">The message to deliver.</param>
+	/// <returns>Number of handlers the message was delivered to.</returns>
+	template<class IMessage>
+	uint16_t scMessageRouter<IMessage>::Dispatch( const IMessage* pMessage )
+	{
+		assert_param( _pProtect != NULL );
+		assert_param( _pFactory != NULL );
+		scPROFILE_SCOPE( scPROBE_DISPATCH );
+
+		uint16_t	list[scROUTE_MAX_FANOUT];
+		Handler_t	handlers[scROUTE_MAX_FANOUT];
+		void*		contexts[scROUTE_MAX_FANOUT];
+		uint32_t	generations[scROUTE_MAX_FANOUT];
+		uint32_t	ticks[scROUTE_MAX_FANOUT];
+		uint16_t	nCount = 0;
+
+		if ( pMessage == NULL )
+		{
+			return 0;
+		}
+
+		uint16_t nDestination = pMessage->Header().Destination();
+		uint16_t nMessageId = (uint16_t)pMessage->GetID();
+
+		_pFactory->Stamp( pMessage, scMESSAGE_STAGE_ROUTED );
+
+		// Collect the routes while locked, the handlers are called without the lock
+		_pProtect->Acquire();
+		if ( nDestination < _nMaxDestinations && nMessageId < _nMaxMessageIds )
+		{
+			Collect( Cell( nDestination, nMessageId ), list, nCount );
+		}
+		if ( nDestination < _nMaxDestinations )
+		{
+			Collect( Cell( nDestination, scROUTE_ANY ), list, nCount );
+		}
+		if ( nMessageId < _nMaxMessageIds )
+		{
+			Collect( Cell( scROUTE_ANY, nMessageId ), list, nCount );
+		}
+		Collect( Cell( scROUTE_ANY, scROUTE_ANY ), list, nCount );
+
+		for( uint16_t i=0; i < nCount; ++i )
+		{
+			handlers[i] = _pRoutes[ list[i] ]._pHandler;
+			contexts[i] = _pRoutes[ list[i] ]._pContext;
+			generations[i] = _pRoutes[ list[i] ]._nGeneration;
+		}
+		if ( nCount == 0 )
+		{
+			_nUnrouted++;
+		}
+		_pProtect->Release();
+
+		for( uint16_t i=0; i < nCount; ++i )
+		{
+			uint32_t nStart = ( _pTickSource != NULL ) ? _pTickSource() : 0;
+
+			_pFactory->Acquire( pMessage );
+			if ( !handlers[i]( pMessage, contexts[i] ) )
+			{
+				_pFactory->Release( pMessage );
+			}
+
+			ticks[i] = ( _pTickSource != NULL ) ? ( _pTickSource() - nStart ) : 0;
+		}
+
+		if ( nCount > 0 )
+		{
+			_pFactory->Stamp( pMessage, scMESSAGE_STAGE_HANDLED );
+		}
+
+		// update the statistics, the route may have been removed by a handler and its
+		// slot taken by a new route, even one with the same handler
+		_pProtect->Acquire();
+		for( uint16_t i=0; i < nCount; ++i )
+		{
+			Route_t& route = _pRoutes[ list[i] ];
+			if ( route._nGeneration == generations[i] )
+			{
+				route._Stats._nHits++;
+				route._Stats._nTotalTicks += ticks[i];
+				if ( ticks[i] > route._Stats._nMaxTicks )
+				{
+					route._Stats._nMaxTicks = ticks[i];
+				}
+			}
+		}
+		_pProtect->Release();
+
+		return nCount;
+	}
+
+	/// <summary>
+	/// Obtain the statistics for a route.
+	/// </summary>
+	/// <param name="nRoute">Route index.</param>
+	/// <param name="stats">Filled in with the current values.</param>
+	template<class IMessage>
+	bool scMessageRouter<IMessage>::GetRouteStats( uint16_t nRoute, RouteStats_t& stats ) const
+	{
+		bool bResult = false;
+		if ( nRoute < _nMaxRoutes && _pRoutes[nRoute]._pHandler != NULL )
+		{
+			scScopeLock		protect( _pProtect );
+			stats = _pRoutes[nRoute]._Stats;
+			bResult = true;
+		}
+		return bResult;
+	}
+
+	/// <summary>
+	/// Clear all the route statistics.
+	/// </summary>
+	template<class IMessage>
+	void scMessageRouter<IMessage>::ResetStats(void)
+	{
+		assert_param( _pProtect != NULL );
+
+		scScopeLock		protect( _pProtect );
+		for( uint16_t i=0; i < _nMaxRoutes; ++i )
+		{
+			memset( &_pRoutes[i]._Stats, 0, sizeof(RouteStats_t) );
+		}
+		_nUnrouted = 0;
+	}
+
+	/// <summary>
+	/// Utility method to dump the route table and the statistics.
+	/// </summary>
+	template<class IMessage>
+	void scMessageRouter<IMessage>::DebugDump(void)
+	{
+		assert_param( _pProtect != NULL );
+
+		scScopeLock		protect( _pProtect );
+		scDebugManager* pDm = scDebugManager::Instance();
+		pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "scMessageRouter: Routes Dump, %u unrouted\n\r", _nUnrouted );
+
+		for( uint16_t i=0; i < _nMaxRoutes; ++i )
+		{
+			const Route_t& route = _pRoutes[i];
+			if ( route._pHandler != NULL )
+			{
+				pDm->Trace( scDEBUGLABEL_INFO_MESSAGE,
+					"scMessageRouter: [%u] %04X:%04X, hits %u, ticks %u, max %u\n\r",
+					i,
+					route._nDestination,
+					route._nMessageId,
+					route._Stats._nHits,
+					route._Stats._nTotalTicks,
+					route._Stats._nMaxTicks );
+			}
+		}
+	}
+
+//////////////////////////////////////////////////////////////////////////////////////
+/// Private Methods
+//////////////////////////////////////////////////////////////////////////////////////
+
+	/// <summary>
+	/// Add the routes in a single table cell to the delivery list.
+	/// </summary>
+	template<class IMessage>
+	void scMessageRouter<IMessage>::Collect( size_t nCell, uint16_t* pList, uint16_t& nCount ) const
+	{
+		uint16_t nRoute = _pTable[nCell];
+		while( nRoute != scROUTE_INVALID )
+		{
+			if ( nCount < scROUTE_MAX_FANOUT )
+			{
+				pList[nCount++] = nRoute;
+			}
+			else
+			{
+				scDebugManager::Instance()->Trace( scDEBUGLABEL_WARNING_MESSAGE,
+					"scMessageRouter: Fan out limit reached.\n\r" );
+				break;
+			}
+			nRoute = _pRoutes[nRoute]._nNext;
+		}
+	}
+
+	/// <summary>
+	/// Number of routes chained on a single table cell.
+	/// </summary>
+	template<class IMessage>
+	uint16_t scMessageRouter<IMessage>::Length( size_t nCell ) const
+	{
+		uint16_t nCount = 0;
+		uint16_t nRoute = _pTable[nCell];
+		while( nRoute != scROUTE_INVALID )
+		{
+			nCount++;
+			nRoute = _pRoutes[nRoute]._nNext;
+		}
+		return nCount;
+	}
+
+	/// <summary>
+	/// Number of handlers Dispatch would deliver a message with this destination and
+	/// message ID to. Values outside of the table only reach the wildcard routes.
+	/// </summary>
+	template<class IMessage>
+	uint16_t scMessageRouter<IMessage>::FanOut( uint16_t nDestination, uint16_t nMessageId ) const
+	{
+		uint16_t nCount = Length( Cell( scROUTE_ANY, scROUTE_ANY ) );
+		if ( nDestination < _nMaxDestinations && nMessageId < _nMaxMessageIds )
+		{
+			nCount += Length( Cell( nDestination, nMessageId ) );
+		}
+		if ( nDestination < _nMaxDestinations )
+		{
+			nCount += Length( Cell( nDestination, scROUTE_ANY ) );
+		}
+		if ( nMessageId < _nMaxMessageIds )
+		{
+			nCount += Length( Cell( scROUTE_ANY, nMessageId ) );
+		}
+		return nCount;
+	}
+
+	/// <summary>
+	/// The largest fan out of any message a route registered with this destination and
+	/// message ID would match. A wildcard covers every value in the table and the values
+	/// outside of it, so registering wildcards walks the whole row, column or table. This
+	/// is only done when registering.
+	/// </summary>
+	template<class IMessage>
+	uint16_t scMessageRouter<IMessage>::MaxFanOut( uint16_t nDestination, uint16_t nMessageId ) const
+	{
+		uint16_t nMax = 0;
+		uint16_t nFirstDestination = ( nDestination == scROUTE_ANY ) ? 0 : nDestination;
+		uint16_t nLastDestination = ( nDestination == scROUTE_ANY ) ? _nMaxDestinations : nDestination;
+		uint16_t nFirstId = ( nMessageId == scROUTE_ANY ) ? 0 : nMessageId;
+		uint16_t nLastId = ( nMessageId == scROUTE_ANY ) ? _nMaxMessageIds : nMessageId;
+
+		for( uint16_t d = nFirstDestination; d <= nLastDestination; ++d )
+		{
+			for( uint16_t m = nFirstId; m <= nLastId; ++m )
+			{
+				uint16_t nCount = FanOut( d, m );
+				if ( nCount > nMax )
+				{
+					nMax = nCount;
+				}
+			}
+		}
+		return nMax;
+	}
+
+}
+#endif // !defined(__SCMESSAGEROUTER_H__INCLUDED_)
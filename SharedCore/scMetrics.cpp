@@ -0,0 +1,331 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scMetrics.cpp
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#include <string.h>
+#include "scMetrics.h"
+
+#if SC_METRICS_ENABLED
+
+#include "scAtomic.h"
+#include "scDebugManager.h"
+#include "scFormat.h"
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
+using namespace SharedCore;
+
+/// <summary>
+/// Buckets of the message size histogram.
+/// </summary>
+static volatile uint32_t g_SizeBuckets[scMETRIC_BUCKETS];
+
+/// <summary>
+/// The metrics of SharedCore, in the order of scMetricId_t.
+/// </summary>
+scMetric_t scMetrics::s_Core[scMETRIC_CORE_COUNT] =
+{
+	scMETRIC_COUNTER_INIT( "driver.total_bytes_in" ),
+	scMETRIC_COUNTER_INIT( "driver.total_bytes_out" ),
+	scMETRIC_COUNTER_INIT( "driver.total_overflows" ),
+	scMETRIC_COUNTER_INIT( "factory.creates" ),
+	scMETRIC_COUNTER_INIT( "factory.create_failures" ),
+	scMETRIC_GAUGE_INIT( "factory.in_use" ),
+	scMETRIC_HISTOGRAM_INIT( "factory.message_size", g_SizeBuckets ),
+	scMETRIC_GAUGE_INIT( "ring.max_peak_bytes" ),
+	scMETRIC_GAUGE_INIT( "queue.total_depth" ),
+	scMETRIC_COUNTER_INIT( "queue.total_full" ),
+	scMETRIC_GAUGE_INIT( "device.count" ),
+	scMETRIC_COUNTER_INIT( "device.missing" )
+};
+
+scMetric_t* volatile scMetrics::s_pRegistered = NULL;
+
+/// <summary>
+/// Count up a counter or raise the level of a gauge, and its peak with it.
+/// </summary>
+void scMetrics::Add( scMetric_t& metric, uint32_t nValue )
+{
+	uint32_t nLevel = scAtomicAdd( &metric._nValue, nValue );
+	if ( metric._nType == scMETRIC_GAUGE )
+	{
+		AtomicMax( &metric._nPeak, nLevel );
+	}
+}
+
+/// <summary>
+/// Lower the level of a gauge.
+/// </summary>
+void scMetrics::Subtract( scMetric_t& metric, uint32_t nValue )
+{
+	scAtomicAdd( &metric._nValue, 0 - nValue );
+}
+
+/// <summary>
+/// Set the level of a gauge.
+/// </summary>
+void scMetrics::Set( scMetric_t& metric, uint32_t nValue )
+{
+	scAtomicStore( &metric._nValue, nValue );
+	AtomicMax( &metric._nPeak, nValue );
+}
+
+/// <summary>
+/// Raise the peak of a gauge without changing its level.
+/// </summary>
+void scMetrics::Peak( scMetric_t& metric, uint32_t nValue )
+{
+	AtomicMax( &metric._nPeak, nValue );
+}
+
+/// <summary>
+/// Add a sample to a histogram.
+/// </summary>
+void scMetrics::Sample( scMetric_t& metric, uint32_t nValue )
+{
+	scAtomicAdd( &metric._nValue, 1 );
+	scAtomicAdd( &metric._nTotal, nValue );
+	AtomicMax( &metric._nPeak, nValue );
+	if ( metric._pBuckets != NULL )
+	{
+		scAtomicAdd( &metric._pBuckets[Bucket( nValue )], 1 );
+	}
+}
+
+/// <summary>
+/// Add a metric of the application to the registry without a lock, the first call
+/// claims the metric so it is never listed twice.
+/// </summary>
+void scMetrics::Register( scMetric_t& metric )
+{
+	if ( !scAtomicCompareExchange( &metric._nListed, 0, 1 ) )
+	{
+		return;
+	}
+	do
+	{
+		metric._pNext = scAtomicLoadPointer( &s_pRegistered );
+	} while( !scAtomicCompareExchangePointer( &s_pRegistered, metric._pNext, &metric ) );
+}
+
+/// <summary>
+/// Find a metric by name.
+/// </summary>
+scMetric_t* scMetrics::Find( const char* pName )
+{
+	for( uint32_t i=0; i < scMETRIC_CORE_COUNT; ++i )
+	{
+		if ( strcmp( s_Core[i]._pName, pName ) == 0 )
+		{
+			return &s_Core[i];
+		}
+	}
+	for( scMetric_t* pMetric = scAtomicLoadPointer( &s_pRegistered ); pMetric != NULL; pMetric = pMetric->_pNext )
+	{
+		if ( strcmp( pMetric->_pName, pName ) == 0 )
+		{
+			return pMetric;
+		}
+	}
+	return NULL;
+}
+
+/// <summary>
+/// Number of metrics in the registry.
+/// </summary>
+uint32_t scMetrics::Count( void )
+{
+	uint32_t nCount = scMETRIC_CORE_COUNT;
+	for( scMetric_t* pMetric = scAtomicLoadPointer( &s_pRegistered ); pMetric != NULL; pMetric = pMetric->_pNext )
+	{
+		nCount++;
+	}
+	return nCount;
+}
+
+/// <summary>
+/// Copy the metrics and optionally reset them, the SharedCore metrics first.
+/// </summary>
+uint32_t scMetrics::Snapshot( scMetricSnapshot_t* pSnapshot, uint32_t nMax, bool bReset )
+{
+	uint32_t nCount = 0;
+
+	if ( pSnapshot == NULL )
+	{
+		nMax = 0;
+	}
+	for( uint32_t i=0; i < scMETRIC_CORE_COUNT; ++i )
+	{
+		Take( s_Core[i], ( nCount < nMax ) ? &pSnapshot[nCount++] : NULL, bReset );
+	}
+	for( scMetric_t* pMetric = scAtomicLoadPointer( &s_pRegistered ); pMetric != NULL; pMetric = pMetric->_pNext )
+	{
+		Take( *pMetric, ( nCount < nMax ) ? &pSnapshot[nCount++] : NULL, bReset );
+	}
+	return nCount;
+}
+
+/// <summary>
+/// Copy, and reset, one metric. A reset takes each value with an exchange so an
+/// update made meanwhile goes either in the copy or in the next period.
+/// </summary>
+void scMetrics::Take( scMetric_t& metric, scMetricSnapshot_t* pSnapshot, bool bReset )
+{
+	scMetricSnapshot_t	copy;
+
+	copy._pName = metric._pName;
+	copy._nType = metric._nType;
+	memset( copy._nBuckets, 0, sizeof(copy._nBuckets) );
+
+	if ( !bReset )
+	{
+		copy._nValue = scAtomicLoad( &metric._nValue );
+		copy._nPeak = scAtomicLoad( &metric._nPeak );
+		copy._nTotal = scAtomicLoad( &metric._nTotal );
+		for( uint32_t b=0; b < scMETRIC_BUCKETS && metric._pBuckets != NULL; ++b )
+		{
+			copy._nBuckets[b] = scAtomicLoad( &metric._pBuckets[b] );
+		}
+	}
+	else if ( metric._nType == scMETRIC_GAUGE )
+	{
+		// the level stays, the peak starts over from it
+		copy._nValue = scAtomicLoad( &metric._nValue );
+		copy._nPeak = scAtomicExchange( &metric._nPeak, copy._nValue );
+		copy._nTotal = 0;
+	}
+	else
+	{
+		copy._nValue = scAtomicExchange( &metric._nValue, 0 );
+		copy._nPeak = scAtomicExchange( &metric._nPeak, 0 );
+		copy._nTotal = scAtomicExchange( &metric._nTotal, 0 );
+		for( uint32_t b=0; b < scMETRIC_BUCKETS && metric._pBuckets != NULL; ++b )
+		{
+			copy._nBuckets[b] = scAtomicExchange( &metric._pBuckets[b], 0 );
+		}
+	}
+
+	if ( pSnapshot != NULL )
+	{
+		*pSnapshot = copy;
+	}
+}
+
+/// <summary>
+/// Trace every metric through the debug manager.
+/// </summary>
+/// <param name="nLabel">The debug label to trace with.</param>
+void scMetrics::Dump( uint16_t nLabel )
+{
+	for( uint32_t i=0; i < scMETRIC_CORE_COUNT; ++i )
+	{
+		Dump( s_Core[i], nLabel );
+	}
+	for( scMetric_t* pMetric = scAtomicLoadPointer( &s_pRegistered ); pMetric != NULL; pMetric = pMetric->_pNext )
+	{
+		Dump( *pMetric, nLabel );
+	}
+}
+
+/// <summary>
+/// Trace one metric, a histogram followed by the buckets that are not empty as the
+/// lowest value of the bucket and its count.
+/// </summary>
+void scMetrics::Dump( scMetric_t& metric, uint16_t nLabel )
+{
+	scDebugManager*		pDm = scDebugManager::Instance();
+	scMetricSnapshot_t	copy;
+
+	Take( metric, &copy, false );
+	switch( copy._nType )
+	{
+	default:
+	case scMETRIC_COUNTER:
+		pDm->Trace( nLabel, "%s: %u\n\r", copy._pName, copy._nValue );
+		break;
+	case scMETRIC_GAUGE:
+		pDm->Trace( nLabel, "%s: %u, peak %u\n\r", copy._pName, copy._nValue, copy._nPeak );
+		break;
+	case scMETRIC_HISTOGRAM:
+		{
+			char sLine[160];
+			pDm->Trace( nLabel, "%s: %u samples, mean %u, max %u\n\r", copy._pName, copy._nValue,
+				( copy._nValue > 0 ) ? copy._nTotal / copy._nValue : 0, copy._nPeak );
+			uint32_t nLength = scFormat::Format( sLine, sizeof(sLine), "  buckets" );
+			for( uint32_t b=0; b < scMETRIC_BUCKETS && nLength < sizeof(sLine); ++b )
+			{
+				if ( copy._nBuckets[b] != 0 )
+				{
+					nLength += scFormat::Format( sLine + nLength, sizeof(sLine) - nLength, " %u:%u",
+						( b == 0 ) ? 0 : ( 1UL << b ), copy._nBuckets[b] );
+				}
+			}
+			pDm->Trace( nLabel, "%s\n\r", sLine );
+			break;
+		}
+	}
+}
+
+/// <summary>
+/// Bucket of a histogram a sample falls in, the power of two below it.
+/// </summary>
+uint32_t scMetrics::Bucket( uint32_t nValue )
+{
+	uint32_t nBucket = 0;
+
+	if ( nValue != 0 )
+	{
+#if defined(_MSC_VER)
+		unsigned long nBit;
+		_BitScanReverse( &nBit, nValue );
+		nBucket = nBit;
+#else
+		nBucket = 31 - __builtin_clz( nValue );
+#endif
+	}
+	return ( nBucket < scMETRIC_BUCKETS ) ? nBucket : scMETRIC_BUCKETS - 1;
+}
+
+/// <summary>
+/// Raise a value to at least nValue.
+/// </summary>
+void scMetrics::AtomicMax( volatile uint32_t* pValue, uint32_t nValue )
+{
+	uint32_t nCurrent = scAtomicLoad( pValue );
+	while( nValue > nCurrent && !scAtomicCompareExchange( pValue, nCurrent, nValue ) )
+	{
+		nCurrent = scAtomicLoad( pValue );
+	}
+}
+
+#endif // SC_METRICS_ENABLED
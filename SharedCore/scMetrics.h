@@ -0,0 +1,317 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scMetrics.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCMETRICS_H__INCLUDED_)
+#define __SCMETRICS_H__INCLUDED_
+
+#include "scTypes.h"
+
+// Set to 1 in scConf.h to build the metrics. When 0 the framework metrics are
+// removed by the preprocessor and cost nothing.
+#ifndef SC_METRICS_ENABLED
+	#define SC_METRICS_ENABLED			(0)
+#endif
+
+namespace SharedCore
+{
+	/// <summary>
+	/// Number of buckets of a histogram, bucket n counts the samples from 2^n up to
+	/// 2^(n+1) - 1, the last one everything larger.
+	/// </summary>
+	#define scMETRIC_BUCKETS			(16)
+
+	/// <summary>
+	/// Kinds of metric.
+	/// </summary>
+	typedef enum
+	{
+		/// <summary>
+		/// Counts up, _nValue is the count.
+		/// </summary>
+		scMETRIC_COUNTER,
+
+		/// <summary>
+		/// A level going up and down, _nValue is the level and _nPeak the highest it
+		/// reached.
+		/// </summary>
+		scMETRIC_GAUGE,
+
+		/// <summary>
+		/// Distribution of samples, _nValue is the number of samples, _nPeak the
+		/// largest and _nTotal their sum.
+		/// </summary>
+		scMETRIC_HISTOGRAM
+	} scMetricType_t;
+
+	/// <summary>
+	/// Metrics kept by SharedCore. There is one of each for the whole system, the
+	/// driver, ring buffer and queue metrics are aggregates over every instance.
+	/// An application wanting the figures of one instance declares and registers
+	/// metrics of its own.
+	/// </summary>
+	typedef enum
+	{
+		/// <summary>
+		/// Bytes received and sent, and writes truncated, summed over every driver.
+		/// </summary>
+		scMETRIC_DRIVER_TOTAL_BYTES_IN,
+		scMETRIC_DRIVER_TOTAL_BYTES_OUT,
+		scMETRIC_DRIVER_TOTAL_OVERFLOWS,
+		scMETRIC_FACTORY_CREATES,
+		scMETRIC_FACTORY_FAILURES,
+		scMETRIC_FACTORY_IN_USE,
+		scMETRIC_FACTORY_SIZE,
+
+		/// <summary>
+		/// Highest fill, in bytes, reached by any one ring buffer.
+		/// </summary>
+		scMETRIC_RING_MAX_PEAK,
+
+		/// <summary>
+		/// Items waiting in every queue together, and sends refused by a full queue.
+		/// </summary>
+		scMETRIC_QUEUE_TOTAL_DEPTH,
+		scMETRIC_QUEUE_TOTAL_FULL,
+
+		scMETRIC_DEVICE_COUNT,
+		scMETRIC_DEVICE_MISSING,
+		scMETRIC_CORE_COUNT
+	} scMetricId_t;
+
+	/// <summary>
+	/// A named metric. The application declares its own statically, initialized
+	/// with one of the scMETRIC_*_INIT macros, and registers them with
+	/// scMetrics::Register. Every field is updated with atomics so a metric may be
+	/// changed from any task or interrupt.
+	/// </summary>
+	typedef struct scMetric_s
+	{
+		/// <summary>
+		/// Name reported with the metric, must stay valid.
+		/// </summary>
+		const char*					_pName;
+
+		/// <summary>
+		/// One of scMetricType_t.
+		/// </summary>
+		uint32_t					_nType;
+
+		/// <summary>
+		/// The count, the level of a gauge or the number of samples.
+		/// </summary>
+		volatile uint32_t			_nValue;
+
+		/// <summary>
+		/// Highest level of a gauge or largest sample.
+		/// </summary>
+		volatile uint32_t			_nPeak;
+
+		/// <summary>
+		/// Sum of the samples of a histogram.
+		/// </summary>
+		volatile uint32_t			_nTotal;
+
+		/// <summary>
+		/// scMETRIC_BUCKETS counts of a histogram, NULL for the other kinds.
+		/// </summary>
+		volatile uint32_t*			_pBuckets;
+
+		/// <summary>
+		/// Set once the metric is in the list of the registry.
+		/// </summary>
+		volatile uint32_t			_nListed;
+
+		/// <summary>
+		/// The next registered metric.
+		/// </summary>
+		struct scMetric_s*			_pNext;
+	} scMetric_t;
+
+	/// <summary>
+	/// Initializers for a scMetric_t.
+	/// </summary>
+	#define scMETRIC_COUNTER_INIT( pName )				{ pName, SharedCore::scMETRIC_COUNTER, 0, 0, 0, NULL, 0, NULL }
+	#define scMETRIC_GAUGE_INIT( pName )				{ pName, SharedCore::scMETRIC_GAUGE, 0, 0, 0, NULL, 0, NULL }
+	#define scMETRIC_HISTOGRAM_INIT( pName, pBuckets )	{ pName, SharedCore::scMETRIC_HISTOGRAM, 0, 0, 0, pBuckets, 0, NULL }
+
+	/// <summary>
+	/// Copy of a metric taken by scMetrics::Snapshot.
+	/// </summary>
+	typedef struct
+	{
+		const char*					_pName;
+		uint32_t					_nType;
+		uint32_t					_nValue;
+		uint32_t					_nPeak;
+		uint32_t					_nTotal;
+		uint32_t					_nBuckets[scMETRIC_BUCKETS];
+	} scMetricSnapshot_t;
+
+	/// <summary>
+	/// Registry of the metrics, those of SharedCore followed by the ones the
+	/// application registered. The SharedCore metrics add up every instance of a
+	/// component: the bytes of every driver, the messages of every factory.
+	///
+	/// Updating a metric is one or two atomic operations and never takes a lock.
+	/// Snapshot copies the metrics and can reset them in the same pass, taking
+	/// each value with an exchange, so nothing counted between the copy and the
+	/// reset is lost.
+	/// </summary>
+	class scMetrics
+	{
+	public:
+		/// <summary>
+		/// A metric of SharedCore.
+		/// </summary>
+		static scMetric_t& Core( uint32_t nId )
+		{
+			return s_Core[nId];
+		}
+
+		/// <summary>
+		/// Count up a counter or raise the level of a gauge.
+		/// </summary>
+		static void Add( scMetric_t& metric, uint32_t nValue );
+
+		/// <summary>
+		/// Lower the level of a gauge.
+		/// </summary>
+		static void Subtract( scMetric_t& metric, uint32_t nValue );
+
+		/// <summary>
+		/// Set the level of a gauge.
+		/// </summary>
+		static void Set( scMetric_t& metric, uint32_t nValue );
+
+		/// <summary>
+		/// Raise the peak of a gauge without changing its level, for a gauge only
+		/// tracking a highest value.
+		/// </summary>
+		static void Peak( scMetric_t& metric, uint32_t nValue );
+
+		/// <summary>
+		/// Add a sample to a histogram.
+		/// </summary>
+		static void Sample( scMetric_t& metric, uint32_t nValue );
+
+		/// <summary>
+		/// Add a metric of the application to the registry, once, later calls do
+		/// nothing. The metric stays in the registry, it must be static.
+		/// </summary>
+		static void Register( scMetric_t& metric );
+
+		/// <summary>
+		/// Find a metric by name.
+		/// </summary>
+		/// <returns>NULL if there is none.</returns>
+		static scMetric_t* Find( const char* pName );
+
+		/// <summary>
+		/// Number of metrics in the registry.
+		/// </summary>
+		static uint32_t Count( void );
+
+		/// <summary>
+		/// Copy the metrics and optionally reset them. Counters and histograms start
+		/// over from zero, a gauge keeps its level and its peak starts from it.
+		/// </summary>
+		/// <param name="pSnapshot">Receives the copies, may be NULL to only reset.
+		/// </param>
+		/// <param name="nMax">Number of entries in pSnapshot.</param>
+		/// <param name="bReset">Reset the metrics as they are copied, all of them even
+		/// those that did not fit.</param>
+		/// <returns>Number of entries filled.</returns>
+		static uint32_t Snapshot( scMetricSnapshot_t* pSnapshot, uint32_t nMax, bool bReset );
+
+		/// <summary>
+		/// Reset every metric.
+		/// </summary>
+		static void Reset( void )
+		{
+			Snapshot( NULL, 0, true );
+		}
+
+		/// <summary>
+		/// Trace every metric through the debug manager.
+		/// </summary>
+		/// <param name="nLabel">The debug label to trace with.</param>
+		static void Dump( uint16_t nLabel );
+
+		/// <summary>
+		/// Bucket of a histogram a sample falls in.
+		/// </summary>
+		static uint32_t Bucket( uint32_t nValue );
+
+	private:
+		/// <summary>
+		/// Copy, and reset, one metric.
+		/// </summary>
+		static void Take( scMetric_t& metric, scMetricSnapshot_t* pSnapshot, bool bReset );
+
+		/// <summary>
+		/// Trace one metric.
+		/// </summary>
+		static void Dump( scMetric_t& metric, uint16_t nLabel );
+
+		/// <summary>
+		/// Raise a value to at least nValue.
+		/// </summary>
+		static void AtomicMax( volatile uint32_t* pValue, uint32_t nValue );
+
+		/// <summary>
+		/// The metrics of SharedCore.
+		/// </summary>
+		static scMetric_t				s_Core[scMETRIC_CORE_COUNT];
+
+		/// <summary>
+		/// Metrics registered by the application, newest first.
+		/// </summary>
+		static scMetric_t* volatile		s_pRegistered;
+	};
+}
+
+#if SC_METRICS_ENABLED
+	/// <summary>
+	/// Update a metric of SharedCore, see scMetricId_t.
+	/// </summary>
+	#define scMETRIC_ADD( nId, nValue )			SharedCore::scMetrics::Add( SharedCore::scMetrics::Core( nId ), nValue )
+	#define scMETRIC_SUBTRACT( nId, nValue )	SharedCore::scMetrics::Subtract( SharedCore::scMetrics::Core( nId ), nValue )
+	#define scMETRIC_PEAK( nId, nValue )		SharedCore::scMetrics::Peak( SharedCore::scMetrics::Core( nId ), nValue )
+	#define scMETRIC_SAMPLE( nId, nValue )		SharedCore::scMetrics::Sample( SharedCore::scMetrics::Core( nId ), nValue )
+#else
+	#define scMETRIC_ADD( nId, nValue )			do { } while(0)
+	#define scMETRIC_SUBTRACT( nId, nValue )	do { } while(0)
+	#define scMETRIC_PEAK( nId, nValue )		do { } while(0)
+	#define scMETRIC_SAMPLE( nId, nValue )		do { } while(0)
+#endif
+
+#endif // !defined(__SCMETRICS_H__INCLUDED_)
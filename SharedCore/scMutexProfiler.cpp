@@ -0,0 +1,248 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scMutexProfiler.cpp
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#include <string.h>
+#include "scMutexProfiler.h"
+#include "scAtomic.h"
+#include "scHiResClock.h"
+#include "scDebugManager.h"
+
+using namespace SharedCore;
+
+scMutexProfiler* volatile scMutexProfiler::s_pRegistered = NULL;
+
+/// <summary>
+/// Constructor.
+/// </summary>
+/// <param name="pMutex">The mutex that does the locking.</param>
+/// <param name="pName">Name shown by Report, must stay valid.</param>
+scMutexProfiler::scMutexProfiler( scIMutex* pMutex, const char* pName )
+	: scIMutex()
+	, _pMutex( pMutex )
+	, _pName( pName )
+	, _nTimeouts( 0 )
+	, _nHoldStart( 0 )
+	, _nListed( 0 )
+	, _pNext( NULL )
+{
+	assert_param( pMutex != NULL );
+	memset( &_Stats, 0, sizeof(_Stats) );
+}
+
+/// <summary>
+/// Destructor, the wrapped mutex is not deleted.
+/// </summary>
+scMutexProfiler::~scMutexProfiler()
+{
+}
+
+/// <summary>
+/// Try the mutex without waiting, then with the timeout.
+/// </summary>
+/// <returns>Non zero when the mutex was acquired.</returns>
+int scMutexProfiler::TryAcquire( uint32_t timeout )
+{
+	int nResult = _pMutex->TryAcquire( 0 );
+	if ( nResult != 0 )
+	{
+		Acquired( false, 0 );
+	}
+	else if ( timeout > 0 )
+	{
+		uint64_t nStart = scHiResClock::Ticks();
+		nResult = _pMutex->TryAcquire( timeout );
+		if ( nResult != 0 )
+		{
+			Acquired( true, scHiResClock::Ticks() - nStart );
+		}
+	}
+	if ( nResult == 0 )
+	{
+		scAtomicAdd( &_nTimeouts, 1 );
+	}
+	return nResult;
+}
+
+/// <summary>
+/// Try the mutex without waiting, then wait for it.
+/// </summary>
+void scMutexProfiler::Acquire( void )
+{
+	if ( _pMutex->TryAcquire( 0 ) != 0 )
+	{
+		Acquired( false, 0 );
+	}
+	else
+	{
+		uint64_t nStart = scHiResClock::Ticks();
+		_pMutex->Acquire();
+		Acquired( true, scHiResClock::Ticks() - nStart );
+	}
+}
+
+/// <summary>
+/// Add the hold time and release the mutex.
+/// </summary>
+void scMutexProfiler::Release( void )
+{
+	Releasing();
+	_pMutex->Release();
+}
+
+/// <summary>
+/// Add the hold time and release the mutex from an interrupt.
+/// </summary>
+void scMutexProfiler::ReleaseISR( void )
+{
+	Releasing();
+	_pMutex->ReleaseISR();
+}
+
+/// <summary>
+/// Copy the statistics.
+/// </summary>
+void scMutexProfiler::Statistics( scMutexStats_t& stats ) const
+{
+	stats = _Stats;
+	stats._nTimeouts = scAtomicLoad( &_nTimeouts );
+}
+
+/// <summary>
+/// Start the statistics over. Call it while the lock is not in use.
+/// </summary>
+void scMutexProfiler::Reset( void )
+{
+	memset( &_Stats, 0, sizeof(_Stats) );
+	scAtomicStore( &_nTimeouts, 0 );
+}
+
+/// <summary>
+/// Add a profiler to the list of Report, once.
+/// </summary>
+void scMutexProfiler::Register( scMutexProfiler& profiler )
+{
+	if ( !scAtomicCompareExchange( &profiler._nListed, 0, 1 ) )
+	{
+		return;
+	}
+	do
+	{
+		profiler._pNext = scAtomicLoadPointer( &s_pRegistered );
+	} while( !scAtomicCompareExchangePointer( &s_pRegistered, profiler._pNext, &profiler ) );
+}
+
+/// <summary>
+/// Trace the registered locks, the one waited for the longest in total first. The
+/// hottest are kept in a short array sorted as it is filled, so nothing is allocated.
+/// </summary>
+/// <param name="nLabel">The debug label to trace with.</param>
+void scMutexProfiler::Report( uint16_t nLabel )
+{
+	scMutexProfiler*	hottest[SC_MUTEX_REPORT];
+	scMutexStats_t		stats[SC_MUTEX_REPORT];
+	uint32_t			nCount = 0;
+	uint32_t			nTotal = 0;
+
+	for( scMutexProfiler* pLock = scAtomicLoadPointer( &s_pRegistered ); pLock != NULL; pLock = pLock->_pNext )
+	{
+		scMutexStats_t	current;
+		uint32_t		nAt;
+
+		pLock->Statistics( current );
+		nTotal++;
+		for( nAt = nCount; nAt > 0 && stats[nAt - 1]._nWaitTotal < current._nWaitTotal; nAt-- )
+		{
+			if ( nAt < SC_MUTEX_REPORT )
+			{
+				hottest[nAt] = hottest[nAt - 1];
+				stats[nAt] = stats[nAt - 1];
+			}
+		}
+		if ( nAt < SC_MUTEX_REPORT )
+		{
+			hottest[nAt] = pLock;
+			stats[nAt] = current;
+			if ( nCount < SC_MUTEX_REPORT )
+			{
+				nCount++;
+			}
+		}
+	}
+
+	scDebugManager* pDm = scDebugManager::Instance();
+	pDm->Trace( nLabel, "scMutexProfiler: %u locks, hottest first\n\r", nTotal );
+	for( uint32_t i = 0; i < nCount; i++ )
+	{
+		const scMutexStats_t& s = stats[i];
+		pDm->Trace( nLabel, "%s: %u acquired, %u contended, %u timeouts, wait %u us max %u us, hold %u us max %u us\n\r",
+			hottest[i]->_pName,
+			s._nAcquisitions,
+			s._nContended,
+			s._nTimeouts,
+			(uint32_t)scHiResClock::ToMicroseconds( s._nWaitTotal ),
+			(uint32_t)scHiResClock::ToMicroseconds( s._nWaitMax ),
+			(uint32_t)scHiResClock::ToMicroseconds( s._nHoldTotal ),
+			(uint32_t)scHiResClock::ToMicroseconds( s._nHoldMax ) );
+	}
+}
+
+/// <summary>
+/// Count an acquisition after waiting nWait ticks. Called with the lock held.
+/// </summary>
+void scMutexProfiler::Acquired( bool bContended, uint64_t nWait )
+{
+	_Stats._nAcquisitions++;
+	if ( bContended )
+	{
+		_Stats._nContended++;
+		_Stats._nWaitTotal += nWait;
+		if ( nWait > _Stats._nWaitMax )
+		{
+			_Stats._nWaitMax = nWait;
+		}
+	}
+	_nHoldStart = scHiResClock::Ticks();
+}
+
+/// <summary>
+/// Count the hold time that ends now. Called with the lock still held.
+/// </summary>
+void scMutexProfiler::Releasing( void )
+{
+	uint64_t nHold = scHiResClock::Ticks() - _nHoldStart;
+
+	_Stats._nHoldTotal += nHold;
+	if ( nHold > _Stats._nHoldMax )
+	{
+		_Stats._nHoldMax = nHold;
+	}
+}
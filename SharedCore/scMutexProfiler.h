@@ -0,0 +1,215 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scMutexProfiler.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCMUTEXPROFILER_H__INCLUDED_)
+#define __SCMUTEXPROFILER_H__INCLUDED_
+
+#include "scTypes.h"
+#include "scIMutex.h"
+
+// Most locks listed by scMutexProfiler::Report. Define it in scConf.h to change it.
+#ifndef SC_MUTEX_REPORT
+	#define SC_MUTEX_REPORT				(16)
+#endif
+
+namespace SharedCore
+{
+	/// <summary>
+	/// Statistics of a profiled lock, the times are ticks of scHiResClock.
+	/// </summary>
+	typedef struct
+	{
+		/// <summary>
+		/// Number of times the lock was taken.
+		/// </summary>
+		uint32_t			_nAcquisitions;
+
+		/// <summary>
+		/// Number of those where the lock was held by another task and had to be
+		/// waited for.
+		/// </summary>
+		uint32_t			_nContended;
+
+		/// <summary>
+		/// Number of TryAcquire calls that gave up.
+		/// </summary>
+		uint32_t			_nTimeouts;
+
+		/// <summary>
+		/// Total and longest time spent waiting for the lock.
+		/// </summary>
+		uint64_t			_nWaitTotal;
+		uint64_t			_nWaitMax;
+
+		/// <summary>
+		/// Total and longest time the lock was held.
+		/// </summary>
+		uint64_t			_nHoldTotal;
+		uint64_t			_nHoldMax;
+	} scMutexStats_t;
+
+	/// <summary>
+	/// Wraps a mutex to find out how contended it is. Each acquisition first tries
+	/// the mutex without waiting; when that fails the lock is contended and the time
+	/// until it is obtained is the wait. The hold time runs from the acquisition to
+	/// the release. The statistics are updated while the lock is held so they need
+	/// no lock of their own.
+	///
+	/// The profiler is given wherever the mutex was, to a factory, a ring buffer or
+	/// the LED engine for example, and Register adds it to the list that Report
+	/// traces, hottest lock first:
+	///
+	///   static scMutexProfiler factoryLock( &rtosMutex, "factory" );
+	///   scMutexProfiler::Register( factoryLock );
+	///   factory.Initialize( memory, memory, &factoryLock );
+	/// </summary>
+	class scMutexProfiler : public scIMutex
+	{
+	public:
+		/// <summary>
+		/// Constructor.
+		/// </summary>
+		/// <param name="pMutex">The mutex that does the locking.</param>
+		/// <param name="pName">Name shown by Report, must stay valid.</param>
+		scMutexProfiler( scIMutex* pMutex, const char* pName );
+
+		/// <summary>
+		/// Destructor, the wrapped mutex is not deleted.
+		/// </summary>
+		virtual ~scMutexProfiler();
+
+		/// <summary>
+		/// Try the mutex without waiting, then with the timeout.
+		/// </summary>
+		/// <returns>Non zero when the mutex was acquired.</returns>
+		virtual int TryAcquire( uint32_t timeout );
+
+		/// <summary>
+		/// Try the mutex without waiting, then wait for it.
+		/// </summary>
+		virtual void Acquire( void );
+
+		/// <summary>
+		/// Add the hold time and release the mutex.
+		/// </summary>
+		virtual void Release( void );
+
+		/// <summary>
+		/// Add the hold time and release the mutex from an interrupt.
+		/// </summary>
+		virtual void ReleaseISR( void );
+
+		/// <summary>
+		/// Name shown by Report.
+		/// </summary>
+		const char* Name( void ) const
+		{
+			return _pName;
+		}
+
+		/// <summary>
+		/// Copy the statistics.
+		/// </summary>
+		void Statistics( scMutexStats_t& stats ) const;
+
+		/// <summary>
+		/// Start the statistics over. Call it while the lock is not in use.
+		/// </summary>
+		void Reset( void );
+
+		/// <summary>
+		/// Add a profiler to the list of Report, once, later calls do nothing. The
+		/// profiler stays in the list, it must be static.
+		/// </summary>
+		static void Register( scMutexProfiler& profiler );
+
+		/// <summary>
+		/// Trace the registered locks, the one waited for the longest in total first,
+		/// up to SC_MUTEX_REPORT of them.
+		/// </summary>
+		/// <param name="nLabel">The debug label to trace with.</param>
+		static void Report( uint16_t nLabel );
+
+	private:
+		/// <summary>
+		/// Count an acquisition after waiting nWait ticks.
+		/// </summary>
+		void Acquired( bool bContended, uint64_t nWait );
+
+		/// <summary>
+		/// Count the hold time that ends now.
+		/// </summary>
+		void Releasing( void );
+
+		/// <summary>
+		/// The mutex that does the locking.
+		/// </summary>
+		scIMutex*						_pMutex;
+
+		/// <summary>
+		/// Name shown by Report.
+		/// </summary>
+		const char*						_pName;
+
+		/// <summary>
+		/// The statistics.
+		/// </summary>
+		scMutexStats_t					_Stats;
+
+		/// <summary>
+		/// Timeouts are counted without the lock, with atomics.
+		/// </summary>
+		volatile uint32_t				_nTimeouts;
+
+		/// <summary>
+		/// When the lock was taken by its holder.
+		/// </summary>
+		uint64_t						_nHoldStart;
+
+		/// <summary>
+		/// Set once the profiler is in the list of Report.
+		/// </summary>
+		volatile uint32_t				_nListed;
+
+		/// <summary>
+		/// The next registered profiler.
+		/// </summary>
+		scMutexProfiler*				_pNext;
+
+		/// <summary>
+		/// Registered profilers, newest first.
+		/// </summary>
+		static scMutexProfiler* volatile	s_pRegistered;
+	};
+}
+
+#endif // !defined(__SCMUTEXPROFILER_H__INCLUDED_)
@@ -0,0 +1,261 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scProfiler.cpp
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#include <string.h>
+#include "scProfiler.h"
+
+#if SC_PROFILER_ENABLED
+
+#include "scAtomic.h"
+#include "scHiResClock.h"
+#include "scDebugManager.h"
+#include "scFormat.h"
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
+using namespace SharedCore;
+
+scProfileStats_t		scProfiler::s_Probes[SC_PROFILER_PROBES];
+const scProfileName_t*	scProfiler::s_pNames = NULL;
+uint16_t				scProfiler::s_nNames = 0;
+
+/// <summary>
+/// Names of the SharedCore probes.
+/// </summary>
+static const char* const g_CoreNames[scPROBE_APPLICATION] =
+{
+	"Send",
+	"HandleInput",
+	"ReliableLink::Poll",
+	"Batcher::Poll",
+	"Dispatch"
+};
+
+/// <summary>
+/// Add a duration to the statistics of a probe.
+/// </summary>
+/// <param name="nProbe">The probe ID.</param>
+/// <param name="nTicks">The duration in ticks of scHiResClock.</param>
+void scProfiler::Record( uint16_t nProbe, uint32_t nTicks )
+{
+	if ( nProbe >= SC_PROFILER_PROBES )
+	{
+		return;
+	}
+	scProfileStats_t& stats = s_Probes[nProbe];
+
+	scAtomicAdd( &stats._nCount, 1 );
+	AtomicMax( &stats._nMinInverted, ~nTicks );
+	AtomicMax( &stats._nMax, nTicks );
+	if ( scAtomicAdd( &stats._nTotalLow, nTicks ) < nTicks )
+	{
+		scAtomicAdd( &stats._nTotalHigh, 1 );
+	}
+	scAtomicAdd( &stats._nBuckets[Bucket( nTicks )], 1 );
+}
+
+/// <summary>
+/// The statistics of a probe.
+/// </summary>
+/// <returns>NULL if the ID is past SC_PROFILER_PROBES.</returns>
+const scProfileStats_t* scProfiler::Stats( uint16_t nProbe )
+{
+	return ( nProbe < SC_PROFILER_PROBES ) ? &s_Probes[nProbe] : NULL;
+}
+
+/// <summary>
+/// The mean duration of a probe in ticks.
+/// </summary>
+uint32_t scProfiler::Mean( uint16_t nProbe )
+{
+	const scProfileStats_t* pStats = Stats( nProbe );
+	if ( pStats == NULL || pStats->_nCount == 0 )
+	{
+		return 0;
+	}
+	uint64_t nTotal = ( (uint64_t)pStats->_nTotalHigh << 32 ) | pStats->_nTotalLow;
+	return (uint32_t)( nTotal / pStats->_nCount );
+}
+
+/// <summary>
+/// The shortest duration of a probe in ticks, zero when never passed.
+/// </summary>
+uint32_t scProfiler::Min( uint16_t nProbe )
+{
+	const scProfileStats_t* pStats = Stats( nProbe );
+	if ( pStats == NULL || pStats->_nCount == 0 )
+	{
+		return 0;
+	}
+	return ~pStats->_nMinInverted;
+}
+
+/// <summary>
+/// Clear the statistics of every probe. A probe passed meanwhile can be partly
+/// cleared.
+/// </summary>
+void scProfiler::Reset( void )
+{
+	memset( (void*)s_Probes, 0, sizeof(s_Probes) );
+}
+
+/// <summary>
+/// Assign the names shown by Dump for the probes of the application, the
+/// SharedCore probes are named already.
+/// </summary>
+/// <param name="pNames">The table, must stay valid.</param>
+/// <param name="nCount">Number of entries in the table.</param>
+void scProfiler::SetNames( const scProfileName_t* pNames, uint16_t nCount )
+{
+	s_pNames = pNames;
+	s_nNames = nCount;
+}
+
+/// <summary>
+/// Convert ticks to microseconds with three decimals.
+/// </summary>
+static uint64_t Nanoseconds( uint32_t nTicks )
+{
+	return scHiResClock::ToMicroseconds( (uint64_t)nTicks * 1000 );
+}
+
+/// <summary>
+/// Trace the statistics of every probe that was passed, times in microseconds,
+/// followed by the histogram buckets that are not empty, as the lowest number of
+/// ticks of the bucket and its count.
+/// </summary>
+/// <param name="nLabel">The debug label to trace with.</param>
+void scProfiler::Dump( uint16_t nLabel )
+{
+	scDebugManager*	pDm = scDebugManager::Instance();
+	char			sLine[192];
+
+	for( uint16_t i=0; i < SC_PROFILER_PROBES; ++i )
+	{
+		uint32_t nCount = s_Probes[i]._nCount;
+		if ( nCount == 0 )
+		{
+			continue;
+		}
+
+		uint64_t nMin = Nanoseconds( Min( i ) );
+		uint64_t nMean = Nanoseconds( Mean( i ) );
+		uint64_t nMax = Nanoseconds( s_Probes[i]._nMax );
+		pDm->Trace( nLabel, "%s: %u calls, min %u.%03u mean %u.%03u max %u.%03u us\n\r", Name( i ), nCount,
+			(uint32_t)( nMin / 1000 ), (uint32_t)( nMin % 1000 ), (uint32_t)( nMean / 1000 ), (uint32_t)( nMean % 1000 ),
+			(uint32_t)( nMax / 1000 ), (uint32_t)( nMax % 1000 ) );
+
+		uint32_t nLength = scFormat::Format( sLine, sizeof(sLine), "  ticks" );
+		for( uint32_t b=0; b < scPROFILE_BUCKETS && nLength < sizeof(sLine); ++b )
+		{
+			if ( s_Probes[i]._nBuckets[b] != 0 )
+			{
+				nLength += scFormat::Format( sLine + nLength, sizeof(sLine) - nLength, " %u:%u",
+					( b == 0 ) ? 0 : ( 1UL << b ), s_Probes[i]._nBuckets[b] );
+			}
+		}
+		pDm->Trace( nLabel, "%s\n\r", sLine );
+	}
+}
+
+/// <summary>
+/// The bucket of a duration, the position of its highest bit. Zero and one both go
+/// to the first bucket.
+/// </summary>
+uint32_t scProfiler::Bucket( uint32_t nTicks )
+{
+	if ( nTicks == 0 )
+	{
+		return 0;
+	}
+#if defined(_MSC_VER)
+	unsigned long nBit;
+	_BitScanReverse( &nBit, nTicks );
+	return nBit;
+#else
+	return 31 - __builtin_clz( nTicks );
+#endif
+}
+
+/// <summary>
+/// The name of a probe, its number when it has none.
+/// </summary>
+const char* scProfiler::Name( uint16_t nProbe )
+{
+	if ( nProbe < scPROBE_APPLICATION )
+	{
+		return g_CoreNames[nProbe];
+	}
+	for( uint16_t i=0; i < s_nNames; ++i )
+	{
+		if ( s_pNames[i]._nId == nProbe )
+		{
+			return s_pNames[i]._pName;
+		}
+	}
+	return "probe";
+}
+
+/// <summary>
+/// Raise a value to at least nValue.
+/// </summary>
+void scProfiler::AtomicMax( volatile uint32_t* pValue, uint32_t nValue )
+{
+	uint32_t nCurrent = scAtomicLoad( pValue );
+	while( nValue > nCurrent && !scAtomicCompareExchange( pValue, nCurrent, nValue ) )
+	{
+		nCurrent = scAtomicLoad( pValue );
+	}
+}
+
+/// <summary>
+/// Start timing.
+/// </summary>
+scProfileScope::scProfileScope( uint16_t nProbe )
+	: _nProbe( nProbe )
+	, _nStart( scHiResClock::Ticks() )
+{
+}
+
+/// <summary>
+/// Record the time since the construction, longer than 32 bits of ticks counts as
+/// the longest.
+/// </summary>
+scProfileScope::~scProfileScope()
+{
+	uint64_t nTicks = scHiResClock::Ticks() - _nStart;
+	scProfiler::Record( _nProbe, ( nTicks > 0xFFFFFFFFULL ) ? 0xFFFFFFFFUL : (uint32_t)nTicks );
+}
+
+#endif // SC_PROFILER_ENABLED
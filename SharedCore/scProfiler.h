@@ -0,0 +1,241 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scProfiler.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCPROFILER_H__INCLUDED_)
+#define __SCPROFILER_H__INCLUDED_
+
+#include "scTypes.h"
+
+// Set to 1 in scConf.h to build the profiler. When 0 the probes and the profiler
+// are removed by the preprocessor and cost nothing.
+#ifndef SC_PROFILER_ENABLED
+	#define SC_PROFILER_ENABLED			(0)
+#endif
+
+// Number of probes the profiler keeps statistics for. Define it in scConf.h to
+// change it.
+#ifndef SC_PROFILER_PROBES
+	#define SC_PROFILER_PROBES			(32)
+#endif
+
+namespace SharedCore
+{
+	/// <summary>
+	/// Probes placed in SharedCore. The application numbers its own from
+	/// scPROBE_APPLICATION on, with the same X-macro helpers as the trace formats:
+	///
+	///   #define APP_PROBES(X)
+	///       X( PROBE_ADC_READ, "AdcRead" )
+	///       X( PROBE_FILTER, "Filter" )
+	///
+	/// with each line of the macro but the last ending in a backslash, then
+	///
+	///   enum { PROBE_APP_BASE = scPROBE_APPLICATION - 1, APP_PROBES( scPROFILE_PROBE_ID ) };
+	///   static const scProfileName_t names[] = { APP_PROBES( scPROFILE_PROBE_ENTRY ) };
+	/// </summary>
+	typedef enum
+	{
+		scPROBE_SEND,
+		scPROBE_HANDLE_INPUT,
+		scPROBE_LINK_POLL,
+		scPROBE_BATCHER_POLL,
+		scPROBE_DISPATCH,
+		scPROBE_APPLICATION
+	} scProbeId_t;
+
+	#define scPROFILE_PROBE_ID( id, name )		id,
+	#define scPROFILE_PROBE_ENTRY( id, name )	{ id, name },
+
+	/// <summary>
+	/// Name of a probe, shown by Dump.
+	/// </summary>
+	typedef struct
+	{
+		uint16_t			_nId;
+		const char*			_pName;
+	} scProfileName_t;
+
+	/// <summary>
+	/// Number of buckets of the latency histogram, bucket n counts the durations of
+	/// 2^n up to 2^(n+1) - 1 ticks.
+	/// </summary>
+	#define scPROFILE_BUCKETS			(32)
+
+	/// <summary>
+	/// Statistics of one probe. Every field is updated with atomic operations so a
+	/// probe can be used by several tasks and interrupts at once.
+	/// </summary>
+	typedef struct
+	{
+		/// <summary>
+		/// Number of times the probe was passed.
+		/// </summary>
+		volatile uint32_t	_nCount;
+
+		/// <summary>
+		/// Shortest duration in ticks, stored inverted so the zero of a reset probe
+		/// is larger than any duration.
+		/// </summary>
+		volatile uint32_t	_nMinInverted;
+
+		/// <summary>
+		/// Longest duration in ticks.
+		/// </summary>
+		volatile uint32_t	_nMax;
+
+		/// <summary>
+		/// Total of the durations in ticks, low and high words.
+		/// </summary>
+		volatile uint32_t	_nTotalLow;
+		volatile uint32_t	_nTotalHigh;
+
+		/// <summary>
+		/// The log2 latency histogram.
+		/// </summary>
+		volatile uint32_t	_nBuckets[scPROFILE_BUCKETS];
+	} scProfileStats_t;
+
+	/// <summary>
+	/// Keeps count, minimum, maximum, mean and a log2 histogram of the duration of
+	/// each probe, timed with scHiResClock, the DWT cycle counter on a Cortex-M. A
+	/// probe is a scope marked with scPROFILE_SCOPE. The statistics live in a static
+	/// table indexed by the probe ID, so no allocation is involved.
+	/// </summary>
+	class scProfiler
+	{
+	public:
+		/// <summary>
+		/// Add a duration to the statistics of a probe.
+		/// </summary>
+		/// <param name="nProbe">The probe ID.</param>
+		/// <param name="nTicks">The duration in ticks of scHiResClock.</param>
+		static void Record( uint16_t nProbe, uint32_t nTicks );
+
+		/// <summary>
+		/// The statistics of a probe.
+		/// </summary>
+		/// <returns>NULL if the ID is past SC_PROFILER_PROBES.</returns>
+		static const scProfileStats_t* Stats( uint16_t nProbe );
+
+		/// <summary>
+		/// The mean duration of a probe in ticks.
+		/// </summary>
+		static uint32_t Mean( uint16_t nProbe );
+
+		/// <summary>
+		/// The shortest duration of a probe in ticks, zero when never passed.
+		/// </summary>
+		static uint32_t Min( uint16_t nProbe );
+
+		/// <summary>
+		/// Clear the statistics of every probe.
+		/// </summary>
+		static void Reset( void );
+
+		/// <summary>
+		/// Assign the names shown by Dump for the probes of the application, the
+		/// SharedCore probes are named already.
+		/// </summary>
+		/// <param name="pNames">The table, must stay valid.</param>
+		/// <param name="nCount">Number of entries in the table.</param>
+		static void SetNames( const scProfileName_t* pNames, uint16_t nCount );
+
+		/// <summary>
+		/// Trace the statistics of every probe that was passed, times in microseconds,
+		/// followed by the histogram buckets that are not empty.
+		/// </summary>
+		/// <param name="nLabel">The debug label to trace with.</param>
+		static void Dump( uint16_t nLabel );
+
+		/// <summary>
+		/// The bucket of a duration, the position of its highest bit.
+		/// </summary>
+		static uint32_t Bucket( uint32_t nTicks );
+
+	private:
+		/// <summary>
+		/// The name of a probe.
+		/// </summary>
+		static const char* Name( uint16_t nProbe );
+
+		/// <summary>
+		/// Raise a value to at least nValue.
+		/// </summary>
+		static void AtomicMax( volatile uint32_t* pValue, uint32_t nValue );
+
+		/// <summary>
+		/// Statistics of every probe.
+		/// </summary>
+		static scProfileStats_t			s_Probes[SC_PROFILER_PROBES];
+
+		/// <summary>
+		/// Names of the probes of the application.
+		/// </summary>
+		static const scProfileName_t*	s_pNames;
+		static uint16_t					s_nNames;
+	};
+
+	/// <summary>
+	/// Times its own life and adds it to a probe, see scPROFILE_SCOPE.
+	/// </summary>
+	class scProfileScope
+	{
+	public:
+		/// <summary>
+		/// Start timing.
+		/// </summary>
+		scProfileScope( uint16_t nProbe );
+
+		/// <summary>
+		/// Record the time since the construction.
+		/// </summary>
+		~scProfileScope();
+
+	private:
+		uint16_t		_nProbe;
+		uint64_t		_nStart;
+	};
+}
+
+#define scPROFILE_JOIN2( a, b )		a##b
+#define scPROFILE_JOIN( a, b )		scPROFILE_JOIN2( a, b )
+
+#if SC_PROFILER_ENABLED
+	/// <summary>
+	/// Time the rest of the enclosing scope under a probe.
+	/// </summary>
+	#define scPROFILE_SCOPE( nProbe )	SharedCore::scProfileScope scPROFILE_JOIN( scProbe_, __LINE__ )( nProbe )
+#else
+	#define scPROFILE_SCOPE( nProbe )	do { } while(0)
+#endif
+
+#endif // !defined(__SCPROFILER_H__INCLUDED_)
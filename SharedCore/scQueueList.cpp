@@ -28,6 +28,7 @@
 
 #include <string.h>
 #include "scQueueList.h"
+#include "scMetrics.h"
 
 namespace SharedCore
 {
@@ -77,6 +78,7 @@ namespace SharedCore
 		{
 			delete _items.front();
 			_items.pop_front();
+			scMETRIC_SUBTRACT( scMETRIC_QUEUE_TOTAL_DEPTH, 1 );
 		}
 		_items.empty();
 	}
@@ -97,8 +99,13 @@ namespace SharedCore
 			memcpy( pNextItem, pvItemToQueue, _nItemSize );
 #endif
 			_items.push_front( pNextItem );
+			scMETRIC_ADD( scMETRIC_QUEUE_TOTAL_DEPTH, 1 );
 			nResult = 1;
 		}
+		else
+		{
+			scMETRIC_ADD( scMETRIC_QUEUE_TOTAL_FULL, 1 );
+		}
 		return nResult;
 	}
 
@@ -123,8 +130,13 @@ namespace SharedCore
 			memcpy( pNextItem, pvItemToQueue, _nItemSize );
 #endif
 			_items.push_back( pNextItem );
+			scMETRIC_ADD( scMETRIC_QUEUE_TOTAL_DEPTH, 1 );
 			nResult = 1;
 		}
+		else
+		{
+			scMETRIC_ADD( scMETRIC_QUEUE_TOTAL_FULL, 1 );
+		}
 		return nResult;
 	}
 
@@ -176,6 +188,7 @@ namespace SharedCore
 			memcpy( pBuffer, pItem, _nItemSize );
 #endif
 			delete pItem;
+			scMETRIC_SUBTRACT( scMETRIC_QUEUE_TOTAL_DEPTH, 1 );
 			nResult = 1;
 		}
 		return nResult;
@@ -191,4 +204,12 @@ namespace SharedCore
 		return _nMaxListSize - _items.size();
 	}
 
+	/// <summary>
+	/// Return the number of items waiting in the queue.
+	/// </summary>
+	uint32_t scQueueList::MessagesWaiting(void)
+	{
+		return (uint32_t)_items.size();
+	}
+
 }	// Namespace SharedCore
\ No newline at end of file
@@ -117,6 +117,11 @@ namespace SharedCore
 		/// </summary>
 		virtual uint32_t SpacesAvailable(void);
 
+		/// <summary>
+		/// Return the number of items waiting in the queue.
+		/// </summary>
+		virtual uint32_t MessagesWaiting(void);
+
 	private:
 		std::list<uint8_t*>		_items;
 		uint32_t				_nItemSize;
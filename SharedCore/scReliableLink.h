@@ -0,0 +1,671 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scReliableLink.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCRELIABLELINK_H__INCLUDED_)
+#define __SCRELIABLELINK_H__INCLUDED_
+
+#include "scTypes.h"
+#include "scAllocator.h"
+#include "scIMutex.h"
+#include "scScopeLock.h"
+#include "scDebugManager.h"
+#include "scDebugLabelCodes.h"
+#include "scErrorCodes.h"
+#include "scProfiler.h"
+#include "scStandardHeader_t.h"
+#include "scMessageFactory.h"
+#include "scMessageRouter.h"
+#include "HAL/scBufferedIODriver.h"
+
+
+#ifndef assert_param
+#define assert_param(X)	if ( !(X) ) { for(;;) ; }
+#endif
+
+/// <summary>
+/// The largest window allowed. The 8-bit sequence number must be able to tell a new
+/// message from a repeat of one that has already been acknowledged.
+/// </summary>
+#define scRELIABLE_MAX_WINDOW		(127)
+
+
+namespace SharedCore
+{
+	/// <summary>
+	/// Provides reliable, in order delivery of messages over a point to point link using
+	/// the sequence number of the standard header. Up to the window size of messages
+	/// can be outstanding before an acknowledge is needed, which removes the round trip
+	/// wait of a stop and wait protocol. The receiver sends a cumulative acknowledge
+	/// for every message that arrives in order and a negative acknowledge when it sees
+	/// a gap. The sender sends everything outstanding again when it gets a negative
+	/// acknowledge or when the oldest message has not been acknowledged before the
+	/// retransmit timeout (go back N). Repeated messages are dropped by the receiver.
+	/// </summary>
+	template<class IMessage>
+	class scReliableLink
+	{
+	public:
+		/// <summary>
+		/// Function used to obtain a free running tick count for the retransmit timer.
+		/// </summary>
+		typedef uint32_t (*TickSource_t)( void );
+
+		/// <summary>
+		/// Construct the link.
+		/// </summary>
+		/// <param name="nWindow">Number of messages that may be waiting for an
+		/// acknowledge, 1 to scRELIABLE_MAX_WINDOW.</param>
+		/// <param name="nAddress">The address of this end of the link, used as the
+		/// source of the acknowledge messages.</param>
+		/// <param name="nControlId">Message ID used for the acknowledge messages.</param>
+		scReliableLink( uint8_t nWindow, uint16_t nAddress, typename IMessage::MsgType_t nControlId );
+
+		/// <summary>
+		/// Destructor. Releases the messages still waiting for an acknowledge.
+		/// </summary>
+		virtual ~scReliableLink();
+
+		/// <summary>
+		/// Allocate the window.
+		/// </summary>
+		/// <param name="allocator">Allocator used for the window memory.</param>
+		/// <param name="pProtect">Mutex protecting the link state.</param>
+		/// <param name="pDriver">Driver the messages are sent to.</param>
+		/// <param name="pFactory">Holds the copies of the messages until they are
+		/// acknowledged.</param>
+		/// <param name="pRouter">Receives the messages that arrive.</param>
+		virtual uint32_t Initialize( scAllocator allocator, scIMutex* pProtect, HAL::scBufferIODriver* pDriver,
+			scMessageFactory<IMessage>* pFactory, scMessageRouter<IMessage>* pRouter );
+
+		/// <summary>
+		/// Set the function used for the retransmit timer.
+		/// </summary>
+		/// <param name="pSource">Tick function.</param>
+		void SetTickSource( TickSource_t pSource )
+		{
+			_pTickSource = pSource;
+		}
+
+		/// <summary>
+		/// Set the time to wait for an acknowledge before sending again.
+		/// </summary>
+		/// <param name="nTicks">Timeout in ticks of the tick source.</param>
+		void SetTimeout( uint32_t nTicks )
+		{
+			_nTimeout = nTicks;
+		}
+
+		/// <summary>
+		/// Get the last error.
+		/// </summary>
+		uint32_t GetLastError()
+		{
+			return _nLastError;
+		}
+
+		/// <summary>
+		/// Send a message. A copy is kept until the other end acknowledges it, the
+		/// caller keeps ownership of the message.
+		/// </summary>
+		/// <param name="pMessage">The message to send.</param>
+		/// <returns>ERROR_SC_WINDOW_FULL when the window is full and the message was not
+		/// sent.</returns>
+		uint32_t Send( const IMessage* pMessage );
+
+		/// <summary>
+		/// Process a message received from the link. Acknowledge messages are consumed,
+		/// reliable messages are delivered to the router when they arrive in order, and
+		/// other messages are passed straight to the router. The caller keeps ownership.
+		/// </summary>
+		/// <param name="pMessage">The received message.</param>
+		/// <returns>true if the message was delivered to the router.</returns>
+		bool Receive( const IMessage* pMessage );
+
+		/// <summary>
+		/// Run the retransmit timer. Call this periodically from the owning task.
+		/// </summary>
+		void Poll(void);
+
+		/// <summary>
+		/// Number of messages waiting for an acknowledge.
+		/// </summary>
+		uint8_t Outstanding(void) const
+		{
+			return _nOutstanding;
+		}
+
+		/// <summary>
+		/// Number of messages that can be sent before the window is full.
+		/// </summary>
+		uint8_t WindowAvailable(void) const
+		{
+			return _nWindow - _nOutstanding;
+		}
+
+		/// <summary>
+		/// Number of messages sent more than once.
+		/// </summary>
+		uint32_t Retransmits(void) const
+		{
+			return _nRetransmits;
+		}
+
+		/// <summary>
+		/// Number of received messages dropped as repeats of ones already delivered.
+		/// </summary>
+		uint32_t Duplicates(void) const
+		{
+			return _nDuplicates;
+		}
+
+		/// <summary>
+		/// Number of received messages dropped because they arrived ahead of one that
+		/// was lost.
+		/// </summary>
+		uint32_t OutOfOrder(void) const
+		{
+			return _nOutOfOrder;
+		}
+
+		/// <summary>
+		/// Number of reliable messages delivered to the router.
+		/// </summary>
+		uint32_t Delivered(void) const
+		{
+			return _nDelivered;
+		}
+
+	private:
+		typedef typename IMessage::HeaderType_t		Header_t;
+
+		/// <summary>
+		/// If an error occurs this value will reflect the last one.
+		/// </summary>
+		uint32_t					_nLastError;
+
+		/// <summary>
+		/// Size of the send window.
+		/// </summary>
+		uint8_t						_nWindow;
+
+		/// <summary>
+		/// Source address for the acknowledge messages.
+		/// </summary>
+		uint16_t					_nAddress;
+
+		/// <summary>
+		/// Message ID for the acknowledge messages.
+		/// </summary>
+		typename IMessage::MsgType_t	_nControlId;
+
+		/// <summary>
+		/// Copies of the messages waiting for an acknowledge, used as a circular list
+		/// starting at _nHead.
+		/// </summary>
+		IMessage**					_pPending;
+
+		/// <summary>
+		/// Index in _pPending of the oldest message.
+		/// </summary>
+		uint8_t						_nHead;
+
+		/// <summary>
+		/// Sequence number of the oldest message waiting for an acknowledge.
+		/// </summary>
+		uint8_t						_nBase;
+
+		/// <summary>
+		/// Number of messages waiting for an acknowledge.
+		/// </summary>
+		uint8_t						_nOutstanding;
+
+		/// <summary>
+		/// The sequence number the receiver expects next.
+		/// </summary>
+		uint8_t						_nExpected;
+
+		/// <summary>
+		/// Set once a negative acknowledge has been sent for the current gap.
+		/// </summary>
+		bool						_bNackSent;
+
+		/// <summary>
+		/// Tick count when the oldest message was last sent.
+		/// </summary>
+		uint32_t					_nTimerStart;
+
+		/// <summary>
+		/// Retransmit timeout.
+		/// </summary>
+		uint32_t					_nTimeout;
+
+		/// <summary>
+		/// Protects the link state.
+		/// </summary>
+		scIMutex*					_pProtect;
+
+		/// <summary>
+		/// The messages are sent here.
+		/// </summary>
+		HAL::scBufferIODriver*		_pDriver;
+
+		/// <summary>
+		/// Holds the copies of the messages.
+		/// </summary>
+		scMessageFactory<IMessage>*	_pFactory;
+
+		/// <summary>
+		/// Receives the messages.
+		/// </summary>
+		scMessageRouter<IMessage>*	_pRouter;
+
+		/// <summary>
+		/// The allocator used for the window memory.
+		/// </summary>
+		scAllocator					_Allocator;
+
+		/// <summary>
+		/// Used for the retransmit timer.
+		/// </summary>
+		TickSource_t				_pTickSource;
+
+		/// <summary>
+		/// Number of messages sent again.
+		/// </summary>
+		uint32_t					_nRetransmits;
+
+		/// <summary>
+		/// Number of repeated messages dropped by the receiver.
+		/// </summary>
+		uint32_t					_nDuplicates;
+
+		/// <summary>
+		/// Number of messages dropped by the receiver after a gap in the sequence.
+		/// </summary>
+		uint32_t					_nOutOfOrder;
+
+		/// <summary>
+		/// Number of messages delivered by the receiver.
+		/// </summary>
+		uint32_t					_nDelivered;
+
+		/// <summary>
+		/// Release the messages acknowledged up to, but not including, nSequence. Must be
+		/// called with the lock.
+		/// </summary>
+		void Acknowledge( uint8_t nSequence );
+
+		/// <summary>
+		/// Send all the outstanding messages again. Must be called with the lock.
+		/// </summary>
+		void Retransmit(void);
+
+		/// <summary>
+		/// Send an acknowledge or negative acknowledge to the other end.
+		/// </summary>
+		/// <param name="nFlags">STANDARD_HEADER_FLAG_ACK or STANDARD_HEADER_FLAG_NACK.</param>
+		/// <param name="nDestination">Address of the other end.</param>
+		/// <param name="nSequence">The next sequence number expected.</param>
+		void SendControl( uint8_t nFlags, uint16_t nDestination, uint8_t nSequence );
+
+		/// <summary>
+		/// Read the tick source.
+		/// </summary>
+		uint32_t Now(void) const
+		{
+			return ( _pTickSource != NULL ) ? _pTickSource() : 0;
+		}
+	};
+
+//////////////////////////////////////////////////////////////////////////////////////
+/// Public Methods
+//////////////////////////////////////////////////////////////////////////////////////
+
+	/// <summary>
+	/// Construct the link.
+	/// </summary>
+	/// <param name="nWindow">Number of messages that may be waiting for an
+	/// acknowledge, 1 to scRELIABLE_MAX_WINDOW.</param>
+	/// <param name="nAddress">The address of this end of the link, used as the
+	/// source of the acknowledge messages.</param>
+	/// <param name="nControlId">Message ID used for the acknowledge messages.</param>
+	template<class IMessage>
+	scReliableLink<IMessage>::scReliableLink( uint8_t nWindow, uint16_t nAddress, typename IMessage::MsgType_t nControlId )
+		:	_nLastError(ERROR_SUCCESS)
+		,	_nWindow(nWindow)
+		,	_nAddress(nAddress)
+		,	_nControlId(nControlId)
+		,	_pPending(NULL)
+		,	_nHead(0)
+		,	_nBase(0)
+		,	_nOutstanding(0)
+		,	_nExpected(0)
+		,	_bNackSent(false)
+		,	_nTimerStart(0)
+		,	_nTimeout(100)
+		,	_pProtect(NULL)
+		,	_pDriver(NULL)
+		,	_pFactory(NULL)
+		,	_pRouter(NULL)
+		,	_Allocator()
+		,	_pTickSource(NULL)
+		,	_nRetransmits(0)
+		,	_nDuplicates(0)
+		,	_nOutOfOrder(0)
+		,	_nDelivered(0)
+	{
+		assert_param( _nWindow > 0 && _nWindow <= scRELIABLE_MAX_WINDOW );
+	}
+
+	/// <summary>
+	/// Destructor. Releases the messages still waiting for an acknowledge.
+	/// </summary>
+	template<class IMessage>
+	scReliableLink<IMessage>::~scReliableLink()
+	{
+		if ( _pPending != NULL )
+		{
+			for( uint8_t i=0; i < _nWindow; ++i )
+			{
+				if ( _pPending[i] != NULL )
+				{
+					_pFactory->Release( _pPending[i] );
+				}
+			}
+			_Allocator.Destroy( _pPending );
+			_pPending = NULL;
+		}
+	}
+
+	/// <summary>
+	/// Allocate the window.
+	/// </summary>
+	/// <param name="allocator">Allocator used for the window memory.</param>
+	/// <param name="pProtect">Mutex protecting the link state.</param>
+	/// <param name="pDriver">Driver the messages are sent to.</param>
+	/// <param name="pFactory">Holds the copies of the messages until they are
+	/// acknowledged.</param>
+	/// <param name="pRouter">Receives the messages that arrive.</param>
+	template<class IMessage>
+	uint32_t scReliableLink<IMessage>::Initialize( scAllocator allocator, scIMutex* pProtect, HAL::scBufferIODriver* pDriver,
+		scMessageFactory<IMessage>* pFactory, scMessageRouter<IMessage>* pRouter )
+	{
+		assert_param( pProtect != NULL );
+		assert_param( pDriver != NULL );
+		assert_param( pFactory != NULL );
+
+		_pProtect = pProtect;
+		_pDriver = pDriver;
+		_pFactory = pFactory;
+		_pRouter = pRouter;
+		_Allocator = allocator;
+
+		_pPending = reinterpret_cast<IMessage**>( _Allocator.Allocate( _nWindow * sizeof(IMessage*), true ) );
+		if ( _pPending != NULL )
+		{
+			memset( _pPending, 0, _nWindow * sizeof(IMessage*) );
+		}
+		else
+		{
+			scDebugManager::Instance()->Trace( scDEBUGLABEL_ERROR_MESSAGE,
+				"scReliableLink: Unable to allocate the window.\n\r" );
+			_nLastError = ERROR_SC_MEMORY_ALLOCATION_FAILURE;
+		}
+
+		return _nLastError;
+	}
+
+	/// <summary>
+	/// Send a message. A copy is kept until the other end acknowledges it, the
+	/// caller keeps ownership of the message.
+	/// </summary>
+	/// <param name="pMessage">The message to send.</param>
+	/// <returns>ERROR_SC_WINDOW_FULL when the window is full and the message was not
+	/// sent.</returns>
+	template<class IMessage>
+	uint32_t scReliableLink<IMessage>::Send( const IMessage* pMessage )
+	{
+		assert_param( _pProtect != NULL );
+
+		uint32_t		nResult = ERROR_SUCCESS;
+		scScopeLock		protect( _pProtect );
+
+		if ( pMessage == NULL )
+		{
+			nResult = ERROR_SC_MEMORY_INVALID_POINTER;
+		}
+		else if ( _nOutstanding >= _nWindow )
+		{
+			nResult = ERROR_SC_WINDOW_FULL;
+		}
+		else
+		{
+			IMessage* pCopy = _pFactory->Copy( pMessage );
+			if ( pCopy != NULL )
+			{
+				uint8_t nSequence = (uint8_t)( _nBase + _nOutstanding );
+
+				// stamp the copy with the sequence number
+				Header_t header( pCopy->Header() );
+				header.SetFlags( header.Flags() | STANDARD_HEADER_FLAG_RELIABLE );
+				header.SetSequence( nSequence );
+				header.UpdateChecksum();
+
+				uint8_t* pBuffer = const_cast<uint8_t*>( pCopy->Buffer() );
+				memcpy( pBuffer, &header.Data(), sizeof(scStandardHeader_t) );
+				*pCopy = IMessage( pBuffer, pCopy->LengthOfBuffer() );
+
+				if ( _nOutstanding == 0 )
+				{
+					_nTimerStart = Now();
+				}
+				_pPending[ ( _nHead + _nOutstanding ) % _nWindow ] = pCopy;
+				_nOutstanding++;
+
+				nResult = _pDriver->Send_n( pCopy->Buffer(), pCopy->LengthOfMessage() );
+			}
+			else
+			{
+				nResult = _pFactory->GetLastError();
+			}
+		}
+
+		_nLastError = nResult;
+		return nResult;
+	}
+
+	/// <summary>
+	/// Process a message received from the link. Acknowledge messages are consumed,
+	/// reliable messages are delivered to the router when they arrive in order, and
+	/// other messages are passed straight to the router. The caller keeps ownership.
+	/// </summary>
+	/// <param name="pMessage">The received message.</param>
+	/// <returns>true if the message was delivered to the router.</returns>
+	template<class IMessage>
+	bool scReliableLink<IMessage>::Receive( const IMessage* pMessage )
+	{
+		assert_param( _pProtect != NULL );
+
+		bool bDeliver = false;
+
+		if ( pMessage != NULL )
+		{
+			uint8_t		nFlags = pMessage->Header().Flags();
+			uint8_t		nSequence = pMessage->Header().Sequence();
+			uint16_t	nSource = pMessage->Header().Source();
+
+			if ( nFlags & ( STANDARD_HEADER_FLAG_ACK | STANDARD_HEADER_FLAG_NACK ) )
+			{
+				scScopeLock		protect( _pProtect );
+				Acknowledge( nSequence );
+				if ( ( nFlags & STANDARD_HEADER_FLAG_NACK ) && _nOutstanding > 0 )
+				{
+					Retransmit();
+				}
+			}
+			else if ( nFlags & STANDARD_HEADER_FLAG_RELIABLE )
+			{
+				uint8_t nControl = 0;
+				uint8_t nExpected = 0;
+				{
+					scScopeLock		protect( _pProtect );
+					uint8_t			nAhead = (uint8_t)( nSequence - _nExpected );
+
+					if ( nAhead == 0 )
+					{
+						_nExpected++;
+						_nDelivered++;
+						_bNackSent = false;
+						bDeliver = true;
+						nControl = STANDARD_HEADER_FLAG_ACK;
+					}
+					else if ( nAhead >= 128 )
+					{
+						// already delivered, the acknowledge was probably lost
+						_nDuplicates++;
+						nControl = STANDARD_HEADER_FLAG_ACK;
+					}
+					else
+					{
+						// a message was lost, ask for it once
+						_nOutOfOrder++;
+						if ( !_bNackSent )
+						{
+							_bNackSent = true;
+							nControl = STANDARD_HEADER_FLAG_NACK;
+						}
+					}
+					nExpected = _nExpected;
+				}
+
+				if ( nControl != 0 )
+				{
+					SendControl( nControl, nSource, nExpected );
+				}
+			}
+			else
+			{
+				bDeliver = true;
+			}
+
+			if ( bDeliver && _pRouter != NULL )
+			{
+				_pRouter->Dispatch( pMessage );
+			}
+		}
+
+		return bDeliver;
+	}
+
+	/// <summary>
+	/// Run the retransmit timer. Call this periodically from the owning task.
+	/// </summary>
+	template<class IMessage>
+	void scReliableLink<IMessage>::Poll(void)
+	{
+		assert_param( _pProtect != NULL );
+		scPROFILE_SCOPE( scPROBE_LINK_POLL );
+
+		scScopeLock		protect( _pProtect );
+		if ( _nOutstanding > 0 && _pTickSource != NULL && ( Now() - _nTimerStart ) >= _nTimeout )
+		{
+			Retransmit();
+		}
+	}
+
+//////////////////////////////////////////////////////////////////////////////////////
+/// Private Methods
+//////////////////////////////////////////////////////////////////////////////////////
+
+	/// <summary>
+	/// Release the messages acknowledged up to, but not including, nSequence. Must be
+	/// called with the lock.
+	/// </summary>
+	template<class IMessage>
+	void scReliableLink<IMessage>::Acknowledge( uint8_t nSequence )
+	{
+		uint8_t nCount = (uint8_t)( nSequence - _nBase );
+
+		// anything outside of the window is an old acknowledge
+		if ( nCount > 0 && nCount <= _nOutstanding )
+		{
+			for( uint8_t i=0; i < nCount; ++i )
+			{
+				_pFactory->Release( _pPending[_nHead] );
+				_pPending[_nHead] = NULL;
+				_nHead = ( _nHead + 1 ) % _nWindow;
+			}
+			_nBase = nSequence;
+			_nOutstanding -= nCount;
+			_nTimerStart = Now();
+		}
+	}
+
+	/// <summary>
+	/// Send all the outstanding messages again. Must be called with the lock.
+	/// </summary>
+	template<class IMessage>
+	void scReliableLink<IMessage>::Retransmit(void)
+	{
+		for( uint8_t i=0; i < _nOutstanding; ++i )
+		{
+			const IMessage* pCopy = _pPending[ ( _nHead + i ) % _nWindow ];
+			_pDriver->Send_n( pCopy->Buffer(), pCopy->LengthOfMessage() );
+			_nRetransmits++;
+		}
+		_nTimerStart = Now();
+	}
+
+	/// <summary>
+	/// Send an acknowledge or negative acknowledge to the other end.
+	/// </summary>
+	/// <param name="nFlags">STANDARD_HEADER_FLAG_ACK or STANDARD_HEADER_FLAG_NACK.</param>
+	/// <param name="nDestination">Address of the other end.</param>
+	/// <param name="nSequence">The next sequence number expected.</param>
+	template<class IMessage>
+	void scReliableLink<IMessage>::SendControl( uint8_t nFlags, uint16_t nDestination, uint8_t nSequence )
+	{
+		Header_t header;
+		header.SetFlags( nFlags );
+		header.SetSequence( nSequence );
+		header.SetDestination( nDestination );
+		header.SetSource( _nAddress );
+		header.SetId( _nControlId );
+		header.SetLength( 0 );
+		header.UpdateChecksum();
+
+		_pDriver->Send_n( reinterpret_cast<const uint8_t*>( &header.Data() ), sizeof(scStandardHeader_t) );
+	}
+
+}
+#endif // !defined(__SCRELIABLELINK_H__INCLUDED_)
@@ -30,6 +30,8 @@
 #include <string.h>
 #include "scMutexNoOp.h"
 #include "scRingBuffer.h"
+#include "scFormat.h"
+#include "scMetrics.h"
 
 #ifdef _DEBUG
 #	define	DEBUG_RING_BUFFER
@@ -37,11 +39,57 @@
 
 using SharedCore::scRingBuffer;
 using SharedCore::scMutexNoOp;
+using SharedCore::scIFormatSink;
+using SharedCore::scFormat;
 
 #ifndef assert_param
 #define assert_param(X)	if ( !(X) ) { for(;;) ; }
 #endif
 
+/// <summary>
+/// Receives the text for WriteFormat. The text is placed after the data already in
+/// the buffer, wrapping at the end, but it is only added to the buffer once the
+/// formatting is complete so a reader never sees a partial record.
+/// </summary>
+class scRingBuffer::FormatSink : public scIFormatSink
+{
+public:
+	FormatSink( scRingBuffer& ring )
+		: _Ring( ring )
+		, _nFree( ring.Available() )
+		, _nLength( 0 )
+	{
+	}
+
+	virtual uint32_t Write( const char* pText, uint32_t nLength )
+	{
+		if ( nLength > _nFree - _nLength )
+		{
+			nLength = _nFree - _nLength;
+		}
+
+		uint32_t	nOffset = (uint32_t)( _Ring._pInsert - _Ring._pBuffer ) + _nLength;
+		if ( nOffset >= _Ring._nBufferSize )
+		{
+			nOffset -= _Ring._nBufferSize;
+		}
+		uint32_t	nFirst = _Ring._nBufferSize - nOffset;
+		if ( nFirst > nLength )
+		{
+			nFirst = nLength;
+		}
+
+		memcpy( _Ring._pBuffer + nOffset, pText, nFirst );
+		memcpy( _Ring._pBuffer, pText + nFirst, nLength - nFirst );
+		_nLength += nLength;
+		return nLength;
+	}
+
+	scRingBuffer&		_Ring;
+	uint32_t			_nFree;
+	uint32_t			_nLength;
+};
+
 /// <summary>
 /// Construct the ring buffer using the provided length, and pointer. If the
 /// pointer is not provided then the buffer is internally allocated using the new
@@ -302,6 +350,7 @@ uint32_t scRingBuffer::WriteEnd(uint32_t nLength)
 	}
 
 	assert_param( _nUsedSize <= _nBufferSize );
+	scMETRIC_PEAK( SharedCore::scMETRIC_RING_MAX_PEAK, _nUsedSize );
 
 	--_nWriteInUse;
 
@@ -331,6 +380,37 @@ uint32_t scRingBuffer::WriteStart(void)
 	return nResult;
 }
 
+/// <summary>
+/// Formats text straight into the free space of the buffer, wrapping at the end,
+/// so no intermediate copy is needed. See scFormat for the conversions. Text that
+/// does not fit is dropped. The caller should hold the lock, as with the other
+/// write operations.
+/// </summary>
+/// <param name="pFormat">The format string.</param>
+/// <param name="ap">The arguments.</param>
+/// <returns>The length of the whole text. When larger than Available was
+/// before the call the text was truncated.</returns>
+uint32_t scRingBuffer::WriteFormat( const char* pFormat, va_list ap )
+{
+	FormatSink	sink( *this );
+	uint32_t	nResult = scFormat::vFormat( sink, pFormat, ap );
+
+	// add the text in up to two pieces so the insert pointer wraps
+	uint32_t	nLength = sink._nLength;
+	while( nLength > 0 )
+	{
+		uint32_t nBlock = (uint32_t)( (_pBuffer + _nBufferSize) - _pInsert );
+		if ( nBlock > nLength )
+		{
+			nBlock = nLength;
+		}
+		WriteStart();
+		WriteEnd( nBlock );
+		nLength -= nBlock;
+	}
+	return nResult;
+}
+
 /// <summary>
 /// This method will shift the byte array down by one byte.
 /// </summary>
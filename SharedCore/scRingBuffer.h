@@ -34,6 +34,7 @@
 #if !defined(__SCRINGBUFFER_H__INCLUDED_)
 #define __SCRINGBUFFER_H__INCLUDED_
 
+#include <stdarg.h>
 #include "scTypes.h"
 
 
@@ -148,6 +149,18 @@ namespace SharedCore
 		/// </summary>
 		uint32_t WriteStart(void);
 
+		/// <summary>
+		/// Formats text straight into the free space of the buffer, wrapping at the end,
+		/// so no intermediate copy is needed. See scFormat for the conversions. Text that
+		/// does not fit is dropped. The caller should hold the lock, as with the other
+		/// write operations.
+		/// </summary>
+		/// <param name="pFormat">The format string.</param>
+		/// <param name="ap">The arguments.</param>
+		/// <returns>The length of the whole text. When larger than Available was
+		/// before the call the text was truncated.</returns>
+		uint32_t WriteFormat( const char* pFormat, va_list ap );
+
 		/// <summary>
 		/// This method will lock the ring buffer to allow memory operations to happen.
 		/// Unlock must be called when complete.
@@ -201,6 +214,11 @@ namespace SharedCore
 		/// </summary>
 		scIMutex*					_pProtectContext;
 
+		/// <summary>
+		/// Receives the text for WriteFormat.
+		/// </summary>
+		class FormatSink;
+
 
 		// prevent copy constructor.
 		scRingBuffer(const scRingBuffer& T ) {};
@@ -212,6 +212,14 @@ namespace SharedCore
 			return _local._nCheckSum;
 		}
 
+		/// <summary>
+		/// Access to the raw header structure, ready to be written to a device.
+		/// </summary>
+		const scStandardHeader_t& Data(void) const
+		{
+			return _local;
+		}
+
 		/// <summary>
 		/// Is the current structure valid.
 		/// </summary>
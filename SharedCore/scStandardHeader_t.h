@@ -40,6 +40,37 @@ namespace SharedCore
 {
 	#define STANDARD_HEADER_PREFIX 0xAA
 
+	// Bits used in the _nFlags field.
+
+	/// <summary>
+	/// The payload is a series of complete messages, each with its own header.
+	/// </summary>
+	#define STANDARD_HEADER_FLAG_BATCH		0x01
+
+	/// <summary>
+	/// The message is part of a reliable stream and carries a sequence number that
+	/// must be acknowledged.
+	/// </summary>
+	#define STANDARD_HEADER_FLAG_RELIABLE	0x02
+
+	/// <summary>
+	/// Acknowledge, the sequence field is the next sequence number expected, all the
+	/// messages before it have been received.
+	/// </summary>
+	#define STANDARD_HEADER_FLAG_ACK		0x04
+
+	/// <summary>
+	/// Negative acknowledge, the sequence field is the next sequence number expected
+	/// and the sender should send again starting from it.
+	/// </summary>
+	#define STANDARD_HEADER_FLAG_NACK		0x08
+
+	/// <summary>
+	/// The payload is one piece of a larger block of data. It starts with a
+	/// scFragmentHeader_t describing where the piece belongs.
+	/// </summary>
+	#define STANDARD_HEADER_FLAG_FRAGMENT	0x10
+
 	#pragma pack(1)
 
 	typedef struct
@@ -53,6 +84,18 @@ namespace SharedCore
 		uint32_t			_nLength;
 		uint8_t				_nCheckSum;
 	} scStandardHeader_t;
+
+	/// <summary>
+	/// Follows the standard header when STANDARD_HEADER_FLAG_FRAGMENT is set. The
+	/// stream number is picked by the sender, the offset is the position of this piece
+	/// in the complete block and the total is the size of the complete block.
+	/// </summary>
+	typedef struct
+	{
+		uint16_t			_nStream;
+		uint32_t			_nOffset;
+		uint32_t			_nTotal;
+	} scFragmentHeader_t;
 	#pragma pack()
 }	// namespace SharedCore
 
@@ -0,0 +1,572 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scTelemetry.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCTELEMETRY_H__INCLUDED_)
+#define __SCTELEMETRY_H__INCLUDED_
+
+#include <string.h>
+#include "scTypes.h"
+#include "scIModule.h"
+#include "scMetrics.h"
+#include "scErrorCodes.h"
+#include "scStandardHeader_t.h"
+#include "scTelemetryDecoder.h"
+#include "scMessageFactory.h"
+#include "scMessageRouter.h"
+
+// Most channels a telemetry module samples, at most scTELEMETRY_MAX_CHANNELS. Define
+// it in scConf.h to change it.
+#ifndef SC_TELEMETRY_CHANNELS
+	#define SC_TELEMETRY_CHANNELS		(32)
+#endif
+
+// Number of delta frames sent between two key frames. Define it in scConf.h to change
+// it.
+#ifndef SC_TELEMETRY_KEY_INTERVAL
+	#define SC_TELEMETRY_KEY_INTERVAL	(16)
+#endif
+
+// Notify command making the module send a key frame next, when a collector connects
+// for example. Define it in scConf.h to change it.
+#ifndef SC_TELEMETRY_KEY_COMMAND
+	#define SC_TELEMETRY_KEY_COMMAND	(0x544B)
+#endif
+
+#ifndef assert_param
+#define assert_param(X)	if ( !(X) ) { for(;;) ; }
+#endif
+
+namespace SharedCore
+{
+	/// <summary>
+	/// Streams the value of metrics to the collectors as telemetry messages. Each
+	/// period the channels, registered scMetric_t, are sampled and the changes since
+	/// the frame before are sent in one message, see scTelemetryFrame_t, created with
+	/// the factory and delivered by the router, which forwards it to the link. A key
+	/// frame with every whole value is sent every SC_TELEMETRY_KEY_INTERVAL frames so
+	/// a collector can start, or recover from a lost frame, without asking. The
+	/// frames are turned into CSV on the host by scTelemetryDecoder.
+	///
+	/// The bandwidth is bounded by a byte budget. Sending a frame uses credit, which
+	/// comes back at the rate of the budget, and a frame is skipped when there is not
+	/// enough. The values left out are in the next frame, since it carries the
+	/// changes since the last frame that was sent. Poll is called from one task, the
+	/// frame is built in the module so no memory is allocated.
+	/// </summary>
+	template<class IMessage>
+	class scTelemetry : public scIModule
+	{
+	public:
+		/// <summary>
+		/// Function used to obtain a free running tick count for the period and the
+		/// budget.
+		/// </summary>
+		typedef uint32_t (*TickSource_t)( void );
+
+		/// <summary>
+		/// Construct the module.
+		/// </summary>
+		/// <param name="nMessageId">Message ID of the telemetry messages.</param>
+		/// <param name="nSource">Source address of the messages.</param>
+		/// <param name="nDestination">Destination address of the messages, the
+		/// collector.</param>
+		scTelemetry( typename IMessage::MsgType_t nMessageId, uint16_t nSource, uint16_t nDestination );
+
+		/// <summary>
+		/// Destructor.
+		/// </summary>
+		virtual ~scTelemetry();
+
+		/// <summary>
+		/// Provide the objects used to send the frames.
+		/// </summary>
+		/// <param name="pFactory">Creates the telemetry messages.</param>
+		/// <param name="pRouter">Delivers them.</param>
+		uint32_t Initialize( scMessageFactory<IMessage>* pFactory, scMessageRouter<IMessage>* pRouter );
+
+		/// <summary>
+		/// Add a metric as the next channel. Channels are numbered in the order they
+		/// are added, the decoder on the host takes the names in the same order.
+		/// </summary>
+		/// <param name="metric">The metric, must stay valid.</param>
+		/// <returns>false if there are SC_TELEMETRY_CHANNELS channels already.</returns>
+		bool AddChannel( scMetric_t& metric );
+
+		/// <summary>
+		/// Number of channels.
+		/// </summary>
+		uint32_t Channels( void ) const
+		{
+			return _nChannels;
+		}
+
+		/// <summary>
+		/// Name of a channel, for the decoder.
+		/// </summary>
+		const char* ChannelName( uint32_t nChannel ) const
+		{
+			return ( nChannel < _nChannels ) ? _pChannels[nChannel]->_pName : NULL;
+		}
+
+		/// <summary>
+		/// Set the function used to time the frames.
+		/// </summary>
+		void SetTickSource( TickSource_t pSource )
+		{
+			_pTickSource = pSource;
+		}
+
+		/// <summary>
+		/// Set the time between two frames.
+		/// </summary>
+		/// <param name="nTicks">Period in ticks of the tick source.</param>
+		void SetPeriod( uint32_t nTicks )
+		{
+			_nPeriod = nTicks;
+		}
+
+		/// <summary>
+		/// Bound the bandwidth to nBytes every nTicks, headers included. The credit
+		/// never grows past nBytes, or past the largest frame when that is larger so a
+		/// key frame can always be sent in the end. 0 removes the bound. Set the tick
+		/// source first, the budget starts full.
+		/// </summary>
+		void SetBudget( uint32_t nBytes, uint32_t nTicks );
+
+		/// <summary>
+		/// Send a key frame with the next frame.
+		/// </summary>
+		void RequestKeyFrame( void )
+		{
+			_bKeyPending = true;
+		}
+
+		/// <summary>
+		/// SC_TELEMETRY_KEY_COMMAND requests a key frame.
+		/// </summary>
+		virtual int Notify( uint32_t nCommand, void* pParameter );
+
+		/// <summary>
+		/// Send a frame when the period has passed and the budget allows it. Call this
+		/// periodically from the owning task.
+		/// </summary>
+		/// <returns>true if a frame was sent.</returns>
+		bool Poll( void );
+
+		/// <summary>
+		/// Sample the channels and send a frame now, within the budget.
+		/// </summary>
+		/// <returns>true if a frame was sent.</returns>
+		bool Sample( void );
+
+		/// <summary>
+		/// Number of frames sent.
+		/// </summary>
+		uint32_t FramesSent( void ) const
+		{
+			return _nFrames;
+		}
+
+		/// <summary>
+		/// Number of bytes sent, headers included.
+		/// </summary>
+		uint32_t BytesSent( void ) const
+		{
+			return _nBytes;
+		}
+
+		/// <summary>
+		/// Number of frames skipped to stay within the budget or because no message
+		/// could be created.
+		/// </summary>
+		uint32_t FramesSkipped( void ) const
+		{
+			return _nSkipped;
+		}
+
+		/// <summary>
+		/// Get the last error.
+		/// </summary>
+		uint32_t GetLastError()
+		{
+			return _nLastError;
+		}
+
+	private:
+		typedef typename IMessage::HeaderType_t		Header_t;
+
+		/// <summary>
+		/// Largest message, the header and a key frame of every channel.
+		/// </summary>
+		enum { MAX_FRAME = sizeof(scStandardHeader_t) + sizeof(scTelemetryFrame_t) + SC_TELEMETRY_CHANNELS * scTELEMETRY_MAX_ENTRY };
+
+		/// <summary>
+		/// The current tick count.
+		/// </summary>
+		uint32_t Now( void ) const
+		{
+			return ( _pTickSource != NULL ) ? _pTickSource() : 0;
+		}
+
+		/// <summary>
+		/// Give back the credit earned since the last call.
+		/// </summary>
+		void Refill( uint32_t nNow );
+
+		/// <summary>
+		/// Build the message in _Frame.
+		/// </summary>
+		/// <returns>Length of the message.</returns>
+		uint32_t Build( bool bKey, uint32_t nNow );
+
+		/// <summary>
+		/// If an error occurs this value will reflect the last one.
+		/// </summary>
+		uint32_t					_nLastError;
+
+		/// <summary>
+		/// Addressing of the messages.
+		/// </summary>
+		typename IMessage::MsgType_t	_nMessageId;
+		uint16_t					_nSource;
+		uint16_t					_nDestination;
+
+		/// <summary>
+		/// Creates and delivers the messages.
+		/// </summary>
+		scMessageFactory<IMessage>*	_pFactory;
+		scMessageRouter<IMessage>*	_pRouter;
+
+		/// <summary>
+		/// The channels, their values in the frame being built and in the last frame
+		/// sent.
+		/// </summary>
+		scMetric_t*					_pChannels[SC_TELEMETRY_CHANNELS];
+		uint32_t					_nSampled[SC_TELEMETRY_CHANNELS];
+		uint32_t					_nSent[SC_TELEMETRY_CHANNELS];
+		uint32_t					_nChannels;
+
+		/// <summary>
+		/// Used for the period and the budget.
+		/// </summary>
+		TickSource_t				_pTickSource;
+
+		/// <summary>
+		/// Time between two frames and when the last one was due.
+		/// </summary>
+		uint32_t					_nPeriod;
+		uint32_t					_nLast;
+		bool						_bStarted;
+
+		/// <summary>
+		/// The budget, 0 bytes when there is none, the credit in bytes and when it was
+		/// last given back.
+		/// </summary>
+		uint32_t					_nBudgetBytes;
+		uint32_t					_nBudgetTicks;
+		uint32_t					_nCredit;
+		uint32_t					_nCreditTick;
+
+		/// <summary>
+		/// Frames sent since the last key frame, and a key frame was requested.
+		/// </summary>
+		uint32_t					_nSinceKey;
+		bool						_bKeyPending;
+
+		/// <summary>
+		/// Sequence number of the next frame.
+		/// </summary>
+		uint16_t					_nSequence;
+
+		/// <summary>
+		/// Frames sent, bytes sent and frames skipped.
+		/// </summary>
+		uint32_t					_nFrames;
+		uint32_t					_nBytes;
+		uint32_t					_nSkipped;
+
+		/// <summary>
+		/// The message being built.
+		/// </summary>
+		uint8_t						_Frame[MAX_FRAME];
+	};
+
+//////////////////////////////////////////////////////////////////////////////////////
+/// Public Methods
+//////////////////////////////////////////////////////////////////////////////////////
+
+	/// <summary>
+	/// Construct the module.
+	/// </summary>
+	template<class IMessage>
+	scTelemetry<IMessage>::scTelemetry( typename IMessage::MsgType_t nMessageId, uint16_t nSource, uint16_t nDestination )
+		: scIModule()
+		, _nLastError( ERROR_SUCCESS )
+		, _nMessageId( nMessageId )
+		, _nSource( nSource )
+		, _nDestination( nDestination )
+		, _pFactory( NULL )
+		, _pRouter( NULL )
+		, _nChannels( 0 )
+		, _pTickSource( NULL )
+		, _nPeriod( 0 )
+		, _nLast( 0 )
+		, _bStarted( false )
+		, _nBudgetBytes( 0 )
+		, _nBudgetTicks( 0 )
+		, _nCredit( 0 )
+		, _nCreditTick( 0 )
+		, _nSinceKey( 0 )
+		, _bKeyPending( true )
+		, _nSequence( 0 )
+		, _nFrames( 0 )
+		, _nBytes( 0 )
+		, _nSkipped( 0 )
+	{
+	}
+
+	/// <summary>
+	/// Destructor.
+	/// </summary>
+	template<class IMessage>
+	scTelemetry<IMessage>::~scTelemetry()
+	{
+	}
+
+	/// <summary>
+	/// Provide the objects used to send the frames.
+	/// </summary>
+	template<class IMessage>
+	uint32_t scTelemetry<IMessage>::Initialize( scMessageFactory<IMessage>* pFactory, scMessageRouter<IMessage>* pRouter )
+	{
+		assert_param( pFactory != NULL && pRouter != NULL );
+
+		_pFactory = pFactory;
+		_pRouter = pRouter;
+		return ERROR_SUCCESS;
+	}
+
+	/// <summary>
+	/// Add a metric as the next channel.
+	/// </summary>
+	template<class IMessage>
+	bool scTelemetry<IMessage>::AddChannel( scMetric_t& metric )
+	{
+		if ( _nChannels >= SC_TELEMETRY_CHANNELS || _nChannels >= scTELEMETRY_MAX_CHANNELS )
+		{
+			return false;
+		}
+		_pChannels[_nChannels] = &metric;
+		_nSent[_nChannels] = 0;
+		_nChannels++;
+		_bKeyPending = true;
+		return true;
+	}
+
+	/// <summary>
+	/// Bound the bandwidth to nBytes every nTicks.
+	/// </summary>
+	template<class IMessage>
+	void scTelemetry<IMessage>::SetBudget( uint32_t nBytes, uint32_t nTicks )
+	{
+		_nBudgetBytes = ( nTicks > 0 ) ? nBytes : 0;
+		_nBudgetTicks = nTicks;
+		_nCredit = ( nBytes > (uint32_t)MAX_FRAME ) ? nBytes : (uint32_t)MAX_FRAME;
+		_nCreditTick = Now();
+	}
+
+	/// <summary>
+	/// SC_TELEMETRY_KEY_COMMAND requests a key frame.
+	/// </summary>
+	template<class IMessage>
+	int scTelemetry<IMessage>::Notify( uint32_t nCommand, void* pParameter )
+	{
+		(void)pParameter;
+
+		if ( nCommand == SC_TELEMETRY_KEY_COMMAND )
+		{
+			RequestKeyFrame();
+		}
+		return ERROR_SUCCESS;
+	}
+
+	/// <summary>
+	/// Send a frame when the period has passed and the budget allows it.
+	/// </summary>
+	template<class IMessage>
+	bool scTelemetry<IMessage>::Poll( void )
+	{
+		uint32_t nNow = Now();
+
+		if ( !_bStarted )
+		{
+			_nLast = nNow - _nPeriod;
+			_bStarted = true;
+		}
+		if ( ( nNow - _nLast ) < _nPeriod )
+		{
+			return false;
+		}
+		_nLast = nNow;
+		return Sample();
+	}
+
+	/// <summary>
+	/// Sample the channels and send a frame now, within the budget. The values become
+	/// the base of the next delta only once the frame is on its way.
+	/// </summary>
+	template<class IMessage>
+	bool scTelemetry<IMessage>::Sample( void )
+	{
+		assert_param( _pFactory != NULL && _pRouter != NULL );
+
+		uint32_t	nNow = Now();
+		bool		bKey = _bKeyPending || _nSinceKey >= SC_TELEMETRY_KEY_INTERVAL;
+		uint32_t	nLength = Build( bKey, nNow );
+
+		if ( _nBudgetBytes > 0 )
+		{
+			Refill( nNow );
+			if ( _nCredit < nLength )
+			{
+				_nSkipped++;
+				return false;
+			}
+		}
+
+		IMessage	frame( _Frame, nLength );
+		IMessage*	pMessage = _pFactory->Copy( &frame );
+		if ( pMessage == NULL )
+		{
+			_nLastError = _pFactory->GetLastError();
+			_nSkipped++;
+			return false;
+		}
+		_pRouter->Dispatch( pMessage );
+		_pFactory->Release( pMessage );
+
+		if ( _nBudgetBytes > 0 )
+		{
+			_nCredit -= nLength;
+		}
+		memcpy( _nSent, _nSampled, _nChannels * sizeof(uint32_t) );
+		_nSequence++;
+		_nSinceKey = bKey ? 0 : _nSinceKey + 1;
+		_bKeyPending = false;
+		_nFrames++;
+		_nBytes += nLength;
+		return true;
+	}
+
+//////////////////////////////////////////////////////////////////////////////////////
+/// Private Methods
+//////////////////////////////////////////////////////////////////////////////////////
+
+	/// <summary>
+	/// Give back the credit earned since the last call, nBudgetBytes every
+	/// nBudgetTicks.
+	/// </summary>
+	template<class IMessage>
+	void scTelemetry<IMessage>::Refill( uint32_t nNow )
+	{
+		uint32_t nLimit = ( _nBudgetBytes > (uint32_t)MAX_FRAME ) ? _nBudgetBytes : (uint32_t)MAX_FRAME;
+		uint64_t nEarned = (uint64_t)( nNow - _nCreditTick ) * _nBudgetBytes / _nBudgetTicks;
+
+		if ( nEarned > 0 )
+		{
+			if ( nEarned >= nLimit - _nCredit )
+			{
+				// a full bucket does not save up
+				_nCredit = nLimit;
+				_nCreditTick = nNow;
+			}
+			else
+			{
+				// only the ticks that earned whole bytes are used up
+				_nCredit += (uint32_t)nEarned;
+				_nCreditTick += (uint32_t)( nEarned * _nBudgetTicks / _nBudgetBytes );
+			}
+		}
+	}
+
+	/// <summary>
+	/// Build the message in _Frame, the header, scTelemetryFrame_t and an entry for
+	/// every channel that changed, or every channel for a key frame.
+	/// </summary>
+	/// <returns>Length of the message.</returns>
+	template<class IMessage>
+	uint32_t scTelemetry<IMessage>::Build( bool bKey, uint32_t nNow )
+	{
+		uint8_t*			pEntry = _Frame + sizeof(scStandardHeader_t) + sizeof(scTelemetryFrame_t);
+		scTelemetryFrame_t	frame;
+
+		frame._nFlags = bKey ? scTELEMETRY_FLAG_KEY : 0;
+		frame._nCount = 0;
+		frame._nSequence = _nSequence;
+		frame._nTimestamp = nNow;
+
+		for( uint32_t i = 0; i < _nChannels; i++ )
+		{
+			_nSampled[i] = _pChannels[i]->_nValue;
+
+			uint32_t nDelta = _nSampled[i] - ( bKey ? 0 : _nSent[i] );
+			if ( nDelta == 0 && !bKey )
+			{
+				continue;
+			}
+
+			// zigzag, so a gauge going down by a little stays short
+			uint32_t nZigzag = ( nDelta << 1 ) ^ ( 0 - ( nDelta >> 31 ) );
+			*pEntry++ = (uint8_t)i;
+			while( nZigzag >= 0x80 )
+			{
+				*pEntry++ = (uint8_t)( nZigzag | 0x80 );
+				nZigzag >>= 7;
+			}
+			*pEntry++ = (uint8_t)nZigzag;
+			frame._nCount++;
+		}
+		memcpy( _Frame + sizeof(scStandardHeader_t), &frame, sizeof(scTelemetryFrame_t) );
+
+		uint32_t	nLength = (uint32_t)( pEntry - _Frame );
+		Header_t	header;
+		header.SetDestination( _nDestination );
+		header.SetSource( _nSource );
+		header.SetId( _nMessageId );
+		header.SetLength( nLength - sizeof(scStandardHeader_t) );
+		header.UpdateChecksum();
+		memcpy( _Frame, &header.Data(), sizeof(scStandardHeader_t) );
+		return nLength;
+	}
+}
+
+#endif // !defined(__SCTELEMETRY_H__INCLUDED_)
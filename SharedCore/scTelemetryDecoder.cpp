@@ -0,0 +1,201 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scTelemetryDecoder.cpp
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#include <string.h>
+#include <stdio.h>
+#include "scTelemetryDecoder.h"
+
+using namespace SharedCore;
+
+#ifdef _WIN32
+	#define TELEMETRY_SNPRINTF( pText, nSize, ... )	_snprintf_s( pText, nSize, _TRUNCATE, __VA_ARGS__ )
+#else
+	#define TELEMETRY_SNPRINTF( pText, nSize, ... )	snprintf( pText, nSize, __VA_ARGS__ )
+#endif
+
+/// <summary>
+/// Construct the decoder.
+/// </summary>
+/// <param name="pNames">Name of each channel, must stay valid.</param>
+/// <param name="nCount">Number of channels.</param>
+scTelemetryDecoder::scTelemetryDecoder( const char* const* pNames, uint32_t nCount )
+	: _pNames( pNames )
+	, _nCount( ( nCount < scTELEMETRY_MAX_CHANNELS ) ? nCount : scTELEMETRY_MAX_CHANNELS )
+	, _nTimestamp( 0 )
+	, _nSequence( 0 )
+	, _bSynced( false )
+	, _nLost( 0 )
+	, _nRejected( 0 )
+{
+	memset( _nValues, 0, sizeof(_nValues) );
+}
+
+/// <summary>
+/// Simple destructor.
+/// </summary>
+scTelemetryDecoder::~scTelemetryDecoder()
+{
+}
+
+/// <summary>
+/// Apply a frame to the channel values. The frame is checked whole before any value
+/// changes, so a damaged frame leaves the values as they were.
+/// </summary>
+/// <param name="pPayload">Payload of the telemetry message.</param>
+/// <param name="nLength">Length of the payload.</param>
+/// <returns>true if the values are those of the frame.</returns>
+bool scTelemetryDecoder::Decode( const uint8_t* pPayload, uint32_t nLength )
+{
+	scTelemetryFrame_t	frame;
+	uint8_t				channels[scTELEMETRY_MAX_CHANNELS];
+	uint32_t			deltas[scTELEMETRY_MAX_CHANNELS];
+	uint32_t			nOffset = sizeof(scTelemetryFrame_t);
+
+	if ( nLength < sizeof(scTelemetryFrame_t) )
+	{
+		_nRejected++;
+		return false;
+	}
+	memcpy( &frame, pPayload, sizeof(scTelemetryFrame_t) );
+
+	for( uint32_t i = 0; i < frame._nCount; i++ )
+	{
+		uint32_t nZigzag = 0;
+
+		if ( nOffset >= nLength || pPayload[nOffset] >= _nCount )
+		{
+			_nRejected++;
+			return false;
+		}
+		channels[i] = pPayload[nOffset++];
+		for( uint32_t nShift = 0; ; nShift += 7 )
+		{
+			if ( nShift > 28 || nOffset >= nLength )
+			{
+				_nRejected++;
+				return false;
+			}
+			uint8_t nByte = pPayload[nOffset++];
+			nZigzag |= (uint32_t)( nByte & 0x7F ) << nShift;
+			if ( ( nByte & 0x80 ) == 0 )
+			{
+				break;
+			}
+		}
+		deltas[i] = ( nZigzag >> 1 ) ^ ( 0 - ( nZigzag & 1 ) );
+	}
+
+	if ( _bSynced && frame._nSequence != (uint16_t)( _nSequence + 1 ) )
+	{
+		_nLost += (uint16_t)( frame._nSequence - _nSequence - 1 );
+		_bSynced = false;
+	}
+	if ( ( frame._nFlags & scTELEMETRY_FLAG_KEY ) != 0 )
+	{
+		memset( _nValues, 0, sizeof(_nValues) );
+		_bSynced = true;
+	}
+	else if ( !_bSynced )
+	{
+		_nSequence = frame._nSequence;
+		_nRejected++;
+		return false;
+	}
+
+	for( uint32_t i = 0; i < frame._nCount; i++ )
+	{
+		_nValues[channels[i]] += deltas[i];
+	}
+	_nTimestamp = frame._nTimestamp;
+	_nSequence = frame._nSequence;
+	return true;
+}
+
+/// <summary>
+/// Produce the CSV header line, timestamp, sequence and the channel names.
+/// </summary>
+/// <param name="pText">Receives the null terminated text.</param>
+/// <param name="nTextSize">Size of the text buffer.</param>
+/// <returns>The length of the text.</returns>
+uint32_t scTelemetryDecoder::Header( char* pText, uint32_t nTextSize ) const
+{
+	uint32_t nLength = 0;
+
+	Append( pText, nTextSize, nLength, "timestamp,sequence" );
+	for( uint32_t i = 0; i < _nCount; i++ )
+	{
+		Append( pText, nTextSize, nLength, "," );
+		Append( pText, nTextSize, nLength, _pNames[i] );
+	}
+	Append( pText, nTextSize, nLength, "\n" );
+	return nLength;
+}
+
+/// <summary>
+/// Produce the CSV line of the frame decoded last.
+/// </summary>
+/// <param name="pText">Receives the null terminated text.</param>
+/// <param name="nTextSize">Size of the text buffer.</param>
+/// <returns>The length of the text.</returns>
+uint32_t scTelemetryDecoder::Row( char* pText, uint32_t nTextSize ) const
+{
+	uint32_t	nLength = 0;
+	char		sNumber[16];
+
+	TELEMETRY_SNPRINTF( sNumber, sizeof(sNumber), "%u,", _nTimestamp );
+	Append( pText, nTextSize, nLength, sNumber );
+	TELEMETRY_SNPRINTF( sNumber, sizeof(sNumber), "%u", (uint32_t)_nSequence );
+	Append( pText, nTextSize, nLength, sNumber );
+	for( uint32_t i = 0; i < _nCount; i++ )
+	{
+		TELEMETRY_SNPRINTF( sNumber, sizeof(sNumber), ",%u", _nValues[i] );
+		Append( pText, nTextSize, nLength, sNumber );
+	}
+	Append( pText, nTextSize, nLength, "\n" );
+	return nLength;
+}
+
+/// <summary>
+/// Add text to a line, as much as fits.
+/// </summary>
+void scTelemetryDecoder::Append( char* pText, uint32_t nTextSize, uint32_t& nLength, const char* pAdd )
+{
+	if ( nTextSize == 0 )
+	{
+		return;
+	}
+	while( *pAdd != '\0' && nLength + 1 < nTextSize )
+	{
+		pText[nLength++] = *pAdd++;
+	}
+	pText[nLength] = '\0';
+}
@@ -0,0 +1,195 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scTelemetryDecoder.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCTELEMETRYDECODER_H__INCLUDED_)
+#define __SCTELEMETRYDECODER_H__INCLUDED_
+
+#include "scTypes.h"
+
+namespace SharedCore
+{
+	/// <summary>
+	/// Set in scTelemetryFrame_t::_nFlags when the frame carries every channel as a
+	/// whole value. A decoder can start, or start over after a lost frame, from it.
+	/// </summary>
+	#define scTELEMETRY_FLAG_KEY		(0x01)
+
+	/// <summary>
+	/// Most channels a frame can carry, the count and the channel are one byte.
+	/// </summary>
+	#define scTELEMETRY_MAX_CHANNELS	(255)
+
+	/// <summary>
+	/// Longest entry of a frame, the channel and a five byte delta.
+	/// </summary>
+	#define scTELEMETRY_MAX_ENTRY		(6)
+
+	#pragma pack(1)
+
+	/// <summary>
+	/// Start of the payload of a telemetry message. It is followed by _nCount
+	/// entries, each the channel number in one byte and the change of its value since
+	/// the frame before, zigzag encoded so small drops stay short, in one to five
+	/// bytes of seven bits, lowest first, the top bit set on all but the last. A
+	/// channel that did not change is left out. In a key frame the change is from
+	/// zero, that is the whole value, and every channel is present.
+	/// </summary>
+	typedef struct
+	{
+		uint8_t				_nFlags;
+		uint8_t				_nCount;
+		uint16_t			_nSequence;
+		uint32_t			_nTimestamp;
+	} scTelemetryFrame_t;
+
+	#pragma pack()
+
+	/// <summary>
+	/// Turns the payloads of telemetry messages back into channel values and CSV
+	/// rows, used by the host tools collecting the telemetry. The channel names are
+	/// the ones the target added its channels with, in the same order. A frame lost
+	/// on the way is noticed from the sequence number, the delta frames are then
+	/// ignored until the next key frame.
+	/// </summary>
+	class scTelemetryDecoder
+	{
+	public:
+		/// <summary>
+		/// Construct the decoder.
+		/// </summary>
+		/// <param name="pNames">Name of each channel, must stay valid.</param>
+		/// <param name="nCount">Number of channels.</param>
+		scTelemetryDecoder( const char* const* pNames, uint32_t nCount );
+
+		/// <summary>
+		/// Simple destructor.
+		/// </summary>
+		virtual ~scTelemetryDecoder();
+
+		/// <summary>
+		/// Apply a frame to the channel values.
+		/// </summary>
+		/// <param name="pPayload">Payload of the telemetry message.</param>
+		/// <param name="nLength">Length of the payload.</param>
+		/// <returns>true if the values are those of the frame, false if the frame is
+		/// damaged or a delta frame came while waiting for a key frame.</returns>
+		bool Decode( const uint8_t* pPayload, uint32_t nLength );
+
+		/// <summary>
+		/// Produce the CSV header line, timestamp, sequence and the channel names.
+		/// </summary>
+		/// <param name="pText">Receives the null terminated text.</param>
+		/// <param name="nTextSize">Size of the text buffer.</param>
+		/// <returns>The length of the text.</returns>
+		uint32_t Header( char* pText, uint32_t nTextSize ) const;
+
+		/// <summary>
+		/// Produce the CSV line of the frame decoded last.
+		/// </summary>
+		/// <param name="pText">Receives the null terminated text.</param>
+		/// <param name="nTextSize">Size of the text buffer.</param>
+		/// <returns>The length of the text.</returns>
+		uint32_t Row( char* pText, uint32_t nTextSize ) const;
+
+		/// <summary>
+		/// Value of a channel after the frame decoded last.
+		/// </summary>
+		uint32_t Value( uint32_t nChannel ) const
+		{
+			return ( nChannel < _nCount ) ? _nValues[nChannel] : 0;
+		}
+
+		/// <summary>
+		/// Timestamp of the frame decoded last.
+		/// </summary>
+		uint32_t Timestamp( void ) const
+		{
+			return _nTimestamp;
+		}
+
+		/// <summary>
+		/// Number of frames found missing from the sequence numbers.
+		/// </summary>
+		uint32_t Lost( void ) const
+		{
+			return _nLost;
+		}
+
+		/// <summary>
+		/// Number of frames that were damaged or ignored waiting for a key frame.
+		/// </summary>
+		uint32_t Rejected( void ) const
+		{
+			return _nRejected;
+		}
+
+	private:
+		/// <summary>
+		/// Add text to a line, as much as fits.
+		/// </summary>
+		static void Append( char* pText, uint32_t nTextSize, uint32_t& nLength, const char* pAdd );
+
+		/// <summary>
+		/// Name of each channel.
+		/// </summary>
+		const char* const*			_pNames;
+
+		/// <summary>
+		/// Number of channels.
+		/// </summary>
+		uint32_t					_nCount;
+
+		/// <summary>
+		/// The value of every channel.
+		/// </summary>
+		uint32_t					_nValues[scTELEMETRY_MAX_CHANNELS];
+
+		/// <summary>
+		/// Timestamp and sequence number of the frame decoded last.
+		/// </summary>
+		uint32_t					_nTimestamp;
+		uint16_t					_nSequence;
+
+		/// <summary>
+		/// Set once a key frame was decoded and no frame was lost since.
+		/// </summary>
+		bool						_bSynced;
+
+		/// <summary>
+		/// Frames lost and frames rejected.
+		/// </summary>
+		uint32_t					_nLost;
+		uint32_t					_nRejected;
+	};
+}
+
+#endif // !defined(__SCTELEMETRYDECODER_H__INCLUDED_)
@@ -0,0 +1,361 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scTimeline.cpp
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#include "scTimeline.h"
+
+#if SC_TIMELINE_ENABLED
+
+#include "scAtomic.h"
+#include "scHiResClock.h"
+#include "scErrorCodes.h"
+
+#if defined(_MSC_VER)
+#	define scTHREAD_LOCAL	__declspec(thread)
+#else
+#	define scTHREAD_LOCAL	__thread
+#endif
+
+using namespace SharedCore;
+
+scTimeline::Buffer_t* volatile	scTimeline::s_pBuffers = NULL;
+volatile uint32_t				scTimeline::s_nThreads = 0;
+volatile bool					scTimeline::s_bEnabled = false;
+
+/// <summary>
+/// The buffer of the thread, NULL until its first event.
+/// </summary>
+static scTHREAD_LOCAL void*		g_pThreadBuffer = NULL;
+
+/// <summary>
+/// Start or stop recording.
+/// </summary>
+void scTimeline::Enable( bool bEnable )
+{
+	s_bEnabled = bEnable;
+	scAtomicFence();
+}
+
+/// <summary>
+/// Record the start of a span of the calling thread.
+/// </summary>
+void scTimeline::Begin( const char* pCategory, const char* pName, uint32_t nArg )
+{
+	Record( 'B', pCategory, pName, nArg );
+}
+
+/// <summary>
+/// Record the end of the last span started by the calling thread.
+/// </summary>
+void scTimeline::End( const char* pCategory, const char* pName )
+{
+	Record( 'E', pCategory, pName, 0 );
+}
+
+/// <summary>
+/// Record an event without a duration.
+/// </summary>
+void scTimeline::Instant( const char* pCategory, const char* pName, uint32_t nArg )
+{
+	Record( 'i', pCategory, pName, nArg );
+}
+
+/// <summary>
+/// Add an event to the buffer of the calling thread. Only this thread writes past
+/// the published count, the event is complete before the count takes it in.
+/// </summary>
+void scTimeline::Record( char nPhase, const char* pCategory, const char* pName, uint32_t nArg )
+{
+	Buffer_t* pBuffer = ThreadBuffer();
+	uint32_t nCount = pBuffer->_nCount;
+
+	if ( nCount >= SC_TIMELINE_EVENTS )
+	{
+		scAtomicAdd( &pBuffer->_nDropped, 1 );
+		return;
+	}
+
+	scTimelineEvent_t& event = pBuffer->_Events[nCount];
+	event._nTicks = scHiResClock::Ticks();
+	event._pName = pName;
+	event._pCategory = pCategory;
+	event._nArg = nArg;
+	event._nPhase = nPhase;
+	scAtomicStore( &pBuffer->_nCount, nCount + 1 );
+}
+
+/// <summary>
+/// The buffer of the calling thread. On its first event the thread takes a buffer
+/// given back by a thread that ended, else it creates one and pushes it on the list
+/// without a lock.
+/// </summary>
+scTimeline::Buffer_t* scTimeline::ThreadBuffer( void )
+{
+	Buffer_t* pBuffer = reinterpret_cast<Buffer_t*>( g_pThreadBuffer );
+
+	if ( pBuffer == NULL )
+	{
+		// Constructed here once per thread, it gives the buffer back when the thread ends
+		static thread_local ThreadOwner	owner;
+
+		for( pBuffer = scAtomicLoadPointer( &s_pBuffers ); pBuffer != NULL; pBuffer = pBuffer->_pNext )
+		{
+			if ( scAtomicCompareExchange( &pBuffer->_nOwned, 0, 1 ) )
+			{
+				break;
+			}
+		}
+
+		if ( pBuffer == NULL )
+		{
+			pBuffer = new Buffer_t;
+			pBuffer->_nThread = scAtomicAdd( &s_nThreads, 1 ) + 1;
+			pBuffer->_nCount = 0;
+			pBuffer->_nDropped = 0;
+			pBuffer->_nOwned = 1;
+			do
+			{
+				pBuffer->_pNext = scAtomicLoadPointer( &s_pBuffers );
+			} while( !scAtomicCompareExchangePointer( &s_pBuffers, pBuffer->_pNext, pBuffer ) );
+		}
+		g_pThreadBuffer = pBuffer;
+	}
+	return pBuffer;
+}
+
+/// <summary>
+/// Give the buffer of the ending thread back for the next thread to record.
+/// </summary>
+scTimeline::ThreadOwner::~ThreadOwner()
+{
+	Buffer_t* pBuffer = reinterpret_cast<Buffer_t*>( g_pThreadBuffer );
+
+	if ( pBuffer != NULL )
+	{
+		g_pThreadBuffer = NULL;
+		scAtomicStore( &pBuffer->_nOwned, 0 );
+	}
+}
+
+/// <summary>
+/// Write a string as a JSON string.
+/// </summary>
+static void WriteString( FILE* pFile, const char* pText )
+{
+	fputc( '"', pFile );
+	for( const char* p = ( pText != NULL ) ? pText : ""; *p != '\0'; ++p )
+	{
+		if ( *p == '"' || *p == '\\' )
+		{
+			fputc( '\\', pFile );
+			fputc( *p, pFile );
+		}
+		else if ( (unsigned char)*p < 0x20 )
+		{
+			fprintf( pFile, "\\u%04x", (unsigned char)*p );
+		}
+		else
+		{
+			fputc( *p, pFile );
+		}
+	}
+	fputc( '"', pFile );
+}
+
+/// <summary>
+/// Write the events of every thread as a Chrome trace event JSON document. Times
+/// are in microseconds from the first event recorded, with three decimals, and each
+/// thread is named after the order it started recording in.
+/// </summary>
+uint32_t scTimeline::Write( FILE* pFile )
+{
+	if ( pFile == NULL )
+	{
+		return ERROR_SC_FILE_FAILURE;
+	}
+
+	// Find the first event so the times start at zero
+	uint64_t nOrigin = 0;
+	bool bFirst = true;
+	for( Buffer_t* pBuffer = scAtomicLoadPointer( &s_pBuffers ); pBuffer != NULL; pBuffer = pBuffer->_pNext )
+	{
+		if ( scAtomicLoad( &pBuffer->_nCount ) > 0 && ( bFirst || pBuffer->_Events[0]._nTicks < nOrigin ) )
+		{
+			nOrigin = pBuffer->_Events[0]._nTicks;
+			bFirst = false;
+		}
+	}
+
+	fputs( "{\"traceEvents\":[", pFile );
+	bFirst = true;
+	for( Buffer_t* pBuffer = scAtomicLoadPointer( &s_pBuffers ); pBuffer != NULL; pBuffer = pBuffer->_pNext )
+	{
+		fprintf( pFile, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+			bFirst ? "" : ",", pBuffer->_nThread, pBuffer->_nThread );
+		bFirst = false;
+		WriteBuffer( pFile, pBuffer, nOrigin );
+	}
+	fputs( "\n],\"displayTimeUnit\":\"ns\"}\n", pFile );
+
+	return ( ferror( pFile ) != 0 ) ? ERROR_SC_FILE_FAILURE : ERROR_SUCCESS;
+}
+
+/// <summary>
+/// Write the events of one buffer so every begin has its end. An end without a
+/// begin, its begin cleared or in a thread before, is skipped. A span left open,
+/// its end dropped or not recorded yet, is ended at the last event of the buffer.
+/// </summary>
+void scTimeline::WriteBuffer( FILE* pFile, const Buffer_t* pBuffer, uint64_t nOrigin )
+{
+	uint32_t nCount = scAtomicLoad( &pBuffer->_nCount );
+	uint32_t nDepth = 0;
+
+	for( uint32_t i=0; i < nCount; ++i )
+	{
+		const scTimelineEvent_t& event = pBuffer->_Events[i];
+		if ( event._nPhase == 'E' )
+		{
+			if ( nDepth == 0 )
+			{
+				continue;
+			}
+			nDepth--;
+		}
+		else if ( event._nPhase == 'B' )
+		{
+			nDepth++;
+		}
+		WriteEvent( pFile, event, event._nPhase, event._nTicks, nOrigin, pBuffer->_nThread );
+	}
+
+	// Walk back from the last event, the begins not taken by a later end are open,
+	// innermost first
+	uint32_t nEnds = 0;
+	for( uint32_t i=nCount; nDepth > 0 && i-- > 0; )
+	{
+		const scTimelineEvent_t& event = pBuffer->_Events[i];
+		if ( event._nPhase == 'E' )
+		{
+			nEnds++;
+		}
+		else if ( event._nPhase == 'B' )
+		{
+			if ( nEnds > 0 )
+			{
+				nEnds--;
+			}
+			else
+			{
+				WriteEvent( pFile, event, 'E', pBuffer->_Events[nCount - 1]._nTicks, nOrigin, pBuffer->_nThread );
+				nDepth--;
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Write one event with the phase and time given, an end carries no value.
+/// </summary>
+void scTimeline::WriteEvent( FILE* pFile, const scTimelineEvent_t& event, char nPhase, uint64_t nTicks, uint64_t nOrigin, uint32_t nThread )
+{
+	uint64_t nNanoseconds = scHiResClock::ToMicroseconds( ( nTicks - nOrigin ) * 1000 );
+
+	fputs( ",\n{\"name\":", pFile );
+	WriteString( pFile, event._pName );
+	fputs( ",\"cat\":", pFile );
+	WriteString( pFile, event._pCategory );
+	fprintf( pFile, ",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":1,\"tid\":%u", nPhase,
+		(unsigned long long)( nNanoseconds / 1000 ), (uint32_t)( nNanoseconds % 1000 ), nThread );
+	if ( nPhase == 'i' )
+	{
+		fputs( ",\"s\":\"t\"", pFile );
+	}
+	if ( nPhase != 'E' )
+	{
+		fprintf( pFile, ",\"args\":{\"value\":%u}", event._nArg );
+	}
+	fputc( '}', pFile );
+}
+
+/// <summary>
+/// Write the events to a new file.
+/// </summary>
+uint32_t scTimeline::Save( const char* pFileName )
+{
+	FILE* pFile = fopen( pFileName, "w" );
+	uint32_t nResult = Write( pFile );
+
+	if ( pFile != NULL && fclose( pFile ) != 0 )
+	{
+		nResult = ERROR_SC_FILE_FAILURE;
+	}
+	return nResult;
+}
+
+/// <summary>
+/// Forget the events recorded, the buffers are kept for their threads.
+/// </summary>
+void scTimeline::Clear( void )
+{
+	for( Buffer_t* pBuffer = scAtomicLoadPointer( &s_pBuffers ); pBuffer != NULL; pBuffer = pBuffer->_pNext )
+	{
+		scAtomicStore( &pBuffer->_nCount, 0 );
+		scAtomicStore( &pBuffer->_nDropped, 0 );
+	}
+}
+
+/// <summary>
+/// Number of events held for every thread.
+/// </summary>
+uint32_t scTimeline::Count( void )
+{
+	uint32_t nCount = 0;
+	for( Buffer_t* pBuffer = scAtomicLoadPointer( &s_pBuffers ); pBuffer != NULL; pBuffer = pBuffer->_pNext )
+	{
+		nCount += scAtomicLoad( &pBuffer->_nCount );
+	}
+	return nCount;
+}
+
+/// <summary>
+/// Number of events dropped because the buffer of the thread was full.
+/// </summary>
+uint32_t scTimeline::Dropped( void )
+{
+	uint32_t nDropped = 0;
+	for( Buffer_t* pBuffer = scAtomicLoadPointer( &s_pBuffers ); pBuffer != NULL; pBuffer = pBuffer->_pNext )
+	{
+		nDropped += scAtomicLoad( &pBuffer->_nDropped );
+	}
+	return nDropped;
+}
+
+#endif // SC_TIMELINE_ENABLED
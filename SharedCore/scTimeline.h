@@ -0,0 +1,308 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scTimeline.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCTIMELINE_H__INCLUDED_)
+#define __SCTIMELINE_H__INCLUDED_
+
+#include "scTypes.h"
+
+// Set to 1 in scConf.h to build the timeline, on hosted builds only. When 0 the
+// events are removed by the preprocessor and cost nothing.
+#ifndef SC_TIMELINE_ENABLED
+	#define SC_TIMELINE_ENABLED			(0)
+#endif
+
+// Number of events kept for each thread. Define it in scConf.h to change it.
+#ifndef SC_TIMELINE_EVENTS
+	#define SC_TIMELINE_EVENTS			(16384)
+#endif
+
+#include <stdio.h>
+
+namespace SharedCore
+{
+	/// <summary>
+	/// One event of the timeline.
+	/// </summary>
+	typedef struct
+	{
+		/// <summary>
+		/// When the event happened, in ticks of scHiResClock.
+		/// </summary>
+		uint64_t			_nTicks;
+
+		/// <summary>
+		/// Name of the event, must stay valid, a literal usually.
+		/// </summary>
+		const char*			_pName;
+
+		/// <summary>
+		/// Category of the event, must stay valid.
+		/// </summary>
+		const char*			_pCategory;
+
+		/// <summary>
+		/// Value shown with the event, a state or a size for example.
+		/// </summary>
+		uint32_t			_nArg;
+
+		/// <summary>
+		/// 'B' begin, 'E' end or 'i' instant, as in the trace event format.
+		/// </summary>
+		char				_nPhase;
+	} scTimelineEvent_t;
+
+	/// <summary>
+	/// Records what the framework does on a timeline, for a hosted build, and writes it
+	/// in the Chrome trace event format read by chrome://tracing and the Perfetto UI.
+	///
+	/// Each thread records into a buffer of its own, found through a thread local
+	/// pointer, so recording takes no lock and threads never contend. The first time
+	/// a thread records it takes the buffer of a thread that ended, or creates one,
+	/// and gives it back when it ends. A reused buffer keeps the events before it, so
+	/// buffers are never freed while the writer may walk them and threads started one
+	/// after the other share a row of the timeline. A thread only appends to its
+	/// buffer and publishes the count afterwards, so the writer may run while the
+	/// threads record; it writes the events published when it got to the buffer. Once
+	/// a buffer is full further events of the thread are dropped and counted, the
+	/// writer ends the spans left open and skips the ends without a begin.
+	///
+	/// Recording starts disabled. Compiled in, a disabled event costs a test of a
+	/// flag; with SC_TIMELINE_ENABLED 0 the macros are empty.
+	/// </summary>
+	class scTimeline
+	{
+	public:
+		/// <summary>
+		/// Start or stop recording.
+		/// </summary>
+		static void Enable( bool bEnable );
+
+		/// <summary>
+		/// True while recording.
+		/// </summary>
+		static bool IsEnabled( void )
+		{
+			return s_bEnabled;
+		}
+
+		/// <summary>
+		/// Record the start of a span of the calling thread.
+		/// </summary>
+		/// <param name="pCategory">The category.</param>
+		/// <param name="pName">The name.</param>
+		/// <param name="nArg">Value shown with the span.</param>
+		static void Begin( const char* pCategory, const char* pName, uint32_t nArg );
+
+		/// <summary>
+		/// Record the end of the last span started by the calling thread.
+		/// </summary>
+		static void End( const char* pCategory, const char* pName );
+
+		/// <summary>
+		/// Record an event without a duration.
+		/// </summary>
+		static void Instant( const char* pCategory, const char* pName, uint32_t nArg );
+
+		/// <summary>
+		/// Write the events of every thread as a Chrome trace event JSON document.
+		/// </summary>
+		/// <param name="pFile">The open file.</param>
+		/// <returns>ERROR_SUCCESS or ERROR_SC_FILE_FAILURE if a write failed.</returns>
+		static uint32_t Write( FILE* pFile );
+
+		/// <summary>
+		/// Write the events to a new file.
+		/// </summary>
+		/// <param name="pFileName">Name of the file, a .json file.</param>
+		/// <returns>ERROR_SUCCESS or ERROR_SC_FILE_FAILURE.</returns>
+		static uint32_t Save( const char* pFileName );
+
+		/// <summary>
+		/// Forget the events recorded. Call it while the threads do not record, an
+		/// event being added meanwhile can be lost.
+		/// </summary>
+		static void Clear( void );
+
+		/// <summary>
+		/// Number of events held for every thread.
+		/// </summary>
+		static uint32_t Count( void );
+
+		/// <summary>
+		/// Number of events dropped because the buffer of the thread was full.
+		/// </summary>
+		static uint32_t Dropped( void );
+
+	private:
+		/// <summary>
+		/// Events of one thread.
+		/// </summary>
+		typedef struct Buffer_s
+		{
+			/// <summary>
+			/// The next buffer of the list.
+			/// </summary>
+			struct Buffer_s*	_pNext;
+
+			/// <summary>
+			/// Number of the thread in the written timeline.
+			/// </summary>
+			uint32_t			_nThread;
+
+			/// <summary>
+			/// Events published, only the owning thread adds to it.
+			/// </summary>
+			volatile uint32_t	_nCount;
+
+			/// <summary>
+			/// Events dropped because the buffer was full.
+			/// </summary>
+			volatile uint32_t	_nDropped;
+
+			/// <summary>
+			/// 1 while a thread records into the buffer, 0 once it ended.
+			/// </summary>
+			volatile uint32_t	_nOwned;
+
+			scTimelineEvent_t	_Events[SC_TIMELINE_EVENTS];
+		} Buffer_t;
+
+		/// <summary>
+		/// Gives the buffer of a thread back when the thread ends.
+		/// </summary>
+		class ThreadOwner
+		{
+		public:
+			~ThreadOwner();
+		};
+
+		/// <summary>
+		/// Add an event to the buffer of the calling thread.
+		/// </summary>
+		static void Record( char nPhase, const char* pCategory, const char* pName, uint32_t nArg );
+
+		/// <summary>
+		/// The buffer of the calling thread, taken or created on its first event.
+		/// </summary>
+		static Buffer_t* ThreadBuffer( void );
+
+		/// <summary>
+		/// Write the events of one buffer.
+		/// </summary>
+		static void WriteBuffer( FILE* pFile, const Buffer_t* pBuffer, uint64_t nOrigin );
+
+		/// <summary>
+		/// Write one event.
+		/// </summary>
+		static void WriteEvent( FILE* pFile, const scTimelineEvent_t& event, char nPhase, uint64_t nTicks, uint64_t nOrigin, uint32_t nThread );
+
+		/// <summary>
+		/// Every buffer created, newest first.
+		/// </summary>
+		static Buffer_t* volatile		s_pBuffers;
+
+		/// <summary>
+		/// Number of buffers created.
+		/// </summary>
+		static volatile uint32_t		s_nThreads;
+
+		/// <summary>
+		/// True while recording.
+		/// </summary>
+		static volatile bool			s_bEnabled;
+	};
+
+	/// <summary>
+	/// Records a span for its own life, see scTIMELINE_SCOPE.
+	/// </summary>
+	class scTimelineScope
+	{
+	public:
+		/// <summary>
+		/// Begin the span when recording.
+		/// </summary>
+		scTimelineScope( const char* pCategory, const char* pName, uint32_t nArg = 0 )
+			: _pCategory( NULL ), _pName( pName )
+		{
+			if ( scTimeline::IsEnabled() )
+			{
+				_pCategory = pCategory;
+				scTimeline::Begin( pCategory, pName, nArg );
+			}
+		}
+
+		/// <summary>
+		/// End the span if it was begun, even when recording stopped meanwhile.
+		/// </summary>
+		~scTimelineScope()
+		{
+			if ( _pCategory != NULL )
+			{
+				scTimeline::End( _pCategory, _pName );
+			}
+		}
+
+	private:
+		const char*		_pCategory;
+		const char*		_pName;
+	};
+}
+
+#define scTIMELINE_JOIN2( a, b )	a##b
+#define scTIMELINE_JOIN( a, b )		scTIMELINE_JOIN2( a, b )
+
+#if SC_TIMELINE_ENABLED
+	/// <summary>
+	/// Record the rest of the enclosing scope as a span.
+	/// </summary>
+	#define scTIMELINE_SCOPE( pCategory, pName ) \
+		SharedCore::scTimelineScope scTIMELINE_JOIN( scSpan_, __LINE__ )( pCategory, pName )
+
+	/// <summary>
+	/// Record the rest of the enclosing scope as a span showing a value.
+	/// </summary>
+	#define scTIMELINE_SCOPE_ARG( pCategory, pName, nArg ) \
+		SharedCore::scTimelineScope scTIMELINE_JOIN( scSpan_, __LINE__ )( pCategory, pName, nArg )
+
+	/// <summary>
+	/// Record an instant event, the value is only evaluated while recording.
+	/// </summary>
+	#define scTIMELINE_INSTANT( pCategory, pName, nArg ) \
+		do { if ( SharedCore::scTimeline::IsEnabled() ) { SharedCore::scTimeline::Instant( pCategory, pName, nArg ); } } while(0)
+#else
+	#define scTIMELINE_SCOPE( pCategory, pName )			do { } while(0)
+	#define scTIMELINE_SCOPE_ARG( pCategory, pName, nArg )	do { } while(0)
+	#define scTIMELINE_INSTANT( pCategory, pName, nArg )	do { } while(0)
+#endif
+
+#endif // !defined(__SCTIMELINE_H__INCLUDED_)
@@ -0,0 +1,115 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scTrace.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCTRACE_H__INCLUDED_)
+#define __SCTRACE_H__INCLUDED_
+
+#include "scTypes.h"
+#include "scDebugManager.h"
+#include "scDebugLabelCodes.h"
+
+// Trace levels, from the least to the most important. Every trace macro names a
+// level and a label. The level decides at compile time whether the call exists,
+// the label decides at run time whether it produces output, so product labels
+// can be used at any level.
+#define scTRACE_LEVEL_DEBUG			(0)
+#define scTRACE_LEVEL_INFO			(1)
+#define scTRACE_LEVEL_WARNING		(2)
+#define scTRACE_LEVEL_ERROR			(3)
+#define scTRACE_LEVEL_NONE			(4)
+
+// Calls below this level are removed by the preprocessor along with their format
+// strings and arguments. Define it in scConf.h, by default everything is kept.
+#ifndef SC_TRACE_MIN_LEVEL
+	#define SC_TRACE_MIN_LEVEL		scTRACE_LEVEL_DEBUG
+#endif
+
+/// <summary>
+/// Trace if the label is enabled. The label is tested inline before any of the
+/// arguments are evaluated.
+/// </summary>
+#define scTRACE_LABEL( nLabel, ... ) \
+	do { if ( SharedCore::scDebugManager::IsEnabled( nLabel ) ) { SharedCore::scDebugManager::Instance()->Trace( nLabel, __VA_ARGS__ ); } } while(0)
+
+/// <summary>
+/// Binary trace if the label is enabled, see scDebugManager::TraceBinary.
+/// </summary>
+#define scTRACE_BINARY_LABEL( nLabel, ... ) \
+	do { if ( SharedCore::scDebugManager::IsEnabled( nLabel ) ) { SharedCore::scDebugManager::Instance()->TraceBinary( nLabel, __VA_ARGS__ ); } } while(0)
+
+/// <summary>
+/// Trace if the label is enabled, at most nPerSecond times a second on average and
+/// nBurst at once from this call site. Repeats of the same text are collapsed, see
+/// scDebugManager::TraceLimited. Meant for errors that can come in storms.
+/// </summary>
+#define scTRACE_LIMITED( nLabel, nPerSecond, nBurst, ... ) \
+	do { if ( SharedCore::scDebugManager::IsEnabled( nLabel ) ) { \
+		static SharedCore::scTraceLimit_t s_Limit = scTRACE_LIMIT_INIT( nPerSecond, nBurst ); \
+		SharedCore::scDebugManager::Instance()->TraceLimited( s_Limit, nLabel, __VA_ARGS__ ); } } while(0)
+
+#define scTRACE_REMOVED()		do { } while(0)
+
+#if SC_TRACE_MIN_LEVEL <= scTRACE_LEVEL_DEBUG
+	#define scTRACE_DEBUG( nLabel, ... )			scTRACE_LABEL( nLabel, __VA_ARGS__ )
+	#define scTRACE_BINARY_DEBUG( nLabel, ... )		scTRACE_BINARY_LABEL( nLabel, __VA_ARGS__ )
+#else
+	#define scTRACE_DEBUG( nLabel, ... )			scTRACE_REMOVED()
+	#define scTRACE_BINARY_DEBUG( nLabel, ... )		scTRACE_REMOVED()
+#endif
+
+#if SC_TRACE_MIN_LEVEL <= scTRACE_LEVEL_INFO
+	#define scTRACE_INFO( nLabel, ... )				scTRACE_LABEL( nLabel, __VA_ARGS__ )
+	#define scTRACE_BINARY_INFO( nLabel, ... )		scTRACE_BINARY_LABEL( nLabel, __VA_ARGS__ )
+#else
+	#define scTRACE_INFO( nLabel, ... )				scTRACE_REMOVED()
+	#define scTRACE_BINARY_INFO( nLabel, ... )		scTRACE_REMOVED()
+#endif
+
+#if SC_TRACE_MIN_LEVEL <= scTRACE_LEVEL_WARNING
+	#define scTRACE_WARNING( nLabel, ... )			scTRACE_LABEL( nLabel, __VA_ARGS__ )
+	#define scTRACE_BINARY_WARNING( nLabel, ... )	scTRACE_BINARY_LABEL( nLabel, __VA_ARGS__ )
+#else
+	#define scTRACE_WARNING( nLabel, ... )			scTRACE_REMOVED()
+	#define scTRACE_BINARY_WARNING( nLabel, ... )	scTRACE_REMOVED()
+#endif
+
+#if SC_TRACE_MIN_LEVEL <= scTRACE_LEVEL_ERROR
+	#define scTRACE_ERROR( nLabel, ... )			scTRACE_LABEL( nLabel, __VA_ARGS__ )
+	#define scTRACE_BINARY_ERROR( nLabel, ... )		scTRACE_BINARY_LABEL( nLabel, __VA_ARGS__ )
+#else
+	#define scTRACE_ERROR( nLabel, ... )			scTRACE_REMOVED()
+	#define scTRACE_BINARY_ERROR( nLabel, ... )		scTRACE_REMOVED()
+#endif
+
+#endif // !defined(__SCTRACE_H__INCLUDED_)
@@ -0,0 +1,255 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scTraceDecoder.cpp
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#include <string.h>
+#include <stdio.h>
+#include "scTraceDecoder.h"
+
+using namespace SharedCore;
+
+#ifdef _WIN32
+	#define TRACE_SNPRINTF( pText, nSize, ... )	_snprintf_s( pText, nSize, _TRUNCATE, __VA_ARGS__ )
+#else
+	#define TRACE_SNPRINTF( pText, nSize, ... )	snprintf( pText, nSize, __VA_ARGS__ )
+#endif
+
+/// <summary>
+/// Construct the decoder.
+/// </summary>
+/// <param name="pTable">The format string table, must stay valid.</param>
+/// <param name="nCount">Number of entries in the table.</param>
+/// <param name="bPrefix">true to start every line with the timestamp and
+/// label of the record.</param>
+scTraceDecoder::scTraceDecoder( const scTraceFormat_t* pTable, uint16_t nCount, bool bPrefix )
+	: _pTable( pTable )
+	, _nCount( nCount )
+	, _bPrefix( bPrefix )
+	, _nTimestamp( 0 )
+	, _bSynced( false )
+{
+}
+
+/// <summary>
+/// Simple destructor.
+/// </summary>
+scTraceDecoder::~scTraceDecoder()
+{
+}
+
+/// <summary>
+/// Locate the format string for an ID.
+/// </summary>
+/// <param name="nFormatId">The format ID.</param>
+/// <returns>The format string or NULL if the ID is not in the table.</returns>
+const char* scTraceDecoder::Find( uint16_t nFormatId ) const
+{
+	// tables built from the X-macro are in ID order so try the direct index first
+	if ( nFormatId < _nCount && _pTable[nFormatId]._nId == nFormatId )
+	{
+		return _pTable[nFormatId]._pFormat;
+	}
+
+	for( uint16_t i=0; i < _nCount; ++i )
+	{
+		if ( _pTable[i]._nId == nFormatId )
+		{
+			return _pTable[i]._pFormat;
+		}
+	}
+	return NULL;
+}
+
+/// <summary>
+/// Produce the text for a record.
+/// </summary>
+/// <param name="record">The record header.</param>
+/// <param name="pArgs">The arguments of the record.</param>
+/// <param name="pText">Receives the null terminated text.</param>
+/// <param name="nTextSize">Size of the text buffer.</param>
+/// <returns>The length of the text.</returns>
+uint32_t scTraceDecoder::Format( const scTraceRecord_t& record, const uint32_t* pArgs, char* pText, uint32_t nTextSize ) const
+{
+	return Format( record, true, pArgs, pText, nTextSize );
+}
+
+/// <summary>
+/// Produce the text for a record, the prefix showing the timestamp only when it is
+/// known.
+/// </summary>
+uint32_t scTraceDecoder::Format( const scTraceRecord_t& record, bool bTimed, const uint32_t* pArgs, char* pText, uint32_t nTextSize ) const
+{
+	uint32_t	a[scTRACE_MAX_ARGS] = { 0, 0, 0, 0 };
+	int			nLength = 0;
+	int			nResult;
+
+	if ( nTextSize == 0 )
+	{
+		return 0;
+	}
+
+	for( uint8_t i=0; i < record._nArgs && i < scTRACE_MAX_ARGS; ++i )
+	{
+		a[i] = pArgs[i];
+	}
+
+	if ( _bPrefix && bTimed )
+	{
+		nResult = TRACE_SNPRINTF( pText, nTextSize, "%10u [%u] ", (unsigned int)record._nTimestamp, (unsigned int)record._nLabel );
+		nLength = ( nResult > 0 ) ? nResult : 0;
+	}
+	else if ( _bPrefix )
+	{
+		nResult = TRACE_SNPRINTF( pText, nTextSize, "%10s [%u] ", "?", (unsigned int)record._nLabel );
+		nLength = ( nResult > 0 ) ? nResult : 0;
+	}
+
+	if ( (uint32_t)nLength < nTextSize )
+	{
+		const char* pFormat = Find( record._nFormatId );
+		if ( pFormat != NULL )
+		{
+			// unused arguments are ignored by the formatter
+			nResult = TRACE_SNPRINTF( pText + nLength, nTextSize - nLength, pFormat, a[0], a[1], a[2], a[3] );
+		}
+		else
+		{
+			nResult = TRACE_SNPRINTF( pText + nLength, nTextSize - nLength, "<format %u> %08x %08x %08x %08x\n\r",
+				(unsigned int)record._nFormatId, a[0], a[1], a[2], a[3] );
+		}
+		nLength += ( nResult > 0 ) ? nResult : 0;
+	}
+
+	if ( (uint32_t)nLength >= nTextSize )
+	{
+		nLength = nTextSize - 1;
+	}
+	return (uint32_t)nLength;
+}
+
+/// <summary>
+/// Decode the record at the start of the buffer. Bytes that are not the start
+/// of a record are skipped one at a time. The timestamp of a delta record is
+/// built on the record decoded before. Until the first record with the whole
+/// timestamp the base is unknown, such as when the data starts part way into the
+/// output, and delta records are decoded without a timestamp.
+/// </summary>
+/// <param name="pData">The binary trace data.</param>
+/// <param name="nLength">Number of bytes available.</param>
+/// <param name="pText">Receives the null terminated text.</param>
+/// <param name="nTextSize">Size of the text buffer.</param>
+/// <param name="nTextLength">Receives the length of the text, zero if bytes were
+/// skipped.</param>
+/// <returns>The number of bytes consumed, zero if the record is not complete.
+/// </returns>
+uint32_t scTraceDecoder::Decode( const uint8_t* pData, uint32_t nLength, char* pText, uint32_t nTextSize, uint32_t& nTextLength )
+{
+	scTraceRecord_t		record;
+	uint32_t			args[scTRACE_MAX_ARGS];
+	uint32_t			nHeader;
+	bool				bWhole = ( nLength > 0 && pData[0] == scTRACE_RECORD_SYNC );
+
+	nTextLength = 0;
+
+	if ( nLength == 0 )
+	{
+		return 0;
+	}
+	if ( pData[0] == scTRACE_RECORD_SYNC )
+	{
+		if ( nLength < sizeof(scTraceRecord_t) )
+		{
+			return 0;
+		}
+		memcpy( &record, pData, sizeof(scTraceRecord_t) );
+		nHeader = sizeof(scTraceRecord_t);
+	}
+	else if ( pData[0] == scTRACE_DELTA_SYNC )
+	{
+		scTraceDeltaRecord_t	delta;
+		uint32_t				nDelta = 0;
+
+		if ( nLength < sizeof(scTraceDeltaRecord_t) )
+		{
+			return 0;
+		}
+		memcpy( &delta, pData, sizeof(scTraceDeltaRecord_t) );
+		nHeader = sizeof(scTraceDeltaRecord_t);
+		for( uint32_t nShift = 0; ; nShift += 7 )
+		{
+			if ( nShift > 14 )
+			{
+				return 1;
+			}
+			if ( nHeader >= nLength )
+			{
+				return 0;
+			}
+			uint8_t nByte = pData[nHeader++];
+			nDelta |= (uint32_t)( nByte & 0x7F ) << nShift;
+			if ( ( nByte & 0x80 ) == 0 )
+			{
+				break;
+			}
+		}
+		record._nSync = delta._nSync;
+		record._nArgs = delta._nArgs;
+		record._nLabel = delta._nLabel;
+		record._nFormatId = delta._nFormatId;
+		record._nTimestamp = _nTimestamp + nDelta;
+	}
+	else
+	{
+		return 1;
+	}
+
+	if ( record._nArgs > scTRACE_MAX_ARGS )
+	{
+		return 1;
+	}
+
+	uint32_t nRecord = nHeader + record._nArgs * sizeof(uint32_t);
+	if ( nLength < nRecord )
+	{
+		return 0;
+	}
+
+	memcpy( args, pData + nHeader, record._nArgs * sizeof(uint32_t) );
+	_bSynced = _bSynced || bWhole;
+	if ( _bSynced )
+	{
+		_nTimestamp = record._nTimestamp;
+	}
+	nTextLength = Format( record, _bSynced, args, pText, nTextSize );
+	return nRecord;
+}
@@ -0,0 +1,242 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scTraceDecoder.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCTRACEDECODER_H__INCLUDED_)
+#define __SCTRACEDECODER_H__INCLUDED_
+
+#include "scTypes.h"
+
+namespace SharedCore
+{
+	/// <summary>
+	/// First byte of every binary trace record, used to find the start of a record
+	/// after data has been lost.
+	/// </summary>
+	#define scTRACE_RECORD_SYNC			(0xB5)
+
+	/// <summary>
+	/// First byte of a binary trace record carrying the time since the record before
+	/// in place of the timestamp, see scTraceDeltaRecord_t.
+	/// </summary>
+	#define scTRACE_DELTA_SYNC			(0xB6)
+
+	/// <summary>
+	/// Longest time a delta record carries, three bytes of seven bits.
+	/// </summary>
+	#define scTRACE_DELTA_MAX			((1UL << 21) - 1)
+
+	/// <summary>
+	/// Most arguments a binary trace record can carry.
+	/// </summary>
+	#define scTRACE_MAX_ARGS			(4)
+
+	/// <summary>
+	/// Helpers for keeping the list of trace formats in a single X-macro so the IDs
+	/// and the text come from the same place. The application lists its formats once:
+	///
+	///   #define APP_TRACE_FORMATS(X)
+	///       X( FMT_UART_OVERRUN, "UART %u overrun, %u bytes lost\n\r" )
+	///       X( FMT_STATE_CHANGE, "State %u -> %u\n\r" )
+	///
+	/// with each line of the macro but the last ending in a backslash.
+	///
+	/// The target only builds the IDs, so none of the text is linked into it:
+	///
+	///   enum { APP_TRACE_FORMATS( scTRACE_FORMAT_ID ) };
+	///
+	/// The host decoder, or a target that wants readable output, builds the table:
+	///
+	///   static const scTraceFormat_t table[] = { APP_TRACE_FORMATS( scTRACE_FORMAT_ENTRY ) };
+	/// </summary>
+	#define scTRACE_FORMAT_ID( id, text )		id,
+	#define scTRACE_FORMAT_ENTRY( id, text )	{ id, text },
+
+	#pragma pack(1)
+
+	/// <summary>
+	/// Header of a binary trace record. It is followed by _nArgs 32 bit arguments
+	/// in the byte order of the target.
+	/// </summary>
+	typedef struct
+	{
+		uint8_t				_nSync;
+		uint8_t				_nArgs;
+		uint16_t			_nLabel;
+		uint16_t			_nFormatId;
+		uint32_t			_nTimestamp;
+	} scTraceRecord_t;
+
+	/// <summary>
+	/// Header of a binary trace record whose timestamp is the one of the record before
+	/// plus a delta. The delta follows the header in one to three bytes of seven bits,
+	/// lowest first, the top bit set on all but the last. Then come the _nArgs
+	/// arguments. Most records are three or more bytes shorter than with the whole
+	/// timestamp.
+	/// </summary>
+	typedef struct
+	{
+		uint8_t				_nSync;
+		uint8_t				_nArgs;
+		uint16_t			_nLabel;
+		uint16_t			_nFormatId;
+	} scTraceDeltaRecord_t;
+
+	#pragma pack()
+
+	/// <summary>
+	/// One entry of the format string table.
+	/// </summary>
+	typedef struct
+	{
+		uint16_t			_nId;
+		const char*			_pFormat;
+	} scTraceFormat_t;
+
+	/// <summary>
+	/// Converts binary trace records back into text using the format string table.
+	/// The formats may only use integer conversions such as %u, %d, %x and %c since
+	/// every argument is recorded as a 32 bit value. Used by the host tools reading
+	/// the debug output, and by the debug manager when the target should produce text.
+	/// </summary>
+	class scTraceDecoder
+	{
+	public:
+		/// <summary>
+		/// Construct the decoder.
+		/// </summary>
+		/// <param name="pTable">The format string table, must stay valid.</param>
+		/// <param name="nCount">Number of entries in the table.</param>
+		/// <param name="bPrefix">true to start every line with the timestamp and
+		/// label of the record.</param>
+		scTraceDecoder( const scTraceFormat_t* pTable, uint16_t nCount, bool bPrefix = false );
+
+		/// <summary>
+		/// Simple destructor.
+		/// </summary>
+		virtual ~scTraceDecoder();
+
+		/// <summary>
+		/// Locate the format string for an ID.
+		/// </summary>
+		/// <param name="nFormatId">The format ID.</param>
+		/// <returns>The format string or NULL if the ID is not in the table.</returns>
+		const char* Find( uint16_t nFormatId ) const;
+
+		/// <summary>
+		/// Produce the text for a record.
+		/// </summary>
+		/// <param name="record">The record header.</param>
+		/// <param name="pArgs">The arguments of the record.</param>
+		/// <param name="pText">Receives the null terminated text.</param>
+		/// <param name="nTextSize">Size of the text buffer.</param>
+		/// <returns>The length of the text.</returns>
+		uint32_t Format( const scTraceRecord_t& record, const uint32_t* pArgs, char* pText, uint32_t nTextSize ) const;
+
+		/// <summary>
+		/// Decode the record at the start of the buffer. Bytes that are not the start
+		/// of a record are skipped one at a time. The timestamp of a delta record is
+		/// built on the record decoded before. Until the first record with the whole
+		/// timestamp the base is unknown, such as when the data starts part way into
+		/// the output, and delta records are decoded without a timestamp.
+		/// </summary>
+		/// <param name="pData">The binary trace data.</param>
+		/// <param name="nLength">Number of bytes available.</param>
+		/// <param name="pText">Receives the null terminated text.</param>
+		/// <param name="nTextSize">Size of the text buffer.</param>
+		/// <param name="nTextLength">Receives the length of the text, zero if bytes were
+		/// skipped.</param>
+		/// <returns>The number of bytes consumed, zero if the record is not complete.
+		/// </returns>
+		uint32_t Decode( const uint8_t* pData, uint32_t nLength, char* pText, uint32_t nTextSize, uint32_t& nTextLength );
+
+		/// <summary>
+		/// The timestamp of the record decoded last.
+		/// </summary>
+		uint32_t Timestamp( void ) const
+		{
+			return _nTimestamp;
+		}
+
+		/// <summary>
+		/// True once a record with the whole timestamp has been decoded, the timestamps
+		/// of the delta records are known from then on.
+		/// </summary>
+		bool Synced( void ) const
+		{
+			return _bSynced;
+		}
+
+		/// <summary>
+		/// Forget the base of the delta records, as when decoding another stream.
+		/// </summary>
+		void Unsync( void )
+		{
+			_bSynced = false;
+		}
+
+	private:
+		/// <summary>
+		/// Produce the text for a record, the prefix showing the timestamp only when it
+		/// is known.
+		/// </summary>
+		uint32_t Format( const scTraceRecord_t& record, bool bTimed, const uint32_t* pArgs, char* pText, uint32_t nTextSize ) const;
+
+		/// <summary>
+		/// The format string table.
+		/// </summary>
+		const scTraceFormat_t*		_pTable;
+
+		/// <summary>
+		/// Number of entries in the table.
+		/// </summary>
+		uint16_t					_nCount;
+
+		/// <summary>
+		/// Start every line with the timestamp and label.
+		/// </summary>
+		bool						_bPrefix;
+
+		/// <summary>
+		/// Timestamp of the record decoded last, the base of the next delta.
+		/// </summary>
+		uint32_t					_nTimestamp;
+
+		/// <summary>
+		/// Set once _nTimestamp comes from a record with the whole timestamp.
+		/// </summary>
+		bool						_bSynced;
+	};
+}
+
+#endif // !defined(__SCTRACEDECODER_H__INCLUDED_)
@@ -0,0 +1,299 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scTraceQueue.cpp
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#include <string.h>
+#include "scTraceQueue.h"
+#include "scErrorCodes.h"
+
+#ifndef assert_param
+#define assert_param(X)	if ( !(X) ) { for(;;) ; }
+#endif
+
+using namespace SharedCore;
+
+/// <summary>
+/// Construct the queue.
+/// </summary>
+/// <param name="nSlots">Number of records the queue holds, a power of two.
+/// </param>
+/// <param name="nSlotSize">Largest record in bytes, up to 65535.</param>
+/// <param name="nPolicy">What to do when the queue is full.</param>
+scTraceQueue::scTraceQueue( uint32_t nSlots, uint32_t nSlotSize, scTracePolicy_t nPolicy )
+	: _nMask( nSlots - 1 )
+	, _nSlotSize( nSlotSize )
+	, _nStride( ( sizeof(Slot_t) + nSlotSize + 3 ) & ~3 )
+	, _pSlots( NULL )
+	, _nWrite( 0 )
+	, _nRead( 0 )
+	, _nPolicy( nPolicy )
+	, _pYield( NULL )
+	, _nWritten( 0 )
+	, _nDropped( 0 )
+	, _nWaits( 0 )
+	, _Allocator()
+{
+	assert_param( nSlots >= 2 && ( nSlots & _nMask ) == 0 );
+	assert_param( nSlotSize <= 0xFFFF );
+}
+
+/// <summary>
+/// Destructor.
+/// </summary>
+scTraceQueue::~scTraceQueue()
+{
+	if ( _pSlots != NULL )
+	{
+		_Allocator.Destroy( _pSlots );
+		_pSlots = NULL;
+	}
+}
+
+/// <summary>
+/// Allocate the slots.
+/// </summary>
+/// <param name="allocator">Allocator used for the slots.</param>
+uint32_t scTraceQueue::Initialize( scAllocator allocator )
+{
+	_Allocator = allocator;
+	_pSlots = _Allocator.Allocate( ( _nMask + 1 ) * _nStride, true );
+	if ( _pSlots == NULL )
+	{
+		return ERROR_SC_MEMORY_ALLOCATION_FAILURE;
+	}
+
+	for( uint32_t i=0; i <= _nMask; ++i )
+	{
+		SlotAt( i )->_nSequence = i;
+		SlotAt( i )->_nLength = 0;
+		SlotAt( i )->_nTag = 0;
+	}
+	_nWrite = 0;
+	_nRead = 0;
+	return ERROR_SUCCESS;
+}
+
+/// <summary>
+/// Claim a slot to build a record in place. Must be followed by Commit.
+/// </summary>
+/// <param name="nSize">Receives the number of bytes available in the slot.
+/// </param>
+/// <returns>The slot or NULL if the record has to be dropped.</returns>
+uint8_t* scTraceQueue::Reserve( uint32_t& nSize )
+{
+	assert_param( _pSlots != NULL );
+
+	uint32_t nPosition = scAtomicLoad( &_nWrite );
+	bool bWaited = false;
+
+	for(;;)
+	{
+		Slot_t*	pSlot = SlotAt( nPosition );
+		int32_t	nDiff = (int32_t)( scAtomicLoad( &pSlot->_nSequence ) - nPosition );
+
+		if ( nDiff == 0 )
+		{
+			if ( scAtomicCompareExchange( &_nWrite, nPosition, nPosition + 1 ) )
+			{
+				nSize = _nSlotSize;
+				return reinterpret_cast<uint8_t*>( pSlot + 1 );
+			}
+		}
+		else if ( nDiff < 0 )
+		{
+			// full
+			if ( _nPolicy == scTraceDropOldest )
+			{
+				uint32_t	nOldest;
+				Slot_t*		pOldest = Claim( nOldest );
+				if ( pOldest == NULL )
+				{
+					// the oldest slot is still being written, give up on this record
+					scAtomicAdd( &_nDropped, 1 );
+					return NULL;
+				}
+				Free( pOldest, nOldest );
+				scAtomicAdd( &_nDropped, 1 );
+			}
+			else if ( _nPolicy == scTraceBlock )
+			{
+				if ( !bWaited )
+				{
+					scAtomicAdd( &_nWaits, 1 );
+					bWaited = true;
+				}
+				if ( _pYield != NULL )
+				{
+					_pYield();
+				}
+			}
+			else
+			{
+				scAtomicAdd( &_nDropped, 1 );
+				return NULL;
+			}
+		}
+		nPosition = scAtomicLoad( &_nWrite );
+	}
+}
+
+/// <summary>
+/// Hand a slot obtained from Reserve to the reader.
+/// </summary>
+/// <param name="pSlot">The slot.</param>
+/// <param name="nLength">Number of bytes used.</param>
+/// <param name="nTag">Passed to the reader with the record, such as the debug
+/// label.</param>
+void scTraceQueue::Commit( uint8_t* pSlot, uint32_t nLength, uint16_t nTag )
+{
+	Slot_t* pHeader = reinterpret_cast<Slot_t*>( pSlot ) - 1;
+
+	pHeader->_nLength = (uint16_t)( ( nLength < _nSlotSize ) ? nLength : _nSlotSize );
+	pHeader->_nTag = nTag;
+	// the sequence still holds the position the slot was claimed at
+	scAtomicStore( &pHeader->_nSequence, pHeader->_nSequence + 1 );
+	scAtomicAdd( &_nWritten, 1 );
+}
+
+/// <summary>
+/// Add a record.
+/// </summary>
+/// <returns>false if the record was dropped.</returns>
+bool scTraceQueue::Push( const uint8_t* pData, uint32_t nLength, uint16_t nTag )
+{
+	scIOSpan_t span;
+	span._pData = pData;
+	span._nLength = nLength;
+	return Push_v( &span, 1, nTag );
+}
+
+/// <summary>
+/// Add a record made of several pieces.
+/// </summary>
+/// <returns>false if the record was dropped.</returns>
+bool scTraceQueue::Push_v( const scIOSpan_t* pSpans, uint32_t nCount, uint16_t nTag )
+{
+	uint32_t	nSize;
+	uint8_t*	pSlot = Reserve( nSize );
+
+	if ( pSlot != NULL )
+	{
+		uint32_t nLength = 0;
+		for( uint32_t i=0; i < nCount && nLength < nSize; ++i )
+		{
+			uint32_t nCopy = pSpans[i]._nLength;
+			if ( nCopy > nSize - nLength )
+			{
+				nCopy = nSize - nLength;
+			}
+			memcpy( pSlot + nLength, pSpans[i]._pData, nCopy );
+			nLength += nCopy;
+		}
+		Commit( pSlot, nLength, nTag );
+	}
+	return pSlot != NULL;
+}
+
+/// <summary>
+/// Pass the waiting records to the reader, oldest first. Only one task may
+/// drain.
+/// </summary>
+/// <param name="pReader">Called for each record.</param>
+/// <param name="pContext">Passed to the reader.</param>
+/// <param name="nMax">Most records to drain.</param>
+/// <returns>Number of records drained.</returns>
+uint32_t scTraceQueue::Drain( Reader_t pReader, void* pContext, uint32_t nMax )
+{
+	uint32_t nCount = 0;
+
+	while( nCount < nMax )
+	{
+		uint32_t	nPosition;
+		Slot_t*		pSlot = Claim( nPosition );
+		if ( pSlot == NULL )
+		{
+			break;
+		}
+
+		// the slot stays claimed while the reader uses it so no writer can reuse it
+		pReader( reinterpret_cast<const uint8_t*>( pSlot + 1 ), pSlot->_nLength, pSlot->_nTag, pContext );
+		Free( pSlot, nPosition );
+		nCount++;
+	}
+	return nCount;
+}
+
+/// <summary>
+/// Number of records waiting, only exact while no one is writing.
+/// </summary>
+uint32_t scTraceQueue::Count(void) const
+{
+	return scAtomicLoad( &_nWrite ) - scAtomicLoad( &_nRead );
+}
+
+/// <summary>
+/// Clear the counters.
+/// </summary>
+void scTraceQueue::ResetCounters(void)
+{
+	scAtomicStore( &_nWritten, 0 );
+	scAtomicStore( &_nDropped, 0 );
+	scAtomicStore( &_nWaits, 0 );
+}
+
+/// <summary>
+/// Claim the oldest record, or NULL if there is none.
+/// </summary>
+scTraceQueue::Slot_t* scTraceQueue::Claim( uint32_t& nPosition )
+{
+	nPosition = scAtomicLoad( &_nRead );
+
+	for(;;)
+	{
+		Slot_t*	pSlot = SlotAt( nPosition );
+		int32_t	nDiff = (int32_t)( scAtomicLoad( &pSlot->_nSequence ) - ( nPosition + 1 ) );
+
+		if ( nDiff == 0 )
+		{
+			if ( scAtomicCompareExchange( &_nRead, nPosition, nPosition + 1 ) )
+			{
+				return pSlot;
+			}
+		}
+		else if ( nDiff < 0 )
+		{
+			return NULL;
+		}
+		nPosition = scAtomicLoad( &_nRead );
+	}
+}
@@ -0,0 +1,300 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+//
+// File Name:		scTraceQueue.h
+// Created By:		Christopher Snyder
+// Creation Date:	19-Oct-2026
+// $Id: $
+//
+//==============================================================================
+//          UNCLASSIFIED
+//==============================================================================
+
+
+#if !defined(__SCTRACEQUEUE_H__INCLUDED_)
+#define __SCTRACEQUEUE_H__INCLUDED_
+
+#include "scTypes.h"
+#include "scAllocator.h"
+#include "scAtomic.h"
+
+namespace SharedCore
+{
+	/// <summary>
+	/// What a writer does when the queue is full.
+	/// </summary>
+	typedef enum
+	{
+		/// <summary>
+		/// The new record is discarded.
+		/// </summary>
+		scTraceDropNewest,
+
+		/// <summary>
+		/// The oldest record is discarded to make room.
+		/// </summary>
+		scTraceDropOldest,
+
+		/// <summary>
+		/// The writer waits for the reader. Never use from an interrupt.
+		/// </summary>
+		scTraceBlock
+	} scTracePolicy_t;
+
+	/// <summary>
+	/// Bounded lock-free queue of variable length records, used to take debug output
+	/// off the caller so Trace never waits for a slow path. Any number of tasks and
+	/// interrupts can write, one task drains. Every record occupies one fixed size
+	/// slot, a record longer than the slot is truncated. Based on the bounded queue by
+	/// Dmitry Vyukov where each slot carries a sequence number telling whether it is
+	/// free or filled for the current lap, so writers only contend on a single
+	/// compare-and-swap of the write position.
+	/// </summary>
+	class scTraceQueue
+	{
+	public:
+		/// <summary>
+		/// Called by a blocked writer while it waits, such as a task delay.
+		/// </summary>
+		typedef void (*Yield_t)( void );
+
+		/// <summary>
+		/// Called for each record drained from the queue with the tag it was written
+		/// with.
+		/// </summary>
+		typedef void (*Reader_t)( const uint8_t* pData, uint32_t nLength, uint16_t nTag, void* pContext );
+
+		/// <summary>
+		/// Construct the queue.
+		/// </summary>
+		/// <param name="nSlots">Number of records the queue holds, a power of two.
+		/// </param>
+		/// <param name="nSlotSize">Largest record in bytes, up to 65535.</param>
+		/// <param name="nPolicy">What to do when the queue is full.</param>
+		scTraceQueue( uint32_t nSlots, uint32_t nSlotSize, scTracePolicy_t nPolicy = scTraceDropNewest );
+
+		/// <summary>
+		/// Destructor.
+		/// </summary>
+		virtual ~scTraceQueue();
+
+		/// <summary>
+		/// Allocate the slots.
+		/// </summary>
+		/// <param name="allocator">Allocator used for the slots.</param>
+		uint32_t Initialize( scAllocator allocator );
+
+		/// <summary>
+		/// Set the function a blocked writer calls while waiting. Without it the writer
+		/// spins.
+		/// </summary>
+		void SetYield( Yield_t pYield )
+		{
+			_pYield = pYield;
+		}
+
+		/// <summary>
+		/// Change the overflow policy.
+		/// </summary>
+		void SetPolicy( scTracePolicy_t nPolicy )
+		{
+			_nPolicy = nPolicy;
+		}
+
+		/// <summary>
+		/// Obtain the overflow policy.
+		/// </summary>
+		scTracePolicy_t Policy(void) const
+		{
+			return _nPolicy;
+		}
+
+		/// <summary>
+		/// Claim a slot to build a record in place. Must be followed by Commit.
+		/// </summary>
+		/// <param name="nSize">Receives the number of bytes available in the slot.
+		/// </param>
+		/// <returns>The slot or NULL if the record has to be dropped.</returns>
+		uint8_t* Reserve( uint32_t& nSize );
+
+		/// <summary>
+		/// Hand a slot obtained from Reserve to the reader.
+		/// </summary>
+		/// <param name="pSlot">The slot.</param>
+		/// <param name="nLength">Number of bytes used.</param>
+		/// <param name="nTag">Passed to the reader with the record, such as the debug
+		/// label.</param>
+		void Commit( uint8_t* pSlot, uint32_t nLength, uint16_t nTag = 0 );
+
+		/// <summary>
+		/// Add a record.
+		/// </summary>
+		/// <returns>false if the record was dropped.</returns>
+		bool Push( const uint8_t* pData, uint32_t nLength, uint16_t nTag = 0 );
+
+		/// <summary>
+		/// Add a record made of several pieces.
+		/// </summary>
+		/// <returns>false if the record was dropped.</returns>
+		bool Push_v( const scIOSpan_t* pSpans, uint32_t nCount, uint16_t nTag = 0 );
+
+		/// <summary>
+		/// Pass the waiting records to the reader, oldest first. Only one task may
+		/// drain.
+		/// </summary>
+		/// <param name="pReader">Called for each record.</param>
+		/// <param name="pContext">Passed to the reader.</param>
+		/// <param name="nMax">Most records to drain.</param>
+		/// <returns>Number of records drained.</returns>
+		uint32_t Drain( Reader_t pReader, void* pContext, uint32_t nMax = 0xFFFFFFFF );
+
+		/// <summary>
+		/// Number of records waiting, only exact while no one is writing.
+		/// </summary>
+		uint32_t Count(void) const;
+
+		/// <summary>
+		/// Number of records added.
+		/// </summary>
+		uint32_t Written(void) const
+		{
+			return _nWritten;
+		}
+
+		/// <summary>
+		/// Number of records lost to overflow under either drop policy.
+		/// </summary>
+		uint32_t Dropped(void) const
+		{
+			return _nDropped;
+		}
+
+		/// <summary>
+		/// Number of times a writer had to wait under the block policy.
+		/// </summary>
+		uint32_t Waits(void) const
+		{
+			return _nWaits;
+		}
+
+		/// <summary>
+		/// Clear the counters.
+		/// </summary>
+		void ResetCounters(void);
+
+	private:
+		typedef struct
+		{
+			/// <summary>
+			/// Tells whether the slot is free or filled for the current lap.
+			/// </summary>
+			volatile uint32_t		_nSequence;
+
+			/// <summary>
+			/// Number of bytes in the record.
+			/// </summary>
+			uint16_t				_nLength;
+
+			/// <summary>
+			/// Tag given by the writer.
+			/// </summary>
+			uint16_t				_nTag;
+		} Slot_t;
+
+		/// <summary>
+		/// Locate a slot.
+		/// </summary>
+		Slot_t* SlotAt( uint32_t nPosition ) const
+		{
+			return reinterpret_cast<Slot_t*>( _pSlots + ( nPosition & _nMask ) * _nStride );
+		}
+
+		/// <summary>
+		/// Claim the oldest record, or NULL if there is none.
+		/// </summary>
+		Slot_t* Claim( uint32_t& nPosition );
+
+		/// <summary>
+		/// Return a claimed record's slot to the writers.
+		/// </summary>
+		void Free( Slot_t* pSlot, uint32_t nPosition )
+		{
+			scAtomicStore( &pSlot->_nSequence, nPosition + _nMask + 1 );
+		}
+
+		/// <summary>
+		/// Number of slots minus one.
+		/// </summary>
+		uint32_t					_nMask;
+
+		/// <summary>
+		/// Largest record.
+		/// </summary>
+		uint32_t					_nSlotSize;
+
+		/// <summary>
+		/// Distance between slots.
+		/// </summary>
+		uint32_t					_nStride;
+
+		/// <summary>
+		/// The slots.
+		/// </summary>
+		uint8_t*					_pSlots;
+
+		/// <summary>
+		/// Position of the next write.
+		/// </summary>
+		volatile uint32_t			_nWrite;
+
+		/// <summary>
+		/// Position of the next read.
+		/// </summary>
+		volatile uint32_t			_nRead;
+
+		/// <summary>
+		/// Overflow policy.
+		/// </summary>
+		scTracePolicy_t				_nPolicy;
+
+		/// <summary>
+		/// Called while waiting.
+		/// </summary>
+		Yield_t						_pYield;
+
+		/// <summary>
+		/// Counters.
+		/// </summary>
+		volatile uint32_t			_nWritten;
+		volatile uint32_t			_nDropped;
+		volatile uint32_t			_nWaits;
+
+		/// <summary>
+		/// Used for the slots.
+		/// </summary>
+		scAllocator					_Allocator;
+	};
+}
+
+#endif // !defined(__SCTRACEQUEUE_H__INCLUDED_)
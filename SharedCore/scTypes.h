@@ -122,4 +122,21 @@ typedef unsigned char bool_t;
 	typedef unsigned int UINT;
 #endif
 
+#ifdef __cplusplus
+namespace SharedCore
+{
+	/// <summary>
+	/// Describes one segment of a scatter-gather operation. Used where a block of data
+	/// is made up of several pieces that live in different places, such as a header,
+	/// a payload and a trailer, so they can be handled without first being copied into
+	/// one contiguous buffer.
+	/// </summary>
+	typedef struct
+	{
+		const uint8_t*		_pData;
+		uint32_t			_nLength;
+	} scIOSpan_t;
+};
+#endif
+
 #endif
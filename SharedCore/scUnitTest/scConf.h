@@ -4,4 +4,9 @@
 #define assert_param(X)	if ( !(X) ) { for(;;) ; }
 #endif
 
-#define SC_SUPPORTS_CRT_SECURITY
\ No newline at end of file
+#define SC_SUPPORTS_CRT_SECURITY
+
+#define SC_PROFILER_ENABLED	(1)
+#define SC_TIMELINE_ENABLED	(1)
+#define SC_METRICS_ENABLED	(1)
+#define SC_FACTORY_LATENCY_ENABLED	(1)
@@ -0,0 +1,174 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+#include "scConsole_test.h"
+#include "scQueueList.h"
+#include "scFSM.h"
+#include "scMutexNoOp.h"
+#include "scAllocator_Imp.h"
+#include "scDebugManager.h"
+#include "scDebugLabelManager.h"
+#include "scDebugLabelCodes.h"
+#include "scErrorCodes.h"
+
+using namespace SharedCore;
+
+static scAllocator_Imp* pAllocatorImp = new scAllocator_Imp();
+
+static const int g_Matrix[] =
+{
+	1,		0,
+	0,		0,
+};
+
+scConsole_test::scConsole_test()
+	: _pDriver(NULL)
+	, _pPath(NULL)
+	, _pConsole(NULL)
+{
+}
+
+scConsole_test::~scConsole_test()
+{
+}
+
+void scConsole_test::SetUp()
+{
+	scDebugManager*	pDm = scDebugManager::Instance();
+	_pDriver = new TypeDriver();
+	_pPath = new TextPath(17);
+	_pConsole = new scConsole( _pDriver );
+	pDm->Allocator( pAllocatorImp );
+	delete pDm->SetLabelManager( new scDebugLabelManager( 16, scDisabled ) );
+	pDm->LabelState( scDEBUGLABEL_INFO_MESSAGE, scEnabled );
+	pDm->Add( _pPath );
+	pDm->Enable();
+	pDm->SetTimestampOptions( scTRACE_TIMESTAMP_DELTA );
+}
+
+void scConsole_test::TearDown()
+{
+	scDebugManager*	pDm = scDebugManager::Instance();
+	pDm->SetTimestampOptions( scTRACE_TIMESTAMP_TEXT | scTRACE_TIMESTAMP_DELTA );
+	pDm->LabelState( scDisabled );
+	delete pDm->Remove( _pPath->PathId() );
+	delete _pConsole;
+}
+
+std::string scConsole_test::Run( const char* pLine )
+{
+	_pPath->_Text.clear();
+	_pDriver->Type( pLine );
+	_pConsole->Poll();
+	return _pPath->_Text;
+}
+
+void scConsole_test::ConsoleTest()
+{
+	uint32_t nValue;
+	EXPECT_TRUE( scConsole::ParseNumber( "42", nValue ) );
+	EXPECT_EQ( 42, nValue );
+	EXPECT_TRUE( scConsole::ParseNumber( "0x1F", nValue ) );
+	EXPECT_EQ( 0x1F, nValue );
+	EXPECT_FALSE( scConsole::ParseNumber( "4x", nValue ) );
+	EXPECT_FALSE( scConsole::ParseNumber( "0x", nValue ) );
+
+	// the built in commands, lines split over reads, backspace and blank lines
+	EXPECT_NE( std::string::npos, Run( "help\r\n" ).find( "labels - list the debug labels" ) );
+	EXPECT_EQ( "", Run( "he" ) );
+	EXPECT_NE( std::string::npos, Run( "lp\bp\n" ).find( "help - list the commands" ) );
+	EXPECT_EQ( "", Run( "  \t \n\n" ) );
+	EXPECT_EQ( "unknown command bogus, try help\n\r", Run( "bogus  1 2\n" ) );
+	EXPECT_EQ( "more than 8 words\n\r", Run( "help 1 2 3 4 5 6 7 8\n" ) );
+	std::string sLong( SC_CONSOLE_LINE + 1, 'x' );
+	EXPECT_EQ( "line longer than 80 characters\n\r", Run( ( sLong + "\n" ).c_str() ) );
+	EXPECT_NE( std::string::npos, Run( "help\n" ).find( "help - " ) );
+
+	// labels are listed and switched by number or group
+	scDebugManager* pDm = scDebugManager::Instance();
+	EXPECT_NE( std::string::npos, Run( "labels\n" ).find( "[2] " ) );
+	EXPECT_EQ( "3 Enabled\n\r", Run( "labels 3 on\n" ) );
+	EXPECT_EQ( scEnabled, pDm->LabelState( 3 ) );
+	EXPECT_EQ( "0x3 Disabled\n\r", Run( "labels 0x3 off\n" ) );
+	EXPECT_EQ( scDisabled, pDm->LabelState( 3 ) );
+	EXPECT_EQ( "no group nothing\n\r", Run( "labels nothing on\n" ) );
+	EXPECT_EQ( "usage: labels <label|group> on|off\n\r", Run( "labels 3\n" ) );
+
+	// allocator statistics
+	scAllocator_Imp	allocator;
+	void* pBlock = allocator.Allocate( 24 );
+	allocator.Destroy( pBlock );
+	pBlock = allocator.Allocate( 8 );
+	EXPECT_TRUE( _pConsole->AddAllocator( "alloc", &allocator ) );
+	EXPECT_FALSE( _pConsole->AddAllocator( "alloc", &allocator ) );
+	EXPECT_EQ( "alloc: 2 allocations, 1 releases, 0 failures, 32 bytes\n\r", Run( "alloc\n" ) );
+	allocator.Destroy( pBlock );
+
+	// queue depth
+	uint32_t		nItem = 0;
+	scQueueList		queue( 4, sizeof(nItem) );
+	queue.SendToBack( &nItem, 0 );
+	EXPECT_TRUE( _pConsole->AddQueue( "rxq", &queue ) );
+	EXPECT_EQ( "rxq: 1 waiting, 3 free\n\r", Run( "rxq\n" ) );
+
+	// device states
+	testDM*			pManager = new testDM();
+	pManager->Add( _pDriver );
+	EXPECT_TRUE( pManager->Device( 1 ) == NULL );
+	EXPECT_TRUE( _pConsole->AddDevices( pManager ) );
+	EXPECT_EQ( "1 devices\n\r[0x0100] Uninitialized, connected, error 0x00000000\n\r", Run( "devices\n" ) );
+
+	// state machine
+	scQueueList		inputs( 2, sizeof(int) );
+	scFSM			fsm( 2, 2, 1, g_Matrix, &inputs );
+	EXPECT_TRUE( _pConsole->AddFSM( "link", &fsm ) );
+	EXPECT_EQ( "link: state 1\n\r", Run( "link\n" ) );
+
+	// factory slots
+	scMutexNoOp			lock;
+	scAllocator			memManager( pAllocatorImp );
+	ConsoleFactory		factory( 2, 100 );
+	ASSERT_EQ( ERROR_SUCCESS, factory.Initialize( memManager, memManager, &lock ) );
+	ConsoleMessage*		pMessage = factory.Create( 20 );
+	EXPECT_TRUE( _pConsole->AddFactory( "msgs", &factory ) );
+	std::string sDump = Run( "msgs\n" );
+	EXPECT_EQ( 0u, sDump.find( "msgs: 1 in use, 1 available\n\r" ) );
+	EXPECT_NE( std::string::npos, sDump.find( "Records Dump" ) );
+	factory.Release( pMessage );
+
+#if SC_METRICS_ENABLED
+	EXPECT_NE( std::string::npos, Run( "metrics\n" ).find( "factory.creates: " ) );
+#endif
+
+	// the table is fixed
+	static const char* const names[SC_CONSOLE_COMMANDS] =
+	{
+		"s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7",
+		"s8", "s9", "s10", "s11", "s12", "s13", "s14", "s15"
+	};
+	uint32_t nAdded = 0;
+	while( nAdded < SC_CONSOLE_COMMANDS && _pConsole->AddFSM( names[nAdded], &fsm ) )
+	{
+		nAdded++;
+	}
+	EXPECT_GT( (uint32_t)SC_CONSOLE_COMMANDS, nAdded );
+	EXPECT_EQ( "s0: state 1\n\r", Run( "s0\n" ) );
+
+	// the manager owns the driver
+	delete pManager;
+}
@@ -0,0 +1,128 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+#pragma once
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"  // Brings in Google Mock.
+
+#include "scConsole.h"
+#include "scDebugPath.h"
+#include "scStandardMessage.h"
+#include "scMessageFactory.h"
+#include "scDeviceManager.h"
+#include "scRingBuffer.h"
+#include "HAL/scBufferedIODriver.h"
+#include <string>
+
+using namespace ::SharedCore;
+
+// Tests for the introspection console.
+class scConsole_test : public ::testing::Test
+{
+public:
+	void ConsoleTest();
+
+	class ConsoleMessage : public scStandardMessage<uint8_t>
+	{
+	public:
+		ConsoleMessage(const uint8_t* pBuffer = NULL, uint32_t nLength = 0)
+			: scStandardMessage<uint8_t>( pBuffer, nLength )
+		{
+		}
+
+		ConsoleMessage& operator=( const ConsoleMessage& source )
+		{
+			if ( this != &source )
+			{
+				this->_pBuffer = source._pBuffer;
+				this->_nLength = source._nLength;
+				this->_Header = source.Header();
+			}
+			return *this;
+		}
+	};
+
+	class ConsoleFactory : public scMessageFactory<ConsoleMessage>
+	{
+	public:
+		ConsoleFactory( uint16_t slots, uint32_t nBytes )
+			: scMessageFactory<ConsoleMessage>( slots, nBytes )
+		{
+		}
+	};
+
+	class testDM : public scDeviceManager
+	{
+	public:
+		testDM() : scDeviceManager() {}
+	};
+
+	/// <summary>
+	/// Serial port the test types the commands into.
+	/// </summary>
+	class TypeDriver : public HAL::scBufferIODriver
+	{
+	public:
+		TypeDriver() : HAL::scBufferIODriver( scDeviceDescriptor(0x0100) )
+		{
+			SetQueue( new scRingBuffer( 256, new uint8_t[256], NULL ), NULL );
+		}
+		virtual void TriggerSend(void)
+		{
+		}
+		void Type( const char* pText )
+		{
+			_pQueueIn->WriteStart();
+			_pQueueIn->WriteBlock( reinterpret_cast<const uint8_t*>(pText), (uint32_t)strlen( pText ) );
+		}
+	};
+
+	/// <summary>
+	/// Keeps the text of the answers.
+	/// </summary>
+	class TextPath : public scDebugPath
+	{
+	public:
+		TextPath( uint8_t id ) : scDebugPath(id), _Text() {}
+		void Capture( const uint8_t* pData, uint32_t nLength )
+		{
+			_Text.append( reinterpret_cast<const char*>(pData), nLength );
+		}
+
+		std::string			_Text;
+	};
+
+	/// <summary>
+	/// Type a line and return the answer.
+	/// </summary>
+	std::string Run( const char* pLine );
+
+protected:
+	scConsole_test();
+
+	virtual ~scConsole_test();
+
+	virtual void SetUp();
+
+	virtual void TearDown();
+
+	TypeDriver*				_pDriver;
+	TextPath*				_pPath;
+	scConsole*				_pConsole;
+};
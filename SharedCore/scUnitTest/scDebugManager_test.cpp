@@ -20,6 +20,16 @@
 #include "gmock/gmock.h"
 #include "scDebugManager_test.h"
 #include "scAllocator_Imp.h"
+#include "scDebugLabelCodes.h"
+#include "scErrorCodes.h"
+
+// Remove the debug level from this file to check the macros compile it out.
+#define SC_TRACE_MIN_LEVEL		(1)
+#include "scTrace.h"
+#include "scFormat.h"
+#include <time.h>
+#include <thread>
+#include <stdio.h>
 
 using ::testing::AtLeast;
 using ::testing::Exactly;
@@ -28,6 +38,86 @@ using namespace SharedCore;
 
 static scAllocator_Imp* pAllocatorImp = new scAllocator_Imp();
 
+#define TEST_TRACE_FORMATS(X) \
+	X( scDebugManager_test::fmt_Overrun, "UART %u overrun, %u bytes lost\n\r" ) \
+	X( scDebugManager_test::fmt_State, "State %u -> %u\n\r" ) \
+	X( scDebugManager_test::fmt_Hello, "Hello\n\r" )
+
+static const scTraceFormat_t g_TestFormats[] = { TEST_TRACE_FORMATS( scTRACE_FORMAT_ENTRY ) };
+
+uint32_t scDebugManager_test::s_nEvaluated = 0;
+scDebugManager_test::PacedPath* scDebugManager_test::s_pPaced = NULL;
+uint32_t scDebugManager_test::s_nYields = 0;
+uint32_t scDebugManager_test::s_nNow = 0;
+uint32_t scDebugManager_test::s_nCounter = 0;
+
+void scDebugManager_test::Yield( void )
+{
+	s_nYields++;
+	s_pPaced->_nSpace += 50;
+}
+
+scDebugManager_test::FlashBlocks::FlashBlocks()
+	: HAL::scBlockMemoryIF( scDeviceDescriptor(0x0200) )
+	, _nWrites(0)
+	, _nErases(0)
+	, _nNotErased(0)
+{
+	memset( _Memory, 0xFF, sizeof(_Memory) );
+}
+
+uint32_t scDebugManager_test::FlashBlocks::Read(uint8_t* pData, uint32_t nDataLength, uint32_t nStartAddress, uint32_t nBlockCount)
+{
+	EXPECT_LE( nBlockCount * 64, nDataLength );
+	EXPECT_LE( nStartAddress + nBlockCount, 32 );
+	memcpy( pData, &_Memory[nStartAddress * 64], nBlockCount * 64 );
+	return ERROR_SUCCESS;
+}
+
+uint32_t scDebugManager_test::FlashBlocks::Write(const uint8_t* pData, uint32_t nStartAddress, uint32_t nBlockCount)
+{
+	EXPECT_LE( nStartAddress + nBlockCount, 32 );
+	for( uint32_t i=0; i < nBlockCount * 64; ++i )
+	{
+		if ( _Memory[nStartAddress * 64 + i] != 0xFF )
+		{
+			_nNotErased++;
+		}
+		_Memory[nStartAddress * 64 + i] &= pData[i];
+	}
+	_nWrites++;
+	return ERROR_SUCCESS;
+}
+
+uint32_t scDebugManager_test::FlashBlocks::BulkErase( uint32_t nStartSector, uint32_t nCount, bool bWait )
+{
+	EXPECT_LE( nStartSector + nCount, 32 );
+	memset( &_Memory[nStartSector * 64], 0xFF, nCount * 64 );
+	_nErases++;
+	return ERROR_SUCCESS;
+}
+
+uint32_t scDebugManager_test::Evaluate( uint32_t nValue )
+{
+	s_nEvaluated++;
+	return nValue;
+}
+
+uint32_t scDebugManager_test::Timestamp( void )
+{
+	return 1234;
+}
+
+uint32_t scDebugManager_test::Now( void )
+{
+	return s_nNow;
+}
+
+uint32_t scDebugManager_test::Counter( void )
+{
+	return s_nCounter;
+}
+
 scDebugManager_test::scDebugManager_test()
 {
 }
@@ -38,10 +128,14 @@ scDebugManager_test::~scDebugManager_test()
 
 void scDebugManager_test::SetUp()
 {
+	// the tests compare trace text exactly, the timestamp test turns the stamp on
+	scDebugManager::Instance()->SetTimestampOptions( scTRACE_TIMESTAMP_DELTA );
 }
 
 void scDebugManager_test::TearDown()
 {
+	scDebugManager::Instance()->SetTimestampOptions( scTRACE_TIMESTAMP_TEXT | scTRACE_TIMESTAMP_DELTA );
+
 	// Do this to avoid tripping tests and to allow debug manager to work 
 	// in the rest of the testing.
 	scDebugManager::Instance()->Add( new MyPathSystem(1) );
@@ -144,3 +238,923 @@ void scDebugManager_test::SimplePathTest()
 
 	delete []pMemory;
 }
+
+void scDebugManager_test::BinaryTraceTest()
+{
+	scDebugManager*		pDm = scDebugManager::Instance();
+	CapturePath*		pPath = new CapturePath(5);
+	scTraceDecoder		decoder( g_TestFormats, 3 );
+	char				sText[128];
+	uint32_t			nText;
+
+	pDm->Allocator( pAllocatorImp );
+	delete pDm->SetLabelManager( new scDebugLabelManager() );
+	pDm->LabelState( scDEBUGLABEL_INFO_MESSAGE, scEnabled );
+	pDm->Add( pPath );
+	pDm->Enable();
+	pDm->SetTimestampSource( &Timestamp );
+
+	// only the ID and the arguments go out
+	pDm->TraceBinary( scDEBUGLABEL_INFO_MESSAGE, fmt_Overrun, 2, 17 );
+	ASSERT_EQ( sizeof(scTraceRecord_t) + 8, pPath->_Data.size() );
+	EXPECT_EQ( scTRACE_RECORD_SYNC, pPath->_Data[0] );
+
+	EXPECT_EQ( pPath->_Data.size(), decoder.Decode( &pPath->_Data[0], (uint32_t)pPath->_Data.size(), sText, sizeof(sText), nText ) );
+	EXPECT_STREQ( "UART 2 overrun, 17 bytes lost\n\r", sText );
+	EXPECT_EQ( strlen( sText ), nText );
+
+	// an incomplete record waits for more data
+	EXPECT_EQ( 0, decoder.Decode( &pPath->_Data[0], 12, sText, sizeof(sText), nText ) );
+
+	// disabled labels produce nothing
+	pDm->TraceBinary( scDEBUGLABEL_DEBUG_MESSAGE, fmt_Hello );
+	EXPECT_EQ( sizeof(scTraceRecord_t) + 8, pPath->_Data.size() );
+
+	// the decoder finds the records in a stream with damaged bytes
+	pPath->_Data.insert( pPath->_Data.begin(), 0x33 );
+	pDm->TraceBinary( scDEBUGLABEL_INFO_MESSAGE, fmt_State, 1, 2 );
+	pDm->TraceBinary( scDEBUGLABEL_INFO_MESSAGE, fmt_Hello );
+	pDm->TraceBinary( scDEBUGLABEL_INFO_MESSAGE, 99, 0xAB );
+
+	std::string	sOutput;
+	uint32_t	nOffset = 0;
+	while( nOffset < pPath->_Data.size() )
+	{
+		uint32_t nUsed = decoder.Decode( &pPath->_Data[nOffset], (uint32_t)pPath->_Data.size() - nOffset, sText, sizeof(sText), nText );
+		ASSERT_NE( 0, nUsed );
+		sOutput.append( sText, nText );
+		nOffset += nUsed;
+	}
+	EXPECT_EQ( "UART 2 overrun, 17 bytes lost\n\rState 1 -> 2\n\rHello\n\r<format 99> 000000ab 00000000 00000000 00000000\n\r", sOutput );
+
+	// the decoder can add the timestamp and label
+	scTraceDecoder		prefixed( g_TestFormats, 3, true );
+	scTraceRecord_t		record = { scTRACE_RECORD_SYNC, 0, scDEBUGLABEL_INFO_MESSAGE, fmt_Hello, 1234 };
+	prefixed.Format( record, NULL, sText, sizeof(sText) );
+	EXPECT_STREQ( "      1234 [2] Hello\n\r", sText );
+
+	// with a decoder assigned the target produces the text itself
+	pPath->_Data.clear();
+	pDm->SetTraceDecoder( &decoder );
+	pDm->TraceBinary( scDEBUGLABEL_INFO_MESSAGE, fmt_State, 3, 4 );
+	EXPECT_EQ( "State 3 -> 4\n\r", std::string( pPath->_Data.begin(), pPath->_Data.end() ) );
+
+	// and decodes straight into the queue slot when there is a queue
+	scTraceQueue		queue( 4, 64 );
+	ASSERT_EQ( ERROR_SUCCESS, queue.Initialize( pAllocatorImp ) );
+	pPath->_Data.clear();
+	pDm->SetTraceQueue( &queue );
+	pDm->TraceBinary( scDEBUGLABEL_INFO_MESSAGE, fmt_State, 5, 6 );
+	EXPECT_EQ( 0, pPath->_Data.size() );
+	EXPECT_EQ( 1, pDm->Drain( 4 ) );
+	EXPECT_EQ( "State 5 -> 6\n\r", std::string( pPath->_Data.begin(), pPath->_Data.end() ) );
+	pDm->SetTraceQueue( NULL );
+	pDm->SetTraceDecoder( NULL );
+
+	// the binary form of the same message is smaller
+	const uint32_t	nLoops = 100;
+	pPath->_bKeep = false;
+	pPath->_nBytes = 0;
+	for( uint32_t i=0; i < nLoops; ++i )
+	{
+		pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "UART %u overrun, %u bytes lost\n\r", i, 17 );
+	}
+	uint32_t nText_Bytes = pPath->_nBytes;
+
+	pPath->_nBytes = 0;
+	for( uint32_t i=0; i < nLoops; ++i )
+	{
+		pDm->TraceBinary( scDEBUGLABEL_INFO_MESSAGE, fmt_Overrun, i, 17 );
+	}
+	EXPECT_LT( pPath->_nBytes, nText_Bytes );
+
+	pDm->SetTimestampSource( NULL );
+	pDm->LabelState( scDEBUGLABEL_INFO_MESSAGE, scDisabled );
+	delete pDm->Remove( pPath->PathId() );
+}
+
+void scDebugManager_test::AsyncTraceTest()
+{
+	scDebugManager*		pDm = scDebugManager::Instance();
+	CapturePath*		pPath = new CapturePath(6);
+	scTraceQueue		queue( 4, 32 );
+
+	ASSERT_EQ( ERROR_SUCCESS, queue.Initialize( pAllocatorImp ) );
+	pDm->Allocator( pAllocatorImp );
+	delete pDm->SetLabelManager( new scDebugLabelManager() );
+	pDm->LabelState( scDEBUGLABEL_INFO_MESSAGE, scEnabled );
+	pDm->Add( pPath );
+	pDm->Enable();
+	pDm->SetTraceQueue( &queue );
+
+	// nothing reaches the path until the queue is drained
+	pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "count %d\n", 1 );
+	pDm->Trace_Info( scDEBUGLABEL_INFO_MESSAGE, "info\n" );
+	pDm->TraceBinary( scDEBUGLABEL_INFO_MESSAGE, fmt_Hello );
+	pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "this line is longer than one slot of the queue\n" );
+	pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "lost\n" );
+	EXPECT_EQ( 0, pPath->_Data.size() );
+	EXPECT_EQ( 4, queue.Count() );
+	EXPECT_EQ( 1, queue.Dropped() );
+
+	EXPECT_EQ( 4, pDm->Drain() );
+	std::string sText( pPath->_Data.begin(), pPath->_Data.end() );
+	EXPECT_EQ( 0, sText.find( "count 1\ninfo\n" ) );
+	EXPECT_EQ( sizeof(scTraceRecord_t), sText.size() - 13 - 31 );
+	EXPECT_EQ( "this line is longer than one sl", sText.substr( sText.size() - 31 ) );
+	EXPECT_EQ( 0, pDm->Drain() );
+
+	pDm->SetTraceQueue( NULL );
+	pDm->LabelState( scDEBUGLABEL_INFO_MESSAGE, scDisabled );
+	delete pDm->Remove( pPath->PathId() );
+}
+
+void scDebugManager_test::TraceMacroTest()
+{
+	scDebugManager*		pDm = scDebugManager::Instance();
+	CapturePath*		pPath = new CapturePath(7);
+	const uint16_t		nProductLabel = 12;
+
+	pDm->Allocator( pAllocatorImp );
+	delete pDm->SetLabelManager( new scDebugLabelManager( 16, scDisabled ) );
+	pDm->Add( pPath );
+	pDm->Enable();
+	s_nEvaluated = 0;
+
+	// disabled labels do not evaluate the arguments
+	scTRACE_INFO( scDEBUGLABEL_INFO_MESSAGE, "value %u\n", Evaluate( 1 ) );
+	scTRACE_BINARY_INFO( nProductLabel, fmt_Overrun, Evaluate( 1 ), 2 );
+	EXPECT_EQ( 0, s_nEvaluated );
+	EXPECT_EQ( 0, pPath->_Data.size() );
+	EXPECT_FALSE( scDebugManager::IsEnabled( nProductLabel ) );
+
+	// enabled through the manager, standard and product labels behave the same
+	pDm->LabelState( scDEBUGLABEL_INFO_MESSAGE, scEnabled );
+	pDm->LabelState( nProductLabel, scEnabled );
+	EXPECT_TRUE( scDebugManager::IsEnabled( nProductLabel ) );
+	scTRACE_INFO( scDEBUGLABEL_INFO_MESSAGE, "value %u\n", Evaluate( 1 ) );
+	scTRACE_WARNING( nProductLabel, "value %u\n", Evaluate( 2 ) );
+	EXPECT_EQ( 2, s_nEvaluated );
+	EXPECT_EQ( "value 1\nvalue 2\n", std::string( pPath->_Data.begin(), pPath->_Data.end() ) );
+
+	// below the compile time level nothing is left, even with the label enabled
+	pPath->_Data.clear();
+	pDm->LabelState( scDEBUGLABEL_DEBUG_MESSAGE, scEnabled );
+	scTRACE_DEBUG( scDEBUGLABEL_DEBUG_MESSAGE, "value %u\n", Evaluate( 3 ) );
+	scTRACE_BINARY_DEBUG( scDEBUGLABEL_DEBUG_MESSAGE, fmt_Hello );
+	EXPECT_EQ( 2, s_nEvaluated );
+	EXPECT_EQ( 0, pPath->_Data.size() );
+
+	// disabling the manager clears every label
+	pDm->Disable();
+	EXPECT_FALSE( scDebugManager::IsEnabled( scDEBUGLABEL_INFO_MESSAGE ) );
+	scTRACE_ERROR( scDEBUGLABEL_INFO_MESSAGE, "value %u\n", Evaluate( 4 ) );
+	EXPECT_EQ( 2, s_nEvaluated );
+	pDm->Enable();
+	EXPECT_TRUE( scDebugManager::IsEnabled( scDEBUGLABEL_INFO_MESSAGE ) );
+
+	// labels past the inline bits fall back to the full check in Trace
+	EXPECT_TRUE( scDebugManager::IsEnabled( SC_TRACE_INLINE_LABELS ) );
+	scTRACE_ERROR( SC_TRACE_INLINE_LABELS, "value %u\n", Evaluate( 5 ) );
+	EXPECT_EQ( 0, pPath->_Data.size() );
+
+	pDm->LabelState( scDisabled );
+	delete pDm->Remove( pPath->PathId() );
+}
+
+void scDebugManager_test::LabelGroupTest()
+{
+	scDebugManager*			pDm = scDebugManager::Instance();
+	CapturePath*			pUart = new CapturePath(8);
+	CapturePath*			pRecorder = new CapturePath(9);
+	scDebugLabelManager*	pLabels = new scDebugLabelManager( 2000, scDisabled );
+	const uint16_t			comms[] = { 5, 1500, 1999 };
+	scTraceQueue			queue( 4, 32 );
+
+	const scLabelMask*		pComms = pLabels->AddGroup( "comms", comms, 3 );
+	ASSERT_TRUE( pComms != NULL );
+	EXPECT_EQ( pComms, pLabels->Group( "comms" ) );
+	EXPECT_TRUE( pLabels->Group( "power" ) == NULL );
+	EXPECT_EQ( 3, pComms->Count() );
+
+	pDm->Allocator( pAllocatorImp );
+	delete pDm->SetLabelManager( pLabels );
+	pDm->Add( pUart );
+	pDm->Add( pRecorder );
+	pDm->Enable();
+
+	// the whole group is switched at once, including labels far past the first word
+	EXPECT_FALSE( pDm->GroupState( "power", scEnabled ) );
+	EXPECT_TRUE( pDm->GroupState( "comms", scEnabled ) );
+	EXPECT_EQ( scEnabled, pDm->LabelState( 1500 ) );
+	EXPECT_EQ( scDisabled, pDm->LabelState( 1501 ) );
+	EXPECT_TRUE( scDebugManager::IsEnabled( 5 ) );
+	EXPECT_EQ( scDisabled, pDm->LabelState( 2000 ) );
+
+	// the uart only takes errors while the recorder takes everything
+	pUart->LabelState( scDisabled );
+	pUart->LabelState( scDEBUGLABEL_ERROR_MESSAGE, scEnabled );
+	pDm->LabelState( scDEBUGLABEL_ERROR_MESSAGE, scEnabled );
+	pDm->Trace( 1999, "a" );
+	pDm->Trace_Info( scDEBUGLABEL_ERROR_MESSAGE, "b" );
+	pDm->Trace( 1998, "c" );
+	EXPECT_EQ( "b", std::string( pUart->_Data.begin(), pUart->_Data.end() ) );
+	EXPECT_EQ( "ab", std::string( pRecorder->_Data.begin(), pRecorder->_Data.end() ) );
+
+	// the label goes through the queue so the paths filter the same way
+	ASSERT_EQ( ERROR_SUCCESS, queue.Initialize( pAllocatorImp ) );
+	pDm->SetTraceQueue( &queue );
+	pDm->Trace( 5, "c" );
+	pDm->Trace( scDEBUGLABEL_ERROR_MESSAGE, "d" );
+	EXPECT_EQ( 2, pDm->Drain() );
+	EXPECT_EQ( "bd", std::string( pUart->_Data.begin(), pUart->_Data.end() ) );
+	EXPECT_EQ( "abcd", std::string( pRecorder->_Data.begin(), pRecorder->_Data.end() ) );
+	pDm->SetTraceQueue( NULL );
+
+	// a path can take a group too
+	pUart->LabelMask( *pComms, scEnabled );
+	EXPECT_TRUE( pUart->Accepts( 1999 ) );
+	EXPECT_FALSE( pUart->Accepts( 1998 ) );
+	pDm->Trace( 1500, "e" );
+	EXPECT_EQ( "bde", std::string( pUart->_Data.begin(), pUart->_Data.end() ) );
+
+	// the mask was sized from the label manager when the path was added, it never
+	// grows while in use so a label past the manager follows the rest
+	pUart->LabelState( 2500, scEnabled );
+	EXPECT_FALSE( pUart->Accepts( 2500 ) );
+	EXPECT_TRUE( pRecorder->Accepts( 2500 ) );
+
+	EXPECT_TRUE( pDm->GroupState( "comms", scDisabled ) );
+	EXPECT_FALSE( scDebugManager::IsEnabled( 5 ) );
+	pDm->Trace( 1500, "f" );
+	EXPECT_EQ( "abcde", std::string( pRecorder->_Data.begin(), pRecorder->_Data.end() ) );
+
+	pDm->LabelState( scDisabled );
+	delete pDm->Remove( pUart->PathId() );
+	delete pDm->Remove( pRecorder->PathId() );
+}
+
+void scDebugManager_test::DevicePathTest()
+{
+	scDebugManager*			pDm = scDebugManager::Instance();
+	DevicePipe				pipe( 32 );
+	scDebugPathDevice*		pDevice = new scDebugPathDevice( 10, &pipe );
+	CapturePath*			pPath = new CapturePath( 11 );
+
+	pDm->Allocator( pAllocatorImp );
+	delete pDm->SetLabelManager( new scDebugLabelManager( 16, scDisabled ) );
+	pDm->LabelState( scDEBUGLABEL_INFO_MESSAGE, scEnabled );
+	pDm->Add( pDevice );
+	pDm->Add( pPath );
+	pDm->Enable();
+
+	// the device formats into its queue, the other path gets the text as before
+	pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "count %u %s\n", 42, "ok" );
+	EXPECT_EQ( "count 42 ok\n", pipe._Sent );
+	EXPECT_EQ( "count 42 ok\n", std::string( pPath->_Data.begin(), pPath->_Data.end() ) );
+	EXPECT_EQ( 1, pipe._nTriggers );
+
+	// the queue wraps between lines without a partial line reaching the device
+	pipe._Sent.clear();
+	for( int i=0; i < 10; ++i )
+	{
+		pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "line %02d of %s\n", i, "ten" );
+	}
+	EXPECT_EQ( 10 * 15, pipe._Sent.size() );
+	EXPECT_EQ( "line 09 of ten\n", pipe._Sent.substr( 9 * 15 ) );
+	EXPECT_FALSE( pipe.GetOverflow() );
+
+	// a line longer than the free space is cut and the overflow flagged
+	pipe._Sent.clear();
+	pipe._bHold = true;
+	pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "%s %s\n", "this line is longer than", "the device queue" );
+	pipe._bHold = false;
+	pipe.TriggerSend();
+	EXPECT_EQ( "this line is longer than the dev", pipe._Sent );
+	EXPECT_TRUE( pipe.GetOverflow() );
+
+	pDm->LabelState( scDisabled );
+	delete pDm->Remove( pDevice->PathId() );
+	delete pDm->Remove( pPath->PathId() );
+}
+
+void scDebugManager_test::PrintArrayTest()
+{
+	scDebugManager*			pDm = scDebugManager::Instance();
+	PacedPath*				pPath = new PacedPath( 12, 0xFFFFFFFF );
+	uint8_t					packet[4096];
+
+	for( uint32_t i=0; i < sizeof(packet); ++i )
+	{
+		packet[i] = (uint8_t)( i * 7 );
+	}
+	packet[1] = 'A';
+	packet[2] = '%';
+
+	pDm->Allocator( pAllocatorImp );
+	delete pDm->SetLabelManager( new scDebugLabelManager( 16, scDisabled ) );
+	pDm->LabelState( scDEBUGLABEL_INFO_MESSAGE, scEnabled );
+	pDm->Add( pPath );
+	pDm->Enable();
+
+	// the layout is unchanged, a short last row is padded
+	pDm->PrintArray( scDEBUGLABEL_INFO_MESSAGE, packet, 18 );
+	EXPECT_EQ( "0x00 00 41 25 15 1c 23 2a 31 38 3f 46 4d 54 5b 62 69 [.A%..#*18?FMT[bi]\r\n"
+		"0x01 70 77                                           [pw              ]\r\n", pPath->_Data );
+
+	// a large dump waits for room instead of overrunning the path
+	pPath->_Data.clear();
+	pPath->_nSpace = 200;
+	s_pPaced = pPath;
+	s_nYields = 0;
+	pDm->SetYieldFunction( &Yield );
+	pDm->PrintArray( scDEBUGLABEL_INFO_MESSAGE, packet, sizeof(packet) );
+	EXPECT_EQ( 256 * 73, pPath->_Data.size() );
+	EXPECT_EQ( 0, pPath->_nOverrun );
+	EXPECT_LT( 0, s_nYields );
+	EXPECT_EQ( "0xff ", pPath->_Data.substr( 255 * 73, 5 ) );
+
+	// without a yield function the rows go straight out
+	pPath->_Data.clear();
+	pPath->_nSpace = 0xFFFFFFFF;
+	pDm->SetYieldFunction( NULL );
+	s_nYields = 0;
+	pDm->PrintArray( scDEBUGLABEL_INFO_MESSAGE, packet, 32 );
+	EXPECT_EQ( 2 * 73, pPath->_Data.size() );
+	EXPECT_EQ( 0, s_nYields );
+
+	pDm->LabelState( scDisabled );
+	delete pDm->Remove( pPath->PathId() );
+}
+
+void scDebugManager_test::RecorderTest()
+{
+	scDebugManager*			pDm = scDebugManager::Instance();
+	scDebugPathRecorder*	pRecorder = new scDebugPathRecorder( 13, 256 );
+	PacedPath				uart( 14, 40 );
+	FlashBlocks				flash;
+	std::string				expected;
+	uint8_t					content[512];
+
+	EXPECT_EQ( ERROR_SUCCESS, pRecorder->Initialize( pAllocatorImp ) );
+	pDm->Allocator( pAllocatorImp );
+	delete pDm->SetLabelManager( new scDebugLabelManager( 16, scDisabled ) );
+	pDm->LabelState( scDEBUGLABEL_INFO_MESSAGE, scEnabled );
+	pDm->Add( pRecorder );
+	pDm->Enable();
+
+	// the recorder keeps the newest 256 bytes
+	pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "boot\n" );
+	EXPECT_EQ( 5, pRecorder->Read( content, sizeof(content) ) );
+	EXPECT_EQ( "boot\n", std::string( (char*)content, 5 ) );
+	expected = "boot\n";
+	for( int i=0; i < 100; ++i )
+	{
+		char sLine[16];
+		scFormat::Format( sLine, sizeof(sLine), "event %03d\n", i );
+		pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "event %03d\n", i );
+		expected += sLine;
+	}
+	expected = expected.substr( expected.size() - 256 );
+	EXPECT_EQ( 256, pRecorder->Length() );
+	EXPECT_EQ( 256, pRecorder->Read( content, sizeof(content) ) );
+	EXPECT_EQ( expected, std::string( (char*)content, 256 ) );
+
+	// the newest bytes are read when the destination is small
+	EXPECT_EQ( 10, pRecorder->Read( content, 10 ) );
+	EXPECT_EQ( "event 099\n", std::string( (char*)content, 10 ) );
+
+	// once frozen nothing changes
+	pRecorder->Freeze();
+	pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "after the fault\n" );
+	EXPECT_EQ( 256, pRecorder->Read( content, sizeof(content) ) );
+	EXPECT_EQ( expected, std::string( (char*)content, 256 ) );
+
+	// the dump waits for the uart to make room
+	s_pPaced = &uart;
+	s_nYields = 0;
+	EXPECT_EQ( 256, pRecorder->Dump( &uart, &Yield ) );
+	EXPECT_EQ( expected, uart._Data );
+	EXPECT_EQ( 0, uart._nOverrun );
+	EXPECT_LT( 0, s_nYields );
+
+	// the image in flash starts with the header, the oldest bytes made room for it
+	EXPECT_EQ( ERROR_SUCCESS, pRecorder->Dump( &flash, 4, 8 ) );
+	scRecorderHeader_t header;
+	memcpy( &header, &flash._Memory[4 * 64], sizeof(header) );
+	EXPECT_EQ( scRECORDER_MAGIC, header._nMagic );
+	EXPECT_EQ( 256 - sizeof(header), header._nLength );
+	EXPECT_EQ( header._nMagic ^ header._nLength ^ header._nPosition, header._nCheck );
+	EXPECT_EQ( expected.substr( sizeof(header) ), std::string( (char*)&flash._Memory[4 * 64 + sizeof(header)], header._nLength ) );
+	EXPECT_EQ( 1, flash._nErases );
+	EXPECT_EQ( 0, flash._nNotErased );
+
+	// the recorder still holds the same output in order
+	EXPECT_EQ( 240, pRecorder->Read( content, sizeof(content) ) );
+	EXPECT_EQ( expected.substr( sizeof(header) ), std::string( (char*)content, 240 ) );
+
+	// a small area keeps the newest output, and an unfilled block is padded
+	pRecorder->Resume();
+	EXPECT_EQ( 0, pRecorder->Length() );
+	pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "%s\n", "after the restart" );
+	EXPECT_EQ( ERROR_SUCCESS, pRecorder->Dump( &flash, 20, 1 ) );
+	memcpy( &header, &flash._Memory[20 * 64], sizeof(header) );
+	EXPECT_EQ( 18, header._nLength );
+	EXPECT_EQ( "after the restart\n", std::string( (char*)&flash._Memory[20 * 64 + sizeof(header)], 18 ) );
+	EXPECT_EQ( 0xFF, flash._Memory[21 * 64 - 1] );
+	EXPECT_TRUE( pRecorder->Frozen() );
+	pRecorder->Resume( false );
+	EXPECT_EQ( 18, pRecorder->Length() );
+
+	pDm->LabelState( scDisabled );
+	delete pDm->Remove( pRecorder->PathId() );
+}
+
+void scDebugManager_test::BlockPathTest()
+{
+	scDebugManager*			pDm = scDebugManager::Instance();
+	FlashBlocks				flash;
+	scDebugPathBlock*		pPath = new scDebugPathBlock( 15, &flash, 8, 16, 2, 1 );
+	std::string				expected;
+	uint8_t					content[2048];
+	uint32_t				nLength = 0;
+	int						nRecord = 0;
+
+	// a new area only has the unit ahead erased
+	EXPECT_EQ( ERROR_SUCCESS, pPath->Initialize( pAllocatorImp, NULL ) );
+	EXPECT_EQ( 1, flash._nErases );
+	EXPECT_EQ( 0, pPath->CurrentBlock() );
+
+	pDm->Allocator( pAllocatorImp );
+	delete pDm->SetLabelManager( new scDebugLabelManager( 16, scDisabled ) );
+	pDm->LabelState( scDEBUGLABEL_INFO_MESSAGE, scEnabled );
+	pDm->Add( pPath );
+	pDm->Enable();
+
+	// records of 11 bytes in blocks of 48, only whole blocks are written
+	for( ; nRecord < 20; ++nRecord )
+	{
+		char sLine[16];
+		scFormat::Format( sLine, sizeof(sLine), "record %03d\n", nRecord );
+		pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "record %03d\n", nRecord );
+		expected += sLine;
+	}
+	EXPECT_EQ( 4, flash._nWrites );
+	EXPECT_EQ( 0, flash._nNotErased );
+	EXPECT_EQ( 3, flash._nErases );
+
+	// reading writes the staged block and returns the whole log
+	EXPECT_EQ( ERROR_SUCCESS, pPath->ReadNewest( content, sizeof(content), nLength ) );
+	EXPECT_EQ( expected, std::string( (char*)content, nLength ) );
+	EXPECT_EQ( 5, pPath->CurrentBlock() );
+
+	// after a restart the log is found and continued
+	delete pDm->Remove( pPath->PathId() );
+	pPath = new scDebugPathBlock( 15, &flash, 8, 16, 2, 1 );
+	EXPECT_EQ( ERROR_SUCCESS, pPath->Initialize( pAllocatorImp, NULL ) );
+	EXPECT_EQ( 5, pPath->CurrentBlock() );
+	EXPECT_GE( 5, pPath->Probes() );
+	pDm->Add( pPath );
+
+	// fill the area several times over, the oldest blocks are erased to make room
+	for( ; nRecord < 300; ++nRecord )
+	{
+		char sLine[16];
+		scFormat::Format( sLine, sizeof(sLine), "record %03d\n", nRecord );
+		pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "record %03d\n", nRecord );
+		expected += sLine;
+	}
+	EXPECT_EQ( 0, flash._nNotErased );
+
+	// the newest output starts with a whole record and ends with the last one
+	EXPECT_EQ( ERROR_SUCCESS, pPath->ReadNewest( content, sizeof(content), nLength ) );
+	std::string newest( (char*)content, nLength );
+	EXPECT_LT( 12 * 48, nLength );
+	EXPECT_EQ( "record ", newest.substr( 0, 7 ) );
+	EXPECT_EQ( expected.substr( expected.size() - nLength ), newest );
+
+	// a small buffer gets the newest whole blocks
+	EXPECT_EQ( ERROR_SUCCESS, pPath->ReadNewest( content, 100, nLength ) );
+	EXPECT_GE( 100, nLength );
+	EXPECT_LT( 0, nLength );
+	EXPECT_EQ( expected.substr( expected.size() - nLength ), std::string( (char*)content, nLength ) );
+
+	// the search after wrapping reads only a few headers
+	uint32_t nCurrent = pPath->CurrentBlock();
+	delete pDm->Remove( pPath->PathId() );
+	pPath = new scDebugPathBlock( 15, &flash, 8, 16, 2, 1 );
+	EXPECT_EQ( ERROR_SUCCESS, pPath->Initialize( pAllocatorImp, NULL ) );
+	EXPECT_EQ( nCurrent, pPath->CurrentBlock() );
+	EXPECT_GE( 7, pPath->Probes() );
+	EXPECT_EQ( ERROR_SUCCESS, pPath->ReadNewest( content, sizeof(content), nLength ) );
+	EXPECT_EQ( newest, std::string( (char*)content, nLength ) );
+
+	pDm->LabelState( scDisabled );
+	delete pPath;
+}
+
+void scDebugManager_test::TimestampTest()
+{
+	// the host clock runs forward in nanoseconds
+	EXPECT_EQ( 1000000000ULL, scHiResClock::Frequency() );
+	uint64_t nStartMicro = scHiResClock::Microseconds();
+	uint64_t nStart = scHiResClock::Ticks();
+	while( scHiResClock::Ticks() - nStart < 2000000 )
+	{
+	}
+	EXPECT_GE( scHiResClock::Microseconds() - nStartMicro, 2000 );
+	EXPECT_EQ( 1500000ULL, scHiResClock::ToMicroseconds( 1500000000ULL ) );
+
+	// a 32 bit counter, as on a target, is extended past its wrap
+	s_nCounter = 0xFFFFFF00;
+	scHiResClock::SetCounter( &Counter, 48000000 );
+	EXPECT_EQ( 48000000ULL, scHiResClock::Frequency() );
+	EXPECT_EQ( 0xFFFFFF00ULL, scHiResClock::Ticks() );
+	s_nCounter = 0x100;
+	EXPECT_EQ( 0x100000100ULL, scHiResClock::Ticks() );
+	EXPECT_EQ( 0x100000100ULL / 48, scHiResClock::Microseconds() );
+	EXPECT_EQ( (uint32_t)( 0x100000100ULL / 48 ), scHiResClock::Timestamp() );
+	scHiResClock::SetCounter( NULL, 0 );
+	EXPECT_EQ( 1000000000ULL, scHiResClock::Frequency() );
+
+	scDebugManager*		pDm = scDebugManager::Instance();
+	CapturePath*		pPath = new CapturePath(11);
+	scTraceDecoder		decoder( g_TestFormats, 3, true );
+	char				sText[128];
+	uint32_t			nText;
+
+	pDm->Allocator( pAllocatorImp );
+	delete pDm->SetLabelManager( new scDebugLabelManager( 16, scDisabled ) );
+	pDm->LabelState( scDEBUGLABEL_INFO_MESSAGE, scEnabled );
+	pDm->Add( pPath );
+	pDm->Enable();
+	pDm->SetTimestampSource( &Now );
+
+	// text traces start with the time in microseconds
+	s_nNow = 12345678;
+	pDm->SetTimestampOptions( scTRACE_TIMESTAMP_TEXT | scTRACE_TIMESTAMP_DELTA );
+	pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "value %u\n", 7 );
+	s_nNow = 45;
+	pDm->Trace_Info( scDEBUGLABEL_INFO_MESSAGE, "info\n" );
+	EXPECT_EQ( "[12.345678] value 7\n[0.000045] info\n", std::string( pPath->_Data.begin(), pPath->_Data.end() ) );
+	pDm->SetTimestampOptions( scTRACE_TIMESTAMP_DELTA );
+	pPath->_Data.clear();
+
+	// binary records drained from the queue carry the time since the record before
+	// when it is short
+	scTraceQueue		queue( 8, 32 );
+	ASSERT_EQ( ERROR_SUCCESS, queue.Initialize( pAllocatorImp ) );
+	pDm->SetTraceQueue( &queue );
+	const uint32_t nSizes[] = { sizeof(scTraceRecord_t), sizeof(scTraceDeltaRecord_t) + 1,
+		sizeof(scTraceDeltaRecord_t) + 2, sizeof(scTraceDeltaRecord_t) + 3, sizeof(scTraceRecord_t) };
+	const uint32_t nTimes[] = { 1000, 1100, 1300, 1000000, 5000000 };
+	for( uint32_t i=0; i < 5; ++i )
+	{
+		s_nNow = nTimes[i];
+		size_t nBefore = pPath->_Data.size();
+		pDm->TraceBinary( scDEBUGLABEL_INFO_MESSAGE, fmt_State, i, i + 1 );
+		EXPECT_EQ( 1, pDm->Drain() );
+		EXPECT_EQ( nSizes[i] + 8, pPath->_Data.size() - nBefore );
+	}
+	EXPECT_EQ( scTRACE_RECORD_SYNC, pPath->_Data[0] );
+	EXPECT_EQ( scTRACE_DELTA_SYNC, pPath->_Data[sizeof(scTraceRecord_t) + 8] );
+
+	std::string	sOutput;
+	uint32_t	nOffset = 0;
+	for( uint32_t i=0; i < 5; ++i )
+	{
+		uint32_t nUsed = decoder.Decode( &pPath->_Data[nOffset], (uint32_t)pPath->_Data.size() - nOffset, sText, sizeof(sText), nText );
+		ASSERT_EQ( nSizes[i] + 8, nUsed );
+		EXPECT_EQ( nTimes[i], decoder.Timestamp() );
+		sOutput.append( sText, nText );
+		nOffset += nUsed;
+	}
+	EXPECT_EQ( "      1000 [2] State 0 -> 1\n\r      1100 [2] State 1 -> 2\n\r      1300 [2] State 2 -> 3\n\r"
+		"   1000000 [2] State 3 -> 4\n\r   5000000 [2] State 4 -> 5\n\r", sOutput );
+
+	// an incomplete delta waits for more data
+	EXPECT_EQ( 0, decoder.Decode( &pPath->_Data[sizeof(scTraceRecord_t) + 8], sizeof(scTraceDeltaRecord_t), sText, sizeof(sText), nText ) );
+
+	// a reader starting on a delta record has no timestamp until a whole one
+	scTraceDecoder		late( g_TestFormats, 3, true );
+	nOffset = sizeof(scTraceRecord_t) + 8;
+	nOffset += late.Decode( &pPath->_Data[nOffset], (uint32_t)pPath->_Data.size() - nOffset, sText, sizeof(sText), nText );
+	EXPECT_FALSE( late.Synced() );
+	EXPECT_EQ( "         ? [2] State 1 -> 2\n\r", std::string( sText, nText ) );
+	nOffset += late.Decode( &pPath->_Data[nOffset], (uint32_t)pPath->_Data.size() - nOffset, sText, sizeof(sText), nText );
+	nOffset += late.Decode( &pPath->_Data[nOffset], (uint32_t)pPath->_Data.size() - nOffset, sText, sizeof(sText), nText );
+	EXPECT_FALSE( late.Synced() );
+	late.Decode( &pPath->_Data[nOffset], (uint32_t)pPath->_Data.size() - nOffset, sText, sizeof(sText), nText );
+	EXPECT_TRUE( late.Synced() );
+	EXPECT_EQ( 5000000, late.Timestamp() );
+
+	// without a queue two tasks could deliver out of order, so the timestamp is whole
+	pDm->SetTraceQueue( NULL );
+	pPath->_Data.clear();
+	pDm->TraceBinary( scDEBUGLABEL_INFO_MESSAGE, fmt_Hello );
+	pDm->TraceBinary( scDEBUGLABEL_INFO_MESSAGE, fmt_Hello );
+	EXPECT_EQ( 2 * sizeof(scTraceRecord_t), pPath->_Data.size() );
+	pDm->SetTraceQueue( &queue );
+
+	// the whole timestamp is repeated so a reader joining late catches up
+	pPath->_Data.clear();
+	uint32_t nWhole = 0;
+	for( uint32_t i=0; i < 3 * SC_TRACE_DELTA_INTERVAL; ++i )
+	{
+		s_nNow += 10;
+		pDm->TraceBinary( scDEBUGLABEL_INFO_MESSAGE, fmt_Hello );
+		pDm->Drain();
+		nWhole += ( pPath->_Data.back() != 10 ) ? 1 : 0;
+	}
+	nOffset = 0;
+	while( nOffset < pPath->_Data.size() )
+	{
+		nWhole -= ( pPath->_Data[nOffset] == scTRACE_RECORD_SYNC ) ? 1 : 0;
+		nOffset += ( pPath->_Data[nOffset] == scTRACE_RECORD_SYNC ) ? sizeof(scTraceRecord_t) : sizeof(scTraceDeltaRecord_t) + 1;
+	}
+	EXPECT_EQ( nOffset, pPath->_Data.size() );
+	EXPECT_EQ( 0, nWhole );
+	EXPECT_EQ( 3 * SC_TRACE_DELTA_INTERVAL - 3, ( pPath->_Data.size() - 3 * sizeof(scTraceRecord_t) ) / ( sizeof(scTraceDeltaRecord_t) + 1 ) );
+
+	// a path taking only some labels gets the time since the record it took last,
+	// not since one only the other paths took
+	CapturePath*		pErrors = new CapturePath(12);
+	pErrors->LabelState( scDisabled );
+	pErrors->LabelState( scDEBUGLABEL_ERROR_MESSAGE, scEnabled );
+	pDm->Add( pErrors );
+	pDm->LabelState( scDEBUGLABEL_ERROR_MESSAGE, scEnabled );
+	pPath->_Data.clear();
+	const uint16_t nLabels[] = { scDEBUGLABEL_ERROR_MESSAGE, scDEBUGLABEL_INFO_MESSAGE, scDEBUGLABEL_INFO_MESSAGE, scDEBUGLABEL_ERROR_MESSAGE };
+	const uint32_t nFiltered[] = { 20000, 20030, 20060, 20100 };
+	for( uint32_t i=0; i < 4; ++i )
+	{
+		s_nNow = nFiltered[i];
+		pDm->TraceBinary( nLabels[i], fmt_Hello );
+	}
+	EXPECT_EQ( 4, pDm->Drain() );
+	EXPECT_EQ( sizeof(scTraceRecord_t) + sizeof(scTraceDeltaRecord_t) + 1, pErrors->_Data.size() );
+	scTraceDecoder		errors( g_TestFormats, 3 );
+	nOffset = 0;
+	for( uint32_t i=0; i < 4; i += 3 )
+	{
+		nOffset += errors.Decode( &pErrors->_Data[nOffset], (uint32_t)pErrors->_Data.size() - nOffset, sText, sizeof(sText), nText );
+		EXPECT_EQ( nFiltered[i], errors.Timestamp() );
+	}
+	EXPECT_EQ( nOffset, pErrors->_Data.size() );
+	nOffset = 0;
+	for( uint32_t i=0; i < 4; ++i )
+	{
+		nOffset += decoder.Decode( &pPath->_Data[nOffset], (uint32_t)pPath->_Data.size() - nOffset, sText, sizeof(sText), nText );
+		EXPECT_EQ( nFiltered[i], decoder.Timestamp() );
+	}
+	EXPECT_EQ( nOffset, pPath->_Data.size() );
+	pDm->LabelState( scDEBUGLABEL_ERROR_MESSAGE, scDisabled );
+	delete pDm->Remove( pErrors->PathId() );
+
+	// records the queue drops to make room leave no hole in the deltas, the paths
+	// only build on what they received
+	scTraceQueue		oldest( 4, 32, scTraceDropOldest );
+	ASSERT_EQ( ERROR_SUCCESS, oldest.Initialize( pAllocatorImp ) );
+	pDm->SetTraceQueue( &oldest );
+	pPath->_Data.clear();
+	for( uint32_t nRound=0; nRound < 2; ++nRound )
+	{
+		for( uint32_t i=0; i < 6; ++i )
+		{
+			s_nNow += 10;
+			pDm->TraceBinary( scDEBUGLABEL_INFO_MESSAGE, fmt_Hello );
+		}
+		EXPECT_EQ( 2 * ( nRound + 1 ), oldest.Dropped() );
+		EXPECT_EQ( 4, pDm->Drain() );
+	}
+	EXPECT_EQ( scTRACE_RECORD_SYNC, pPath->_Data[0] );
+	EXPECT_EQ( sizeof(scTraceRecord_t) + 7 * ( sizeof(scTraceDeltaRecord_t) + 1 ), pPath->_Data.size() );
+	scTraceDecoder		dropped( g_TestFormats, 3 );
+	const uint32_t		nKept[] = { 30, 40, 50, 60, 90, 100, 110, 120 };
+	nOffset = 0;
+	for( uint32_t i=0; i < 8; ++i )
+	{
+		nOffset += dropped.Decode( &pPath->_Data[nOffset], (uint32_t)pPath->_Data.size() - nOffset, sText, sizeof(sText), nText );
+		EXPECT_EQ( s_nNow - 120 + nKept[i], dropped.Timestamp() );
+	}
+	pDm->SetTraceQueue( NULL );
+
+	// without deltas every record has the whole timestamp
+	pDm->SetTimestampOptions( 0 );
+	pPath->_Data.clear();
+	pDm->TraceBinary( scDEBUGLABEL_INFO_MESSAGE, fmt_Hello );
+	pDm->TraceBinary( scDEBUGLABEL_INFO_MESSAGE, fmt_Hello );
+	EXPECT_EQ( 2 * sizeof(scTraceRecord_t), pPath->_Data.size() );
+
+	pDm->SetTimestampOptions( scTRACE_TIMESTAMP_DELTA );
+	pDm->SetTimestampSource( NULL );
+	pDm->LabelState( scDisabled );
+	delete pDm->Remove( pPath->PathId() );
+}
+
+static void ThreadYield( void )
+{
+	std::this_thread::yield();
+}
+
+double scDebugManager_test::RunTracers( uint32_t nThreads, uint32_t nTraces, bool bQueued, bool bChurn )
+{
+	scDebugManager*		pDm = scDebugManager::Instance();
+	volatile uint32_t	nDone = 0;
+	scTraceQueue		queue( 256, 48, scTraceBlock );
+
+	if ( bQueued )
+	{
+		queue.Initialize( pAllocatorImp );
+		queue.SetYield( &ThreadYield );
+		pDm->SetTraceQueue( &queue );
+	}
+
+	// the debug task drains the queue, another adds and removes a path
+	std::thread helper( [&]()
+	{
+		while( scAtomicLoad( &nDone ) == 0 )
+		{
+			if ( bChurn )
+			{
+				pDm->Add( new CountingPath(13) );
+				delete pDm->Remove( 13 );
+			}
+			if ( !bQueued || pDm->Drain() == 0 )
+			{
+				std::this_thread::yield();
+			}
+		}
+	} );
+
+	uint64_t nStart = scHiResClock::Ticks();
+	std::vector<std::thread> tracers;
+	for( uint32_t t=0; t < nThreads; ++t )
+	{
+		tracers.push_back( std::thread( [pDm, t, nTraces]()
+		{
+			for( uint32_t i=0; i < nTraces; ++i )
+			{
+				pDm->Trace( scDEBUGLABEL_INFO_MESSAGE, "thread %u trace %u\n", t, i );
+			}
+		} ) );
+	}
+	for( uint32_t t=0; t < nThreads; ++t )
+	{
+		tracers[t].join();
+	}
+	if ( bQueued )
+	{
+		while( queue.Count() > 0 )
+		{
+			std::this_thread::yield();
+		}
+	}
+	uint64_t nTicks = scHiResClock::Ticks() - nStart;
+	scAtomicStore( &nDone, 1 );
+	helper.join();
+
+	if ( bQueued )
+	{
+		pDm->Drain();
+		pDm->SetTraceQueue( NULL );
+	}
+	return (double)nThreads * nTraces * scHiResClock::Frequency() / ( nTicks > 0 ? nTicks : 1 );
+}
+
+void scDebugManager_test::ConcurrentTraceTest()
+{
+	scDebugManager*		pDm = scDebugManager::Instance();
+	CountingPath*		pPath = new CountingPath(12);
+	const uint32_t		nTraces = 20000;
+	uint32_t			nExpected = 0;
+
+	pDm->Allocator( pAllocatorImp );
+	delete pDm->SetLabelManager( new scDebugLabelManager( 16, scDisabled ) );
+	pDm->LabelState( scDEBUGLABEL_INFO_MESSAGE, scEnabled );
+	pDm->Add( pPath );
+	pDm->Enable();
+	pDm->SetPathWaitFunction( &ThreadYield );
+
+	// straight to the path, which is called by every thread
+	const uint32_t nThreads[] = { 1, 2, 4 };
+	for( uint32_t i=0; i < 3; ++i )
+	{
+		double nRate = RunTracers( nThreads[i], nTraces, false, false );
+		nExpected += nThreads[i] * nTraces;
+		printf( "direct, %u threads: %.0f traces/s\n", nThreads[i], nRate );
+	}
+	EXPECT_EQ( nExpected, pPath->_nRecords );
+
+	// through the lock-free queue, only the draining thread calls the path
+	for( uint32_t i=0; i < 3; ++i )
+	{
+		double nRate = RunTracers( nThreads[i], nTraces, true, false );
+		nExpected += nThreads[i] * nTraces;
+		printf( "queued, %u threads: %.0f traces/s\n", nThreads[i], nRate );
+	}
+	EXPECT_EQ( nExpected, pPath->_nRecords );
+
+	// paths come and go while the threads trace, none of the records is lost
+	double nRate = RunTracers( 4, nTraces, false, true );
+	nExpected += 4 * nTraces;
+	printf( "direct, 4 threads, paths changing: %.0f traces/s\n", nRate );
+	nRate = RunTracers( 4, nTraces, true, true );
+	nExpected += 4 * nTraces;
+	printf( "queued, 4 threads, paths changing: %.0f traces/s\n", nRate );
+	EXPECT_EQ( nExpected, pPath->_nRecords );
+	EXPECT_EQ( 0, pPath->_nBroken );
+
+	pDm->SetPathWaitFunction( NULL );
+	pDm->LabelState( scDisabled );
+	delete pDm->Remove( pPath->PathId() );
+}
+
+void scDebugManager_test::LimitTest()
+{
+	scDebugManager*		pDm = scDebugManager::Instance();
+	CapturePath*		pPath = new CapturePath(14);
+	// a limit stays in the list of the manager, it must outlive it
+	static scTraceLimit_t	limit = scTRACE_LIMIT_INIT( 10, 3 );
+
+	pDm->Allocator( pAllocatorImp );
+	delete pDm->SetLabelManager( new scDebugLabelManager( 16, scDisabled ) );
+	pDm->LabelState( scDEBUGLABEL_INFO_MESSAGE, scEnabled );
+	pDm->Add( pPath );
+	pDm->Enable();
+	pDm->SetTimestampSource( &Now );
+	s_nNow = 5000000;
+
+	// a burst of three gets through, the rest is only counted
+	for( uint32_t i=0; i < 10; ++i )
+	{
+		pDm->TraceLimited( limit, scDEBUGLABEL_INFO_MESSAGE, "error %u\n", i );
+	}
+	EXPECT_EQ( "error 0\nerror 1\nerror 2\n", std::string( pPath->_Data.begin(), pPath->_Data.end() ) );
+	EXPECT_EQ( 7, limit._nSuppressed );
+
+	// disabled labels do not take from the bucket
+	pDm->TraceLimited( limit, scDEBUGLABEL_DEBUG_MESSAGE, "debug\n" );
+	EXPECT_EQ( 7, limit._nSuppressed );
+
+	// one message every 100 ms, the count goes out ahead of it
+	pPath->_Data.clear();
+	s_nNow += 100000;
+	pDm->TraceLimited( limit, scDEBUGLABEL_INFO_MESSAGE, "error %u\n", 10 );
+	pDm->TraceLimited( limit, scDEBUGLABEL_INFO_MESSAGE, "error %u\n", 11 );
+	std::string sText( pPath->_Data.begin(), pPath->_Data.end() );
+	EXPECT_EQ( "scDebugManager_test.cpp:", sText.substr( 0, 24 ) );
+	EXPECT_NE( std::string::npos, sText.find( " 7 messages suppressed\n\rerror 10\n" ) );
+	EXPECT_EQ( 1, limit._nSuppressed );
+
+	// the same text again is counted as a repeat
+	pPath->_Data.clear();
+	s_nNow += 1000000;
+	pDm->TraceLimited( limit, scDEBUGLABEL_INFO_MESSAGE, "error %u\n", 10 );
+	pDm->TraceLimited( limit, scDEBUGLABEL_INFO_MESSAGE, "error %u\n", 10 );
+	EXPECT_EQ( 0, pPath->_Data.size() );
+	EXPECT_EQ( 2, limit._nRepeats );
+	pDm->TraceLimited( limit, scDEBUGLABEL_INFO_MESSAGE, "error %u\n", 12 );
+	sText.assign( pPath->_Data.begin(), pPath->_Data.end() );
+	EXPECT_NE( std::string::npos, sText.find( " last message repeated 2 times\n\r" ) );
+	EXPECT_NE( std::string::npos, sText.find( " 1 messages suppressed\n\rerror 12\n" ) );
+
+	// a storm that stopped is reported by the periodic call
+	pPath->_Data.clear();
+	const uint32_t nStorm = 100000;
+	for( uint32_t i=0; i < nStorm; ++i )
+	{
+		scTRACE_LIMITED( scDEBUGLABEL_INFO_MESSAGE, 1, 1, "storm %u\n", i );
+	}
+	EXPECT_EQ( "storm 0\n", std::string( pPath->_Data.begin(), pPath->_Data.end() ) );
+	EXPECT_EQ( nStorm - 1, pDm->ReportSuppressed() );
+	sText.assign( pPath->_Data.begin(), pPath->_Data.end() );
+	EXPECT_NE( std::string::npos, sText.find( " 99999 messages suppressed\n\r" ) );
+	EXPECT_EQ( 0, pDm->ReportSuppressed() );
+
+	// without a timestamp source the limits use the 64 bit time of scHiResClock, a
+	// quiet spell just past the 32 bit wrap of the microseconds refills the bucket
+	static scTraceLimit_t	quiet = scTRACE_LIMIT_INIT( 1, 1 );
+	pDm->SetTimestampSource( NULL );
+	s_nCounter = 0;
+	scHiResClock::SetCounter( &Counter, 1000 );
+	EXPECT_TRUE( pDm->Allow( quiet ) );
+	EXPECT_FALSE( pDm->Allow( quiet ) );
+	s_nCounter = 4294968;
+	EXPECT_TRUE( pDm->Allow( quiet ) );
+	EXPECT_FALSE( pDm->Allow( quiet ) );
+
+	// with no clock at all the bucket could never refill, nothing is held back
+	scHiResClock::SetCounter( &Counter, 0 );
+	for( uint32_t i=0; i < 10; ++i )
+	{
+		EXPECT_TRUE( pDm->Allow( quiet ) );
+	}
+	scHiResClock::SetCounter( NULL, 0 );
+	EXPECT_EQ( 2, quiet._nSuppressed );
+	pPath->_Data.clear();
+	EXPECT_EQ( 2, pDm->ReportSuppressed() );
+
+	pDm->LabelState( scDisabled );
+	delete pDm->Remove( pPath->PathId() );
+}
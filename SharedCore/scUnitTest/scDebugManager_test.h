@@ -25,6 +25,13 @@
 #include "scDebugPath.h"
 #include "scDebugLabelManager.h"
 #include "scDebugManager.h"
+#include "scTraceDecoder.h"
+#include "scDebugPathDevice.h"
+#include "scDebugPathRecorder.h"
+#include "scDebugPathBlock.h"
+#include "scHiResClock.h"
+#include "scAtomic.h"
+#include <vector>
 
 using namespace ::SharedCore;
 
@@ -36,6 +43,168 @@ class scDebugManager_test : public ::testing::Test
 {
 public:
 	void SimplePathTest();
+	void BinaryTraceTest();
+	void AsyncTraceTest();
+	void TraceMacroTest();
+	void LabelGroupTest();
+	void DevicePathTest();
+	void PrintArrayTest();
+	void RecorderTest();
+	void BlockPathTest();
+	void TimestampTest();
+	void ConcurrentTraceTest();
+	void LimitTest();
+
+	typedef enum
+	{
+		fmt_Overrun,
+		fmt_State,
+		fmt_Hello
+	} TestFormats_t;
+
+	/// <summary>
+	/// Path that keeps, or only counts, everything captured.
+	/// </summary>
+	class CapturePath : public scDebugPath
+	{
+	public:
+		CapturePath( uint8_t id ) : scDebugPath(id), _bKeep(true), _nBytes(0), _Data() {}
+		void Capture( const uint8_t* pData, uint32_t nLength )
+		{
+			_nBytes += nLength;
+			if ( _bKeep )
+			{
+				_Data.insert( _Data.end(), pData, pData + nLength );
+			}
+		}
+
+		bool					_bKeep;
+		uint32_t				_nBytes;
+		std::vector<uint8_t>	_Data;
+	};
+
+	/// <summary>
+	/// Path called from several threads, counts the records and checks each one is
+	/// whole.
+	/// </summary>
+	class CountingPath : public scDebugPath
+	{
+	public:
+		CountingPath( uint8_t id ) : scDebugPath(id), _nRecords(0), _nBroken(0) {}
+		void Capture( const uint8_t* pData, uint32_t nLength )
+		{
+			scAtomicAdd( &_nRecords, 1 );
+			if ( nLength < 8 || memcmp( pData, "thread ", 7 ) != 0 || pData[nLength - 1] != '\n' )
+			{
+				scAtomicAdd( &_nBroken, 1 );
+			}
+		}
+
+		volatile uint32_t		_nRecords;
+		volatile uint32_t		_nBroken;
+	};
+
+	/// <summary>
+	/// Trace from several threads at once.
+	/// </summary>
+	/// <returns>Traces per second.</returns>
+	double RunTracers( uint32_t nThreads, uint32_t nTraces, bool bQueued, bool bChurn );
+
+	class DevicePipe : public HAL::scBufferIODriver
+	{
+	public:
+		DevicePipe( uint32_t nSize ) : HAL::scBufferIODriver( scDeviceDescriptor(0x0100) ), _bHold(false), _nTriggers(0), _Sent()
+		{
+			SetQueue( NULL, new scRingBuffer( nSize, new uint8_t[nSize], NULL ) );
+		}
+		virtual void TriggerSend(void)
+		{
+			_nTriggers++;
+			while( !_bHold && _pQueueOut->InUse() > 0 )
+			{
+				uint32_t nLength = _pQueueOut->ReadStart();
+				_Sent.append( reinterpret_cast<const char*>( _pQueueOut->ReadBlock() ), nLength );
+				_pQueueOut->ReadEnd( nLength );
+			}
+		}
+
+		bool					_bHold;
+		uint32_t				_nTriggers;
+		std::string				_Sent;
+	};
+
+	static uint32_t Timestamp( void );
+
+	/// <summary>
+	/// Timestamp and counter set by the test.
+	/// </summary>
+	static uint32_t Now( void );
+	static uint32_t Counter( void );
+
+	static uint32_t			s_nNow;
+	static uint32_t			s_nCounter;
+
+	/// <summary>
+	/// Counts how many times trace arguments are evaluated.
+	/// </summary>
+	static uint32_t Evaluate( uint32_t nValue );
+
+	static uint32_t			s_nEvaluated;
+
+	/// <summary>
+	/// Path with a limited amount of room, like a device with a transmit queue.
+	/// </summary>
+	class PacedPath : public scDebugPath
+	{
+	public:
+		PacedPath( uint8_t id, uint32_t nSpace ) : scDebugPath(id), _nSpace(nSpace), _nOverrun(0), _Data() {}
+		void Capture( const uint8_t* pData, uint32_t nLength )
+		{
+			if ( nLength > _nSpace )
+			{
+				_nOverrun++;
+			}
+			_nSpace -= ( nLength < _nSpace ) ? nLength : _nSpace;
+			_Data.append( reinterpret_cast<const char*>(pData), nLength );
+		}
+		uint32_t Space(void) const
+		{
+			return _nSpace;
+		}
+
+		uint32_t				_nSpace;
+		uint32_t				_nOverrun;
+		std::string				_Data;
+	};
+
+	/// <summary>
+	/// Yield used by PrintArray, drains some of the paced path.
+	/// </summary>
+	static void Yield( void );
+
+	static PacedPath*		s_pPaced;
+	static uint32_t			s_nYields;
+
+	/// <summary>
+	/// Flash kept in memory, a block must be erased before it is written.
+	/// </summary>
+	class FlashBlocks : public HAL::scBlockMemoryIF
+	{
+	public:
+		FlashBlocks();
+
+		virtual uint32_t Read(uint8_t* pData, uint32_t nDataLength, uint32_t nStartAddress, uint32_t nBlockCount);
+		virtual uint32_t Write(const uint8_t* pData, uint32_t nStartAddress, uint32_t nBlockCount);
+		virtual uint32_t DefaultBlockSize(void) const { return 64; }
+		virtual const uint64_t TotalSizeBytes(void) const { return 64 * 32; }
+		virtual uint32_t TotalSizeBlocks(void) const { return 32; }
+		virtual uint32_t BulkErase( uint32_t nStartSector, uint32_t nCount, bool bWait );
+
+		uint32_t				_nWrites;
+		uint32_t				_nErases;
+		uint32_t				_nNotErased;
+		uint8_t					_Memory[64 * 32];
+	};
 
 	class MyPath : public scDebugPath
 	{
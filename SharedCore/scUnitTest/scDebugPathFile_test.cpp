@@ -0,0 +1,245 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+#include "gmock/gmock.h"
+#include "scDebugPathFile_test.h"
+
+#if defined(__linux__) || defined(_WIN32)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include "scFormat.h"
+#include "scErrorCodes.h"
+#include "scHiResClock.h"
+
+#if !defined(_WIN32)
+	#include <unistd.h>
+	#include <dirent.h>
+#endif
+
+using namespace SharedCore;
+
+scDebugPathFile_test::scDebugPathFile_test()
+{
+#if defined(_WIN32)
+	char sTemp[MAX_PATH];
+	EXPECT_NE( 0u, GetTempPathA( sizeof(sTemp), sTemp ) );
+	scFormat::Format( _sDirectory, sizeof(_sDirectory), "%sscDebugPathFile_%u", sTemp, (uint32_t)GetCurrentProcessId() );
+	EXPECT_TRUE( CreateDirectoryA( _sDirectory, NULL ) || GetLastError() == ERROR_ALREADY_EXISTS );
+#else
+	strcpy( _sDirectory, "/tmp/scDebugPathFile_XXXXXX" );
+	EXPECT_TRUE( mkdtemp( _sDirectory ) != NULL );
+#endif
+	scFormat::Format( _sLog, sizeof(_sLog), "%s/trace.log", _sDirectory );
+}
+
+scDebugPathFile_test::~scDebugPathFile_test()
+{
+#if defined(_WIN32)
+	WIN32_FIND_DATAA	entry;
+	std::string			pattern = std::string( _sDirectory ) + "/*";
+	HANDLE				hFind = FindFirstFileA( pattern.c_str(), &entry );
+	if ( hFind != INVALID_HANDLE_VALUE )
+	{
+		do
+		{
+			if ( entry.cFileName[0] != '.' )
+			{
+				std::string name = std::string( _sDirectory ) + "/" + entry.cFileName;
+				DeleteFileA( name.c_str() );
+			}
+		} while( FindNextFileA( hFind, &entry ) );
+		FindClose( hFind );
+	}
+	RemoveDirectoryA( _sDirectory );
+#else
+	DIR* pDir = opendir( _sDirectory );
+	if ( pDir != NULL )
+	{
+		struct dirent* pEntry;
+		while( ( pEntry = readdir( pDir ) ) != NULL )
+		{
+			if ( pEntry->d_name[0] != '.' )
+			{
+				std::string name = std::string( _sDirectory ) + "/" + pEntry->d_name;
+				unlink( name.c_str() );
+			}
+		}
+		closedir( pDir );
+	}
+	rmdir( _sDirectory );
+#endif
+}
+
+std::string scDebugPathFile_test::ReadFile( const char* pName, uint32_t nIndex )
+{
+	char sName[128];
+	if ( nIndex == 0 )
+	{
+		scFormat::Format( sName, sizeof(sName), "%s", pName );
+	}
+	else
+	{
+		scFormat::Format( sName, sizeof(sName), "%s.%u", pName, nIndex );
+	}
+
+	std::string result;
+	FILE* pFile = fopen( sName, "rb" );
+	if ( pFile != NULL )
+	{
+		char	buffer[4096];
+		size_t	nRead;
+		while( ( nRead = fread( buffer, 1, sizeof(buffer), pFile ) ) > 0 )
+		{
+			result.append( buffer, nRead );
+		}
+		fclose( pFile );
+	}
+	return result;
+}
+
+uint32_t scDebugPathFile_test::Record( char* pText, uint32_t nSize, uint32_t i )
+{
+	return scFormat::Format( pText, nSize, "[%08u] a trace record from the file path test\n", i );
+}
+
+void scDebugPathFile_test::RotationTest()
+{
+	scDebugPathFile*	pPath = new scDebugPathFile( 20, 4096, 4 );
+	std::string			expected;
+	char				sText[80];
+
+	// the previous log is kept as trace.log.1
+	FILE* pOld = fopen( _sLog, "wb" );
+	fputs( "previous run\n", pOld );
+	fclose( pOld );
+
+	EXPECT_EQ( ERROR_SUCCESS, pPath->Open( _sLog, scDebugPathFile::file_Buffered, 16 * 1024, 5 ) );
+	EXPECT_EQ( "previous run\n", ReadFile( _sLog, 1 ) );
+
+	// 40000 bytes in records of 50, the path takes them in 4k blocks
+	for( uint32_t i=0; i < 800; ++i )
+	{
+		uint32_t nLength = Record( sText, sizeof(sText), i );
+		while( pPath->Space() < nLength )
+		{
+			std::this_thread::yield();
+		}
+		pPath->Capture( reinterpret_cast<const uint8_t*>(sText), nLength );
+		expected.append( sText, nLength );
+	}
+	EXPECT_EQ( ERROR_SUCCESS, pPath->Flush() );
+	EXPECT_EQ( 40000u, pPath->Captured() );
+	EXPECT_EQ( 0u, pPath->Dropped() );
+	pPath->Close();
+
+	// the files hold the output, oldest first, and the previous run moved up
+	EXPECT_EQ( 2u, pPath->Rotations() );
+	EXPECT_EQ( expected, ReadFile( _sLog, 2 ) + ReadFile( _sLog, 1 ) + ReadFile( _sLog ) );
+	EXPECT_LE( 16u * 1024, ReadFile( _sLog, 2 ).size() );
+	EXPECT_EQ( "previous run\n", ReadFile( _sLog, 3 ) );
+
+	// the segments of a record stay together, and nothing is taken once closed
+	scIOSpan_t spans[2] = { { reinterpret_cast<const uint8_t*>("head:"), 5 }, { reinterpret_cast<const uint8_t*>("body\n"), 5 } };
+	EXPECT_EQ( ERROR_SUCCESS, pPath->Open( _sLog, scDebugPathFile::file_Buffered, 0, 2 ) );
+	pPath->Capture_v( spans, 2 );
+	pPath->Close();
+	pPath->Capture_v( spans, 2 );
+	EXPECT_EQ( 1u, pPath->Dropped() );
+	EXPECT_EQ( "head:body\n", ReadFile( _sLog ) );
+	EXPECT_EQ( expected.substr( expected.size() - ReadFile( _sLog, 1 ).size() ), ReadFile( _sLog, 1 ) );
+
+	delete pPath;
+}
+
+void scDebugPathFile_test::MappedTest()
+{
+	scDebugPathFile*	pPath = new scDebugPathFile( 21 );
+	std::string			expected;
+	char				sText[80];
+
+	EXPECT_EQ( ERROR_SUCCESS, pPath->Open( _sLog, scDebugPathFile::file_Mapped, 16 * 1024, 4 ) );
+	for( uint32_t i=0; i < 800; ++i )
+	{
+		uint32_t nLength = Record( sText, sizeof(sText), i );
+		while( pPath->Space() < nLength )
+		{
+			std::this_thread::yield();
+		}
+		pPath->Capture( reinterpret_cast<const uint8_t*>(sText), nLength );
+		expected.append( sText, nLength );
+	}
+	EXPECT_EQ( 0u, pPath->Dropped() );
+
+	// the mapped files are filled to the end and the last is cut to the length used
+	pPath->Close();
+	EXPECT_EQ( 2u, pPath->Rotations() );
+	EXPECT_EQ( 16u * 1024, ReadFile( _sLog, 2 ).size() );
+	EXPECT_EQ( 16u * 1024, ReadFile( _sLog, 1 ).size() );
+	EXPECT_EQ( 40000u - 32 * 1024, ReadFile( _sLog ).size() );
+	EXPECT_EQ( expected, ReadFile( _sLog, 2 ) + ReadFile( _sLog, 1 ) + ReadFile( _sLog ) );
+	EXPECT_EQ( "", ReadFile( ( std::string( _sLog ) + ".next" ).c_str() ) );
+
+	delete pPath;
+}
+
+void scDebugPathFile_test::ThroughputTest()
+{
+	const uint32_t		nTotal = 256 * 1024 * 1024;
+	const uint32_t		nRecord = 128;
+	uint8_t				record[nRecord];
+
+	memset( record, 'x', sizeof(record) );
+	record[nRecord - 1] = '\n';
+
+	for( uint32_t nMode = scDebugPathFile::file_Buffered; nMode <= scDebugPathFile::file_Mapped; ++nMode )
+	{
+		scDebugPathFile* pPath = new scDebugPathFile( 22, 1024 * 1024, 16 );
+		EXPECT_EQ( ERROR_SUCCESS, pPath->Open( _sLog, (scDebugPathFile::Mode_t)nMode, 64 * 1024 * 1024, 2 ) );
+
+		// the caller never waits, what the writer cannot keep up with is dropped. The
+		// rate depends on the machine so it is only reported.
+		uint64_t nStart = scHiResClock::Ticks();
+		for( uint32_t i=0; i < nTotal / nRecord; ++i )
+		{
+			pPath->Capture( record, nRecord );
+		}
+		uint64_t nTicks = scHiResClock::Ticks() - nStart;
+		pPath->Close();
+
+		double dSeconds = (double)nTicks / scHiResClock::Frequency();
+		double dRate = nTotal / ( dSeconds > 0 ? dSeconds : 1e-9 ) / ( 1024 * 1024 );
+		printf( "%s: %.0f MB/s captured, %llu bytes kept, %u records dropped, %u rotations\n",
+			nMode == scDebugPathFile::file_Buffered ? "buffered" : "mapped", dRate,
+			(unsigned long long)pPath->Captured(), pPath->Dropped(), pPath->Rotations() );
+
+		// every record is either kept whole or counted as dropped, and the newest
+		// file holds whole records
+		EXPECT_EQ( (uint64_t)nTotal, pPath->Captured() + (uint64_t)pPath->Dropped() * nRecord );
+		EXPECT_LT( 0u, pPath->Captured() );
+		std::string sKept = ReadFile( _sLog );
+		EXPECT_LE( (uint64_t)sKept.size(), pPath->Captured() );
+		EXPECT_EQ( 0u, sKept.size() % nRecord );
+		EXPECT_EQ( std::string::npos, sKept.find_first_not_of( "x\n" ) );
+		delete pPath;
+	}
+}
+
+#endif // defined(__linux__) || defined(_WIN32)
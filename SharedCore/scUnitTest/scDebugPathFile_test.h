@@ -0,0 +1,61 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+#pragma once
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"  // Brings in Google Mock.
+
+#include "scDebugPathFile.h"
+#include <string>
+
+using namespace ::SharedCore;
+
+#if defined(__linux__) || defined(_WIN32)
+
+// Tests for the debug path logging to files on a hosted build.
+class scDebugPathFile_test : public ::testing::Test
+{
+public:
+	void RotationTest();
+	void MappedTest();
+	void ThroughputTest();
+
+protected:
+	scDebugPathFile_test();
+
+	virtual ~scDebugPathFile_test();
+
+	/// <summary>
+	/// Read a whole file, empty if it does not exist.
+	/// </summary>
+	std::string ReadFile( const char* pName, uint32_t nIndex = 0 );
+
+	/// <summary>
+	/// Build the text of record i.
+	/// </summary>
+	static uint32_t Record( char* pText, uint32_t nSize, uint32_t i );
+
+	/// <summary>
+	/// Directory holding the files of the test, removed afterwards.
+	/// </summary>
+	char			_sDirectory[64];
+	char			_sLog[96];
+};
+
+#endif // defined(__linux__) || defined(_WIN32)
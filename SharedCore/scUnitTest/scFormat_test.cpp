@@ -0,0 +1,184 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+#include "gmock/gmock.h"
+#include "scFormat_test.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+using namespace SharedCore;
+
+scFormat_test::scFormat_test()
+{
+}
+
+scFormat_test::~scFormat_test()
+{
+}
+
+uint32_t scFormat_test::StringSink::Write( const char* pText, uint32_t nLength )
+{
+	uint32_t nRoom = _nLimit - (uint32_t)_Text.size();
+	if ( nLength > nRoom )
+	{
+		nLength = nRoom;
+	}
+	_Text.append( pText, nLength );
+	return nLength;
+}
+
+void scFormat_test::Compare( const char* pFormat, ... )
+{
+	char	sExpected[128];
+	char	sActual[128];
+	va_list	ap;
+	va_list	copy;
+
+	va_start( ap, pFormat );
+	va_copy( copy, ap );
+	int			nExpected = vsnprintf( sExpected, sizeof(sExpected), pFormat, ap );
+	uint32_t	nActual = scFormat::vFormat( sActual, sizeof(sActual), pFormat, copy );
+	va_end( copy );
+	va_end( ap );
+
+	EXPECT_STREQ( sExpected, sActual ) << "format \"" << pFormat << "\"";
+	EXPECT_EQ( (uint32_t)nExpected, nActual ) << "format \"" << pFormat << "\"";
+}
+
+void scFormat_test::ConversionTest()
+{
+	// the conversions used across the framework give the same text as the C library
+	Compare( "plain text" );
+	Compare( "%u %u %u", 0U, 7U, 4294967295U );
+	Compare( "%d %d %i", -1, 2147483647, (-2147483647 - 1) );
+	Compare( "[%5d] [%-5d] [%05d] [%5u]", -42, -42, -42, 42U );
+	Compare( "[%.5d] [%8.3d] [%.0d] [%.0u]", 42, -7, 0, 0U );
+	Compare( "%x %X %08x %04X", 0xBEEFU, 0xBEEFU, 0xABCU, 0x12U );
+	Compare( "%02u:%02u:%02u %04u-%02u-%02u", 9U, 5U, 59U, 2026U, 10U, 19U );
+	Compare( "%lu %ld %lx", 4000000000UL, -4000000L, 0xDEADBEEFUL );
+	Compare( "%llu %lld %llX", 18446744073709551615ULL, (-9223372036854775807LL - 1), 0x0123456789ABCDEFULL );
+	Compare( "%zu %hu %hd", (size_t)123456, (unsigned short)65535, (short)-3 );
+	Compare( "%s|%10s|%-10s|%.3s|%s", "abc", "right", "left", "truncated", "" );
+	Compare( "%c%c%c %5c|%-3c|", 'a', 'b', 'c', 'd', 'e' );
+	Compare( "%p", (void*)0x1234 );
+	Compare( "100%% %*d|%-*d|%.*s", 6, 42, 4, 7, 2, "xyz" );
+	Compare( "%10u%10u%10u%10u%10u%10u", 1U, 22U, 333U, 4444U, 55555U, 666666U );
+
+	// powers of ten around the two digit table and the 32 bit boundary
+	uint64_t nValue = 1;
+	for( int i=0; i < 20; ++i )
+	{
+		Compare( "%llu %llu %llu", (unsigned long long)( nValue - 1 ), (unsigned long long)nValue,
+			(unsigned long long)( nValue + 1 ) );
+		nValue *= 10;
+	}
+	Compare( "%llu %llu", 4294967295ULL, 4294967296ULL );
+
+	// a small buffer is cut and terminated, the length of the whole text is returned
+	char sText[8];
+	memset( sText, 'x', sizeof(sText) );
+	EXPECT_EQ( 16, scFormat::Format( sText, sizeof(sText), "%s-%u", "abcdefghij", 12345U ) );
+	EXPECT_STREQ( "abcdefg", sText );
+	EXPECT_EQ( 5, scFormat::Format( sText, 0, "%u", 12345U ) );
+	EXPECT_EQ( 'a', sText[0] );
+
+	// a sink that fills up stops receiving text, the length is still counted
+	StringSink	sink( 10 );
+	scFormatArg	args[3] = { scFormatArg( "abcdefgh" ), scFormatArg( 123 ), scFormatArg( 'z' ) };
+	EXPECT_EQ( 14, scFormat::Format( sink, "%s %d %c", args, 3 ) );
+	EXPECT_EQ( "abcdefgh 1", sink._Text );
+
+	// conversions the formatter does not know are shown as written
+	EXPECT_EQ( 6, scFormat::Format( sText, sizeof(sText), "%q %+d", 5 ) );
+	EXPECT_STREQ( "%q %+d", sText );
+}
+
+void scFormat_test::TypeSafeTest()
+{
+	char		sText[64];
+	int			nNegative = -1;
+	size_t		nSize = 300;
+	uint8_t		nByte = 200;
+	int			nInt = 0;
+
+	// the types come from the compiler, so mismatches with the format are harmless
+	scFormat::Format( sText, sizeof(sText), "%u %d %u", nSize, nByte, nNegative );
+	EXPECT_STREQ( "300 200 4294967295", sText );
+
+	scFormat::Format( sText, sizeof(sText), "%s, %s, %d", 42, 'c', "text" );
+	EXPECT_STREQ( "42, c, text", sText );
+
+	scFormat::Format( sText, sizeof(sText), "%x %X %x", 0xFFFFFFFFFFULL, -2, (long long)-2 );
+	EXPECT_STREQ( "ffffffffff FFFFFFFE fffffffffffffffe", sText );
+
+	scFormat::Format( sText, sizeof(sText), "%c%c %u %f", 'o', 107, 'A', 1.5 );
+	EXPECT_STREQ( "ok 65 ?", sText );
+
+	// missing arguments print nothing instead of reading past the list
+	EXPECT_EQ( 6, scFormat::Format( sText, sizeof(sText), "[%d] [%s]", 5 ) );
+	EXPECT_STREQ( "[5] []", sText );
+
+	scFormat::Format( sText, sizeof(sText), "%p %s %s", &nInt, (const char*)NULL, static_cast<const void*>( &nInt ) );
+	char sExpected[64];
+	snprintf( sExpected, sizeof(sExpected), "%p (null) %p", (void*)&nInt, (void*)&nInt );
+	EXPECT_STREQ( sExpected, sText );
+
+	// widths and padding are the same as the va_list form
+	scFormat::Format( sText, sizeof(sText), "[%-6s][%6s][%06d][%-4u]", "ab", "cd", -12, 7U );
+	EXPECT_STREQ( "[ab    ][    cd][-00012][7   ]", sText );
+
+	// the conversion helpers on their own
+	char	sDigits[24];
+	char*	pEnd = sDigits + sizeof(sDigits);
+	EXPECT_EQ( "18446744073709551615", std::string( scFormat::Decimal( pEnd, 18446744073709551615ULL ), pEnd ) );
+	EXPECT_EQ( "0", std::string( scFormat::Decimal( pEnd, 0 ), pEnd ) );
+	EXPECT_EQ( "DEADBEEF", std::string( scFormat::Hex( pEnd, 0xDEADBEEF, true ), pEnd ) );
+}
+
+void scFormat_test::BenchmarkTest()
+{
+	const uint32_t	nLoops = 200000;
+	char			sText[128];
+	char			sLibrary[128];
+	uint32_t		nBytes = 0;
+	uint32_t		nLibraryBytes = 0;
+
+	// the line used by the trace benchmark, plus the hex and padding of a dump line
+	clock_t nStart = clock();
+	for( uint32_t i=0; i < nLoops; ++i )
+	{
+		nBytes += scFormat::Format( sText, sizeof(sText), "UART %u overrun, %u bytes lost\n\r", i, 17U );
+		nBytes += scFormat::Format( sText, sizeof(sText), "[%u] %04X:%08x %-6s %5d\n\r", i, i & 0xFFFF, i * 2654435761U, "Used", -(int)i );
+	}
+	clock_t nFormat_Time = clock() - nStart;
+
+	nStart = clock();
+	for( uint32_t i=0; i < nLoops; ++i )
+	{
+		nLibraryBytes += snprintf( sLibrary, sizeof(sLibrary), "UART %u overrun, %u bytes lost\n\r", i, 17U );
+		nLibraryBytes += snprintf( sLibrary, sizeof(sLibrary), "[%u] %04X:%08x %-6s %5d\n\r", i, i & 0xFFFF, i * 2654435761U, "Used", -(int)i );
+	}
+	clock_t nLibrary_Time = clock() - nStart;
+
+	printf( "scFormat:  %u calls, %ld clocks, %u bytes\n", nLoops * 2, (long)nFormat_Time, nBytes );
+	printf( "vsnprintf: %u calls, %ld clocks, %u bytes\n", nLoops * 2, (long)nLibrary_Time, nLibraryBytes );
+	EXPECT_EQ( nLibraryBytes, nBytes );
+	EXPECT_STREQ( sLibrary, sText );
+}
@@ -0,0 +1,59 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+#pragma once
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"  // Brings in Google Mock.
+
+#include "scFormat.h"
+#include <string>
+
+using namespace ::SharedCore;
+
+// Tests for the bounded formatter used in place of vsprintf.
+class scFormat_test : public ::testing::Test
+{
+public:
+	void ConversionTest();
+	void TypeSafeTest();
+	void BenchmarkTest();
+
+	/// <summary>
+	/// Sink collecting the text into a string, up to a limit.
+	/// </summary>
+	class StringSink : public scIFormatSink
+	{
+	public:
+		StringSink( uint32_t nLimit ) : _nLimit( nLimit ), _Text() {}
+		virtual uint32_t Write( const char* pText, uint32_t nLength );
+
+		uint32_t				_nLimit;
+		std::string				_Text;
+	};
+
+protected:
+	scFormat_test();
+
+	virtual ~scFormat_test();
+
+	/// <summary>
+	/// Format with both scFormat::vFormat and vsnprintf and check they agree.
+	/// </summary>
+	void Compare( const char* pFormat, ... );
+};
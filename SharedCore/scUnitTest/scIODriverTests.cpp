@@ -313,4 +313,82 @@ void scIODriverTests::CallbackIODriver_Test()
 	EXPECT_EQ( 1000, pDriver2->GetIdleNotifyTimeout() );
 	pDriver2->Unsubscribe( Handler_Event2 );
 
-}
\ No newline at end of file
+}
+
+scIODriverTests::TestDriver5::TestDriver5()
+	: scBufferIODriver( scDeviceDescriptor(Driver_5) )
+	, _nTriggerCount(0)
+	, _Sent()
+{
+}
+
+// Drains the whole transmit queue and keeps a copy so the gathered stream can be checked.
+void scIODriverTests::TestDriver5::TriggerSend(void)
+{
+	_nTriggerCount++;
+	while( _pQueueOut->InUse() > 0 )
+	{
+		uint32_t nNumber = _pQueueOut->ReadStart();
+		_Sent.insert( _Sent.end(), _pQueueOut->ReadBlock(), _pQueueOut->ReadBlock() + nNumber );
+		_pQueueOut->ReadEnd( nNumber );
+	}
+}
+
+void scIODriverTests::TestDriver5::Initialize( scDeviceManager* pDm )
+{
+	scRingBuffer* pIn = new scRingBuffer( 50, new uint8_t[50], NULL );
+	scRingBuffer* pOut = new scRingBuffer( 50, new uint8_t[50], NULL );
+
+	SetQueue( pIn, pOut );
+
+	scBufferIODriver::Initialize( pDm );
+}
+
+void scIODriverTests::ScatterGatherSend_Test()
+{
+	testDM	dm;
+
+	uint8_t			Header[6];
+	uint8_t			Payload[100];
+	uint8_t			Trailer[4];
+	TestDriver5*	pDriver = new TestDriver5();
+
+	memset( &Header[0], 0xAA, sizeof(Header) );
+	memset( &Trailer[0], 0x55, sizeof(Trailer) );
+	for( int i=0; i < sizeof(Payload); ++i )
+	{
+		Payload[i] = (uint8_t)i;
+	}
+
+	dm.Add( pDriver );
+	dm.Initialize();
+	pDriver->Enable();
+
+	scIOSpan_t		spans[3];
+	spans[0]._pData = &Header[0];
+	spans[0]._nLength = 6;
+	spans[1]._pData = &Payload[0];
+	spans[1]._nLength = 20;
+	spans[2]._pData = &Trailer[0];
+	spans[2]._nLength = 4;
+
+	// small enough to fit in the queue, only one trigger is expected.
+	EXPECT_EQ( ERROR_SUCCESS, pDriver->Send_v( &spans[0], 3 ) );
+	EXPECT_EQ( 1, pDriver->_nTriggerCount );
+	ASSERT_EQ( 30, pDriver->_Sent.size() );
+	EXPECT_EQ( 0, memcmp( &pDriver->_Sent[0], &Header[0], 6 ) );
+	EXPECT_EQ( 0, memcmp( &pDriver->_Sent[6], &Payload[0], 20 ) );
+	EXPECT_EQ( 0, memcmp( &pDriver->_Sent[26], &Trailer[0], 4 ) );
+
+	// larger than the 50 byte queue, the driver is kicked when the queue fills.
+	pDriver->_Sent.clear();
+	spans[1]._nLength = sizeof(Payload);
+	EXPECT_EQ( ERROR_SUCCESS, pDriver->Send_v( &spans[0], 3 ) );
+	ASSERT_EQ( 110, pDriver->_Sent.size() );
+	EXPECT_EQ( 0, memcmp( &pDriver->_Sent[6], &Payload[0], sizeof(Payload) ) );
+	EXPECT_EQ( 0, memcmp( &pDriver->_Sent[106], &Trailer[0], 4 ) );
+	EXPECT_FALSE( pDriver->GetOverflow() );
+
+	// empty request still behaves.
+	EXPECT_EQ( ERROR_SUCCESS, pDriver->Send_v( NULL, 0 ) );
+}
@@ -37,12 +37,14 @@ public:
 		Driver_1,
 		Driver_2,
 		Driver_3,
-		Driver_4
+		Driver_4,
+		Driver_5
 	} Driver_t;
 
 	void EventIODriver_Test();
 	void BufferIODriver_Test();
 	void CallbackIODriver_Test();
+	void ScatterGatherSend_Test();
 
 	class testDM : public scDeviceManager
 	{
@@ -96,6 +98,27 @@ public:
 		void Test_Events(void);
 	};
 
+	class TestDriver5 : public scBufferIODriver
+	{
+	public:
+		TestDriver5();
+		virtual ~TestDriver5() {}
+
+		virtual void Initialize( scDeviceManager* pDm );
+
+		virtual void TriggerSend(void);
+
+		/// <summary>
+		/// Number of times the transmit was triggered.
+		/// </summary>
+		uint32_t			_nTriggerCount;
+
+		/// <summary>
+		/// Everything that was pulled out of the transmit queue.
+		/// </summary>
+		vector<uint8_t>		_Sent;
+	};
+
 protected:
 	// You can remove any or all of the following functions if its body
 	// is empty.
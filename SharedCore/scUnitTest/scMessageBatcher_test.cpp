@@ -0,0 +1,271 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+
+#include "gmock/gmock.h"
+#include "scMessageBatcher_test.h"
+#include "scErrorCodes.h"
+
+using namespace SharedCore;
+
+uint32_t	scMessageBatcher_test::_nTicks = 0;
+
+scMessageBatcher_test::BatchMessage* scMessageBatcher_test::BatchFactory::Build( uint16_t nDestination, BatchMessages_t nId, uint32_t nLength, uint8_t nFill )
+{
+	BatchMessage* pMessage = Create( sizeof(scStandardHeader_t) + nLength );
+	if ( pMessage != NULL )
+	{
+		scStandardHeader<BatchMessages_t> header;
+		header.SetDestination( nDestination );
+		header.SetSource( 7 );
+		header.SetId( nId );
+		header.SetLength( nLength );
+		header.UpdateChecksum();
+
+		uint8_t* pBuffer = const_cast<uint8_t*>( pMessage->Buffer() );
+		memcpy( pBuffer, &header.Data(), sizeof(scStandardHeader_t) );
+		memset( pBuffer + sizeof(scStandardHeader_t), nFill, nLength );
+		*pMessage = BatchMessage( pBuffer, sizeof(scStandardHeader_t) + nLength );
+	}
+	return pMessage;
+}
+
+scMessageBatcher_test::LoopbackDriver::LoopbackDriver()
+	: scBufferIODriver( scDeviceDescriptor(1) )
+	, _nTriggerCount(0)
+	, _Sent()
+{
+}
+
+void scMessageBatcher_test::LoopbackDriver::Initialize( scDeviceManager* pDm )
+{
+	scRingBuffer* pIn = new scRingBuffer( 16, new uint8_t[16], NULL );
+	scRingBuffer* pOut = new scRingBuffer( 256, new uint8_t[256], NULL );
+
+	SetQueue( pIn, pOut );
+
+	scBufferIODriver::Initialize( pDm );
+}
+
+void scMessageBatcher_test::LoopbackDriver::TriggerSend(void)
+{
+	_nTriggerCount++;
+	while( _pQueueOut->InUse() > 0 )
+	{
+		uint32_t nNumber = _pQueueOut->ReadStart();
+		_Sent.insert( _Sent.end(), _pQueueOut->ReadBlock(), _pQueueOut->ReadBlock() + nNumber );
+		_pQueueOut->ReadEnd( nNumber );
+	}
+}
+
+bool scMessageBatcher_test::Handler( const BatchMessage* pMessage, void* pContext )
+{
+	std::vector<uint8_t>* pLog = reinterpret_cast<std::vector<uint8_t>*>( pContext );
+	pLog->push_back( (uint8_t)pMessage->GetID() );
+	pLog->push_back( pMessage->Payload()[0] );
+	return false;
+}
+
+uint32_t scMessageBatcher_test::Ticks( void )
+{
+	return _nTicks;
+}
+
+scMessageBatcher_test::scMessageBatcher_test()
+	: _Lock()
+	, _NewOp()
+	, _Memory( &_NewOp )
+	, _pDm( NULL )
+	, _pDriver( NULL )
+	, _pFactory( NULL )
+	, _pRouter( NULL )
+	, _pBatcher( NULL )
+	, _Received()
+{
+}
+
+scMessageBatcher_test::~scMessageBatcher_test()
+{
+}
+
+void scMessageBatcher_test::SetUp()
+{
+	_nTicks = 0;
+
+	_pDm = new testDM();
+	_pDriver = new LoopbackDriver();
+	_pDm->Add( _pDriver );
+	_pDm->Initialize();
+	_pDriver->Enable();
+
+	_pFactory = new BatchFactory( 10, 400 );
+	_pFactory->Initialize( _Memory, _Memory, &_Lock );
+
+	_pRouter = new Router_t( 4, 4, 4 );
+	_pRouter->Initialize( _Memory, &_Lock, _pFactory );
+	_pRouter->Register( scROUTE_ANY, scROUTE_ANY, &Handler, &_Received );
+
+	_pBatcher = new Batcher_t( 2, 128, msg_Container );
+	EXPECT_EQ( ERROR_SUCCESS, _pBatcher->Initialize( _Memory, &_Lock, _pDriver ) );
+	_pBatcher->SetReceiver( _pFactory, _pRouter );
+}
+
+void scMessageBatcher_test::TearDown()
+{
+	delete _pBatcher;
+	delete _pRouter;
+	delete _pFactory;
+	delete _pDm;
+}
+
+uint16_t scMessageBatcher_test::Loopback(void)
+{
+	uint16_t nResult = 0;
+	uint32_t nOffset = 0;
+	while( nOffset < _pDriver->_Sent.size() )
+	{
+		uint8_t*		pFrame = &_pDriver->_Sent[nOffset];
+		BatchMessage*	pMessage = _pFactory->Create( pFrame, (uint32_t)_pDriver->_Sent.size() - nOffset );
+		nOffset += pMessage->LengthOfMessage();
+		nResult += _pBatcher->Receive( pMessage );
+		_pFactory->Release( pMessage );
+	}
+	_pDriver->_Sent.clear();
+	return nResult;
+}
+
+void scMessageBatcher_test::BatchTest()
+{
+	BatchMessage* pMsg;
+
+	// five small messages to the same place stay in the batch
+	for( uint8_t i=0; i < 5; ++i )
+	{
+		pMsg = _pFactory->Build( 1, msg_Sample, 2, i );
+		EXPECT_EQ( ERROR_SUCCESS, _pBatcher->Send( pMsg ) );
+		_pFactory->Release( pMsg );
+	}
+	EXPECT_EQ( 0, _pDriver->_nTriggerCount );
+
+	// one transmission, one header for all of them
+	_pBatcher->Flush();
+	EXPECT_EQ( 1, _pDriver->_nTriggerCount );
+	ASSERT_EQ( sizeof(scStandardHeader_t) + 5 * 16, _pDriver->_Sent.size() );
+	EXPECT_EQ( STANDARD_HEADER_FLAG_BATCH, _pDriver->_Sent[1] );
+	EXPECT_EQ( 1, _pBatcher->ContainersSent() );
+	EXPECT_EQ( 5, _pBatcher->MessagesBatched() );
+
+	// the receiver gets back the original messages in order
+	EXPECT_EQ( 5, Loopback() );
+	ASSERT_EQ( 10, _Received.size() );
+	for( uint8_t i=0; i < 5; ++i )
+	{
+		EXPECT_EQ( msg_Sample, _Received[i*2] );
+		EXPECT_EQ( i, _Received[i*2+1] );
+	}
+	EXPECT_EQ( 0, _pFactory->MessagesInUse() );
+
+	// a lone message is sent as is
+	_Received.clear();
+	pMsg = _pFactory->Build( 2, msg_Event, 4, 0x55 );
+	_pBatcher->Send( pMsg );
+	_pFactory->Release( pMsg );
+	_pBatcher->Flush( 2 );
+	ASSERT_EQ( sizeof(scStandardHeader_t) + 4, _pDriver->_Sent.size() );
+	EXPECT_EQ( 0, _pDriver->_Sent[1] );
+	EXPECT_EQ( 1, Loopback() );
+	EXPECT_EQ( msg_Event, _Received[0] );
+
+	// reaching the threshold sends the batch without a flush
+	_pBatcher->SetFlushThreshold( 48 );
+	for( uint8_t i=0; i < 3; ++i )
+	{
+		pMsg = _pFactory->Build( 1, msg_Sample, 2, i );
+		_pBatcher->Send( pMsg );
+		_pFactory->Release( pMsg );
+	}
+	EXPECT_EQ( sizeof(scStandardHeader_t) + 48, _pDriver->_Sent.size() );
+	_pDriver->_Sent.clear();
+
+	// a third destination pushes out the oldest batch
+	pMsg = _pFactory->Build( 1, msg_Sample, 2, 1 );
+	_pBatcher->Send( pMsg );
+	_pFactory->Release( pMsg );
+	pMsg = _pFactory->Build( 2, msg_Sample, 2, 2 );
+	_pBatcher->Send( pMsg );
+	_pFactory->Release( pMsg );
+	EXPECT_TRUE( _pDriver->_Sent.empty() );
+	pMsg = _pFactory->Build( 3, msg_Sample, 2, 3 );
+	_pBatcher->Send( pMsg );
+	_pFactory->Release( pMsg );
+	EXPECT_EQ( 16, _pDriver->_Sent.size() );
+	_pBatcher->Flush();
+	EXPECT_EQ( 48, _pDriver->_Sent.size() );
+
+	// too big to batch goes straight out
+	_pDriver->_Sent.clear();
+	pMsg = _pFactory->Build( 1, msg_Event, 200, 9 );
+	_pBatcher->Send( pMsg );
+	_pFactory->Release( pMsg );
+	EXPECT_EQ( sizeof(scStandardHeader_t) + 200, _pDriver->_Sent.size() );
+
+	// damaged container
+	_pDriver->_Sent.clear();
+	_Received.clear();
+	for( uint8_t i=0; i < 2; ++i )
+	{
+		pMsg = _pFactory->Build( 1, msg_Sample, 2, i );
+		_pBatcher->Send( pMsg );
+		_pFactory->Release( pMsg );
+	}
+	_pBatcher->Flush();
+	_pDriver->_Sent[ sizeof(scStandardHeader_t) + 16 + 3 ] ^= 0xFF;
+	EXPECT_EQ( 1, Loopback() );
+	EXPECT_EQ( 1, _pBatcher->ReceiveErrors() );
+}
+
+void scMessageBatcher_test::DeadlineTest()
+{
+	BatchMessage* pMsg;
+
+	_pBatcher->SetTickSource( &Ticks );
+	_pBatcher->SetDeadline( 10 );
+
+	pMsg = _pFactory->Build( 1, msg_Sample, 2, 1 );
+	_pBatcher->Send( pMsg );
+	_pFactory->Release( pMsg );
+
+	_nTicks = 5;
+	pMsg = _pFactory->Build( 1, msg_Sample, 2, 2 );
+	_pBatcher->Send( pMsg );
+	_pFactory->Release( pMsg );
+
+	_pBatcher->Poll();
+	EXPECT_TRUE( _pDriver->_Sent.empty() );
+
+	// the deadline runs from the first message in the batch
+	_nTicks = 10;
+	_pBatcher->Poll();
+	EXPECT_EQ( sizeof(scStandardHeader_t) + 32, _pDriver->_Sent.size() );
+	EXPECT_EQ( 2, Loopback() );
+
+	_pBatcher->Poll();
+	EXPECT_TRUE( _pDriver->_Sent.empty() );
+}
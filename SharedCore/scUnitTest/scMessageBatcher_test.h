@@ -0,0 +1,144 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+#pragma once
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"  // Brings in Google Mock.
+
+#include "scStandardHeader.h"
+#include "scStandardMessage.h"
+#include "scMessageFactory.h"
+#include "scMessageRouter.h"
+#include "scMessageBatcher.h"
+#include "scMutexNoOp.h"
+#include "scAllocator_Imp.h"
+#include "scDeviceManager.h"
+#include "HAL/scBufferedIODriver.h"
+#include <vector>
+
+using namespace ::SharedCore;
+using namespace SharedCore::HAL;
+
+// Tests for combining small messages into container messages.
+class scMessageBatcher_test : public ::testing::Test
+{
+public:
+	void BatchTest();
+	void DeadlineTest();
+
+	typedef enum
+	{
+		msg_Sample,
+		msg_Event,
+		msg_Container
+	} BatchMessages_t;
+
+	class BatchMessage : public scStandardMessage<BatchMessages_t>
+	{
+	public:
+		BatchMessage(const uint8_t* pBuffer = NULL, uint32_t nLength = 0)
+			: scStandardMessage<BatchMessages_t>( pBuffer, nLength )
+		{
+		}
+
+		BatchMessage& operator=( const BatchMessage& source )
+		{
+			if ( this != &source )
+			{
+				this->_pBuffer = source._pBuffer;
+				this->_nLength = source._nLength;
+				this->_Header = source.Header();
+			}
+			return *this;
+		}
+	};
+
+	class BatchFactory : public scMessageFactory<BatchMessage>
+	{
+	public:
+		BatchFactory( uint16_t slots, uint32_t nBytes )
+			: scMessageFactory<BatchMessage>( slots, nBytes )
+		{
+		}
+
+		/// <summary>
+		/// Create a message with a payload of nLength bytes all set to nFill.
+		/// </summary>
+		BatchMessage* Build( uint16_t nDestination, BatchMessages_t nId, uint32_t nLength, uint8_t nFill );
+	};
+
+	typedef scMessageRouter<BatchMessage>	Router_t;
+	typedef scMessageBatcher<BatchMessage>	Batcher_t;
+
+	class testDM : public scDeviceManager
+	{
+	public:
+		testDM() : scDeviceManager() {}
+	};
+
+	/// <summary>
+	/// Driver that keeps everything written to it.
+	/// </summary>
+	class LoopbackDriver : public scBufferIODriver
+	{
+	public:
+		LoopbackDriver();
+		virtual ~LoopbackDriver() {}
+
+		virtual void Initialize( scDeviceManager* pDm );
+
+		virtual void TriggerSend(void);
+
+		uint32_t				_nTriggerCount;
+		std::vector<uint8_t>	_Sent;
+	};
+
+	static bool Handler( const BatchMessage* pMessage, void* pContext );
+
+	static uint32_t Ticks( void );
+
+protected:
+	scMessageBatcher_test();
+
+	virtual ~scMessageBatcher_test();
+
+	virtual void SetUp();
+
+	virtual void TearDown();
+
+	/// <summary>
+	/// Pass the bytes captured by the driver back through the batcher.
+	/// </summary>
+	uint16_t Loopback(void);
+
+	scMutexNoOp					_Lock;
+	scAllocator_Imp				_NewOp;
+	scAllocator					_Memory;
+	testDM*						_pDm;
+	LoopbackDriver*				_pDriver;
+	BatchFactory*				_pFactory;
+	Router_t*					_pRouter;
+	Batcher_t*					_pBatcher;
+
+	std::vector<uint8_t>		_Received;
+
+	static uint32_t				_nTicks;
+};
@@ -0,0 +1,546 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+#include "gmock/gmock.h"
+#include "scMessageFragment_test.h"
+#include "scErrorCodes.h"
+
+using namespace SharedCore;
+
+uint32_t	scMessageFragment_test::_nTicks = 0;
+
+scMessageFragment_test::LoopbackDriver::LoopbackDriver( int nId )
+	: scBufferIODriver( scDeviceDescriptor(nId) )
+	, _Sent()
+{
+}
+
+void scMessageFragment_test::LoopbackDriver::Initialize( scDeviceManager* pDm )
+{
+	scRingBuffer* pIn = new scRingBuffer( 16, new uint8_t[16], NULL );
+	scRingBuffer* pOut = new scRingBuffer( 256, new uint8_t[256], NULL );
+
+	SetQueue( pIn, pOut );
+
+	scBufferIODriver::Initialize( pDm );
+}
+
+void scMessageFragment_test::LoopbackDriver::TriggerSend(void)
+{
+	while( _pQueueOut->InUse() > 0 )
+	{
+		uint32_t nNumber = _pQueueOut->ReadStart();
+		_Sent.insert( _Sent.end(), _pQueueOut->ReadBlock(), _pQueueOut->ReadBlock() + nNumber );
+		_pQueueOut->ReadEnd( nNumber );
+	}
+}
+
+uint32_t scMessageFragment_test::Ticks( void )
+{
+	return _nTicks;
+}
+
+uint32_t scMessageFragment_test::DriverSend( const FragmentMessage* pMessage, void* pContext )
+{
+	return reinterpret_cast<LoopbackDriver*>( pContext )->Send_n( pMessage->Buffer(), pMessage->LengthOfMessage() );
+}
+
+bool scMessageFragment_test::Reassemble( const FragmentMessage* pMessage, void* pContext )
+{
+	reinterpret_cast<Reassembler_t*>( pContext )->Receive( pMessage );
+	return false;
+}
+
+bool scMessageFragment_test::VectorSink::Open( uint16_t nSource, uint16_t nStream, uint16_t nId, uint32_t nTotal )
+{
+	_nOpened++;
+	_Data.clear();
+	return true;
+}
+
+uint32_t scMessageFragment_test::VectorSink::Write( uint16_t nSource, uint16_t nStream, uint32_t nOffset, const uint8_t* pData, uint32_t nLength )
+{
+	EXPECT_EQ( _Data.size(), nOffset );
+	_Data.insert( _Data.end(), pData, pData + nLength );
+	return ERROR_SUCCESS;
+}
+
+void scMessageFragment_test::VectorSink::Close( uint16_t nSource, uint16_t nStream, bool bComplete )
+{
+	if ( bComplete )
+	{
+		_nCompleted++;
+	}
+	else
+	{
+		_nAborted++;
+	}
+}
+
+scMessageFragment_test::RamBlocks::RamBlocks()
+	: scBlockMemoryIF( scDeviceDescriptor(2) )
+	, _nWrites(0)
+	, _bFail(false)
+{
+	memset( _Memory, 0, sizeof(_Memory) );
+}
+
+uint32_t scMessageFragment_test::RamBlocks::Read(uint8_t* pData, uint32_t nDataLength, uint32_t nStartAddress, uint32_t nBlockCount)
+{
+	EXPECT_LE( nBlockCount * 64, nDataLength );
+	EXPECT_LE( nStartAddress + nBlockCount, 20 );
+	memcpy( pData, &_Memory[nStartAddress * 64], nBlockCount * 64 );
+	return ERROR_SUCCESS;
+}
+
+uint32_t scMessageFragment_test::RamBlocks::Write(const uint8_t* pData, uint32_t nStartAddress, uint32_t nBlockCount)
+{
+	EXPECT_LE( nStartAddress + nBlockCount, 20 );
+	if ( _bFail )
+	{
+		return ERROR_SC_EXTERNAL_MEMORY_FAILURE;
+	}
+	memcpy( &_Memory[nStartAddress * 64], pData, nBlockCount * 64 );
+	_nWrites++;
+	return ERROR_SUCCESS;
+}
+
+scMessageFragment_test::scMessageFragment_test()
+	: _Lock()
+	, _NewOp()
+	, _Memory( &_NewOp )
+	, _pDm( NULL )
+	, _pDriver( NULL )
+	, _pReturn( NULL )
+	, _pFactory( NULL )
+{
+}
+
+scMessageFragment_test::~scMessageFragment_test()
+{
+}
+
+void scMessageFragment_test::SetUp()
+{
+	_nTicks = 0;
+
+	_pDm = new testDM();
+	_pDriver = new LoopbackDriver( 1 );
+	_pReturn = new LoopbackDriver( 3 );
+	_pDm->Add( _pDriver );
+	_pDm->Add( _pReturn );
+	_pDm->Initialize();
+	_pDriver->Enable();
+	_pReturn->Enable();
+
+	_pFactory = new FragmentFactory( 4, 400 );
+	_pFactory->Initialize( _Memory, _Memory, &_Lock );
+}
+
+void scMessageFragment_test::TearDown()
+{
+	delete _pFactory;
+	delete _pDm;
+}
+
+std::vector< std::vector<uint8_t> > scMessageFragment_test::Frames( LoopbackDriver* pDriver )
+{
+	if ( pDriver == NULL )
+	{
+		pDriver = _pDriver;
+	}
+
+	std::vector< std::vector<uint8_t> > frames;
+	uint32_t nOffset = 0;
+	while( nOffset < pDriver->_Sent.size() )
+	{
+		scStandardHeader_t header;
+		memcpy( &header, &pDriver->_Sent[nOffset], sizeof(header) );
+		uint32_t nLength = sizeof(header) + header._nLength;
+		frames.push_back( std::vector<uint8_t>( pDriver->_Sent.begin() + nOffset, pDriver->_Sent.begin() + nOffset + nLength ) );
+		nOffset += nLength;
+	}
+	pDriver->_Sent.clear();
+	return frames;
+}
+
+bool scMessageFragment_test::Deliver( Reassembler_t* pReassembler, std::vector<uint8_t>& frame )
+{
+	FragmentMessage* pMessage = _pFactory->Create( &frame[0], (uint32_t)frame.size() );
+	EXPECT_TRUE( pMessage != NULL );
+	bool bResult = pReassembler->Receive( pMessage );
+	_pFactory->Release( pMessage );
+	return bResult;
+}
+
+void scMessageFragment_test::TransferTest()
+{
+	std::vector<uint8_t> block( 1000 );
+	for( uint32_t i=0; i < block.size(); ++i )
+	{
+		block[i] = (uint8_t)( i * 7 );
+	}
+
+	VectorSink		sink;
+	Reassembler_t	reassembler( 2 );
+	Fragmenter_t	fragmenter( 100 );
+	ASSERT_EQ( ERROR_SUCCESS, reassembler.Initialize( _Memory, &_Lock, &sink ) );
+	ASSERT_EQ( ERROR_SUCCESS, fragmenter.Initialize( _pFactory, &DriverSend, _pDriver ) );
+
+	// the block is larger than any message the factory can hold
+	EXPECT_EQ( ERROR_SUCCESS, fragmenter.Send( 1, 2, msg_File, &block[0], (uint32_t)block.size() ) );
+	std::vector< std::vector<uint8_t> > frames = Frames();
+	ASSERT_EQ( 10, frames.size() );
+	EXPECT_EQ( STANDARD_HEADER_FLAG_FRAGMENT, frames[0][1] );
+
+	uint32_t nReceived = 0;
+	uint32_t nTotal = 0;
+	for( uint32_t i=0; i < frames.size(); ++i )
+	{
+		EXPECT_TRUE( Deliver( &reassembler, frames[i] ) );
+		if ( i == 4 )
+		{
+			ASSERT_TRUE( reassembler.GetProgress( 2, 0, nReceived, nTotal ) );
+			EXPECT_EQ( 500, nReceived );
+			EXPECT_EQ( 1000, nTotal );
+			EXPECT_EQ( 1, reassembler.ActiveStreams() );
+		}
+	}
+
+	EXPECT_TRUE( sink._Data == block );
+	EXPECT_EQ( 1, sink._nCompleted );
+	EXPECT_EQ( 1, reassembler.Completed() );
+	EXPECT_EQ( 0, reassembler.ActiveStreams() );
+	EXPECT_FALSE( reassembler.GetProgress( 2, 0, nReceived, nTotal ) );
+	EXPECT_EQ( 0, _pFactory->MessagesInUse() );
+
+	// an empty block still arrives
+	fragmenter.Send( 1, 2, msg_File, NULL, 0 );
+	frames = Frames();
+	ASSERT_EQ( 1, frames.size() );
+	EXPECT_TRUE( Deliver( &reassembler, frames[0] ) );
+	EXPECT_EQ( 2, sink._nCompleted );
+	EXPECT_EQ( 0, sink._Data.size() );
+
+	// ordinary messages are left alone
+	scStandardHeader<FragmentMessages_t> header;
+	header.SetId( msg_Command );
+	header.SetLength( 0 );
+	header.UpdateChecksum();
+	std::vector<uint8_t> plain( reinterpret_cast<const uint8_t*>( &header.Data() ), reinterpret_cast<const uint8_t*>( &header.Data() ) + sizeof(scStandardHeader_t) );
+	EXPECT_FALSE( Deliver( &reassembler, plain ) );
+}
+
+void scMessageFragment_test::BlockSinkTest()
+{
+	RamBlocks				device;
+	scFragmentBlockSink		sink( &device, 2, 16 );
+	Reassembler_t			reassembler( 1 );
+	Fragmenter_t			fragmenter( 50 );
+	ASSERT_EQ( ERROR_SUCCESS, sink.Initialize( _Memory ) );
+	ASSERT_EQ( ERROR_SUCCESS, reassembler.Initialize( _Memory, &_Lock, &sink ) );
+	fragmenter.Initialize( _pFactory, &DriverSend, _pDriver );
+
+	std::vector<uint8_t> block( 700 );
+	for( uint32_t i=0; i < block.size(); ++i )
+	{
+		block[i] = (uint8_t)( i + 1 );
+	}
+
+	// the data is handed over in pieces that do not line up with the fragments or
+	// the blocks, the way it would be read from a file
+	Fragmenter_t::Stream_t stream;
+	fragmenter.Begin( stream, 1, 3, msg_File, (uint32_t)block.size() );
+	for( uint32_t nOffset=0; nOffset < block.size(); nOffset += 37 )
+	{
+		uint32_t nLength = ( block.size() - nOffset < 37 ) ? (uint32_t)block.size() - nOffset : 37;
+		fragmenter.Write( stream, &block[nOffset], nLength );
+	}
+	EXPECT_TRUE( Fragmenter_t::Complete( stream ) );
+
+	std::vector< std::vector<uint8_t> > frames = Frames();
+	for( uint32_t i=0; i < frames.size(); ++i )
+	{
+		Deliver( &reassembler, frames[i] );
+	}
+
+	EXPECT_EQ( 1, reassembler.Completed() );
+	EXPECT_EQ( 700, sink.StoredLength() );
+	EXPECT_FALSE( sink.Busy() );
+	EXPECT_EQ( 11, device._nWrites );
+	EXPECT_EQ( 0, memcmp( &device._Memory[2 * 64], &block[0], block.size() ) );
+	EXPECT_EQ( 0, device._Memory[0] );
+
+	// more than the storage area holds is refused at the start
+	fragmenter.Begin( stream, 1, 3, msg_File, 16 * 64 + 1 );
+	fragmenter.Write( stream, &block[0], 10 );
+	frames = Frames();
+	ASSERT_EQ( 1, frames.size() );
+	EXPECT_TRUE( Deliver( &reassembler, frames[0] ) );
+	EXPECT_EQ( 1, reassembler.Failed() );
+	EXPECT_FALSE( sink.Busy() );
+
+	// one stream at a time
+	fragmenter.Begin( stream, 1, 3, msg_File, 200 );
+	fragmenter.Write( stream, &block[0], 50 );
+	fragmenter.Send( 1, 4, msg_File, &block[0], 50 );
+	frames = Frames();
+	ASSERT_EQ( 2, frames.size() );
+	EXPECT_TRUE( Deliver( &reassembler, frames[0] ) );
+	EXPECT_TRUE( Deliver( &reassembler, frames[1] ) );
+	EXPECT_TRUE( sink.Busy() );
+	EXPECT_EQ( 1, reassembler.ActiveStreams() );
+	EXPECT_EQ( 2, reassembler.Failed() );
+	EXPECT_EQ( 0, sink.StoredLength() );
+	fragmenter.Write( stream, &block[50], 150 );
+	frames = Frames();
+	for( uint32_t i=0; i < frames.size(); ++i )
+	{
+		Deliver( &reassembler, frames[i] );
+	}
+	EXPECT_EQ( 200, sink.StoredLength() );
+
+	// the last block fails to write when the stream closes
+	device._bFail = true;
+	fragmenter.Send( 1, 3, msg_File, &block[0], 30 );
+	frames = Frames();
+	ASSERT_EQ( 1, frames.size() );
+	EXPECT_TRUE( Deliver( &reassembler, frames[0] ) );
+	EXPECT_FALSE( sink.Busy() );
+	EXPECT_EQ( 0, sink.StoredLength() );
+	EXPECT_EQ( ERROR_SC_EXTERNAL_MEMORY_FAILURE, sink.GetLastError() );
+}
+
+void scMessageFragment_test::LossTest()
+{
+	std::vector<uint8_t> block( 500, 0x5A );
+
+	VectorSink		sink;
+	Reassembler_t	reassembler( 2 );
+	Fragmenter_t	fragmenter( 100 );
+	reassembler.Initialize( _Memory, &_Lock, &sink );
+	fragmenter.Initialize( _pFactory, &DriverSend, _pDriver );
+
+	// a repeated fragment is ignored
+	fragmenter.Send( 1, 2, msg_File, &block[0], (uint32_t)block.size() );
+	std::vector< std::vector<uint8_t> > frames = Frames();
+	ASSERT_EQ( 5, frames.size() );
+	Deliver( &reassembler, frames[0] );
+	Deliver( &reassembler, frames[1] );
+	Deliver( &reassembler, frames[1] );
+	Deliver( &reassembler, frames[0] );
+	for( uint32_t i=2; i < frames.size(); ++i )
+	{
+		Deliver( &reassembler, frames[i] );
+	}
+	EXPECT_EQ( 1, sink._nCompleted );
+	EXPECT_TRUE( sink._Data == block );
+
+	// sending the finished stream again does not open it or deliver a second copy
+	for( uint32_t i=0; i < frames.size(); ++i )
+	{
+		EXPECT_TRUE( Deliver( &reassembler, frames[i] ) );
+		EXPECT_EQ( 0, reassembler.ActiveStreams() );
+	}
+	EXPECT_EQ( 1, sink._nOpened );
+	EXPECT_EQ( 1, sink._nCompleted );
+	EXPECT_EQ( 0, reassembler.Failed() );
+
+	// a missing fragment aborts the stream and the rest is ignored
+	fragmenter.Send( 1, 2, msg_File, &block[0], (uint32_t)block.size() );
+	frames = Frames();
+	for( uint32_t i=0; i < frames.size(); ++i )
+	{
+		if ( i != 2 )
+		{
+			EXPECT_TRUE( Deliver( &reassembler, frames[i] ) );
+		}
+	}
+	EXPECT_EQ( 1, sink._nAborted );
+	EXPECT_EQ( 1, sink._nCompleted );
+	EXPECT_EQ( 1, reassembler.Failed() );
+	EXPECT_EQ( 0, reassembler.ActiveStreams() );
+
+	// only as many streams as there are slots
+	Fragmenter_t::Stream_t streams[3];
+	for( uint8_t i=0; i < 3; ++i )
+	{
+		fragmenter.Begin( streams[i], 1, 2, msg_File, 200 );
+		fragmenter.Write( streams[i], &block[0], 100 );
+	}
+	frames = Frames();
+	ASSERT_EQ( 3, frames.size() );
+	for( uint32_t i=0; i < frames.size(); ++i )
+	{
+		Deliver( &reassembler, frames[i] );
+	}
+	EXPECT_EQ( 2, reassembler.ActiveStreams() );
+	EXPECT_EQ( 2, reassembler.Failed() );
+
+	// streams that stop arriving time out
+	reassembler.SetTimeout( 10 );
+	reassembler.SetTickSource( &Ticks );
+	_nTicks = 100;
+	reassembler.Poll();
+	EXPECT_EQ( 0, reassembler.ActiveStreams() );
+	EXPECT_EQ( 4, reassembler.Failed() );
+}
+
+void scMessageFragment_test::RestartTest()
+{
+	std::vector<uint8_t> block( 300, 0x11 );
+	std::vector<uint8_t> other( 300, 0x22 );
+
+	VectorSink		sink;
+	Reassembler_t	reassembler( 2 );
+	reassembler.Initialize( _Memory, &_Lock, &sink );
+	reassembler.SetTimeout( 10 );
+	reassembler.SetTickSource( &Ticks );
+
+	Fragmenter_t*	pFragmenter = new Fragmenter_t( 100 );
+	pFragmenter->Initialize( _pFactory, &DriverSend, _pDriver );
+	pFragmenter->Send( 1, 2, msg_File, &block[0], (uint32_t)block.size() );
+	std::vector< std::vector<uint8_t> > frames = Frames();
+	for( uint32_t i=0; i < frames.size(); ++i )
+	{
+		Deliver( &reassembler, frames[i] );
+	}
+	EXPECT_EQ( 1, sink._nCompleted );
+
+	// a repeat within the timeout is still recognized
+	_nTicks = 5;
+	EXPECT_TRUE( Deliver( &reassembler, frames[0] ) );
+	EXPECT_EQ( 0, reassembler.ActiveStreams() );
+	EXPECT_EQ( 1, sink._nOpened );
+
+	// the sender restarts and numbers its streams from 0 again
+	delete pFragmenter;
+	pFragmenter = new Fragmenter_t( 100 );
+	pFragmenter->Initialize( _pFactory, &DriverSend, _pDriver );
+
+	// a block of another size is a new stream at once
+	pFragmenter->Send( 1, 2, msg_File, &other[0], 150 );
+	frames = Frames();
+	for( uint32_t i=0; i < frames.size(); ++i )
+	{
+		Deliver( &reassembler, frames[i] );
+	}
+	EXPECT_EQ( 2, sink._nCompleted );
+	EXPECT_TRUE( sink._Data == std::vector<uint8_t>( 150, 0x22 ) );
+
+	// a block of the same size once the timeout has passed
+	delete pFragmenter;
+	pFragmenter = new Fragmenter_t( 100 );
+	pFragmenter->Initialize( _pFactory, &DriverSend, _pDriver );
+	_nTicks = 30;
+	reassembler.Poll();
+	pFragmenter->Send( 1, 2, msg_File, &other[0], (uint32_t)other.size() );
+	frames = Frames();
+	for( uint32_t i=0; i < frames.size(); ++i )
+	{
+		Deliver( &reassembler, frames[i] );
+	}
+	EXPECT_EQ( 3, sink._nCompleted );
+	EXPECT_TRUE( sink._Data == other );
+	EXPECT_EQ( 0, reassembler.Failed() );
+
+	delete pFragmenter;
+}
+
+void scMessageFragment_test::LinkTest()
+{
+	std::vector<uint8_t> block( 500 );
+	for( uint32_t i=0; i < block.size(); ++i )
+	{
+		block[i] = (uint8_t)( i * 3 );
+	}
+
+	// the window holds every fragment until it is acknowledged
+	FragmentFactory		factory( 16, 2000 );
+	factory.Initialize( _Memory, _Memory, &_Lock );
+
+	VectorSink			sink;
+	Reassembler_t		reassembler( 2 );
+	Router_t			router( 4, 4, 4 );
+	Link_t				sender( 8, 2, msg_Command );
+	Link_t				receiver( 8, 1, msg_Command );
+	Fragmenter_t		fragmenter( 100 );
+	reassembler.Initialize( _Memory, &_Lock, &sink );
+	router.Initialize( _Memory, &_Lock, &factory );
+	router.Register( scROUTE_ANY, msg_File, &Reassemble, &reassembler );
+	ASSERT_EQ( ERROR_SUCCESS, sender.Initialize( _Memory, &_Lock, _pDriver, &factory, NULL ) );
+	ASSERT_EQ( ERROR_SUCCESS, receiver.Initialize( _Memory, &_Lock, _pReturn, &factory, &router ) );
+	ASSERT_EQ( ERROR_SUCCESS, fragmenter.Initialize( &factory, &sender ) );
+
+	EXPECT_EQ( ERROR_SUCCESS, fragmenter.Send( 1, 2, msg_File, &block[0], (uint32_t)block.size() ) );
+	EXPECT_EQ( 5, sender.Outstanding() );
+
+	// the third fragment is lost on the way
+	std::vector< std::vector<uint8_t> > frames = Frames();
+	ASSERT_EQ( 5, frames.size() );
+	for( uint32_t i=0; i < frames.size(); ++i )
+	{
+		EXPECT_EQ( STANDARD_HEADER_FLAG_FRAGMENT | STANDARD_HEADER_FLAG_RELIABLE, frames[i][1] );
+		if ( i != 2 )
+		{
+			FragmentMessage* pMessage = factory.Create( &frames[i][0], (uint32_t)frames[i].size() );
+			receiver.Receive( pMessage );
+			factory.Release( pMessage );
+		}
+	}
+	EXPECT_EQ( 0, sink._nAborted );
+	EXPECT_EQ( 0, sink._nCompleted );
+
+	// the acknowledges and the negative acknowledge bring the rest again
+	for( int nRound=0; nRound < 4 && sender.Outstanding() > 0; ++nRound )
+	{
+		std::vector< std::vector<uint8_t> > control = Frames( _pReturn );
+		for( uint32_t i=0; i < control.size(); ++i )
+		{
+			FragmentMessage* pMessage = factory.Create( &control[i][0], (uint32_t)control[i].size() );
+			sender.Receive( pMessage );
+			factory.Release( pMessage );
+		}
+
+		frames = Frames();
+		for( uint32_t i=0; i < frames.size(); ++i )
+		{
+			FragmentMessage* pMessage = factory.Create( &frames[i][0], (uint32_t)frames[i].size() );
+			receiver.Receive( pMessage );
+			factory.Release( pMessage );
+		}
+	}
+
+	EXPECT_EQ( 0, sender.Outstanding() );
+	EXPECT_LT( 0, sender.Retransmits() );
+	EXPECT_EQ( 1, sink._nCompleted );
+	EXPECT_EQ( 0, sink._nAborted );
+	EXPECT_TRUE( sink._Data == block );
+	EXPECT_EQ( 0, factory.MessagesInUse() );
+
+	// a full window stops the stream where it is, the rest is written once there is room
+	Link_t					narrow( 2, 2, msg_Command );
+	Fragmenter_t::Stream_t	stream;
+	narrow.Initialize( _Memory, &_Lock, _pDriver, &factory, NULL );
+	fragmenter.Initialize( &factory, &narrow );
+	fragmenter.Begin( stream, 1, 2, msg_File, (uint32_t)block.size() );
+	EXPECT_EQ( ERROR_SC_WINDOW_FULL, fragmenter.Write( stream, &block[0], (uint32_t)block.size() ) );
+	EXPECT_EQ( 200, stream._nOffset );
+	EXPECT_EQ( 2, Frames().size() );
+}
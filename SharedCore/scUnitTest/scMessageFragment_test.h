@@ -0,0 +1,192 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+#pragma once
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"  // Brings in Google Mock.
+
+#include "scStandardHeader.h"
+#include "scStandardMessage.h"
+#include "scMessageFactory.h"
+#include "scMessageFragmenter.h"
+#include "scMessageReassembler.h"
+#include "scFragmentBlockSink.h"
+#include "scMessageRouter.h"
+#include "scReliableLink.h"
+#include "scMutexNoOp.h"
+#include "scAllocator_Imp.h"
+#include "scDeviceManager.h"
+#include "HAL/scBufferedIODriver.h"
+#include "HAL/scBlockMemoryIF.h"
+#include <vector>
+
+using namespace ::SharedCore;
+using namespace SharedCore::HAL;
+
+// Tests for sending large blocks as a series of fragments.
+class scMessageFragment_test : public ::testing::Test
+{
+public:
+	void TransferTest();
+	void BlockSinkTest();
+	void LossTest();
+	void RestartTest();
+	void LinkTest();
+
+	typedef enum
+	{
+		msg_Command,
+		msg_File
+	} FragmentMessages_t;
+
+	class FragmentMessage : public scStandardMessage<FragmentMessages_t>
+	{
+	public:
+		FragmentMessage(const uint8_t* pBuffer = NULL, uint32_t nLength = 0)
+			: scStandardMessage<FragmentMessages_t>( pBuffer, nLength )
+		{
+		}
+
+		FragmentMessage& operator=( const FragmentMessage& source )
+		{
+			if ( this != &source )
+			{
+				this->_pBuffer = source._pBuffer;
+				this->_nLength = source._nLength;
+				this->_Header = source.Header();
+			}
+			return *this;
+		}
+	};
+
+	class FragmentFactory : public scMessageFactory<FragmentMessage>
+	{
+	public:
+		FragmentFactory( uint16_t slots, uint32_t nBytes )
+			: scMessageFactory<FragmentMessage>( slots, nBytes )
+		{
+		}
+	};
+
+	typedef scMessageFragmenter<FragmentMessage>	Fragmenter_t;
+	typedef scMessageReassembler<FragmentMessage>	Reassembler_t;
+	typedef scMessageRouter<FragmentMessage>		Router_t;
+	typedef scReliableLink<FragmentMessage>			Link_t;
+
+	class testDM : public scDeviceManager
+	{
+	public:
+		testDM() : scDeviceManager() {}
+	};
+
+	/// <summary>
+	/// Driver that keeps everything written to it.
+	/// </summary>
+	class LoopbackDriver : public scBufferIODriver
+	{
+	public:
+		LoopbackDriver( int nId );
+		virtual ~LoopbackDriver() {}
+
+		virtual void Initialize( scDeviceManager* pDm );
+
+		virtual void TriggerSend(void);
+
+		std::vector<uint8_t>	_Sent;
+	};
+
+	/// <summary>
+	/// Sink that keeps the data of one stream in memory.
+	/// </summary>
+	class VectorSink : public scIFragmentSink
+	{
+	public:
+		VectorSink() : _nOpened(0), _nCompleted(0), _nAborted(0), _Data() {}
+
+		virtual bool Open( uint16_t nSource, uint16_t nStream, uint16_t nId, uint32_t nTotal );
+		virtual uint32_t Write( uint16_t nSource, uint16_t nStream, uint32_t nOffset, const uint8_t* pData, uint32_t nLength );
+		virtual void Close( uint16_t nSource, uint16_t nStream, bool bComplete );
+
+		uint32_t				_nOpened;
+		uint32_t				_nCompleted;
+		uint32_t				_nAborted;
+		std::vector<uint8_t>	_Data;
+	};
+
+	/// <summary>
+	/// Block device kept in memory.
+	/// </summary>
+	class RamBlocks : public scBlockMemoryIF
+	{
+	public:
+		RamBlocks();
+
+		virtual uint32_t Read(uint8_t* pData, uint32_t nDataLength, uint32_t nStartAddress, uint32_t nBlockCount);
+		virtual uint32_t Write(const uint8_t* pData, uint32_t nStartAddress, uint32_t nBlockCount);
+		virtual uint32_t DefaultBlockSize(void) const { return 64; }
+		virtual const uint64_t TotalSizeBytes(void) const { return 64 * 20; }
+		virtual uint32_t TotalSizeBlocks(void) const { return 20; }
+		virtual uint32_t BulkErase( uint32_t nStartSector, uint32_t nCount, bool bWait ) { return ERROR_SC_DEVICE_FEATURE_UNSUPPORTED; }
+
+		uint32_t				_nWrites;
+		bool					_bFail;
+		uint8_t					_Memory[64 * 20];
+	};
+
+	static uint32_t Ticks( void );
+
+	/// <summary>
+	/// Send hook writing the fragments straight to a LoopbackDriver.
+	/// </summary>
+	static uint32_t DriverSend( const FragmentMessage* pMessage, void* pContext );
+
+	/// <summary>
+	/// Router handler passing the fragments to a reassembler.
+	/// </summary>
+	static bool Reassemble( const FragmentMessage* pMessage, void* pContext );
+
+protected:
+	scMessageFragment_test();
+
+	virtual ~scMessageFragment_test();
+
+	virtual void SetUp();
+
+	virtual void TearDown();
+
+	/// <summary>
+	/// Split the bytes captured by the driver into frames.
+	/// </summary>
+	std::vector< std::vector<uint8_t> > Frames( LoopbackDriver* pDriver = NULL );
+
+	/// <summary>
+	/// Pass one frame to the reassembler.
+	/// </summary>
+	bool Deliver( Reassembler_t* pReassembler, std::vector<uint8_t>& frame );
+
+	scMutexNoOp					_Lock;
+	scAllocator_Imp				_NewOp;
+	scAllocator					_Memory;
+	testDM*						_pDm;
+	LoopbackDriver*				_pDriver;
+	LoopbackDriver*				_pReturn;
+	FragmentFactory*			_pFactory;
+
+	static uint32_t				_nTicks;
+};
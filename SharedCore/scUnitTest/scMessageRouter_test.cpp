@@ -0,0 +1,297 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+
+#include "gmock/gmock.h"
+#include "scMessageRouter_test.h"
+#include "scErrorCodes.h"
+
+using namespace SharedCore;
+
+int			scMessageRouter_test::_nOrder = 0;
+uint32_t	scMessageRouter_test::_nTicks = 0;
+
+scMessageRouter_test::RouterMessage* scMessageRouter_test::RouterFactory::Build( uint16_t nDestination, RouterMessages_t nId )
+{
+	RouterMessage* pMessage = Create( sizeof(scStandardHeader_t) );
+	if ( pMessage != NULL )
+	{
+		scStandardHeader_t		local;
+		memset( &local, 0, sizeof(local) );
+		local._prefix = STANDARD_HEADER_PREFIX;
+		local._nDestination = nDestination;
+		local._nSource = 1;
+		local._nMessageID = (uint16_t)nId;
+		local._nCheckSum = scStandardHeader<RouterMessages_t>( local ).ComputeChecksum();
+
+		uint8_t* pBuffer = const_cast<uint8_t*>( pMessage->Buffer() );
+		memcpy( pBuffer, &local, sizeof(local) );
+		*pMessage = RouterMessage( pBuffer, sizeof(scStandardHeader_t) );
+	}
+	return pMessage;
+}
+
+bool scMessageRouter_test::Handler( const RouterMessage* pMessage, void* pContext )
+{
+	HandlerLog_t* pLog = reinterpret_cast<HandlerLog_t*>( pContext );
+	pLog->_nCalls++;
+	pLog->_pLast = pMessage;
+	pLog->_nOrder = _nOrder++;
+	_nTicks += 5;
+	return pLog->_bKeep;
+}
+
+bool scMessageRouter_test::Replacer( const RouterMessage* pMessage, void* pContext )
+{
+	Replace_t* pReplace = reinterpret_cast<Replace_t*>( pContext );
+	if ( pReplace->_nReplaced == scROUTE_INVALID )
+	{
+		pReplace->_pRouter->Unregister( pReplace->_nRoute );
+		pReplace->_nReplaced = pReplace->_pRouter->Register(
+			pMessage->Header().Destination(), (uint16_t)pMessage->GetID(), &Replacer, pContext );
+	}
+	return false;
+}
+
+uint32_t scMessageRouter_test::Ticks( void )
+{
+	return _nTicks;
+}
+
+scMessageRouter_test::scMessageRouter_test()
+	: _Lock()
+	, _NewOp()
+	, _Memory( &_NewOp )
+	, _pFactory( NULL )
+	, _pRouter( NULL )
+{
+}
+
+scMessageRouter_test::~scMessageRouter_test()
+{
+}
+
+void scMessageRouter_test::SetUp()
+{
+	_nOrder = 0;
+	_nTicks = 0;
+	_pFactory = new RouterFactory( 10, 200 );
+	_pFactory->Initialize( _Memory, _Memory, &_Lock );
+	_pRouter = new Router_t( 4, 8, 6 );
+	EXPECT_EQ( ERROR_SUCCESS, _pRouter->Initialize( _Memory, &_Lock, _pFactory ) );
+}
+
+void scMessageRouter_test::TearDown()
+{
+	delete _pRouter;
+	delete _pFactory;
+}
+
+void scMessageRouter_test::RouteTest()
+{
+	HandlerLog_t	ping = { 0, false, NULL, -1 };
+	HandlerLog_t	pong = { 0, false, NULL, -1 };
+
+	_pRouter->SetTickSource( &Ticks );
+
+	uint16_t nPing = _pRouter->Register( 1, msg_Ping, &Handler, &ping );
+	uint16_t nPong = _pRouter->Register( 1, msg_Pong, &Handler, &pong );
+	EXPECT_NE( scROUTE_INVALID, nPing );
+	EXPECT_NE( scROUTE_INVALID, nPong );
+
+	// outside of the table
+	EXPECT_EQ( scROUTE_INVALID, _pRouter->Register( 4, msg_Ping, &Handler, &ping ) );
+	EXPECT_EQ( ERROR_SC_ROUTE_OUT_OF_RANGE, _pRouter->GetLastError() );
+
+	RouterMessage* pMsg = _pFactory->Build( 1, msg_Ping );
+	ASSERT_TRUE( pMsg != NULL );
+	EXPECT_EQ( 1, _pRouter->Dispatch( pMsg ) );
+	EXPECT_EQ( 1, _pRouter->Dispatch( pMsg ) );
+	EXPECT_EQ( 2, ping._nCalls );
+	EXPECT_EQ( 0, pong._nCalls );
+	EXPECT_EQ( pMsg, ping._pLast );
+
+	// the router gave back every reference it took
+	EXPECT_EQ( 1, _pFactory->MessagesInUse() );
+	EXPECT_TRUE( _pFactory->Release( pMsg ) );
+	EXPECT_EQ( 0, _pFactory->MessagesInUse() );
+
+	// nothing registered for this destination
+	pMsg = _pFactory->Build( 2, msg_Ping );
+	EXPECT_EQ( 0, _pRouter->Dispatch( pMsg ) );
+	EXPECT_EQ( 1, _pRouter->Unrouted() );
+	_pFactory->Release( pMsg );
+
+	Router_t::RouteStats_t stats;
+	EXPECT_TRUE( _pRouter->GetRouteStats( nPing, stats ) );
+	EXPECT_EQ( 2, stats._nHits );
+	EXPECT_EQ( 10, stats._nTotalTicks );
+	EXPECT_EQ( 5, stats._nMaxTicks );
+
+	EXPECT_TRUE( _pRouter->GetRouteStats( nPong, stats ) );
+	EXPECT_EQ( 0, stats._nHits );
+
+	_pRouter->DebugDump();
+
+	// removing the route stops the delivery
+	EXPECT_TRUE( _pRouter->Unregister( nPing ) );
+	EXPECT_FALSE( _pRouter->Unregister( nPing ) );
+	EXPECT_FALSE( _pRouter->GetRouteStats( nPing, stats ) );
+	pMsg = _pFactory->Build( 1, msg_Ping );
+	EXPECT_EQ( 0, _pRouter->Dispatch( pMsg ) );
+	EXPECT_EQ( 2, ping._nCalls );
+	_pFactory->Release( pMsg );
+
+	// the freed slot is reused
+	EXPECT_EQ( nPing, _pRouter->Register( 0, msg_Status, &Handler, &ping ) );
+
+	_pRouter->ResetStats();
+	EXPECT_EQ( 0, _pRouter->Unrouted() );
+}
+
+void scMessageRouter_test::WildcardTest()
+{
+	HandlerLog_t	exact = { 0, false, NULL, -1 };
+	HandlerLog_t	dest = { 0, false, NULL, -1 };
+	HandlerLog_t	id = { 0, false, NULL, -1 };
+	HandlerLog_t	any = { 0, false, NULL, -1 };
+
+	// registered in the reverse of the delivery order
+	_pRouter->Register( scROUTE_ANY, scROUTE_ANY, &Handler, &any );
+	_pRouter->Register( scROUTE_ANY, msg_Status, &Handler, &id );
+	_pRouter->Register( 3, scROUTE_ANY, &Handler, &dest );
+	_pRouter->Register( 3, msg_Status, &Handler, &exact );
+
+	RouterMessage* pMsg = _pFactory->Build( 3, msg_Status );
+	EXPECT_EQ( 4, _pRouter->Dispatch( pMsg ) );
+	EXPECT_EQ( 0, exact._nOrder );
+	EXPECT_EQ( 1, dest._nOrder );
+	EXPECT_EQ( 2, id._nOrder );
+	EXPECT_EQ( 3, any._nOrder );
+	_pFactory->Release( pMsg );
+
+	// destination outside of the table only reaches the wildcards
+	pMsg = _pFactory->Build( 500, msg_Status );
+	EXPECT_EQ( 2, _pRouter->Dispatch( pMsg ) );
+	EXPECT_EQ( 2, id._nCalls );
+	EXPECT_EQ( 2, any._nCalls );
+	_pFactory->Release( pMsg );
+
+	// message ID outside of the table
+	pMsg = _pFactory->Build( 3, msg_Unknown );
+	EXPECT_EQ( 2, _pRouter->Dispatch( pMsg ) );
+	EXPECT_EQ( 2, dest._nCalls );
+	EXPECT_EQ( 3, any._nCalls );
+	EXPECT_EQ( 1, exact._nCalls );
+	_pFactory->Release( pMsg );
+
+	EXPECT_EQ( 0, _pRouter->Unrouted() );
+	EXPECT_EQ( 0, _pFactory->MessagesInUse() );
+}
+
+void scMessageRouter_test::FanOutTest()
+{
+	HandlerLog_t	first = { 0, false, NULL, -1 };
+	HandlerLog_t	keeper = { 0, true, NULL, -1 };
+	HandlerLog_t	last = { 0, false, NULL, -1 };
+
+	_pRouter->Register( 2, msg_Pong, &Handler, &first );
+	_pRouter->Register( 2, msg_Pong, &Handler, &keeper );
+	_pRouter->Register( 2, msg_Pong, &Handler, &last );
+
+	RouterMessage* pMsg = _pFactory->Build( 2, msg_Pong );
+	EXPECT_EQ( 3, _pRouter->Dispatch( pMsg ) );
+	EXPECT_EQ( 0, first._nOrder );
+	EXPECT_EQ( 1, keeper._nOrder );
+	EXPECT_EQ( 2, last._nOrder );
+
+	// the caller and the keeper each hold a reference
+	EXPECT_FALSE( _pFactory->Release( pMsg ) );
+	EXPECT_EQ( 1, _pFactory->MessagesInUse() );
+	EXPECT_TRUE( _pFactory->Release( keeper._pLast ) );
+	EXPECT_EQ( 0, _pFactory->MessagesInUse() );
+
+	// the table is full after three more
+	EXPECT_NE( scROUTE_INVALID, _pRouter->Register( 0, msg_Ping, &Handler, &first ) );
+	EXPECT_NE( scROUTE_INVALID, _pRouter->Register( 0, msg_Ping, &Handler, &first ) );
+	EXPECT_NE( scROUTE_INVALID, _pRouter->Register( 0, msg_Ping, &Handler, &first ) );
+	EXPECT_EQ( scROUTE_INVALID, _pRouter->Register( 0, msg_Ping, &Handler, &first ) );
+	EXPECT_EQ( ERROR_SC_ROUTE_TABLE_FULL, _pRouter->GetLastError() );
+}
+
+void scMessageRouter_test::FanOutLimitTest()
+{
+	HandlerLog_t	log = { 0, false, NULL, -1 };
+	Router_t		router( 4, 8, 16 );
+
+	EXPECT_EQ( ERROR_SUCCESS, router.Initialize( _Memory, &_Lock, _pFactory ) );
+
+	// fill the fan out of 1:msg_Ping across the exact and the wildcard cells
+	for( int i=0; i < scROUTE_MAX_FANOUT - 2; ++i )
+	{
+		EXPECT_NE( scROUTE_INVALID, router.Register( 1, msg_Ping, &Handler, &log ) );
+	}
+	EXPECT_NE( scROUTE_INVALID, router.Register( 1, scROUTE_ANY, &Handler, &log ) );
+	EXPECT_NE( scROUTE_INVALID, router.Register( scROUTE_ANY, scROUTE_ANY, &Handler, &log ) );
+
+	// anything else that 1:msg_Ping would match is refused
+	EXPECT_EQ( scROUTE_INVALID, router.Register( 1, msg_Ping, &Handler, &log ) );
+	EXPECT_EQ( ERROR_SC_ROUTE_FANOUT_LIMIT, router.GetLastError() );
+	EXPECT_EQ( scROUTE_INVALID, router.Register( 1, scROUTE_ANY, &Handler, &log ) );
+	EXPECT_EQ( scROUTE_INVALID, router.Register( scROUTE_ANY, msg_Ping, &Handler, &log ) );
+	EXPECT_EQ( scROUTE_INVALID, router.Register( scROUTE_ANY, scROUTE_ANY, &Handler, &log ) );
+	EXPECT_EQ( ERROR_SC_ROUTE_FANOUT_LIMIT, router.GetLastError() );
+
+	// routes that do not reach 1:msg_Ping are still accepted
+	EXPECT_NE( scROUTE_INVALID, router.Register( 1, msg_Pong, &Handler, &log ) );
+	EXPECT_NE( scROUTE_INVALID, router.Register( 2, scROUTE_ANY, &Handler, &log ) );
+	EXPECT_NE( scROUTE_INVALID, router.Register( scROUTE_ANY, msg_Status, &Handler, &log ) );
+
+	// every route is delivered, none are dropped by the fan out limit
+	RouterMessage* pMsg = _pFactory->Build( 1, msg_Ping );
+	EXPECT_EQ( scROUTE_MAX_FANOUT, router.Dispatch( pMsg ) );
+	EXPECT_EQ( scROUTE_MAX_FANOUT, log._nCalls );
+	_pFactory->Release( pMsg );
+	EXPECT_EQ( 0, _pFactory->MessagesInUse() );
+}
+
+void scMessageRouter_test::ReplaceTest()
+{
+	Replace_t replace = { _pRouter, scROUTE_INVALID, scROUTE_INVALID };
+
+	replace._nRoute = _pRouter->Register( 1, msg_Ping, &Replacer, &replace );
+	ASSERT_NE( scROUTE_INVALID, replace._nRoute );
+
+	// the handler swaps its route for a new one in the same slot
+	RouterMessage* pMsg = _pFactory->Build( 1, msg_Ping );
+	EXPECT_EQ( 1, _pRouter->Dispatch( pMsg ) );
+	EXPECT_EQ( replace._nRoute, replace._nReplaced );
+
+	// the hit belonged to the removed route, the new one starts from nothing
+	Router_t::RouteStats_t stats;
+	EXPECT_TRUE( _pRouter->GetRouteStats( replace._nReplaced, stats ) );
+	EXPECT_EQ( 0, stats._nHits );
+
+	EXPECT_EQ( 1, _pRouter->Dispatch( pMsg ) );
+	EXPECT_TRUE( _pRouter->GetRouteStats( replace._nReplaced, stats ) );
+	EXPECT_EQ( 1, stats._nHits );
+	_pFactory->Release( pMsg );
+	EXPECT_EQ( 0, _pFactory->MessagesInUse() );
+}
@@ -0,0 +1,133 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+#pragma once
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"  // Brings in Google Mock.
+
+#include "scStandardHeader.h"
+#include "scStandardMessage.h"
+#include "scMessageFactory.h"
+#include "scMessageRouter.h"
+#include "scMutexNoOp.h"
+#include "scAllocator_Imp.h"
+
+using namespace ::SharedCore;
+
+// Tests for the table driven message router.
+class scMessageRouter_test : public ::testing::Test
+{
+public:
+	void RouteTest();
+	void WildcardTest();
+	void FanOutTest();
+	void FanOutLimitTest();
+	void ReplaceTest();
+
+	typedef enum
+	{
+		msg_Ping,
+		msg_Pong,
+		msg_Status,
+		msg_Unknown = 100
+	} RouterMessages_t;
+
+	class RouterMessage : public scStandardMessage<RouterMessages_t>
+	{
+	public:
+		RouterMessage(const uint8_t* pBuffer = NULL, uint32_t nLength = 0)
+			: scStandardMessage<RouterMessages_t>( pBuffer, nLength )
+		{
+		}
+
+		RouterMessage& operator=( const RouterMessage& source )
+		{
+			if ( this != &source )
+			{
+				this->_pBuffer = source._pBuffer;
+				this->_nLength = source._nLength;
+				this->_Header = source.Header();
+			}
+			return *this;
+		}
+	};
+
+	class RouterFactory : public scMessageFactory<RouterMessage>
+	{
+	public:
+		RouterFactory( uint16_t slots, uint32_t nBytes )
+			: scMessageFactory<RouterMessage>( slots, nBytes )
+		{
+		}
+
+		/// <summary>
+		/// Create a message with just the header filled in.
+		/// </summary>
+		RouterMessage* Build( uint16_t nDestination, RouterMessages_t nId );
+	};
+
+	typedef scMessageRouter<RouterMessage>	Router_t;
+
+	/// <summary>
+	/// Records the calls made into a handler.
+	/// </summary>
+	typedef struct
+	{
+		uint32_t				_nCalls;
+		bool					_bKeep;
+		const RouterMessage*	_pLast;
+		int						_nOrder;
+	} HandlerLog_t;
+
+	static bool Handler( const RouterMessage* pMessage, void* pContext );
+
+	/// <summary>
+	/// Route that replaces itself with a new route to the same handler.
+	/// </summary>
+	typedef struct
+	{
+		Router_t*				_pRouter;
+		uint16_t				_nRoute;
+		uint16_t				_nReplaced;
+	} Replace_t;
+
+	static bool Replacer( const RouterMessage* pMessage, void* pContext );
+
+	static uint32_t Ticks( void );
+
+protected:
+	scMessageRouter_test();
+
+	virtual ~scMessageRouter_test();
+
+	virtual void SetUp();
+
+	virtual void TearDown();
+
+	scMutexNoOp			_Lock;
+	scAllocator_Imp		_NewOp;
+	scAllocator			_Memory;
+	RouterFactory*		_pFactory;
+	Router_t*			_pRouter;
+
+	static int			_nOrder;
+	static uint32_t		_nTicks;
+};
@@ -405,6 +405,60 @@ void scMessage_tests::FactoryTestUsedNoOverflow()
 	delete pRingMemory;
 }
 
+// Regression test for GetLocalPointer tracking the wrong lowest record. A
+// record found later in the slot table but higher in the buffer used to become
+// the range start, so the space handed out could overlap a live message.
+void scMessage_tests::FactoryLocalRangeTest()
+{
+	MyMessage*			pMsg1;
+	MyMessage*			pMsg2;
+	MyMessage*			pMsg3;
+	MyMessage*			pMsg4;
+	MyMessage*			pMsg5;
+	scMutexNoOp			lock;
+	scAllocator_Imp*	pNewOp = new scAllocator_Imp();
+	scAllocator			memManager( pNewOp );
+	MessageFactory*		pFactory = new MessageFactory(5, 100);
+
+	EXPECT_CALL( *pFactory, PostCreateP(_)).Times(AtLeast(7));
+
+	pFactory->Initialize( memManager, memManager, &lock );
+	EXPECT_EQ( ERROR_SUCCESS, pFactory->GetLastError() );
+
+	pMsg1 = pFactory->Create( 10 );						// slot 0, 0..10
+	pMsg2 = pFactory->Create( 10 );						// slot 1, 10..20
+	pMsg3 = pFactory->Create( 20 );						// slot 2, 20..40
+	pMsg4 = pFactory->Create( 30 );						// slot 3, 40..70
+	pMsg5 = pFactory->Create( 30 );						// slot 4, 70..100
+	ASSERT_TRUE( pMsg1 != NULL && pMsg3 != NULL );
+
+	const uint8_t*	pStart = pMsg1->Buffer();
+	const uint8_t*	pEnd = pStart + 100;
+	EXPECT_EQ( pStart + 20, pMsg3->Buffer() );
+
+	EXPECT_TRUE( pFactory->Release( pMsg2 ) );
+	EXPECT_TRUE( pFactory->Release( pMsg4 ) );
+	EXPECT_TRUE( pFactory->Release( pMsg5 ) );
+
+	// slot 1 now holds the top of the buffer, ahead of slot 2 in the table
+	pMsg2 = pFactory->Create( 60 );
+	ASSERT_TRUE( pMsg2 != NULL );
+	EXPECT_EQ( pStart + 40, pMsg2->Buffer() );
+
+	// only 10 bytes are free locally so this one rolls over to the allocator
+	pMsg4 = pFactory->Create( 15 );
+	ASSERT_TRUE( pMsg4 != NULL );
+	EXPECT_TRUE( pMsg4->Buffer() < pStart || pMsg4->Buffer() >= pEnd );
+
+	EXPECT_TRUE( pFactory->Release( pMsg1 ) );
+	EXPECT_TRUE( pFactory->Release( pMsg2 ) );
+	EXPECT_TRUE( pFactory->Release( pMsg3 ) );
+	EXPECT_TRUE( pFactory->Release( pMsg4 ) );
+
+	delete pFactory;
+	delete pNewOp;
+}
+
 #define ALLOCATION_COUNT	10000
 
 void scMessage_tests::FactoryStressTest()
@@ -457,3 +511,84 @@ void scMessage_tests::FactoryStressTest()
 	delete pNewOp;
 
 }
+
+uint32_t scMessage_tests::s_nClock = 0;
+
+uint32_t scMessage_tests::Clock( void )
+{
+	return s_nClock;
+}
+
+void scMessage_tests::FactoryLatencyTest()
+{
+	scMutexNoOp			lock;
+	scAllocator_Imp*	pNewOp = new scAllocator_Imp();
+	scAllocator			memManager( pNewOp );
+	MessageFactory*		pFactory = new MessageFactory(4, 100);
+	scMessageLatency_t	latency;
+
+	EXPECT_CALL( *pFactory, PostCreateP(_)).Times(AtLeast(2));
+
+	s_nClock = 1000;
+	scHiResClock::SetCounter( &Clock, 1000000 );
+	pFactory->Initialize( memManager, memManager, &lock );
+
+	MyMessage* pMsg1 = pFactory->Create( &manual[0], sizeof( manual ) );
+	MyMessage* pMsg2 = pFactory->Create( NULL, 0 );
+	ASSERT_TRUE( pMsg1 != NULL );
+	ASSERT_TRUE( pMsg2 != NULL );
+	EXPECT_EQ( msg_Stop, pMsg1->GetID() );
+
+	// only the first time a stage is reached is kept
+	s_nClock += 50;
+	pFactory->Stamp( pMsg1, scMESSAGE_STAGE_ROUTED );
+	s_nClock += 100;
+	pFactory->Stamp( pMsg1, scMESSAGE_STAGE_ROUTED );
+	s_nClock += 150;
+	pFactory->Stamp( pMsg1, scMESSAGE_STAGE_HANDLED );
+	pFactory->Stamp( NULL, scMESSAGE_STAGE_HANDLED );
+
+	// both messages are older than the threshold
+	s_nClock += 700;
+	EXPECT_EQ( 2, pFactory->CheckLeaks( 500 ) );
+	EXPECT_EQ( 0, pFactory->CheckLeaks() );
+	EXPECT_FALSE( pFactory->Latency( msg_Stop, latency ) );
+
+	EXPECT_TRUE( pFactory->Release( pMsg1 ) );
+	EXPECT_EQ( 1, pFactory->CheckLeaks( 500 ) );
+
+	ASSERT_TRUE( pFactory->Latency( msg_Stop, latency ) );
+	EXPECT_EQ( 1, latency._nCount );
+	EXPECT_EQ( 1000, latency._nLifetime );
+	EXPECT_EQ( 1000, latency._nLifetimeMax );
+	EXPECT_EQ( 1, latency._nLifetimeBuckets[9] );
+	EXPECT_EQ( 0, latency._nStaged[scMESSAGE_STAGE_FRAMED] );
+	EXPECT_EQ( 1, latency._nStaged[scMESSAGE_STAGE_ROUTED] );
+	EXPECT_EQ( 50, latency._nStageTime[scMESSAGE_STAGE_ROUTED] );
+	EXPECT_EQ( 300, latency._nStageTime[scMESSAGE_STAGE_HANDLED] );
+	EXPECT_EQ( 50, latency._nQueueingMax );
+	EXPECT_EQ( 1, latency._nQueueingBuckets[5] );
+
+	// a slot used again starts over, the ID keeps adding up
+	pMsg1 = pFactory->Create( &manual[0], sizeof( manual ) );
+	s_nClock += 3;
+	EXPECT_TRUE( pFactory->Release( pMsg1 ) );
+	EXPECT_TRUE( pFactory->Release( pMsg2 ) );
+	EXPECT_EQ( 0, pFactory->CheckLeaks( 0 ) );
+
+	ASSERT_TRUE( pFactory->Latency( msg_Stop, latency ) );
+	EXPECT_EQ( 2, latency._nCount );
+	EXPECT_EQ( 1003, latency._nLifetime );
+	EXPECT_EQ( 1, latency._nLifetimeBuckets[1] );
+	EXPECT_EQ( 1, latency._nStaged[scMESSAGE_STAGE_ROUTED] );
+
+	ASSERT_TRUE( pFactory->Latency( msg_Start, latency ) );
+	EXPECT_EQ( 1, latency._nCount );
+	EXPECT_EQ( 1003, latency._nLifetime );
+
+	pFactory->LatencyDump( scDEBUGLABEL_INFO_MESSAGE );
+
+	scHiResClock::SetCounter( NULL, 0 );
+	delete pFactory;
+	delete pNewOp;
+}
@@ -28,6 +28,7 @@
 #include "scMessageFactory.h"
 #include "scMutexNoOp.h"
 #include "scAllocator_Imp.h"
+#include "scHiResClock.h"
 
 using namespace ::SharedCore;
 
@@ -41,7 +42,16 @@ public:
 	void FactoryTest();
 	void FactoryTestUsedAllSlots();
 	void FactoryTestUsedNoOverflow();
+	void FactoryLocalRangeTest();
 	void FactoryStressTest();
+	void FactoryLatencyTest();
+
+	/// <summary>
+	/// Clock set by the test.
+	/// </summary>
+	static uint32_t Clock( void );
+
+	static uint32_t			s_nClock;
 
 	typedef enum
 	{
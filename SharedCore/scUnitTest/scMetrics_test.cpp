@@ -0,0 +1,238 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+#include "scMetrics_test.h"
+#include "scQueueList.h"
+#include "scMutexNoOp.h"
+#include "scAllocator_Imp.h"
+#include "scDebugManager.h"
+#include "scDebugLabelManager.h"
+#include "scDebugLabelCodes.h"
+#include "scErrorCodes.h"
+#include <thread>
+#include <vector>
+
+using namespace SharedCore;
+
+static scAllocator_Imp* pAllocatorImp = new scAllocator_Imp();
+
+// Metrics of the application, they stay registered so they are static.
+static volatile uint32_t	g_LatencyBuckets[scMETRIC_BUCKETS];
+static scMetric_t			g_Requests = scMETRIC_COUNTER_INIT( "app.requests" );
+static scMetric_t			g_Sessions = scMETRIC_GAUGE_INIT( "app.sessions" );
+static scMetric_t			g_Latency = scMETRIC_HISTOGRAM_INIT( "app.latency", g_LatencyBuckets );
+
+scMetrics_test::scMetrics_test()
+{
+}
+
+scMetrics_test::~scMetrics_test()
+{
+}
+
+void scMetrics_test::SetUp()
+{
+	scMetrics::Reset();
+}
+
+uint32_t scMetrics_test::Value( const char* pName )
+{
+	scMetric_t* pMetric = scMetrics::Find( pName );
+	EXPECT_TRUE( pMetric != NULL ) << pName;
+	return ( pMetric != NULL ) ? pMetric->_nValue : 0;
+}
+
+uint32_t scMetrics_test::Peak( const char* pName )
+{
+	scMetric_t* pMetric = scMetrics::Find( pName );
+	EXPECT_TRUE( pMetric != NULL ) << pName;
+	return ( pMetric != NULL ) ? pMetric->_nPeak : 0;
+}
+
+void scMetrics_test::RegistryTest()
+{
+	EXPECT_EQ( 0, scMetrics::Bucket( 0 ) );
+	EXPECT_EQ( 0, scMetrics::Bucket( 1 ) );
+	EXPECT_EQ( 3, scMetrics::Bucket( 15 ) );
+	EXPECT_EQ( 15, scMetrics::Bucket( 0xFFFFFFFF ) );
+
+	// registering twice lists a metric once
+	scMetrics::Register( g_Requests );
+	scMetrics::Register( g_Sessions );
+	scMetrics::Register( g_Latency );
+	scMetrics::Register( g_Requests );
+	EXPECT_EQ( scMETRIC_CORE_COUNT + 3, scMetrics::Count() );
+	EXPECT_TRUE( scMetrics::Find( "app.requests" ) == &g_Requests );
+	EXPECT_TRUE( scMetrics::Find( "driver.total_bytes_out" ) == &scMetrics::Core( scMETRIC_DRIVER_TOTAL_BYTES_OUT ) );
+	EXPECT_TRUE( scMetrics::Find( "app.none" ) == NULL );
+
+	scMetrics::Add( g_Requests, 2 );
+	scMetrics::Add( g_Requests, 3 );
+	EXPECT_EQ( 5, g_Requests._nValue );
+
+	scMetrics::Add( g_Sessions, 4 );
+	scMetrics::Subtract( g_Sessions, 3 );
+	EXPECT_EQ( 1, g_Sessions._nValue );
+	EXPECT_EQ( 4, g_Sessions._nPeak );
+	scMetrics::Set( g_Sessions, 2 );
+	scMetrics::Peak( g_Sessions, 9 );
+	EXPECT_EQ( 2, g_Sessions._nValue );
+	EXPECT_EQ( 9, g_Sessions._nPeak );
+
+	scMetrics::Sample( g_Latency, 1 );
+	scMetrics::Sample( g_Latency, 10 );
+	scMetrics::Sample( g_Latency, 100 );
+	EXPECT_EQ( 3, g_Latency._nValue );
+	EXPECT_EQ( 100, g_Latency._nPeak );
+	EXPECT_EQ( 111, g_Latency._nTotal );
+
+	// a snapshot leaves the metrics alone unless it resets them
+	std::vector<scMetricSnapshot_t> snapshot( scMetrics::Count() );
+	EXPECT_EQ( snapshot.size(), scMetrics::Snapshot( &snapshot[0], (uint32_t)snapshot.size(), false ) );
+	const scMetricSnapshot_t& latency = snapshot[scMETRIC_CORE_COUNT];
+	EXPECT_STREQ( "app.latency", latency._pName );
+	EXPECT_EQ( scMETRIC_HISTOGRAM, latency._nType );
+	EXPECT_EQ( 1, latency._nBuckets[0] );
+	EXPECT_EQ( 1, latency._nBuckets[3] );
+	EXPECT_EQ( 1, latency._nBuckets[6] );
+	EXPECT_EQ( 5, g_Requests._nValue );
+
+	EXPECT_EQ( 2, scMetrics::Snapshot( &snapshot[0], 2, true ) );
+	EXPECT_STREQ( "driver.total_bytes_in", snapshot[0]._pName );
+	EXPECT_EQ( 0, g_Requests._nValue );
+	EXPECT_EQ( 0, g_Latency._nValue );
+	EXPECT_EQ( 0, g_Latency._nTotal );
+	EXPECT_EQ( 0, g_LatencyBuckets[6] );
+	EXPECT_EQ( 2, g_Sessions._nValue );
+	EXPECT_EQ( 2, g_Sessions._nPeak );
+
+	// counts from several tasks are exact
+	const uint32_t nThreads = 4;
+	const uint32_t nAdds = 100000;
+	std::vector<std::thread> threads;
+	for( uint32_t t=0; t < nThreads; ++t )
+	{
+		threads.push_back( std::thread( [nAdds, t]()
+		{
+			for( uint32_t i=0; i < nAdds; ++i )
+			{
+				scMetrics::Add( g_Requests, 1 );
+				scMetrics::Sample( g_Latency, t );
+			}
+		} ) );
+	}
+	for( size_t t=0; t < threads.size(); ++t )
+	{
+		threads[t].join();
+	}
+	EXPECT_EQ( nThreads * nAdds, g_Requests._nValue );
+	EXPECT_EQ( nThreads * nAdds, g_Latency._nValue );
+	EXPECT_EQ( nThreads - 1, g_Latency._nPeak );
+
+	// the dump shows every metric
+	scDebugManager*	pDm = scDebugManager::Instance();
+	TextPath*		pPath = new TextPath(16);
+	pDm->Allocator( pAllocatorImp );
+	delete pDm->SetLabelManager( new scDebugLabelManager( 16, scDisabled ) );
+	pDm->LabelState( scDEBUGLABEL_INFO_MESSAGE, scEnabled );
+	pDm->Add( pPath );
+	pDm->Enable();
+	pDm->SetTimestampOptions( scTRACE_TIMESTAMP_DELTA );
+	scMetrics::Dump( scDEBUGLABEL_INFO_MESSAGE );
+	EXPECT_NE( std::string::npos, pPath->_Text.find( "app.requests: 400000\n\r" ) );
+	EXPECT_NE( std::string::npos, pPath->_Text.find( "app.sessions: 2, peak 2\n\r" ) );
+	EXPECT_NE( std::string::npos, pPath->_Text.find( "app.latency: 400000 samples, mean 1, max 3\n\r  buckets 0:200000 2:200000\n\r" ) );
+	EXPECT_NE( std::string::npos, pPath->_Text.find( "factory.create_failures: " ) );
+	pDm->SetTimestampOptions( scTRACE_TIMESTAMP_TEXT | scTRACE_TIMESTAMP_DELTA );
+	pDm->LabelState( scDisabled );
+	delete pDm->Remove( pPath->PathId() );
+
+	scMetrics::Set( g_Sessions, 0 );
+	scMetrics::Reset();
+}
+
+void scMetrics_test::ComponentTest()
+{
+	// drivers count the bytes in and out, and the overflows
+	HoldDriver*		pDriver = new HoldDriver();
+	const uint8_t	data[12] = { 0 };
+	uint8_t			received[12];
+	pDriver->Send_n( data, sizeof(data) );
+	EXPECT_EQ( 12, Value( "driver.total_bytes_out" ) );
+	EXPECT_LE( 12, Peak( "ring.max_peak_bytes" ) );
+	pDriver->Send_n( data, sizeof(data) );
+	EXPECT_EQ( 16, Value( "driver.total_bytes_out" ) );
+	EXPECT_EQ( 1, Value( "driver.total_overflows" ) );
+	EXPECT_EQ( 16, Peak( "ring.max_peak_bytes" ) );
+	pDriver->Receive( data, 5 );
+	EXPECT_EQ( 5, pDriver->Recv_n( received, sizeof(received) ) );
+	EXPECT_EQ( 5, Value( "driver.total_bytes_in" ) );
+
+	// the device manager counts its devices
+	uint32_t nDevices = Value( "device.count" );
+	testDM*	pDm = new testDM();
+	pDm->Add( pDriver );
+	EXPECT_EQ( nDevices + 1, Value( "device.count" ) );
+	delete pDm;
+	EXPECT_EQ( nDevices, Value( "device.count" ) );
+
+	// queues report their depth and refusals
+	uint32_t nDepth = Value( "queue.total_depth" );
+	uint32_t nItem = 0;
+	scQueueList* pQueue = new scQueueList( 2, sizeof(nItem) );
+	EXPECT_EQ( 1, pQueue->SendToBack( &nItem, 0 ) );
+	EXPECT_EQ( 1, pQueue->SendToFront( &nItem, 0 ) );
+	EXPECT_EQ( 0, pQueue->SendToBack( &nItem, 0 ) );
+	EXPECT_EQ( nDepth + 2, Value( "queue.total_depth" ) );
+	EXPECT_LE( nDepth + 2, Peak( "queue.total_depth" ) );
+	EXPECT_EQ( 1, Value( "queue.total_full" ) );
+	EXPECT_EQ( 1, pQueue->Receive( &nItem, 0 ) );
+	EXPECT_EQ( nDepth + 1, Value( "queue.total_depth" ) );
+	delete pQueue;
+	EXPECT_EQ( nDepth, Value( "queue.total_depth" ) );
+
+	// factories count the messages, their sizes and the failures
+	uint32_t			nInUse = Value( "factory.in_use" );
+	scMutexNoOp			lock;
+	scAllocator			memManager( pAllocatorImp );
+	MetricFactory*		pFactory = new MetricFactory( 2, 100 );
+	ASSERT_EQ( ERROR_SUCCESS, pFactory->Initialize( memManager, memManager, &lock ) );
+	MetricMessage*		pFirst = pFactory->Create( 20 );
+	MetricMessage*		pSecond = pFactory->Create( 40 );
+	EXPECT_TRUE( pFactory->Create( 10 ) == NULL );
+	EXPECT_EQ( 2, Value( "factory.creates" ) );
+	EXPECT_EQ( 1, Value( "factory.create_failures" ) );
+	EXPECT_EQ( nInUse + 2, Value( "factory.in_use" ) );
+	EXPECT_EQ( 2, Value( "factory.message_size" ) );
+	EXPECT_EQ( 40, Peak( "factory.message_size" ) );
+	EXPECT_TRUE( pFactory->Release( pFirst ) );
+	EXPECT_TRUE( pFactory->Release( pSecond ) );
+	EXPECT_EQ( nInUse, Value( "factory.in_use" ) );
+	delete pFactory;
+
+	// one call copies and resets everything
+	scMetricSnapshot_t snapshot[scMETRIC_CORE_COUNT];
+	EXPECT_EQ( scMETRIC_CORE_COUNT, scMetrics::Snapshot( snapshot, scMETRIC_CORE_COUNT, true ) );
+	EXPECT_EQ( 16, snapshot[scMETRIC_DRIVER_TOTAL_BYTES_OUT]._nValue );
+	EXPECT_EQ( 1, snapshot[scMETRIC_FACTORY_SIZE]._nBuckets[4] );
+	EXPECT_EQ( 1, snapshot[scMETRIC_FACTORY_SIZE]._nBuckets[5] );
+	EXPECT_EQ( 0, Value( "driver.total_bytes_out" ) );
+	EXPECT_EQ( 0, Value( "factory.message_size" ) );
+	EXPECT_EQ( nInUse, Value( "factory.in_use" ) );
+}
@@ -0,0 +1,128 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+#pragma once
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"  // Brings in Google Mock.
+
+#include "scMetrics.h"
+#include "scDebugPath.h"
+#include "scStandardMessage.h"
+#include "scMessageFactory.h"
+#include "scDeviceManager.h"
+#include "scRingBuffer.h"
+#include "HAL/scBufferedIODriver.h"
+#include <string>
+
+using namespace ::SharedCore;
+
+// Tests for the metrics registry.
+class scMetrics_test : public ::testing::Test
+{
+public:
+	void RegistryTest();
+	void ComponentTest();
+
+	class MetricMessage : public scStandardMessage<uint8_t>
+	{
+	public:
+		MetricMessage(const uint8_t* pBuffer = NULL, uint32_t nLength = 0)
+			: scStandardMessage<uint8_t>( pBuffer, nLength )
+		{
+		}
+
+		MetricMessage& operator=( const MetricMessage& source )
+		{
+			if ( this != &source )
+			{
+				this->_pBuffer = source._pBuffer;
+				this->_nLength = source._nLength;
+				this->_Header = source.Header();
+			}
+			return *this;
+		}
+	};
+
+	class MetricFactory : public scMessageFactory<MetricMessage>
+	{
+	public:
+		MetricFactory( uint16_t slots, uint32_t nBytes )
+			: scMessageFactory<MetricMessage>( slots, nBytes )
+		{
+		}
+	};
+
+	class testDM : public scDeviceManager
+	{
+	public:
+		testDM() : scDeviceManager() {}
+	};
+
+	/// <summary>
+	/// Driver with a small transmit queue that is only emptied on request.
+	/// </summary>
+	class HoldDriver : public HAL::scBufferIODriver
+	{
+	public:
+		HoldDriver() : HAL::scBufferIODriver( scDeviceDescriptor(0x0100) )
+		{
+			SetQueue( new scRingBuffer( 16, new uint8_t[16], NULL ), new scRingBuffer( 16, new uint8_t[16], NULL ) );
+		}
+		virtual void TriggerSend(void)
+		{
+		}
+		void Receive( const uint8_t* pData, uint32_t nLength )
+		{
+			_pQueueIn->WriteStart();
+			_pQueueIn->WriteBlock( pData, nLength );
+		}
+	};
+
+	/// <summary>
+	/// Keeps the text of the dump.
+	/// </summary>
+	class TextPath : public scDebugPath
+	{
+	public:
+		TextPath( uint8_t id ) : scDebugPath(id), _Text() {}
+		void Capture( const uint8_t* pData, uint32_t nLength )
+		{
+			_Text.append( reinterpret_cast<const char*>(pData), nLength );
+		}
+
+		std::string			_Text;
+	};
+
+	/// <summary>
+	/// Value of a metric by name.
+	/// </summary>
+	static uint32_t Value( const char* pName );
+
+	/// <summary>
+	/// Peak of a metric by name.
+	/// </summary>
+	static uint32_t Peak( const char* pName );
+
+protected:
+	scMetrics_test();
+
+	virtual ~scMetrics_test();
+
+	virtual void SetUp();
+};
@@ -0,0 +1,161 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+#include "scMutexProfiler_test.h"
+#include "scHiResClock.h"
+#include "scAllocator_Imp.h"
+#include "scDebugManager.h"
+#include "scDebugLabelManager.h"
+#include "scDebugLabelCodes.h"
+#include <thread>
+#include <vector>
+
+using namespace SharedCore;
+
+static scAllocator_Imp* pAllocatorImp = new scAllocator_Imp();
+
+uint32_t	scMutexProfiler_test::s_nClock = 0;
+
+// The profilers stay registered so they are static.
+static scMutexProfiler_test::FakeMutex	g_QuietMutex;
+static scMutexProfiler_test::FakeMutex	g_BusyMutex;
+static scMutexProfiler					g_Quiet( &g_QuietMutex, "quiet" );
+static scMutexProfiler					g_Busy( &g_BusyMutex, "busy" );
+
+scMutexProfiler_test::scMutexProfiler_test()
+{
+}
+
+scMutexProfiler_test::~scMutexProfiler_test()
+{
+}
+
+void scMutexProfiler_test::TearDown()
+{
+	scHiResClock::SetCounter( NULL, 0 );
+}
+
+uint32_t scMutexProfiler_test::Clock( void )
+{
+	return s_nClock;
+}
+
+void scMutexProfiler_test::ContentionTest()
+{
+	scMutexStats_t stats;
+	s_nClock = 0;
+	scHiResClock::SetCounter( &Clock, 1000000 );
+
+	// a free lock is not contended, the hold time is counted
+	g_Quiet.Acquire();
+	EXPECT_TRUE( g_QuietMutex._bHeld );
+	s_nClock += 40;
+	g_Quiet.Release();
+	EXPECT_FALSE( g_QuietMutex._bHeld );
+	EXPECT_EQ( 1, g_Quiet.TryAcquire( 0 ) );
+	s_nClock += 10;
+	g_Quiet.Release();
+	g_Quiet.Statistics( stats );
+	EXPECT_EQ( 2, stats._nAcquisitions );
+	EXPECT_EQ( 0, stats._nContended );
+	EXPECT_EQ( 0, stats._nWaitTotal );
+	EXPECT_EQ( 50, stats._nHoldTotal );
+	EXPECT_EQ( 40, stats._nHoldMax );
+
+	// a busy lock is waited for
+	g_BusyMutex._bBusy = true;
+	g_BusyMutex._nWait = 300;
+	g_Busy.Acquire();
+	s_nClock += 5;
+	g_Busy.Release();
+	g_BusyMutex._nWait = 100;
+	EXPECT_EQ( 1, g_Busy.TryAcquire( 200 ) );
+	g_Busy.ReleaseISR();
+	EXPECT_EQ( 0, g_Busy.TryAcquire( 50 ) );
+	EXPECT_EQ( 0, g_Busy.TryAcquire( 0 ) );
+	g_Busy.Statistics( stats );
+	EXPECT_EQ( 2, stats._nAcquisitions );
+	EXPECT_EQ( 2, stats._nContended );
+	EXPECT_EQ( 2, stats._nTimeouts );
+	EXPECT_EQ( 400, stats._nWaitTotal );
+	EXPECT_EQ( 300, stats._nWaitMax );
+	EXPECT_EQ( 5, stats._nHoldTotal );
+
+	// the report lists the hottest lock first
+	scDebugManager*	pDm = scDebugManager::Instance();
+	TextPath*		pPath = new TextPath(18);
+	pDm->Allocator( pAllocatorImp );
+	delete pDm->SetLabelManager( new scDebugLabelManager( 16, scDisabled ) );
+	pDm->LabelState( scDEBUGLABEL_INFO_MESSAGE, scEnabled );
+	pDm->Add( pPath );
+	pDm->Enable();
+	scMutexProfiler::Register( g_Quiet );
+	scMutexProfiler::Register( g_Busy );
+	scMutexProfiler::Register( g_Quiet );
+	scMutexProfiler::Report( scDEBUGLABEL_INFO_MESSAGE );
+	size_t nBusy = pPath->_Text.find( "busy: 2 acquired, 2 contended, 2 timeouts, wait 400 us max 300 us, hold 5 us max 5 us\n\r" );
+	size_t nQuiet = pPath->_Text.find( "quiet: 2 acquired, 0 contended, 0 timeouts, wait 0 us max 0 us, hold 50 us max 40 us\n\r" );
+	EXPECT_NE( std::string::npos, pPath->_Text.find( "scMutexProfiler: 2 locks, hottest first\n\r" ) );
+	EXPECT_NE( std::string::npos, nBusy );
+	EXPECT_NE( std::string::npos, nQuiet );
+	EXPECT_LT( nBusy, nQuiet );
+	pDm->LabelState( scDisabled );
+	delete pDm->Remove( pPath->PathId() );
+
+	g_Busy.Reset();
+	g_Busy.Statistics( stats );
+	EXPECT_EQ( 0, stats._nAcquisitions );
+	EXPECT_EQ( 0, stats._nTimeouts );
+	EXPECT_EQ( 0, stats._nWaitTotal );
+}
+
+void scMutexProfiler_test::ThreadTest()
+{
+	StdMutex			mutex;
+	scMutexProfiler		profiler( &mutex, "shared" );
+	const uint32_t		nThreads = 4;
+	const uint32_t		nLoops = 20000;
+	uint32_t			nShared = 0;
+	std::vector<std::thread> threads;
+
+	for( uint32_t t=0; t < nThreads; ++t )
+	{
+		threads.push_back( std::thread( [&profiler, &nShared, nLoops]()
+		{
+			for( uint32_t i=0; i < nLoops; ++i )
+			{
+				profiler.Acquire();
+				nShared++;
+				profiler.Release();
+			}
+		} ) );
+	}
+	for( size_t t=0; t < threads.size(); ++t )
+	{
+		threads[t].join();
+	}
+
+	// the statistics are kept under the lock so none are lost
+	scMutexStats_t stats;
+	profiler.Statistics( stats );
+	EXPECT_EQ( nThreads * nLoops, nShared );
+	EXPECT_EQ( nThreads * nLoops, stats._nAcquisitions );
+	EXPECT_GE( stats._nAcquisitions, stats._nContended );
+	EXPECT_GE( stats._nWaitTotal, stats._nWaitMax );
+	EXPECT_GE( stats._nHoldTotal, stats._nHoldMax );
+}
@@ -0,0 +1,143 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+#pragma once
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"  // Brings in Google Mock.
+
+#include "scMutexProfiler.h"
+#include "scDebugPath.h"
+#include <mutex>
+#include <string>
+
+using namespace ::SharedCore;
+
+// Tests for the lock contention profiler.
+class scMutexProfiler_test : public ::testing::Test
+{
+public:
+	void ContentionTest();
+	void ThreadTest();
+
+	/// <summary>
+	/// Mutex the test marks as busy, waiting for it moves the clock on.
+	/// </summary>
+	class FakeMutex : public scIMutex
+	{
+	public:
+		FakeMutex() : scIMutex(), _bBusy(false), _nWait(0), _bHeld(false) {}
+		virtual int TryAcquire( uint32_t timeout )
+		{
+			if ( _bBusy && timeout == 0 )
+			{
+				return 0;
+			}
+			if ( _bBusy )
+			{
+				s_nClock += ( timeout < _nWait ) ? timeout : _nWait;
+				if ( timeout < _nWait )
+				{
+					return 0;
+				}
+			}
+			_bHeld = true;
+			return 1;
+		}
+		virtual void Acquire( void )
+		{
+			if ( _bBusy )
+			{
+				s_nClock += _nWait;
+			}
+			_bHeld = true;
+		}
+		virtual void Release( void )
+		{
+			_bHeld = false;
+		}
+		virtual void ReleaseISR( void )
+		{
+			_bHeld = false;
+		}
+
+		bool				_bBusy;
+		uint32_t			_nWait;
+		bool				_bHeld;
+	};
+
+	/// <summary>
+	/// Mutex of the host, a timeout other than zero waits without a limit.
+	/// </summary>
+	class StdMutex : public scIMutex
+	{
+	public:
+		virtual int TryAcquire( uint32_t timeout )
+		{
+			if ( timeout == 0 )
+			{
+				return _Mutex.try_lock() ? 1 : 0;
+			}
+			_Mutex.lock();
+			return 1;
+		}
+		virtual void Acquire( void )
+		{
+			_Mutex.lock();
+		}
+		virtual void Release( void )
+		{
+			_Mutex.unlock();
+		}
+		virtual void ReleaseISR( void )
+		{
+			_Mutex.unlock();
+		}
+
+		std::mutex			_Mutex;
+	};
+
+	/// <summary>
+	/// Keeps the text of the report.
+	/// </summary>
+	class TextPath : public scDebugPath
+	{
+	public:
+		TextPath( uint8_t id ) : scDebugPath(id), _Text() {}
+		void Capture( const uint8_t* pData, uint32_t nLength )
+		{
+			_Text.append( reinterpret_cast<const char*>(pData), nLength );
+		}
+
+		std::string			_Text;
+	};
+
+	/// <summary>
+	/// Clock of the test, one tick a microsecond.
+	/// </summary>
+	static uint32_t Clock( void );
+
+	static uint32_t			s_nClock;
+
+protected:
+	scMutexProfiler_test();
+
+	virtual ~scMutexProfiler_test();
+
+	virtual void TearDown();
+};
@@ -0,0 +1,145 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+#include "scProfiler_test.h"
+#include "scHiResClock.h"
+#include "scDebugLabelManager.h"
+#include "scDebugLabelCodes.h"
+#include "scAllocator_Imp.h"
+#include <thread>
+#include <stdio.h>
+#include <vector>
+
+using namespace SharedCore;
+
+static scAllocator_Imp* pAllocatorImp = new scAllocator_Imp();
+
+scProfiler_test::scProfiler_test()
+{
+}
+
+scProfiler_test::~scProfiler_test()
+{
+}
+
+void scProfiler_test::SetUp()
+{
+	scProfiler::Reset();
+}
+
+void scProfiler_test::ProbeTest()
+{
+	// buckets are powers of two
+	EXPECT_EQ( 0, scProfiler::Bucket( 0 ) );
+	EXPECT_EQ( 0, scProfiler::Bucket( 1 ) );
+	EXPECT_EQ( 1, scProfiler::Bucket( 2 ) );
+	EXPECT_EQ( 9, scProfiler::Bucket( 1023 ) );
+	EXPECT_EQ( 10, scProfiler::Bucket( 1024 ) );
+	EXPECT_EQ( 31, scProfiler::Bucket( 0xFFFFFFFF ) );
+
+	uint16_t nProbe = scPROBE_APPLICATION;
+	EXPECT_EQ( 0, scProfiler::Min( nProbe ) );
+	EXPECT_EQ( 0, scProfiler::Mean( nProbe ) );
+	scProfiler::Record( nProbe, 5 );
+	scProfiler::Record( nProbe, 100 );
+	scProfiler::Record( nProbe, 300 );
+	const scProfileStats_t* pStats = scProfiler::Stats( nProbe );
+	ASSERT_TRUE( pStats != NULL );
+	EXPECT_EQ( 3, pStats->_nCount );
+	EXPECT_EQ( 5, scProfiler::Min( nProbe ) );
+	EXPECT_EQ( 300, pStats->_nMax );
+	EXPECT_EQ( 135, scProfiler::Mean( nProbe ) );
+	EXPECT_EQ( 1, pStats->_nBuckets[2] );
+	EXPECT_EQ( 1, pStats->_nBuckets[6] );
+	EXPECT_EQ( 1, pStats->_nBuckets[8] );
+	EXPECT_TRUE( scProfiler::Stats( SC_PROFILER_PROBES ) == NULL );
+	scProfiler::Record( SC_PROFILER_PROBES, 5 );
+
+	// a scope records the time it was open
+	uint64_t nWait = scHiResClock::Frequency() / 10000;
+	{
+		scPROFILE_SCOPE( nProbe + 1 );
+		uint64_t nStart = scHiResClock::Ticks();
+		while( scHiResClock::Ticks() - nStart < nWait )
+		{
+		}
+	}
+	EXPECT_EQ( 1, scProfiler::Stats( nProbe + 1 )->_nCount );
+	EXPECT_LE( nWait, scProfiler::Min( nProbe + 1 ) );
+
+	// the core probes are in place, Send_n goes through Send_v
+	NullDriver		driver;
+	const uint8_t	data[8] = { 0 };
+	driver.Send_n( data, sizeof(data) );
+	driver.Send_n( data, sizeof(data) );
+	EXPECT_EQ( 2, scProfiler::Stats( scPROBE_SEND )->_nCount );
+
+	// several tasks record at once without losing a call
+	const uint32_t	nThreads = 4;
+	const uint32_t	nCalls = 50000;
+	std::vector<std::thread> threads;
+	uint16_t nShared = nProbe + 2;
+	for( uint32_t t=0; t < nThreads; ++t )
+	{
+		threads.push_back( std::thread( [nShared, nCalls, t]()
+		{
+			for( uint32_t i=0; i < nCalls; ++i )
+			{
+				scProfiler::Record( nShared, 10 + t );
+			}
+		} ) );
+	}
+	for( size_t t=0; t < threads.size(); ++t )
+	{
+		threads[t].join();
+	}
+	EXPECT_EQ( nThreads * nCalls, scProfiler::Stats( nShared )->_nCount );
+	EXPECT_EQ( 10, scProfiler::Min( nShared ) );
+	EXPECT_EQ( 10 + nThreads - 1, scProfiler::Stats( nShared )->_nMax );
+	EXPECT_EQ( nThreads * nCalls, scProfiler::Stats( nShared )->_nBuckets[3] );
+
+	// the dump names the probes given by the application
+	static const scProfileName_t names[] = { { scPROBE_APPLICATION, "App" } };
+	scProfiler::SetNames( names, 1 );
+	scDebugManager*	pDm = scDebugManager::Instance();
+	TextPath*		pPath = new TextPath(15);
+	pDm->Allocator( pAllocatorImp );
+	delete pDm->SetLabelManager( new scDebugLabelManager( 16, scDisabled ) );
+	pDm->LabelState( scDEBUGLABEL_INFO_MESSAGE, scEnabled );
+	pDm->Add( pPath );
+	pDm->Enable();
+	pDm->SetTimestampOptions( scTRACE_TIMESTAMP_DELTA );
+
+	scProfiler::Reset();
+	EXPECT_EQ( 0, scProfiler::Stats( nProbe )->_nCount );
+	scProfiler::Record( nProbe, 1000 );
+	scProfiler::Record( nProbe, 3000 );
+	scProfiler::Dump( scDEBUGLABEL_INFO_MESSAGE );
+	uint64_t nMin = 1000ULL * 1000000000ULL / scHiResClock::Frequency();
+	char sExpect[96];
+	sprintf( sExpect, "App: 2 calls, min %u.%03u ", (uint32_t)( nMin / 1000 ), (uint32_t)( nMin % 1000 ) );
+	EXPECT_EQ( 0, pPath->_Text.find( sExpect ) );
+	EXPECT_NE( std::string::npos, pPath->_Text.find( "  ticks 512:1 2048:1\n\r" ) );
+
+	scProfiler::SetNames( NULL, 0 );
+	scProfiler::Reset();
+	pDm->SetTimestampOptions( scTRACE_TIMESTAMP_TEXT | scTRACE_TIMESTAMP_DELTA );
+	pDm->LabelState( scDisabled );
+	delete pDm->Remove( pPath->PathId() );
+}
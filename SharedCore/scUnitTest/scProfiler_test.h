@@ -0,0 +1,79 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+#pragma once
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"  // Brings in Google Mock.
+
+#include "scProfiler.h"
+#include "scDebugPath.h"
+#include "scDebugManager.h"
+#include "scRingBuffer.h"
+#include "HAL/scBufferedIODriver.h"
+#include <string>
+
+using namespace ::SharedCore;
+
+// Tests for the profiling probes.
+class scProfiler_test : public ::testing::Test
+{
+public:
+	void ProbeTest();
+
+	/// <summary>
+	/// Keeps the text of the dump.
+	/// </summary>
+	class TextPath : public scDebugPath
+	{
+	public:
+		TextPath( uint8_t id ) : scDebugPath(id), _Text() {}
+		void Capture( const uint8_t* pData, uint32_t nLength )
+		{
+			_Text.append( reinterpret_cast<const char*>(pData), nLength );
+		}
+
+		std::string			_Text;
+	};
+
+	/// <summary>
+	/// Driver sending into nowhere, to pass the Send probe.
+	/// </summary>
+	class NullDriver : public HAL::scBufferIODriver
+	{
+	public:
+		NullDriver() : HAL::scBufferIODriver( scDeviceDescriptor(0x0100) )
+		{
+			SetQueue( NULL, new scRingBuffer( 64, new uint8_t[64], NULL ) );
+		}
+		virtual void TriggerSend(void)
+		{
+			while( _pQueueOut->InUse() > 0 )
+			{
+				_pQueueOut->ReadEnd( _pQueueOut->ReadStart() );
+			}
+		}
+	};
+
+protected:
+	scProfiler_test();
+
+	virtual ~scProfiler_test();
+
+	virtual void SetUp();
+};
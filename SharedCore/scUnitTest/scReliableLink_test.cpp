@@ -0,0 +1,331 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+
+#include <stdio.h>
+#include "gmock/gmock.h"
+#include "scReliableLink_test.h"
+#include "scErrorCodes.h"
+
+using namespace SharedCore;
+
+uint32_t	scReliableLink_test::_nTicks = 0;
+
+scReliableLink_test::LinkMessage* scReliableLink_test::LinkFactory::Build( uint16_t nDestination, uint32_t nCounter )
+{
+	LinkMessage* pMessage = Create( sizeof(scStandardHeader_t) + sizeof(uint32_t) );
+	if ( pMessage != NULL )
+	{
+		scStandardHeader<LinkMessages_t> header;
+		header.SetDestination( nDestination );
+		header.SetSource( nDestination == 1 ? 2 : 1 );
+		header.SetId( msg_Data );
+		header.SetLength( sizeof(uint32_t) );
+		header.UpdateChecksum();
+
+		uint8_t* pBuffer = const_cast<uint8_t*>( pMessage->Buffer() );
+		memcpy( pBuffer, &header.Data(), sizeof(scStandardHeader_t) );
+		memcpy( pBuffer + sizeof(scStandardHeader_t), &nCounter, sizeof(uint32_t) );
+		*pMessage = LinkMessage( pBuffer, sizeof(scStandardHeader_t) + sizeof(uint32_t) );
+	}
+	return pMessage;
+}
+
+scReliableLink_test::WireDriver::WireDriver( int nId )
+	: scBufferIODriver( scDeviceDescriptor(nId) )
+	, _Sent()
+{
+}
+
+void scReliableLink_test::WireDriver::Initialize( scDeviceManager* pDm )
+{
+	scRingBuffer* pIn = new scRingBuffer( 16, new uint8_t[16], NULL );
+	scRingBuffer* pOut = new scRingBuffer( 256, new uint8_t[256], NULL );
+
+	SetQueue( pIn, pOut );
+
+	scBufferIODriver::Initialize( pDm );
+}
+
+void scReliableLink_test::WireDriver::TriggerSend(void)
+{
+	while( _pQueueOut->InUse() > 0 )
+	{
+		uint32_t nNumber = _pQueueOut->ReadStart();
+		_Sent.insert( _Sent.end(), _pQueueOut->ReadBlock(), _pQueueOut->ReadBlock() + nNumber );
+		_pQueueOut->ReadEnd( nNumber );
+	}
+}
+
+scReliableLink_test::LinkEnd::LinkEnd( testDM* pDm, int nId, uint8_t nWindow, scAllocator& memory, scIMutex* pLock )
+	: _pDriver( new WireDriver( nId ) )
+	, _pFactory( new LinkFactory( 40, 1024 ) )
+	, _pRouter( new Router_t( 4, 2, 2 ) )
+	, _pLink( new Link_t( nWindow, (uint16_t)nId, msg_Control ) )
+	, _Received()
+{
+	pDm->Add( _pDriver );
+	_pFactory->Initialize( memory, memory, pLock );
+	_pRouter->Initialize( memory, pLock, _pFactory );
+	_pRouter->Register( scROUTE_ANY, msg_Data, &Handler, &_Received );
+	_pLink->Initialize( memory, pLock, _pDriver, _pFactory, _pRouter );
+	_pLink->SetTickSource( &Ticks );
+}
+
+scReliableLink_test::LinkEnd::~LinkEnd()
+{
+	delete _pLink;
+	delete _pRouter;
+	delete _pFactory;
+}
+
+bool scReliableLink_test::Handler( const LinkMessage* pMessage, void* pContext )
+{
+	std::vector<uint32_t>* pLog = reinterpret_cast<std::vector<uint32_t>*>( pContext );
+	uint32_t nCounter;
+	memcpy( &nCounter, pMessage->Payload(), sizeof(uint32_t) );
+	pLog->push_back( nCounter );
+	return false;
+}
+
+uint32_t scReliableLink_test::Ticks( void )
+{
+	return _nTicks;
+}
+
+scReliableLink_test::scReliableLink_test()
+	: _Lock()
+	, _NewOp()
+	, _Memory( &_NewOp )
+	, _nRandom( 1 )
+{
+}
+
+scReliableLink_test::~scReliableLink_test()
+{
+}
+
+void scReliableLink_test::SetUp()
+{
+	_nTicks = 0;
+	_nRandom = 12345;
+}
+
+void scReliableLink_test::Transmit( WireDriver* pDriver, std::deque<Frame_t>& wire, uint32_t nDelay, uint32_t nLoss )
+{
+	uint32_t nOffset = 0;
+	while( nOffset < pDriver->_Sent.size() )
+	{
+		scStandardHeader<LinkMessages_t> header( &pDriver->_Sent[nOffset], (uint32_t)pDriver->_Sent.size() - nOffset );
+		uint32_t nLength = sizeof(scStandardHeader_t) + header.Length();
+
+		// simple repeatable random number for the frame loss
+		_nRandom = _nRandom * 1103515245 + 12345;
+		if ( ( ( _nRandom >> 16 ) % 100 ) >= nLoss )
+		{
+			Frame_t frame;
+			frame._nDue = _nTicks + nDelay;
+			frame._Data.assign( pDriver->_Sent.begin() + nOffset, pDriver->_Sent.begin() + nOffset + nLength );
+			wire.push_back( frame );
+		}
+		nOffset += nLength;
+	}
+	pDriver->_Sent.clear();
+}
+
+void scReliableLink_test::Deliver( std::deque<Frame_t>& wire, LinkEnd* pEnd )
+{
+	while( !wire.empty() && wire.front()._nDue <= _nTicks )
+	{
+		Frame_t& frame = wire.front();
+		LinkMessage* pMessage = pEnd->_pFactory->Create( &frame._Data[0], (uint32_t)frame._Data.size() );
+		pEnd->_pLink->Receive( pMessage );
+		pEnd->_pFactory->Release( pMessage );
+		wire.pop_front();
+	}
+}
+
+scReliableLink_test::Transfer_t scReliableLink_test::Transfer( uint8_t nWindow, uint32_t nCount, uint32_t nDelay, uint32_t nLoss )
+{
+	Transfer_t			result;
+	testDM				dm;
+	std::deque<Frame_t>	toB;
+	std::deque<Frame_t>	toA;
+	LinkEnd				a( &dm, 1, nWindow, _Memory, &_Lock );
+	LinkEnd				b( &dm, 2, nWindow, _Memory, &_Lock );
+	uint32_t			nSent = 0;
+
+	dm.Initialize();
+	a._pDriver->Enable();
+	b._pDriver->Enable();
+	a._pLink->SetTimeout( 2 * nDelay + 4 );
+	b._pLink->SetTimeout( 2 * nDelay + 4 );
+
+	_nTicks = 0;
+	while( b._Received.size() < nCount && _nTicks < 100000 )
+	{
+		_nTicks++;
+
+		while( nSent < nCount && a._pLink->WindowAvailable() > 0 )
+		{
+			LinkMessage* pMsg = a._pFactory->Build( 2, nSent );
+			EXPECT_EQ( ERROR_SUCCESS, a._pLink->Send( pMsg ) );
+			a._pFactory->Release( pMsg );
+			nSent++;
+		}
+
+		a._pLink->Poll();
+		Transmit( a._pDriver, toB, nDelay, nLoss );
+		Deliver( toB, &b );
+		Transmit( b._pDriver, toA, nDelay, nLoss );
+		Deliver( toA, &a );
+	}
+
+	result._nTicks = _nTicks;
+	result._nRetransmits = a._pLink->Retransmits();
+	result._bInOrder = ( b._Received.size() == nCount );
+	for( uint32_t i=0; i < b._Received.size(); ++i )
+	{
+		if ( b._Received[i] != i )
+		{
+			result._bInOrder = false;
+		}
+	}
+	return result;
+}
+
+void scReliableLink_test::InOrderTest()
+{
+	testDM		dm;
+	LinkEnd		a( &dm, 1, 3, _Memory, &_Lock );
+	LinkEnd		b( &dm, 2, 3, _Memory, &_Lock );
+	dm.Initialize();
+
+	// fill the window
+	for( uint32_t i=0; i < 3; ++i )
+	{
+		LinkMessage* pMsg = a._pFactory->Build( 2, i );
+		EXPECT_EQ( ERROR_SUCCESS, a._pLink->Send( pMsg ) );
+		a._pFactory->Release( pMsg );
+	}
+	LinkMessage* pMsg = a._pFactory->Build( 2, 3 );
+	EXPECT_EQ( ERROR_SC_WINDOW_FULL, a._pLink->Send( pMsg ) );
+	a._pFactory->Release( pMsg );
+	EXPECT_EQ( 3, a._pLink->Outstanding() );
+	EXPECT_EQ( 3, a._pFactory->MessagesInUse() );
+
+	std::deque<Frame_t> toB;
+	std::deque<Frame_t> toA;
+	Transmit( a._pDriver, toB, 0, 0 );
+	ASSERT_EQ( 3, toB.size() );
+
+	// each frame is stamped with the sequence number
+	for( uint8_t i=0; i < 3; ++i )
+	{
+		LinkMessage frame( &toB[i]._Data[0], (uint32_t)toB[i]._Data.size() );
+		EXPECT_EQ( i, frame.Header().Sequence() );
+		EXPECT_EQ( STANDARD_HEADER_FLAG_RELIABLE, frame.Header().Flags() );
+		EXPECT_TRUE( frame.Header().Valid() );
+	}
+
+	// lose the first frame, the receiver asks for it once
+	toB.pop_front();
+	Deliver( toB, &b );
+	EXPECT_EQ( 0, b._Received.size() );
+	EXPECT_EQ( 2, b._pLink->OutOfOrder() );
+	EXPECT_EQ( 0, b._pLink->Duplicates() );
+	Transmit( b._pDriver, toA, 0, 0 );
+	ASSERT_EQ( 1, toA.size() );
+	EXPECT_EQ( STANDARD_HEADER_FLAG_NACK, toA[0]._Data[1] );
+
+	// the sender goes back and sends the whole window
+	Deliver( toA, &a );
+	EXPECT_EQ( 3, a._pLink->Retransmits() );
+	Transmit( a._pDriver, toB, 0, 0 );
+	Deliver( toB, &b );
+	ASSERT_EQ( 3, b._Received.size() );
+	EXPECT_EQ( 0, b._Received[0] );
+	EXPECT_EQ( 2, b._Received[2] );
+
+	// the acknowledges free the window
+	Transmit( b._pDriver, toA, 0, 0 );
+	Deliver( toA, &a );
+	EXPECT_EQ( 0, a._pLink->Outstanding() );
+	EXPECT_EQ( 0, a._pFactory->MessagesInUse() );
+
+	// a repeat is acknowledged again but not delivered
+	pMsg = a._pFactory->Build( 2, 3 );
+	a._pLink->Send( pMsg );
+	a._pFactory->Release( pMsg );
+	Transmit( a._pDriver, toB, 0, 0 );
+	toB.push_back( toB.front() );
+	Deliver( toB, &b );
+	EXPECT_EQ( 4, b._Received.size() );
+	EXPECT_EQ( 1, b._pLink->Duplicates() );
+	EXPECT_EQ( 2, b._pLink->OutOfOrder() );
+	Transmit( b._pDriver, toA, 0, 0 );
+	EXPECT_EQ( 2, toA.size() );
+	Deliver( toA, &a );
+	EXPECT_EQ( 0, a._pLink->Outstanding() );
+
+	// unreliable messages go straight through
+	pMsg = b._pFactory->Build( 2, 99 );
+	EXPECT_TRUE( b._pLink->Receive( pMsg ) );
+	b._pFactory->Release( pMsg );
+	EXPECT_EQ( 99, b._Received.back() );
+
+	// the timer sends the outstanding message again
+	a._pLink->SetTimeout( 10 );
+	_nTicks = 0;
+	pMsg = a._pFactory->Build( 2, 4 );
+	a._pLink->Send( pMsg );
+	a._pFactory->Release( pMsg );
+	uint32_t nRetransmits = a._pLink->Retransmits();
+	_nTicks = 9;
+	a._pLink->Poll();
+	EXPECT_EQ( nRetransmits, a._pLink->Retransmits() );
+	_nTicks = 10;
+	a._pLink->Poll();
+	EXPECT_EQ( nRetransmits + 1, a._pLink->Retransmits() );
+}
+
+void scReliableLink_test::LossyGoodputTest()
+{
+	const uint32_t	nCount = 300;
+	const uint32_t	nDelay = 5;
+	uint8_t			windows[] = { 1, 4, 16 };
+	double			goodput[3];
+
+	for( int nLoss=0; nLoss <= 10; nLoss += 10 )
+	{
+		for( int i=0; i < 3; ++i )
+		{
+			Transfer_t result = Transfer( windows[i], nCount, nDelay, nLoss );
+			EXPECT_TRUE( result._bInOrder );
+
+			goodput[i] = (double)nCount / (double)result._nTicks;
+			printf( "window %2u, loss %2d%%: %u messages in %u ticks, %.3f per tick, %u retransmits\n",
+				windows[i], nLoss, nCount, result._nTicks, goodput[i], result._nRetransmits );
+		}
+
+		EXPECT_GT( goodput[1], goodput[0] * 2 );
+		EXPECT_GT( goodput[2], goodput[1] );
+	}
+}
@@ -0,0 +1,182 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+
+#pragma once
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"  // Brings in Google Mock.
+
+#include "scStandardHeader.h"
+#include "scStandardMessage.h"
+#include "scMessageFactory.h"
+#include "scMessageRouter.h"
+#include "scReliableLink.h"
+#include "scMutexNoOp.h"
+#include "scAllocator_Imp.h"
+#include "scDeviceManager.h"
+#include "HAL/scBufferedIODriver.h"
+#include <vector>
+#include <deque>
+
+using namespace ::SharedCore;
+using namespace SharedCore::HAL;
+
+// Tests for the sliding window reliable link. Two ends are connected through a
+// simulated wire that delays and drops frames.
+class scReliableLink_test : public ::testing::Test
+{
+public:
+	void InOrderTest();
+	void LossyGoodputTest();
+
+	typedef enum
+	{
+		msg_Data,
+		msg_Control
+	} LinkMessages_t;
+
+	class LinkMessage : public scStandardMessage<LinkMessages_t>
+	{
+	public:
+		LinkMessage(const uint8_t* pBuffer = NULL, uint32_t nLength = 0)
+			: scStandardMessage<LinkMessages_t>( pBuffer, nLength )
+		{
+		}
+
+		LinkMessage& operator=( const LinkMessage& source )
+		{
+			if ( this != &source )
+			{
+				this->_pBuffer = source._pBuffer;
+				this->_nLength = source._nLength;
+				this->_Header = source.Header();
+			}
+			return *this;
+		}
+	};
+
+	class LinkFactory : public scMessageFactory<LinkMessage>
+	{
+	public:
+		LinkFactory( uint16_t slots, uint32_t nBytes )
+			: scMessageFactory<LinkMessage>( slots, nBytes )
+		{
+		}
+
+		/// <summary>
+		/// Create a data message carrying a counter.
+		/// </summary>
+		LinkMessage* Build( uint16_t nDestination, uint32_t nCounter );
+	};
+
+	typedef scMessageRouter<LinkMessage>	Router_t;
+	typedef scReliableLink<LinkMessage>		Link_t;
+
+	class testDM : public scDeviceManager
+	{
+	public:
+		testDM() : scDeviceManager() {}
+	};
+
+	/// <summary>
+	/// Driver that keeps everything written to it.
+	/// </summary>
+	class WireDriver : public scBufferIODriver
+	{
+	public:
+		WireDriver( int nId );
+		virtual ~WireDriver() {}
+
+		virtual void Initialize( scDeviceManager* pDm );
+
+		virtual void TriggerSend(void);
+
+		std::vector<uint8_t>	_Sent;
+	};
+
+	/// <summary>
+	/// A frame travelling on the simulated wire.
+	/// </summary>
+	typedef struct
+	{
+		uint32_t				_nDue;
+		std::vector<uint8_t>	_Data;
+	} Frame_t;
+
+	/// <summary>
+	/// Everything needed for one end of the link.
+	/// </summary>
+	class LinkEnd
+	{
+	public:
+		LinkEnd( testDM* pDm, int nId, uint8_t nWindow, scAllocator& memory, scIMutex* pLock );
+		~LinkEnd();
+
+		WireDriver*				_pDriver;
+		LinkFactory*			_pFactory;
+		Router_t*				_pRouter;
+		Link_t*					_pLink;
+		std::vector<uint32_t>	_Received;
+	};
+
+	/// <summary>
+	/// Results of a transfer over the simulated wire.
+	/// </summary>
+	typedef struct
+	{
+		uint32_t				_nTicks;
+		uint32_t				_nRetransmits;
+		bool					_bInOrder;
+	} Transfer_t;
+
+	static bool Handler( const LinkMessage* pMessage, void* pContext );
+
+	static uint32_t Ticks( void );
+
+protected:
+	scReliableLink_test();
+
+	virtual ~scReliableLink_test();
+
+	virtual void SetUp();
+
+	/// <summary>
+	/// Send nCount messages from one end to the other over a wire with the given delay
+	/// and percentage of lost frames.
+	/// </summary>
+	Transfer_t Transfer( uint8_t nWindow, uint32_t nCount, uint32_t nDelay, uint32_t nLoss );
+
+	/// <summary>
+	/// Move the frames written by the driver onto the wire.
+	/// </summary>
+	void Transmit( WireDriver* pDriver, std::deque<Frame_t>& wire, uint32_t nDelay, uint32_t nLoss );
+
+	/// <summary>
+	/// Deliver the frames that have reached the end of the wire.
+	/// </summary>
+	void Deliver( std::deque<Frame_t>& wire, LinkEnd* pEnd );
+
+	scMutexNoOp			_Lock;
+	scAllocator_Imp		_NewOp;
+	scAllocator			_Memory;
+	uint32_t			_nRandom;
+
+	static uint32_t		_nTicks;
+};
@@ -88,3 +88,45 @@ void scRingBuffer_Test::SingleByteFill()
 	EXPECT_EQ( _nBufferSize, _pBuffer->Available() );
 }
 
+uint32_t scRingBuffer_Test::Format( const char* pFormat, ... )
+{
+	va_list ap;
+	va_start( ap, pFormat );
+	uint32_t nResult = _pBuffer->WriteFormat( pFormat, ap );
+	va_end( ap );
+	return nResult;
+}
+
+std::string scRingBuffer_Test::Read(void)
+{
+	std::string sText;
+	while( _pBuffer->InUse() > 0 )
+	{
+		uint32_t nLength = _pBuffer->ReadStart();
+		sText.append( reinterpret_cast<const char*>( _pBuffer->ReadBlock() ), nLength );
+		_pBuffer->ReadEnd( nLength );
+	}
+	return sText;
+}
+
+void scRingBuffer_Test::FormatWrap()
+{
+	// move the insert point near the end so the text has to wrap
+	EXPECT_EQ( 14, Format( "%-8s|%5u", "start", 42U ) );
+	EXPECT_EQ( "start   |   42", Read() );
+	EXPECT_EQ( 6, _pBuffer->WriteStart() );
+	_pBuffer->WriteEnd( 0 );
+
+	EXPECT_EQ( 15, Format( "%d,%04X,%c,%s", -17, 0xBEEFU, 'z', "wrap" ) );
+	EXPECT_EQ( 15, _pBuffer->InUse() );
+	EXPECT_EQ( "-17,BEEF,z,wrap", Read() );
+
+	// text that does not fit is cut at the free space
+	EXPECT_EQ( 10, Format( "%s", "0123456789" ) );
+	EXPECT_EQ( 26, Format( "%s-%s", "abcdefghijkl", "mnopqrstuvwxy" ) );
+	EXPECT_EQ( 0, _pBuffer->Available() );
+	EXPECT_EQ( "0123456789abcdefghij", Read() );
+
+	EXPECT_EQ( 0, Format( "" ) );
+	EXPECT_EQ( 0, _pBuffer->InUse() );
+}
@@ -22,6 +22,7 @@
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"  // Brings in Google Mock.
 #include "scRingBuffer.h"
+#include <string>
 
 using namespace ::SharedCore;
 
@@ -31,6 +32,7 @@ class scRingBuffer_Test : public ::testing::Test
 {
 public:
 	void SingleByteFill();
+	void FormatWrap();
 
 protected:
 	// You can remove any or all of the following functions if its body
@@ -51,6 +53,10 @@ protected:
 
 	virtual void TearDown();
 
+	uint32_t Format( const char* pFormat, ... );
+
+	std::string Read(void);
+
 	scRingBuffer*			_pBuffer;
 	uint32_t				_nBufferSize;
 
@@ -0,0 +1,210 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+#include "scTelemetry_test.h"
+#include "scErrorCodes.h"
+#include <string>
+
+using namespace SharedCore;
+
+uint32_t	scTelemetry_test::s_nTicks = 0;
+
+// The channels, metrics of the application.
+static volatile uint32_t	g_SizeBuckets[scMETRIC_BUCKETS];
+static scMetric_t			g_Count = scMETRIC_COUNTER_INIT( "tel.count" );
+static scMetric_t			g_Level = scMETRIC_GAUGE_INIT( "tel.level" );
+static scMetric_t			g_Size = scMETRIC_HISTOGRAM_INIT( "tel.size", g_SizeBuckets );
+
+bool scTelemetry_test::Handler( const TelemetryMessage* pMessage, void* pContext )
+{
+	std::vector<Payload_t>* pLog = reinterpret_cast<std::vector<Payload_t>*>( pContext );
+	EXPECT_TRUE( pMessage->Validate() );
+	EXPECT_EQ( 9, pMessage->Header().Destination() );
+	EXPECT_EQ( 3, pMessage->Header().Source() );
+	pLog->push_back( Payload_t( pMessage->Payload(), pMessage->Payload() + pMessage->LengthOfPayload() ) );
+	return false;
+}
+
+uint32_t scTelemetry_test::Ticks( void )
+{
+	return s_nTicks;
+}
+
+scTelemetry_test::scTelemetry_test()
+	: _Lock()
+	, _NewOp()
+	, _Memory( &_NewOp )
+	, _pFactory( NULL )
+	, _pRouter( NULL )
+	, _pTelemetry( NULL )
+	, _Received()
+{
+}
+
+scTelemetry_test::~scTelemetry_test()
+{
+}
+
+void scTelemetry_test::SetUp()
+{
+	s_nTicks = 0;
+	g_Count._nValue = 0;
+	g_Level._nValue = 0;
+	g_Size._nValue = 0;
+
+	_pFactory = new TelemetryFactory( 4, 400 );
+	_pFactory->Initialize( _Memory, _Memory, &_Lock );
+
+	_pRouter = new Router_t( 16, 4, 4 );
+	_pRouter->Initialize( _Memory, &_Lock, _pFactory );
+	_pRouter->Register( 9, msg_Telemetry, &Handler, &_Received );
+
+	_pTelemetry = new Telemetry_t( msg_Telemetry, 3, 9 );
+	EXPECT_EQ( ERROR_SUCCESS, _pTelemetry->Initialize( _pFactory, _pRouter ) );
+	_pTelemetry->SetTickSource( &Ticks );
+	EXPECT_TRUE( _pTelemetry->AddChannel( g_Count ) );
+	EXPECT_TRUE( _pTelemetry->AddChannel( g_Level ) );
+	EXPECT_TRUE( _pTelemetry->AddChannel( g_Size ) );
+}
+
+void scTelemetry_test::TearDown()
+{
+	delete _pTelemetry;
+	delete _pRouter;
+	delete _pFactory;
+}
+
+bool scTelemetry_test::Decode( scTelemetryDecoder& decoder, size_t nFrame )
+{
+	return decoder.Decode( &_Received[nFrame][0], (uint32_t)_Received[nFrame].size() );
+}
+
+void scTelemetry_test::FrameTest()
+{
+	const char*			names[3] = { _pTelemetry->ChannelName( 0 ), _pTelemetry->ChannelName( 1 ), _pTelemetry->ChannelName( 2 ) };
+	scTelemetryDecoder	decoder( names, 3 );
+	char				sText[128];
+
+	_pTelemetry->SetPeriod( 10 );
+	g_Count._nValue = 1000;
+	g_Level._nValue = 7;
+
+	// the first frame is a key frame with every channel
+	EXPECT_TRUE( _pTelemetry->Poll() );
+	ASSERT_EQ( 1u, _Received.size() );
+	EXPECT_EQ( sizeof(scTelemetryFrame_t) + 3 + 2 + 2, _Received[0].size() );
+	EXPECT_EQ( scTELEMETRY_FLAG_KEY, _Received[0][0] );
+	EXPECT_TRUE( Decode( decoder, 0 ) );
+	EXPECT_EQ( 1000, decoder.Value( 0 ) );
+	EXPECT_EQ( 7, decoder.Value( 1 ) );
+	decoder.Header( sText, sizeof(sText) );
+	EXPECT_STREQ( "timestamp,sequence,tel.count,tel.level,tel.size\n", sText );
+	decoder.Row( sText, sizeof(sText) );
+	EXPECT_STREQ( "0,0,1000,7,0\n", sText );
+
+	// then only the changes, a gauge going down stays short
+	s_nTicks = 5;
+	EXPECT_FALSE( _pTelemetry->Poll() );
+	s_nTicks = 10;
+	g_Count._nValue += 5;
+	g_Level._nValue -= 2;
+	EXPECT_TRUE( _pTelemetry->Poll() );
+	ASSERT_EQ( 2u, _Received.size() );
+	EXPECT_EQ( sizeof(scTelemetryFrame_t) + 2 + 2, _Received[1].size() );
+	EXPECT_TRUE( Decode( decoder, 1 ) );
+	EXPECT_EQ( 1005, decoder.Value( 0 ) );
+	EXPECT_EQ( 5, decoder.Value( 1 ) );
+	EXPECT_EQ( 10, decoder.Timestamp() );
+	decoder.Row( sText, sizeof(sText) );
+	EXPECT_STREQ( "10,1,1005,5,0\n", sText );
+
+	// a frame lost on the way stops the deltas until the next key frame
+	s_nTicks = 20;
+	g_Count._nValue += 1;
+	EXPECT_TRUE( _pTelemetry->Poll() );
+	s_nTicks = 30;
+	g_Count._nValue += 1;
+	EXPECT_TRUE( _pTelemetry->Poll() );
+	EXPECT_FALSE( Decode( decoder, 3 ) );
+	EXPECT_EQ( 1, decoder.Lost() );
+	EXPECT_EQ( 1005, decoder.Value( 0 ) );
+	_pTelemetry->Notify( SC_TELEMETRY_KEY_COMMAND, NULL );
+	s_nTicks = 40;
+	EXPECT_TRUE( _pTelemetry->Poll() );
+	EXPECT_TRUE( Decode( decoder, 4 ) );
+	EXPECT_EQ( 1007, decoder.Value( 0 ) );
+	EXPECT_EQ( 1, decoder.Rejected() );
+
+	// a key frame comes every SC_TELEMETRY_KEY_INTERVAL frames on its own
+	for( uint32_t i = 0; i <= SC_TELEMETRY_KEY_INTERVAL; i++ )
+	{
+		s_nTicks += 10;
+		g_Size._nValue += i;
+		EXPECT_TRUE( _pTelemetry->Poll() );
+		EXPECT_EQ( i == SC_TELEMETRY_KEY_INTERVAL ? scTELEMETRY_FLAG_KEY : 0, _Received.back()[0] ) << i;
+		EXPECT_TRUE( Decode( decoder, _Received.size() - 1 ) );
+	}
+	EXPECT_EQ( g_Size._nValue, decoder.Value( 2 ) );
+
+	// a damaged frame leaves the values alone
+	Payload_t	damaged = _Received.back();
+	damaged[sizeof(scTelemetryFrame_t)] = 3;
+	EXPECT_FALSE( decoder.Decode( &damaged[0], (uint32_t)damaged.size() ) );
+	EXPECT_FALSE( decoder.Decode( &damaged[0], sizeof(scTelemetryFrame_t) - 1 ) );
+	EXPECT_EQ( g_Size._nValue, decoder.Value( 2 ) );
+	EXPECT_EQ( 3, decoder.Rejected() );
+
+	// the CSV is cut to the buffer
+	EXPECT_EQ( 9u, decoder.Header( sText, 10 ) );
+	EXPECT_STREQ( "timestamp", sText );
+}
+
+void scTelemetry_test::BudgetTest()
+{
+	const char*			names[3] = { "a", "b", "c" };
+	scTelemetryDecoder	decoder( names, 3 );
+	uint32_t			nSentCount = 0;
+
+	// 100 bytes every 1000 ticks, with a frame due every 10 ticks
+	_pTelemetry->SetPeriod( 10 );
+	_pTelemetry->SetBudget( 100, 1000 );
+	for( s_nTicks = 0; s_nTicks < 10000; s_nTicks++ )
+	{
+		g_Count._nValue += 300;
+		g_Level._nValue = s_nTicks & 0xFF;
+		if ( _pTelemetry->Poll() )
+		{
+			nSentCount = g_Count._nValue;
+		}
+	}
+
+	// bounded by the starting credit and the rate
+	uint32_t nLimit = sizeof(scStandardHeader_t) + sizeof(scTelemetryFrame_t) + SC_TELEMETRY_CHANNELS * scTELEMETRY_MAX_ENTRY;
+	EXPECT_GE( nLimit + 100 * 10, _pTelemetry->BytesSent() );
+	EXPECT_LE( 100u * 9, _pTelemetry->BytesSent() );
+	EXPECT_EQ( 1000u, _pTelemetry->FramesSent() + _pTelemetry->FramesSkipped() );
+	EXPECT_LT( 0u, _pTelemetry->FramesSkipped() );
+
+	// the skipped frames are not missed, the next one carries their changes
+	for( size_t i = 0; i < _Received.size(); i++ )
+	{
+		EXPECT_TRUE( Decode( decoder, i ) ) << i;
+	}
+	EXPECT_EQ( 0, decoder.Lost() );
+	EXPECT_EQ( nSentCount, decoder.Value( 0 ) );
+}
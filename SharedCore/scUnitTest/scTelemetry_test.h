@@ -0,0 +1,112 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+#pragma once
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"  // Brings in Google Mock.
+
+#include "scStandardHeader.h"
+#include "scStandardMessage.h"
+#include "scMessageFactory.h"
+#include "scMessageRouter.h"
+#include "scTelemetry.h"
+#include "scTelemetryDecoder.h"
+#include "scMutexNoOp.h"
+#include "scAllocator_Imp.h"
+#include <vector>
+
+using namespace ::SharedCore;
+
+// Tests for the telemetry frames and their decoder.
+class scTelemetry_test : public ::testing::Test
+{
+public:
+	void FrameTest();
+	void BudgetTest();
+
+	typedef enum
+	{
+		msg_Command,
+		msg_Telemetry
+	} TelemetryMessages_t;
+
+	class TelemetryMessage : public scStandardMessage<TelemetryMessages_t>
+	{
+	public:
+		TelemetryMessage(const uint8_t* pBuffer = NULL, uint32_t nLength = 0)
+			: scStandardMessage<TelemetryMessages_t>( pBuffer, nLength )
+		{
+		}
+
+		TelemetryMessage& operator=( const TelemetryMessage& source )
+		{
+			if ( this != &source )
+			{
+				this->_pBuffer = source._pBuffer;
+				this->_nLength = source._nLength;
+				this->_Header = source.Header();
+			}
+			return *this;
+		}
+	};
+
+	class TelemetryFactory : public scMessageFactory<TelemetryMessage>
+	{
+	public:
+		TelemetryFactory( uint16_t slots, uint32_t nBytes )
+			: scMessageFactory<TelemetryMessage>( slots, nBytes )
+		{
+		}
+	};
+
+	typedef scMessageRouter<TelemetryMessage>	Router_t;
+	typedef scTelemetry<TelemetryMessage>		Telemetry_t;
+	typedef std::vector<uint8_t>				Payload_t;
+
+	/// <summary>
+	/// Keeps the payload of every telemetry message.
+	/// </summary>
+	static bool Handler( const TelemetryMessage* pMessage, void* pContext );
+
+	static uint32_t Ticks( void );
+
+	static uint32_t			s_nTicks;
+
+protected:
+	scTelemetry_test();
+
+	virtual ~scTelemetry_test();
+
+	virtual void SetUp();
+
+	virtual void TearDown();
+
+	/// <summary>
+	/// Decode a received frame.
+	/// </summary>
+	bool Decode( scTelemetryDecoder& decoder, size_t nFrame );
+
+	scMutexNoOp					_Lock;
+	scAllocator_Imp				_NewOp;
+	scAllocator					_Memory;
+	TelemetryFactory*			_pFactory;
+	Router_t*					_pRouter;
+	Telemetry_t*				_pTelemetry;
+	std::vector<Payload_t>		_Received;
+};
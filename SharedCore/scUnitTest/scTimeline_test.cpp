@@ -0,0 +1,217 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+#include "scTimeline_test.h"
+#include "scAllocator_Imp.h"
+#include "scMutexNoOp.h"
+#include "scAtomic.h"
+#include "scErrorCodes.h"
+#include <string>
+#include <thread>
+#include <stdio.h>
+
+using namespace SharedCore;
+
+#define SPANS		(1000)
+
+// Workers still running, they wait for each other so neither takes the buffer of
+// the other
+static volatile uint32_t	s_nWorkers = 0;
+
+scTimeline_test::scTimeline_test()
+	: _nFired( 0 )
+{
+}
+
+scTimeline_test::~scTimeline_test()
+{
+}
+
+void scTimeline_test::SetUp()
+{
+	scTimeline::Clear();
+}
+
+void scTimeline_test::TearDown()
+{
+	scTimeline::Enable( false );
+	scTimeline::Clear();
+}
+
+void scTimeline_test::Handler( scTimeline_test* pSource, uint32_t nArg, void* )
+{
+	pSource->_nFired += nArg;
+}
+
+uint32_t scTimeline_test::Occurrences( const std::string& text, const char* pFind )
+{
+	uint32_t nCount = 0;
+	for( size_t nAt = text.find( pFind ); nAt != std::string::npos; nAt = text.find( pFind, nAt + 1 ) )
+	{
+		nCount++;
+	}
+	return nCount;
+}
+
+std::string scTimeline_test::Written( void )
+{
+	std::string text;
+	FILE* pFile = tmpfile();
+	EXPECT_TRUE( pFile != NULL );
+	if ( pFile != NULL )
+	{
+		EXPECT_EQ( ERROR_SUCCESS, scTimeline::Write( pFile ) );
+		rewind( pFile );
+
+		char sBuffer[4096];
+		size_t nRead;
+		while( ( nRead = fread( sBuffer, 1, sizeof(sBuffer), pFile ) ) > 0 )
+		{
+			text.append( sBuffer, nRead );
+		}
+		fclose( pFile );
+	}
+	return text;
+}
+
+void scTimeline_test::TimelineTest()
+{
+	// nothing is kept while disabled
+	for( uint32_t i=0; i < 1000; ++i )
+	{
+		scTIMELINE_SCOPE( "test", "Disabled" );
+		scTIMELINE_INSTANT( "test", "Disabled", i );
+	}
+	EXPECT_EQ( 0, scTimeline::Count() );
+
+	scTimeline::Enable( true );
+	EXPECT_TRUE( scTimeline::IsEnabled() );
+
+	// the framework records its own events
+	scEvent<scTimeline_test, uint32_t>	event( this );
+	event.Subscribe( &Handler );
+	event.FireEvent( 3 );
+	EXPECT_EQ( 3, _nFired );
+
+	scMutexNoOp			lock;
+	scAllocator_Imp*	pNewOp = new scAllocator_Imp();
+	scAllocator			memManager( pNewOp );
+	TimelineFactory*	pFactory = new TimelineFactory( 4, 200 );
+	ASSERT_EQ( ERROR_SUCCESS, pFactory->Initialize( memManager, memManager, &lock ) );
+	TimelineMessage*	pMessage = pFactory->Create( 20 );
+	ASSERT_TRUE( pMessage != NULL );
+	EXPECT_TRUE( pFactory->Release( pMessage ) );
+
+	NullDriver			driver;
+	const uint8_t		data[8] = { 0 };
+	driver.Send_n( data, sizeof(data) );
+
+	// spans of other threads go to buffers of their own
+	{
+		scTIMELINE_SCOPE_ARG( "test", "Main", 7 );
+		std::thread threads[2];
+		s_nWorkers = 2;
+		for( uint32_t t=0; t < 2; ++t )
+		{
+			threads[t] = std::thread( []()
+			{
+				for( uint32_t i=0; i < SPANS; ++i )
+				{
+					scTIMELINE_SCOPE( "test", "Worker" );
+				}
+				scAtomicAdd( &s_nWorkers, (uint32_t)-1 );
+				while( scAtomicLoad( &s_nWorkers ) > 0 )
+				{
+					std::this_thread::yield();
+				}
+			} );
+		}
+		threads[0].join();
+		threads[1].join();
+	}
+	EXPECT_EQ( 0, scTimeline::Dropped() );
+
+	std::string text = Written();
+	EXPECT_EQ( ERROR_SC_FILE_FAILURE, scTimeline::Save( "/no such directory/timeline.json" ) );
+
+	EXPECT_EQ( 0, text.find( "{\"traceEvents\":[" ) );
+	EXPECT_NE( std::string::npos, text.find( "\"name\":\"FireEvent\",\"cat\":\"event\",\"ph\":\"B\"" ) );
+	EXPECT_NE( std::string::npos, text.find( "\"name\":\"Create\",\"cat\":\"message\",\"ph\":\"B\"" ) );
+	EXPECT_NE( std::string::npos, text.find( "\"name\":\"Release\",\"cat\":\"message\",\"ph\":\"E\"" ) );
+	EXPECT_NE( std::string::npos, text.find( "\"name\":\"TriggerSend\",\"cat\":\"driver\",\"ph\":\"i\"" ) );
+	EXPECT_NE( std::string::npos, text.find( "\"args\":{\"value\":7}" ) );
+	EXPECT_EQ( 2 * SPANS, Occurrences( text, "\"name\":\"Worker\",\"cat\":\"test\",\"ph\":\"B\"" ) );
+	EXPECT_EQ( Occurrences( text, "\"ph\":\"B\"" ), Occurrences( text, "\"ph\":\"E\"" ) );
+	EXPECT_LE( 3, Occurrences( text, "\"name\":\"thread_name\"" ) );
+	EXPECT_NE( std::string::npos, text.find( "\"ts\":0.000," ) );
+	EXPECT_EQ( "],\"displayTimeUnit\":\"ns\"}\n", text.substr( text.size() - 26 ) );
+
+	// a full buffer drops the newest events
+	scTimeline::Clear();
+	std::thread filler( []()
+	{
+		for( uint32_t i=0; i < SC_TIMELINE_EVENTS + 10; ++i )
+		{
+			scTIMELINE_INSTANT( "test", "Fill", i );
+		}
+	} );
+	filler.join();
+	EXPECT_EQ( SC_TIMELINE_EVENTS, scTimeline::Count() );
+	EXPECT_EQ( 10, scTimeline::Dropped() );
+
+	// a thread takes the buffer of one that ended, and a span whose end was dropped
+	// is ended at the last event
+	uint32_t nThreads = Occurrences( Written(), "\"name\":\"thread_name\"" );
+	scTimeline::Clear();
+	std::thread dropper( []()
+	{
+		scTIMELINE_SCOPE( "test", "Open" );
+		for( uint32_t i=0; i < SC_TIMELINE_EVENTS - 1; ++i )
+		{
+			scTIMELINE_INSTANT( "test", "Fill", i );
+		}
+	} );
+	dropper.join();
+	EXPECT_EQ( 1, scTimeline::Dropped() );
+	text = Written();
+	EXPECT_EQ( nThreads, Occurrences( text, "\"name\":\"thread_name\"" ) );
+	EXPECT_EQ( 1, Occurrences( text, "\"name\":\"Open\",\"cat\":\"test\",\"ph\":\"E\"" ) );
+
+	// an end whose begin was cleared is skipped
+	{
+		scTIMELINE_SCOPE( "test", "Cleared" );
+		scTimeline::Clear();
+	}
+	EXPECT_EQ( 1, scTimeline::Count() );
+	text = Written();
+	EXPECT_EQ( std::string::npos, text.find( "\"name\":\"Cleared\"" ) );
+	EXPECT_EQ( Occurrences( text, "\"ph\":\"B\"" ), Occurrences( text, "\"ph\":\"E\"" ) );
+
+	// a span begun while recording ends even when recording stopped
+	scTimeline::Clear();
+	{
+		scTIMELINE_SCOPE( "test", "Stopping" );
+		scTimeline::Enable( false );
+		scTIMELINE_INSTANT( "test", "Ignored", 0 );
+	}
+	EXPECT_EQ( 2, scTimeline::Count() );
+
+	delete pFactory;
+	delete pNewOp;
+}
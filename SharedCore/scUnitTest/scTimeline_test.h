@@ -0,0 +1,112 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+#pragma once
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"  // Brings in Google Mock.
+
+#include "scTimeline.h"
+#include "scEvent.h"
+#include "scStandardMessage.h"
+#include "scMessageFactory.h"
+#include "scRingBuffer.h"
+#include "HAL/scBufferedIODriver.h"
+
+using namespace ::SharedCore;
+
+// Tests for the timeline of framework events.
+class scTimeline_test : public ::testing::Test
+{
+public:
+	void TimelineTest();
+
+	class TimelineMessage : public scStandardMessage<uint8_t>
+	{
+	public:
+		TimelineMessage(const uint8_t* pBuffer = NULL, uint32_t nLength = 0)
+			: scStandardMessage<uint8_t>( pBuffer, nLength )
+		{
+		}
+
+		TimelineMessage& operator=( const TimelineMessage& source )
+		{
+			if ( this != &source )
+			{
+				this->_pBuffer = source._pBuffer;
+				this->_nLength = source._nLength;
+				this->_Header = source.Header();
+			}
+			return *this;
+		}
+	};
+
+	class TimelineFactory : public scMessageFactory<TimelineMessage>
+	{
+	public:
+		TimelineFactory( uint16_t slots, uint32_t nBytes )
+			: scMessageFactory<TimelineMessage>( slots, nBytes )
+		{
+		}
+	};
+
+	/// <summary>
+	/// Driver sending into nowhere, to record TriggerSend.
+	/// </summary>
+	class NullDriver : public HAL::scBufferIODriver
+	{
+	public:
+		NullDriver() : HAL::scBufferIODriver( scDeviceDescriptor(0x0100) )
+		{
+			SetQueue( NULL, new scRingBuffer( 64, new uint8_t[64], NULL ) );
+		}
+		virtual void TriggerSend(void)
+		{
+			while( _pQueueOut->InUse() > 0 )
+			{
+				_pQueueOut->ReadEnd( _pQueueOut->ReadStart() );
+			}
+		}
+	};
+
+	/// <summary>
+	/// Counts the events fired.
+	/// </summary>
+	static void Handler( scTimeline_test* pSource, uint32_t nArg, void* pContext );
+
+	/// <summary>
+	/// Number of times a string appears in the text.
+	/// </summary>
+	static uint32_t Occurrences( const std::string& text, const char* pFind );
+
+	/// <summary>
+	/// The timeline as written.
+	/// </summary>
+	static std::string Written( void );
+
+	uint32_t				_nFired;
+
+protected:
+	scTimeline_test();
+
+	virtual ~scTimeline_test();
+
+	virtual void SetUp();
+
+	virtual void TearDown();
+};
@@ -0,0 +1,180 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+
+#include "gmock/gmock.h"
+#include "scTraceQueue_test.h"
+#include "scErrorCodes.h"
+#include <string>
+#include <thread>
+#include <stdio.h>
+
+using namespace SharedCore;
+
+#define PRODUCERS		(4)
+#define RECORDS			(20000)
+
+void scTraceQueue_test::Collect( const uint8_t* pData, uint32_t nLength, uint16_t nTag, void* pContext )
+{
+	std::string* pText = reinterpret_cast<std::string*>( pContext );
+	pText->append( reinterpret_cast<const char*>(pData), nLength );
+	if ( nTag != 0 )
+	{
+		pText->append( 1, (char)( '0' + nTag ) );
+	}
+	pText->append( "|" );
+}
+
+void scTraceQueue_test::Checker::Read( const uint8_t* pData, uint32_t nLength, uint16_t nTag, void* pContext )
+{
+	Checker*	pThis = reinterpret_cast<Checker*>( pContext );
+	Record_t	record;
+
+	EXPECT_EQ( sizeof(Record_t), nLength );
+	memcpy( &record, pData, sizeof(record) );
+
+	// records may be lost but never reordered
+	if ( record._nSequence < pThis->_Next[record._nProducer] )
+	{
+		pThis->_nOutOfOrder++;
+	}
+	pThis->_Next[record._nProducer] = record._nSequence + 1;
+	pThis->_nReceived++;
+}
+
+void scTraceQueue_test::Yield( void )
+{
+	std::this_thread::yield();
+}
+
+scTraceQueue_test::scTraceQueue_test()
+	: _NewOp()
+	, _Memory( &_NewOp )
+{
+}
+
+scTraceQueue_test::~scTraceQueue_test()
+{
+}
+
+void scTraceQueue_test::PolicyTest()
+{
+	scTraceQueue	queue( 4, 8 );
+	std::string		sText;
+	const char*		names[] = { "one", "two", "three", "four", "five", "six" };
+
+	ASSERT_EQ( ERROR_SUCCESS, queue.Initialize( _Memory ) );
+
+	// the newest records are lost once full
+	for( int i=0; i < 6; ++i )
+	{
+		EXPECT_EQ( i < 4, queue.Push( reinterpret_cast<const uint8_t*>(names[i]), (uint32_t)strlen( names[i] ) ) );
+	}
+	EXPECT_EQ( 4, queue.Count() );
+	EXPECT_EQ( 4, queue.Written() );
+	EXPECT_EQ( 2, queue.Dropped() );
+	EXPECT_EQ( 4, queue.Drain( &Collect, &sText ) );
+	EXPECT_EQ( "one|two|three|four|", sText );
+	EXPECT_EQ( 0, queue.Count() );
+
+	// the oldest records are lost once full
+	queue.ResetCounters();
+	queue.SetPolicy( scTraceDropOldest );
+	sText.clear();
+	for( int i=0; i < 6; ++i )
+	{
+		EXPECT_TRUE( queue.Push( reinterpret_cast<const uint8_t*>(names[i]), (uint32_t)strlen( names[i] ) ) );
+	}
+	EXPECT_EQ( 2, queue.Dropped() );
+	EXPECT_EQ( 6, queue.Written() );
+	EXPECT_EQ( 2, queue.Drain( &Collect, &sText, 2 ) );
+	EXPECT_EQ( 2, queue.Drain( &Collect, &sText ) );
+	EXPECT_EQ( "three|four|five|six|", sText );
+
+	// long records are cut to the slot, a record can be built in place
+	sText.clear();
+	const char* pLong = "0123456789";
+	queue.Push( reinterpret_cast<const uint8_t*>(pLong), 10 );
+	uint32_t nSize = 0;
+	uint8_t* pSlot = queue.Reserve( nSize );
+	ASSERT_TRUE( pSlot != NULL );
+	EXPECT_EQ( 8, nSize );
+	memcpy( pSlot, "abc", 3 );
+	queue.Commit( pSlot, 3, 5 );
+	queue.Drain( &Collect, &sText );
+	EXPECT_EQ( "01234567|abc5|", sText );
+}
+
+void scTraceQueue_test::RunThreads( scTracePolicy_t nPolicy )
+{
+	scTraceQueue	queue( 64, sizeof(Record_t), nPolicy );
+	Checker			checker( PRODUCERS );
+	volatile uint32_t	nDone = 0;
+
+	queue.Initialize( _Memory );
+	queue.SetYield( &Yield );
+
+	std::thread reader( [&]()
+	{
+		while( scAtomicLoad( &nDone ) == 0 )
+		{
+			if ( queue.Drain( &Checker::Read, &checker ) == 0 )
+			{
+				std::this_thread::yield();
+			}
+		}
+		queue.Drain( &Checker::Read, &checker );
+	} );
+
+	std::vector<std::thread> writers;
+	for( uint32_t p=0; p < PRODUCERS; ++p )
+	{
+		writers.push_back( std::thread( [&queue, p]()
+		{
+			for( uint32_t i=0; i < RECORDS; ++i )
+			{
+				Record_t record = { p, i };
+				queue.Push( reinterpret_cast<const uint8_t*>(&record), sizeof(record) );
+			}
+		} ) );
+	}
+	for( uint32_t p=0; p < PRODUCERS; ++p )
+	{
+		writers[p].join();
+	}
+	scAtomicStore( &nDone, 1 );
+	reader.join();
+
+	printf( "policy %d: %u written, %u received, %u dropped, %u waits\n", (int)nPolicy,
+		queue.Written(), checker._nReceived, queue.Dropped(), queue.Waits() );
+
+	EXPECT_EQ( 0, checker._nOutOfOrder );
+	// every record is either received or counted as dropped
+	EXPECT_EQ( PRODUCERS * RECORDS, checker._nReceived + queue.Dropped() );
+	if ( nPolicy == scTraceBlock )
+	{
+		EXPECT_EQ( 0, queue.Dropped() );
+	}
+}
+
+void scTraceQueue_test::ThreadedTest()
+{
+	RunThreads( scTraceBlock );
+	RunThreads( scTraceDropNewest );
+	RunThreads( scTraceDropOldest );
+}
@@ -0,0 +1,80 @@
+//==============================================================================
+//           Copyright Common Ground Software Solutions 2014
+//          chris.snyder@commongroundss.com
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>
+//
+//==============================================================================
+#pragma once
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"  // Brings in Google Mock.
+
+#include "scTraceQueue.h"
+#include "scAllocator_Imp.h"
+#include <vector>
+
+using namespace ::SharedCore;
+
+// Tests for the lock-free queue used by the asynchronous debug output.
+class scTraceQueue_test : public ::testing::Test
+{
+public:
+	void PolicyTest();
+	void ThreadedTest();
+
+	/// <summary>
+	/// Record written by the producer threads.
+	/// </summary>
+	typedef struct
+	{
+		uint32_t		_nProducer;
+		uint32_t		_nSequence;
+	} Record_t;
+
+	/// <summary>
+	/// Collects what was drained.
+	/// </summary>
+	static void Collect( const uint8_t* pData, uint32_t nLength, uint16_t nTag, void* pContext );
+
+	/// <summary>
+	/// Checks the records from each producer arrive in order.
+	/// </summary>
+	class Checker
+	{
+	public:
+		Checker( uint32_t nProducers ) : _Next( nProducers, 0 ), _nReceived(0), _nOutOfOrder(0) {}
+
+		static void Read( const uint8_t* pData, uint32_t nLength, uint16_t nTag, void* pContext );
+
+		std::vector<uint32_t>	_Next;
+		uint32_t				_nReceived;
+		uint32_t				_nOutOfOrder;
+	};
+
+	static void Yield( void );
+
+protected:
+	scTraceQueue_test();
+
+	virtual ~scTraceQueue_test();
+
+	/// <summary>
+	/// Run producers against one reader and check the result.
+	/// </summary>
+	void RunThreads( scTracePolicy_t nPolicy );
+
+	scAllocator_Imp				_NewOp;
+	scAllocator					_Memory;
+};
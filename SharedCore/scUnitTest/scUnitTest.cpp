@@ -38,6 +38,19 @@
 #include "scLedTests.h"
 #include "scIODriverTests.h"
 #include "scModuleManager_test.h"
+#include "scMessageRouter_test.h"
+#include "scMessageBatcher_test.h"
+#include "scReliableLink_test.h"
+#include "scMessageFragment_test.h"
+#include "scTraceQueue_test.h"
+#include "scFormat_test.h"
+#include "scDebugPathFile_test.h"
+#include "scProfiler_test.h"
+#include "scTimeline_test.h"
+#include "scMetrics_test.h"
+#include "scConsole_test.h"
+#include "scTelemetry_test.h"
+#include "scMutexProfiler_test.h"
 
 using namespace ::SharedCore;
 
@@ -243,6 +256,11 @@ TEST_F(scRingBuffer_Test, SingleByteFill )
 	SingleByteFill();
 }
 
+TEST_F(scRingBuffer_Test, FormatWrap )
+{
+	FormatWrap();
+}
+
 TEST_F(scDeviceGuid_test, DeviceDescriptorTest )
 {
 	DeviceDescriptorTest();
@@ -273,6 +291,56 @@ TEST_F(scDebugManager_test, SimplePathTest )
 	SimplePathTest();
 }
 
+TEST_F(scDebugManager_test, BinaryTraceTest )
+{
+	BinaryTraceTest();
+}
+
+TEST_F(scDebugManager_test, AsyncTraceTest )
+{
+	AsyncTraceTest();
+}
+
+TEST_F(scDebugManager_test, TraceMacroTest )
+{
+	TraceMacroTest();
+}
+
+TEST_F(scDebugManager_test, LabelGroupTest )
+{
+	LabelGroupTest();
+}
+
+TEST_F(scDebugManager_test, DevicePathTest )
+{
+	DevicePathTest();
+}
+
+TEST_F(scDebugManager_test, PrintArrayTest )
+{
+	PrintArrayTest();
+}
+
+TEST_F(scDebugManager_test, RecorderTest )
+{
+	RecorderTest();
+}
+
+TEST_F(scDebugManager_test, BlockPathTest )
+{
+	BlockPathTest();
+}
+
+TEST_F(scDebugManager_test, TimestampTest )
+{
+	TimestampTest();
+}
+
+TEST_F(scDebugManager_test, LimitTest )
+{
+	LimitTest();
+}
+
 TEST_F(scMessage_tests, StandardHeader )
 {
 	StandardHeader();
@@ -298,6 +366,11 @@ TEST_F(scMessage_tests, FactoryTestUsedNoOverflow )
 	FactoryTestUsedNoOverflow();
 }
 
+TEST_F(scMessage_tests, FactoryLocalRangeTest )
+{
+	FactoryLocalRangeTest();
+}
+
 
 TEST_F(scLedTests, LedIF_Test )
 {
@@ -319,6 +392,148 @@ TEST_F(scIODriverTests, CallbackIODriver_Test )
 	CallbackIODriver_Test();
 }
 
+TEST_F(scIODriverTests, ScatterGatherSend_Test )
+{
+	ScatterGatherSend_Test();
+}
+
+TEST_F(scMessageRouter_test, RouteTest )
+{
+	RouteTest();
+}
+
+TEST_F(scMessageRouter_test, WildcardTest )
+{
+	WildcardTest();
+}
+
+TEST_F(scMessageRouter_test, FanOutTest )
+{
+	FanOutTest();
+}
+
+TEST_F(scMessageRouter_test, FanOutLimitTest )
+{
+	FanOutLimitTest();
+}
+
+TEST_F(scMessageRouter_test, ReplaceTest )
+{
+	ReplaceTest();
+}
+
+TEST_F(scMessageBatcher_test, BatchTest )
+{
+	BatchTest();
+}
+
+TEST_F(scMessageBatcher_test, DeadlineTest )
+{
+	DeadlineTest();
+}
+
+TEST_F(scReliableLink_test, InOrderTest )
+{
+	InOrderTest();
+}
+
+TEST_F(scMessageFragment_test, TransferTest )
+{
+	TransferTest();
+}
+
+TEST_F(scMessageFragment_test, BlockSinkTest )
+{
+	BlockSinkTest();
+}
+
+TEST_F(scMessageFragment_test, LossTest )
+{
+	LossTest();
+}
+
+TEST_F(scMessageFragment_test, RestartTest )
+{
+	RestartTest();
+}
+
+TEST_F(scMessageFragment_test, LinkTest )
+{
+	LinkTest();
+}
+
+TEST_F(scTraceQueue_test, PolicyTest )
+{
+	PolicyTest();
+}
+
+TEST_F(scFormat_test, ConversionTest )
+{
+	ConversionTest();
+}
+
+TEST_F(scFormat_test, TypeSafeTest )
+{
+	TypeSafeTest();
+}
+
+#if defined(__linux__) || defined(_WIN32)
+TEST_F(scDebugPathFile_test, RotationTest )
+{
+	RotationTest();
+}
+
+TEST_F(scDebugPathFile_test, MappedTest )
+{
+	MappedTest();
+}
+#endif
+
+TEST_F(scProfiler_test, ProbeTest )
+{
+	ProbeTest();
+}
+
+TEST_F(scTimeline_test, TimelineTest )
+{
+	TimelineTest();
+}
+
+TEST_F(scMetrics_test, RegistryTest )
+{
+	RegistryTest();
+}
+
+TEST_F(scMetrics_test, ComponentTest )
+{
+	ComponentTest();
+}
+
+TEST_F(scConsole_test, ConsoleTest )
+{
+	ConsoleTest();
+}
+
+TEST_F(scTelemetry_test, FrameTest )
+{
+	FrameTest();
+}
+
+TEST_F(scTelemetry_test, BudgetTest )
+{
+	BudgetTest();
+}
+
+TEST_F(scMutexProfiler_test, ContentionTest )
+{
+	ContentionTest();
+}
+
+TEST_F(scMutexProfiler_test, ThreadTest )
+{
+	ThreadTest();
+}
+
 TEST_F(scLedTests, LedEngine_Test )
 {
 	LedEngine_Test();
@@ -338,6 +553,38 @@ TEST_F(scMessage_tests, FactoryStressTest )
 	FactoryStressTest();
 }
 
+TEST_F(scMessage_tests, FactoryLatencyTest )
+{
+	FactoryLatencyTest();
+}
+
+TEST_F(scTraceQueue_test, ThreadedTest )
+{
+	ThreadedTest();
+}
+
+TEST_F(scDebugManager_test, ConcurrentTraceTest )
+{
+	ConcurrentTraceTest();
+}
+
+#if defined(__linux__) || defined(_WIN32)
+TEST_F(scDebugPathFile_test, ThroughputTest )
+{
+	ThroughputTest();
+}
+#endif
+
+TEST_F(scReliableLink_test, LossyGoodputTest )
+{
+	LossyGoodputTest();
+}
+
+TEST_F(scFormat_test, BenchmarkTest )
+{
+	BenchmarkTest();
+}
+
 //////////////////////////////////////////////////////
 // End of all tests
 //////////////////////////////////////////////////////